@@ -32,6 +32,21 @@ namespace cacore
     };
 
 
+    //Content hash of a byte range, i.e. of files and cooked data
+    inline uint64_t hash_bytes(void const* pData, uint64_t size) noexcept
+    {
+        fnv1a hasher{};
+        hasher(pData, size);
+        return static_cast<uint64_t>(hasher);
+    }
+
+    //Check of binary files that record the size and hash of the payload following their header.
+    //False when the payload was truncated, extended or changed
+    inline bool verify_payload(uint64_t recordedSize, uint64_t recordedHash, void const* pPayload, uint64_t payloadSize) noexcept
+    {
+        return recordedSize == payloadSize && recordedHash == hash_bytes(pPayload, payloadSize);
+    }
+
     template<typename T>
     struct custom_hash_trait
     {
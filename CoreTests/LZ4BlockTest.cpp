@@ -0,0 +1,74 @@
+#include <LZ4Block.h>
+#include <DebugUtils.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAString.h>
+#include <random>
+
+using namespace resource_management;
+
+namespace
+{
+	bool TestRoundTrip(castl::vector<uint8_t> const& source, castl::string const& name)
+	{
+		castl::vector<uint8_t> compressed;
+		lz4_block::Compress(source.data(), source.size(), compressed);
+		castl::vector<uint8_t> decompressed(source.size());
+		if (!lz4_block::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size())
+			|| decompressed != source)
+		{
+			CA_LOG_ERR("LZ4 Roundtrip Failed: " + name);
+			return false;
+		}
+		return true;
+	}
+}
+
+bool TestLZ4Block()
+{
+	bool result = TestRoundTrip({}, "Empty");
+	result &= TestRoundTrip({ 1, 2, 3, 4, 5, 6, 7 }, "Shorter Than A Match");
+
+	std::mt19937 random(7);
+	castl::vector<uint8_t> noise(70000);
+	for (uint8_t& value : noise)
+	{
+		value = static_cast<uint8_t>(random());
+	}
+	result &= TestRoundTrip(noise, "Noise");
+
+	//Long runs need extended lengths, the pattern repeats past the largest match offset
+	castl::vector<uint8_t> repetitive(200000);
+	for (size_t byteID = 0; byteID < repetitive.size(); ++byteID)
+	{
+		repetitive[byteID] = byteID < 1000 ? 42 : static_cast<uint8_t>((byteID * 7) % 251 + (byteID / 4096) % 3);
+	}
+	result &= TestRoundTrip(repetitive, "Repetitive");
+
+	castl::vector<uint8_t> compressed;
+	lz4_block::Compress(repetitive.data(), repetitive.size(), compressed);
+	if (compressed.size() >= repetitive.size() / 4)
+	{
+		CA_LOG_ERR("LZ4 Does Not Compress Repetitive Data");
+		result = false;
+	}
+
+	//Malformed blocks and wrong sizes are rejected without writing past the destination
+	castl::vector<uint8_t> decompressed(repetitive.size() + 1);
+	if (lz4_block::Decompress(compressed.data(), compressed.size() - 1, decompressed.data(), repetitive.size())
+		|| lz4_block::Decompress(compressed.data(), compressed.size(), decompressed.data(), repetitive.size() - 1)
+		|| lz4_block::Decompress(compressed.data(), compressed.size(), decompressed.data(), repetitive.size() + 1))
+	{
+		CA_LOG_ERR("LZ4 Accepts A Truncated Block Or A Wrong Size");
+		result = false;
+	}
+	castl::vector<uint8_t> corrupted = compressed;
+	//The first sequence of the run of 42 has one literal, its offset is 1. Offset 0 is invalid
+	corrupted[2] = 0;
+	corrupted[3] = 0;
+	if (lz4_block::Decompress(corrupted.data(), corrupted.size(), decompressed.data(), repetitive.size()))
+	{
+		CA_LOG_ERR("LZ4 Accepts A Zero Match Offset");
+		result = false;
+	}
+	return result;
+}
@@ -0,0 +1,208 @@
+#include <MeshCookPasses.h>
+#include <DebugUtils.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAArray.h>
+#include <CASTL/CAString.h>
+#include <CASTL/CAAlgorithm.h>
+#include <cmath>
+
+using namespace resource_management;
+
+namespace
+{
+	//Flat grid of quadCount x quadCount quads in the xy plane, two triangles per quad
+	void BuildGrid(uint32_t quadCount, castl::vector<glm::vec3>& outPositions, castl::vector<uint32_t>& outIndices)
+	{
+		uint32_t rowVertices = quadCount + 1;
+		outPositions.clear();
+		outIndices.clear();
+		for (uint32_t y = 0; y < rowVertices; ++y)
+		{
+			for (uint32_t x = 0; x < rowVertices; ++x)
+			{
+				outPositions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), 0.0f));
+			}
+		}
+		for (uint32_t y = 0; y < quadCount; ++y)
+		{
+			for (uint32_t x = 0; x < quadCount; ++x)
+			{
+				uint32_t corner = y * rowVertices + x;
+				uint32_t quad[6] = { corner, corner + 1, corner + rowVertices + 1, corner, corner + rowVertices + 1, corner + rowVertices };
+				outIndices.insert(outIndices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	bool CheckIndices(castl::vector<uint32_t> const& indices, uint32_t vertexCount, castl::string const& name)
+	{
+		if (indices.size() % 3 != 0)
+		{
+			CA_LOG_ERR(name + ": Index Count Is Not A Multiple Of 3");
+			return false;
+		}
+		for (uint32_t index : indices)
+		{
+			if (index >= vertexCount)
+			{
+				CA_LOG_ERR(name + ": Index Out Of Bounds");
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Signed area of the triangles projected on the xy plane
+	float ProjectedArea(castl::vector<uint32_t> const& indices, castl::vector<glm::vec3> const& positions)
+	{
+		float area = 0.0f;
+		for (uint32_t indexID = 0; indexID < indices.size(); indexID += 3)
+		{
+			glm::vec3 a = positions[indices[indexID]];
+			glm::vec3 b = positions[indices[indexID + 1]];
+			glm::vec3 c = positions[indices[indexID + 2]];
+			area += 0.5f * ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+		}
+		return area;
+	}
+
+	bool TestVertexOrder(castl::vector<uint32_t> indices, uint32_t vertexCount)
+	{
+		castl::vector<uint32_t> sourceIndices = indices;
+		MeshVertexOrderPass::OptimizeVertexCache(indices.data(), static_cast<uint32_t>(indices.size()), vertexCount);
+		if (!CheckIndices(indices, vertexCount, "Vertex Cache Order"))
+		{
+			return false;
+		}
+		castl::vector<uint32_t> vertexOrder = MeshVertexOrderPass::OptimizeVertexFetch(indices.data(), static_cast<uint32_t>(indices.size()), vertexCount);
+		if (!CheckIndices(indices, vertexCount, "Vertex Fetch Order"))
+		{
+			return false;
+		}
+		castl::vector<uint32_t> sortedOrder = vertexOrder;
+		castl::sort(sortedOrder.begin(), sortedOrder.end());
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			if (sortedOrder.size() != vertexCount || sortedOrder[vertexID] != vertexID)
+			{
+				CA_LOG_ERR("Vertex Fetch Order Is Not A Permutation");
+				return false;
+			}
+		}
+		//Both orders keep every triangle, the corners of a triangle keep their winding
+		castl::vector<castl::array<uint32_t, 3>> sourceTriangles;
+		castl::vector<castl::array<uint32_t, 3>> reorderedTriangles;
+		for (uint32_t indexID = 0; indexID < indices.size(); indexID += 3)
+		{
+			castl::array<uint32_t, 3> source = { sourceIndices[indexID], sourceIndices[indexID + 1], sourceIndices[indexID + 2] };
+			castl::array<uint32_t, 3> reordered = { vertexOrder[indices[indexID]], vertexOrder[indices[indexID + 1]], vertexOrder[indices[indexID + 2]] };
+			castl::rotate(source.begin(), castl::min_element(source.begin(), source.end()), source.end());
+			castl::rotate(reordered.begin(), castl::min_element(reordered.begin(), reordered.end()), reordered.end());
+			sourceTriangles.push_back(source);
+			reorderedTriangles.push_back(reordered);
+		}
+		castl::sort(sourceTriangles.begin(), sourceTriangles.end());
+		castl::sort(reorderedTriangles.begin(), reorderedTriangles.end());
+		if (sourceTriangles != reorderedTriangles)
+		{
+			CA_LOG_ERR("Vertex Order Changes The Triangles");
+			return false;
+		}
+		return true;
+	}
+
+	bool TestMeshlets(castl::vector<uint32_t> const& indices, uint32_t vertexCount)
+	{
+		auto meshlets = MeshletBuildPass::SplitMeshlets(indices.data(), static_cast<uint32_t>(indices.size()), vertexCount);
+		uint32_t nextIndex = 0;
+		castl::vector<uint32_t> vertexMeshlet(vertexCount, ~0u);
+		for (uint32_t meshletID = 0; meshletID < meshlets.size(); ++meshletID)
+		{
+			auto const& meshlet = meshlets[meshletID];
+			if (meshlet.firstIndex != nextIndex || meshlet.indexCount == 0 || meshlet.indexCount % 3 != 0)
+			{
+				CA_LOG_ERR("Meshlets Do Not Cover The Triangles In Order");
+				return false;
+			}
+			if (meshlet.indexCount / 3 > MeshletBuildPass::MAX_MESHLET_TRIANGLES || meshlet.vertexCount > MeshletBuildPass::MAX_MESHLET_VERTICES)
+			{
+				CA_LOG_ERR("Meshlet " + castl::to_string(meshletID) + " Exceeds The Vertex Or Primitive Limit");
+				return false;
+			}
+			uint32_t distinctVertices = 0;
+			for (uint32_t indexID = meshlet.firstIndex; indexID < meshlet.firstIndex + meshlet.indexCount; ++indexID)
+			{
+				if (vertexMeshlet[indices[indexID]] != meshletID)
+				{
+					vertexMeshlet[indices[indexID]] = meshletID;
+					++distinctVertices;
+				}
+			}
+			if (distinctVertices != meshlet.vertexCount)
+			{
+				CA_LOG_ERR("Meshlet " + castl::to_string(meshletID) + " Vertex Count Does Not Match Its Indices");
+				return false;
+			}
+			nextIndex += meshlet.indexCount;
+		}
+		if (nextIndex != indices.size())
+		{
+			CA_LOG_ERR("Meshlets Do Not Cover The Triangles In Order");
+			return false;
+		}
+		return true;
+	}
+
+	bool TestSimplify(castl::vector<uint32_t> const& indices, castl::vector<glm::vec3> const& positions)
+	{
+		uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+		uint32_t targetIndexCount = static_cast<uint32_t>(indices.size()) / 4 / 3 * 3;
+		float error = 0.0f;
+		castl::vector<uint32_t> lodIndices = MeshLodPass::Simplify(indices.data(), static_cast<uint32_t>(indices.size())
+			, positions.data(), vertexCount, targetIndexCount, 0.01f, error);
+		if (!CheckIndices(lodIndices, vertexCount, "LOD"))
+		{
+			return false;
+		}
+		if (lodIndices.empty() || lodIndices.size() >= indices.size())
+		{
+			CA_LOG_ERR("LOD Does Not Reduce The Grid");
+			return false;
+		}
+		for (uint32_t indexID = 0; indexID < lodIndices.size(); indexID += 3)
+		{
+			if (lodIndices[indexID] == lodIndices[indexID + 1] || lodIndices[indexID + 1] == lodIndices[indexID + 2] || lodIndices[indexID] == lodIndices[indexID + 2])
+			{
+				CA_LOG_ERR("LOD Keeps A Degenerate Triangle");
+				return false;
+			}
+		}
+		//A flat grid simplifies without error, its border stays in place so the covered area does not change
+		float sourceArea = ProjectedArea(indices, positions);
+		float lodArea = ProjectedArea(lodIndices, positions);
+		if (error > 0.01f || std::abs(lodArea - sourceArea) > sourceArea * 1e-4f)
+		{
+			CA_LOG_ERR("LOD Moves The Surface Of A Flat Grid");
+			return false;
+		}
+		return true;
+	}
+}
+
+bool TestMeshCook()
+{
+	castl::vector<glm::vec3> positions;
+	castl::vector<uint32_t> indices;
+	//More vertices and triangles than a single meshlet holds
+	BuildGrid(24, positions, indices);
+	uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+	bool result = CheckIndices(indices, vertexCount, "Grid");
+	result &= TestVertexOrder(indices, vertexCount);
+	result &= TestMeshlets(indices, vertexCount);
+	castl::vector<uint32_t> cacheOrdered = indices;
+	MeshVertexOrderPass::OptimizeVertexCache(cacheOrdered.data(), static_cast<uint32_t>(cacheOrdered.size()), vertexCount);
+	result &= TestMeshlets(cacheOrdered, vertexCount);
+	result &= TestSimplify(indices, positions);
+	return result;
+}
@@ -92,6 +92,10 @@ struct TestStruct3
 	}
 };
 
+bool TestLZ4Block();
+bool TestTextureBlockEncoding();
+bool TestMeshCook();
+
 void TestHash()
 {
 	static_assert(careflection::containerInfo<glm::vec3>::container_size(glm::vec3{ 1, 1, 1 }) == 3);
@@ -182,5 +186,9 @@ int main(int argc, char* argv[])
 	TestStruct1 testStruct3;
 	cacore::deserializer<decltype(byteBuffer)> deserializer1(byteBuffer);
 	deserializer1.deserialize(testStruct3);
-	return 0;
+
+	bool passed = TestLZ4Block();
+	passed &= TestTextureBlockEncoding();
+	passed &= TestMeshCook();
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <TextureCookPasses.h>
+#include <DebugUtils.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAString.h>
+#include <cstdlib>
+
+using namespace resource_management;
+
+namespace
+{
+	constexpr uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	//Reference decoders of the modes the encoder writes, outTexels holds 16 RGBA texels
+	void DecodeBC1Color(uint8_t const* pBlock, uint8_t (&outTexels)[16][4])
+	{
+		uint16_t colors[2] = { static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8)), static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8)) };
+		int32_t palette[4][3];
+		for (uint32_t colorID = 0; colorID < 2; ++colorID)
+		{
+			uint32_t r = (colors[colorID] >> 11) & 31;
+			uint32_t g = (colors[colorID] >> 5) & 63;
+			uint32_t b = colors[colorID] & 31;
+			palette[colorID][0] = (r << 3) | (r >> 2);
+			palette[colorID][1] = (g << 2) | (g >> 4);
+			palette[colorID][2] = (b << 3) | (b >> 2);
+		}
+		for (uint32_t channelID = 0; channelID < 3; ++channelID)
+		{
+			if (colors[0] > colors[1])
+			{
+				palette[2][channelID] = (2 * palette[0][channelID] + palette[1][channelID]) / 3;
+				palette[3][channelID] = (palette[0][channelID] + 2 * palette[1][channelID]) / 3;
+			}
+			else
+			{
+				palette[2][channelID] = (palette[0][channelID] + palette[1][channelID]) / 2;
+				palette[3][channelID] = 0;
+			}
+		}
+		uint32_t indexBits = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<uint32_t>(pBlock[7]) << 24);
+		for (uint32_t texelID = 0; texelID < 16; ++texelID)
+		{
+			uint32_t index = (indexBits >> (texelID * 2)) & 3;
+			for (uint32_t channelID = 0; channelID < 3; ++channelID)
+			{
+				outTexels[texelID][channelID] = static_cast<uint8_t>(palette[index][channelID]);
+			}
+		}
+	}
+
+	void DecodeBC4Channel(uint8_t const* pBlock, uint32_t channelID, uint8_t (&outTexels)[16][4])
+	{
+		int32_t palette[8] = { pBlock[0], pBlock[1] };
+		if (palette[0] > palette[1])
+		{
+			for (int32_t stepID = 1; stepID < 7; ++stepID)
+			{
+				palette[stepID + 1] = ((7 - stepID) * palette[0] + stepID * palette[1]) / 7;
+			}
+		}
+		else
+		{
+			for (int32_t stepID = 1; stepID < 5; ++stepID)
+			{
+				palette[stepID + 1] = ((5 - stepID) * palette[0] + stepID * palette[1]) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		uint64_t indexBits = 0;
+		for (uint32_t byteID = 2; byteID < 8; ++byteID)
+		{
+			indexBits |= static_cast<uint64_t>(pBlock[byteID]) << ((byteID - 2) * 8);
+		}
+		for (uint32_t texelID = 0; texelID < 16; ++texelID)
+		{
+			outTexels[texelID][channelID] = static_cast<uint8_t>(palette[(indexBits >> (texelID * 3)) & 7]);
+		}
+	}
+
+	uint32_t ReadBits(uint8_t const* pBlock, uint32_t& inoutPosition, uint32_t bitCount)
+	{
+		uint32_t value = 0;
+		for (uint32_t bitID = 0; bitID < bitCount; ++bitID, ++inoutPosition)
+		{
+			value |= ((pBlock[inoutPosition / 8] >> (inoutPosition % 8)) & 1) << bitID;
+		}
+		return value;
+	}
+
+	//Mode 6 only, false for any other mode
+	bool DecodeBC7Block(uint8_t const* pBlock, uint8_t (&outTexels)[16][4])
+	{
+		uint32_t position = 0;
+		if (ReadBits(pBlock, position, 7) != (1 << 6))
+		{
+			return false;
+		}
+		uint32_t endpoints[2][4];
+		for (uint32_t channelID = 0; channelID < 4; ++channelID)
+		{
+			endpoints[0][channelID] = ReadBits(pBlock, position, 7);
+			endpoints[1][channelID] = ReadBits(pBlock, position, 7);
+		}
+		uint32_t parities[2];
+		parities[0] = ReadBits(pBlock, position, 1);
+		parities[1] = ReadBits(pBlock, position, 1);
+		for (uint32_t texelID = 0; texelID < 16; ++texelID)
+		{
+			uint32_t weight = BC7_WEIGHTS4[ReadBits(pBlock, position, texelID == 0 ? 3 : 4)];
+			for (uint32_t channelID = 0; channelID < 4; ++channelID)
+			{
+				uint32_t value0 = (endpoints[0][channelID] << 1) | parities[0];
+				uint32_t value1 = (endpoints[1][channelID] << 1) | parities[1];
+				outTexels[texelID][channelID] = static_cast<uint8_t>(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+			}
+		}
+		return true;
+	}
+
+	//Encodes the image, decodes every block and compares the texels inside the image with the source
+	bool TestFormat(ETextureFormat format, castl::string const& name, castl::vector<uint8_t> const& rgba, uint32_t width, uint32_t height
+		, int32_t maxColorError, int32_t maxAlphaError)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blocksY = (height + 3) / 4;
+		uint32_t blockBytes = GetFormatBlockBytes(format);
+		castl::vector<uint8_t> encoded(blocksX * blocksY * blockBytes);
+		TextureCooker::EncodeBlockRows(format, rgba.data(), width, height, 0, blocksY, encoded.data());
+		int32_t colorError = 0;
+		int32_t alphaError = 0;
+		for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+			{
+				uint8_t const* pBlock = encoded.data() + (blockY * blocksX + blockX) * blockBytes;
+				uint8_t texels[16][4] = {};
+				uint32_t colorChannels = 3;
+				bool hasAlpha = false;
+				switch (format)
+				{
+				case ETextureFormat::E_BC1_RGBA_UNORM:
+					DecodeBC1Color(pBlock, texels);
+					break;
+				case ETextureFormat::E_BC3_UNORM:
+					DecodeBC4Channel(pBlock, 3, texels);
+					DecodeBC1Color(pBlock + 8, texels);
+					hasAlpha = true;
+					break;
+				case ETextureFormat::E_BC5_UNORM:
+					DecodeBC4Channel(pBlock, 0, texels);
+					DecodeBC4Channel(pBlock + 8, 1, texels);
+					colorChannels = 2;
+					break;
+				case ETextureFormat::E_BC7_UNORM:
+					if (!DecodeBC7Block(pBlock, texels))
+					{
+						CA_LOG_ERR("BC7 Block Is Not Mode 6: " + name);
+						return false;
+					}
+					hasAlpha = true;
+					break;
+				default:
+					return false;
+				}
+				for (uint32_t texelID = 0; texelID < 16; ++texelID)
+				{
+					uint32_t x = blockX * 4 + texelID % 4;
+					uint32_t y = blockY * 4 + texelID / 4;
+					if (x >= width || y >= height)
+					{
+						continue;
+					}
+					uint8_t const* pSource = rgba.data() + (y * width + x) * 4;
+					for (uint32_t channelID = 0; channelID < colorChannels; ++channelID)
+					{
+						colorError = castl::max(colorError, std::abs(texels[texelID][channelID] - pSource[channelID]));
+					}
+					if (hasAlpha)
+					{
+						alphaError = castl::max(alphaError, std::abs(texels[texelID][3] - pSource[3]));
+					}
+				}
+			}
+		}
+		if (colorError > maxColorError || alphaError > maxAlphaError)
+		{
+			CA_LOG_ERR("Block Encoding Error Too Large: " + name + " Color " + castl::to_string(colorError) + " Alpha " + castl::to_string(alphaError));
+			return false;
+		}
+		return true;
+	}
+}
+
+bool TestTextureBlockEncoding()
+{
+	//Sizes that are not multiples of 4 load the edge blocks with repeated texels
+	constexpr uint32_t width = 30;
+	constexpr uint32_t height = 22;
+	castl::vector<uint8_t> solid(width * height * 4);
+	castl::vector<uint8_t> gradient(width * height * 4);
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint8_t* pSolid = solid.data() + (y * width + x) * 4;
+			pSolid[0] = 200;
+			pSolid[1] = 117;
+			pSolid[2] = 33;
+			pSolid[3] = 90;
+			uint8_t* pGradient = gradient.data() + (y * width + x) * 4;
+			pGradient[0] = static_cast<uint8_t>(x * 8);
+			pGradient[1] = static_cast<uint8_t>(y * 11);
+			pGradient[2] = static_cast<uint8_t>(255 - x * 4 - y * 4);
+			pGradient[3] = static_cast<uint8_t>(x * 4 + y * 3);
+		}
+	}
+
+	//Solid blocks only lose the endpoint precision: 5 and 6 bits for BC1, 8 bits for BC4, 7 bits plus parity for BC7
+	bool result = TestFormat(ETextureFormat::E_BC1_RGBA_UNORM, "BC1 Solid", solid, width, height, 4, 0);
+	result &= TestFormat(ETextureFormat::E_BC3_UNORM, "BC3 Solid", solid, width, height, 4, 0);
+	result &= TestFormat(ETextureFormat::E_BC5_UNORM, "BC5 Solid", solid, width, height, 0, 0);
+	result &= TestFormat(ETextureFormat::E_BC7_UNORM, "BC7 Solid", solid, width, height, 1, 1);
+
+	result &= TestFormat(ETextureFormat::E_BC1_RGBA_UNORM, "BC1 Gradient", gradient, width, height, 24, 0);
+	result &= TestFormat(ETextureFormat::E_BC3_UNORM, "BC3 Gradient", gradient, width, height, 24, 2);
+	result &= TestFormat(ETextureFormat::E_BC5_UNORM, "BC5 Gradient", gradient, width, height, 4, 0);
+	result &= TestFormat(ETextureFormat::E_BC7_UNORM, "BC7 Gradient", gradient, width, height, 20, 8);
+	return result;
+}
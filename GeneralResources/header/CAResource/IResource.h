@@ -5,9 +5,13 @@ namespace resource_management
 	class IResource
 	{
 	public:
+		virtual ~IResource() = default;
 		virtual void Serialzie(castl::vector<uint8_t>& out) = 0;
 		virtual void Deserialzie(castl::vector<uint8_t>& in) = 0;
 		virtual void Load() {};
+		//Called before an evicted resource is destroyed
 		virtual void Unload() {};
+		//Heap memory owned by the resource, counted against the budget of its type
+		virtual uint64_t GetMemorySizeInByte() const { return 0; }
 	};
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <CASTL/CAString.h>
+#include <CASTL/CAVector.h>
+
+namespace resource_management
+{
+	//Content of one file when it was recorded, size and write time only decide whether the hash has to be recomputed
+	struct ImportedFileRecord
+	{
+		castl::string path;
+		uint64_t size = 0;
+		int64_t writeTime = 0;
+		uint64_t contentHash = 0;
+	};
+
+	//Everything an import depended on and produced, a source is imported again once any of it changed
+	struct ImportRecord
+	{
+		//Source relative to the scanned directory
+		ImportedFileRecord source;
+		castl::string importerType;
+		uint32_t importerVersion = 0;
+		castl::string importerTags;
+		//Relative to the scanned directory
+		castl::vector<ImportedFileRecord> dependencies;
+		//Relative to the resource root
+		castl::vector<ImportedFileRecord> outputs;
+	};
+}
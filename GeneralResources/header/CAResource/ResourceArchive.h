@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+namespace resource_management
+{
+	//Compression of the entries of a resource archive, entries that do not shrink are stored uncompressed
+	enum class EResourceArchiveCompression : uint32_t
+	{
+		eNone = 0,
+		//LZ4 block format
+		eLZ4 = 1,
+	};
+}
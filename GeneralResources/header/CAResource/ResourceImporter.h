@@ -2,6 +2,11 @@
 #include <CASTL/CAString.h>
 #include <CASTL/CAVector.h>
 
+namespace thread_management
+{
+	class TaskScheduler;
+}
+
 namespace resource_management
 {
 	class ResourceManagingSystem;
@@ -12,9 +17,24 @@ namespace resource_management
 		virtual castl::string GetResourceType() const = 0;
 		virtual castl::string GetSourceFilePostfix() const = 0;
 		virtual castl::string GetDestFilePostfix() const = 0;
+		//Importer settings, resources are imported again when they change
 		virtual castl::string GetTags() const = 0;
+		//Bump when the importer output changes, resources are imported again
+		virtual uint32_t GetImporterVersion() const { return 0; }
 		virtual uint64_t GetIResourceSizeInByte() const = 0;
-		virtual void ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) = 0;
+		//False when the import failed, the resource is imported again by the next scan
+		virtual bool ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) = 0;
+		//Other source files read while importing the resource(i.e. included shader headers), a changed one triggers a reimport
+		virtual castl::vector<castl::string> GetSourceDependencies(castl::string const& resourcePath) { return {}; }
+		//Resources of this importer imported at the same time, ImportResource must be thread safe above 1
+		virtual uint32_t GetMaxParallelImports() const { return 1; }
+		//Called once per scan before its resources are imported
+		virtual void BeginImportBatch() {}
+		//Called once per scan after its resources are imported and before they are serialized, work the imports queued
+		//(i.e. texture encoding) can be spread over tasks of the scheduler. Scheduler is null when the scan is single threaded
+		virtual void EndImportBatch(thread_management::TaskScheduler* scheduler) {}
+		//Importers may print per resource cook statistics when set
+		virtual void SetVerbose(bool verbose) {}
 	};
 
 	template<typename TRes>
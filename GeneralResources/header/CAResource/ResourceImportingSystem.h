@@ -1,5 +1,7 @@
 #pragma once
 #include "ResourceImporter.h"
+#include "ImportRecord.h"
+#include "ResourceArchive.h"
 #include <ThreadManager.h>
 
 namespace resource_management
@@ -11,5 +13,15 @@ namespace resource_management
 		virtual void SetResourceManager(ResourceManagingSystem* resourceManagingSystem) = 0;
 		virtual void AddImporter(ResourceImporterBase* importer) = 0;
 		virtual void ScanSourceDirectory(const castl::string& sourceDirectory) = 0;
+		//Imports on the scheduler's workers, resources are serialized once every import finished
+		virtual void ScanSourceDirectory(const castl::string& sourceDirectory, thread_management::TaskScheduler* scheduler) = 0;
+		//Sources the next scan of the directory would import, nothing is imported
+		virtual castl::vector<castl::string> CollectOutdatedSources(const castl::string& sourceDirectory) = 0;
+		//Records of the import database kept in the resource root
+		virtual castl::vector<ImportRecord> GetImportRecords() = 0;
+		//Packs the resource root of the managing system into one archive for MountResourceArchive
+		virtual bool BuildResourceArchive(castl::string const& archivePath, EResourceArchiveCompression compression) = 0;
+		//Prints the progress and throughput of each scan and the size of built archives, forwarded to the importers
+		virtual void SetVerbose(bool verbose) = 0;
 	};
 }
\ No newline at end of file
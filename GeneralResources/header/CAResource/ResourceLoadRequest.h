@@ -0,0 +1,81 @@
+#pragma once
+#include "IResource.h"
+#include <CASTL/CAString.h>
+#include <CASTL/CASharedPtr.h>
+
+namespace resource_management
+{
+	enum class EResourceLoadPriority : uint32_t
+	{
+		eLow = 0,
+		eNormal,
+		eHigh,
+		//Needed before the current frame can continue
+		eCritical,
+		eCount,
+	};
+
+	enum class EResourceLoadState : uint32_t
+	{
+		eQueued,
+		eLoading,
+		eLoaded,
+		//The file is missing or empty
+		eFailed,
+		//Every handle canceled before the load started
+		eCanceled,
+	};
+
+	//Load of one path, shared by every handle that requested the path while it was in flight.
+	//Requests must not outlive the managing system that created them
+	class IResourceLoadRequest
+	{
+	public:
+		virtual ~IResourceLoadRequest() = default;
+		virtual castl::string const& GetPath() const = 0;
+		virtual EResourceLoadState GetState() const = 0;
+		//Null until loaded
+		virtual IResource* GetResource() const = 0;
+		//Blocks until the load finished, a load still queued runs on the waiting thread
+		virtual void Wait() = 0;
+		//Priorities are never lowered, the highest one asked for by any handle is used
+		virtual void RaisePriority(EResourceLoadPriority priority) = 0;
+		//Drops the callback of one handle, a queued load is canceled once no handle is left
+		virtual void Cancel(uint64_t callbackID) = 0;
+	};
+
+	template<typename TRes>
+	class ResourceLoadHandle
+	{
+	public:
+		ResourceLoadHandle() = default;
+		ResourceLoadHandle(castl::shared_ptr<IResourceLoadRequest> const& request, uint64_t callbackID) :
+			m_Request(request)
+			, m_CallbackID(callbackID)
+		{
+		}
+
+		bool Valid() const { return m_Request != nullptr; }
+		EResourceLoadState GetState() const { return m_Request->GetState(); }
+		bool IsLoaded() const { return GetState() == EResourceLoadState::eLoaded; }
+		TRes* Get() const { return static_cast<TRes*>(m_Request->GetResource()); }
+		TRes* Wait() const
+		{
+			m_Request->Wait();
+			return Get();
+		}
+		void RaisePriority(EResourceLoadPriority priority) const { m_Request->RaisePriority(priority); }
+		//The callback of this handle is not invoked anymore, unless the load already finished
+		void Cancel()
+		{
+			if (m_Request != nullptr)
+			{
+				m_Request->Cancel(m_CallbackID);
+				m_Request.reset();
+			}
+		}
+	private:
+		castl::shared_ptr<IResourceLoadRequest> m_Request;
+		uint64_t m_CallbackID = 0;
+	};
+}
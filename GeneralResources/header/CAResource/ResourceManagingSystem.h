@@ -1,14 +1,36 @@
 #pragma once
 #include "ResourceImporter.h"
 #include "IResource.h"
+#include "ResourceLoadRequest.h"
+#include "ResourceArchive.h"
 #include <ThreadManager.h>
+#include <CASTL/CAFunctional.h>
 #include <functional>
 
 namespace resource_management
 {
+	struct ResourceMemoryStatistics
+	{
+		castl::string typeName;
+		uint32_t residentCount = 0;
+		uint32_t referencedCount = 0;
+		//Resource objects and the memory they own
+		uint64_t residentBytes = 0;
+		//Memory created from the resources elsewhere, like GPU buffers
+		uint64_t externalBytes = 0;
+		//0 when the type has no budget
+		uint64_t budgetBytes = 0;
+		uint64_t evictedCount = 0;
+	};
+
 	class ResourceManagingSystem
 	{
 	public:
+		//Allocates the resource without a path and deserializes it, runs on a loading thread
+		using ResourceDeserializer = castl::function<IResource*(castl::vector<uint8_t>& data)>;
+
+		virtual ~ResourceManagingSystem() = default;
+
 		virtual void* AllocResourceMemory(
 			castl::string type_name
 			, castl::string const& resource_path
@@ -23,24 +45,98 @@ namespace resource_management
 
 		virtual IResource* TryGetResource(castl::string const& path) = 0;
 
+		//Reads from the mounted archives first, then from the resource root
 		virtual castl::vector<uint8_t> LoadBinaryFile(castl::string const& path) = 0;
 
+		//Serves the resources packed in the archive, false when it cannot be opened or is corrupted
+		virtual bool MountResourceArchive(castl::string const& archivePath) = 0;
+
+		//Loading threads, until it is set one thread is started with the first load
+		virtual void SetLoadingThreadCount(uint32_t threadCount) = 0;
+
+		//Loads of the same path share one request while in flight, loaded paths complete at once.
+		//Requests reference their resource, loaded resources stay resident while a handle or an undispatched callback is alive
+		virtual castl::shared_ptr<IResourceLoadRequest> RequestResourceLoad(castl::string const& path
+			, castl::string const& typeName
+			, EResourceLoadPriority priority
+			, cacore::HashObj<castl::string> const& callbackThreadKey
+			, ResourceDeserializer&& deserializer
+			, castl::function<void(IResource*)>&& callback
+			, uint64_t& outCallbackID) = 0;
+
+		//Invokes the callbacks of finished loads requested for the thread key, returns how many were invoked
+		virtual uint32_t DispatchLoadCallbacks(cacore::HashObj<castl::string> const& threadKey) = 0;
+
+		//Loaded resources without references are evicted least recently released first while their type is over budget.
+		//0 means no budget
+		virtual void SetResourceBudget(castl::string const& typeName, uint64_t budgetInBytes) = 0;
+		//Counts memory created from a loaded resource outside of it against its type's budget(i.e. its GPU buffers)
+		virtual void SetExternalMemorySize(IResource* resource, uint64_t sizeInBytes) = 0;
+		//Keeps a loaded resource resident, resources not loaded through RequestResourceLoad are ignored
+		virtual void AddResourceReference(IResource* resource) = 0;
+		virtual void ReleaseResourceReference(IResource* resource) = 0;
+		virtual castl::vector<ResourceMemoryStatistics> GetMemoryStatistics() = 0;
+
 		template<typename TRes>
-		void LoadResource(castl::string const& path, std::function<void(TRes*)> callback)
+		void SetResourceBudget(uint64_t budgetInBytes)
+		{
+			SetResourceBudget(typeid(TRes).name(), budgetInBytes);
+		}
+
+		//Dispatches the callbacks of the thread key within the scheduler's frame
+		thread_management::CTask* ScheduleLoadCallbacks(thread_management::TaskScheduler* scheduler, cacore::HashObj<castl::string> const& threadKey)
+		{
+			return scheduler->NewTask()
+				->Name("Dispatch Resource Load Callbacks")
+				->Thread(threadKey)
+				->Functor([this, threadKey]()
+					{
+						DispatchLoadCallbacks(threadKey);
+					});
+		}
+
+		//The file is read and deserialized on a loading thread, the callback runs once DispatchLoadCallbacks is called with the thread key.
+		//The callback receives null when the file could not be loaded
+		template<typename TRes>
+		ResourceLoadHandle<TRes> LoadResourceAsync(castl::string const& path
+			, EResourceLoadPriority priority
+			, cacore::HashObj<castl::string> const& callbackThreadKey
+			, std::function<void(TRes*)> callback = nullptr)
 		{
 			static_assert(std::is_base_of<IResource, TRes>::value, "Type T not derived from IResource");
-			IResource* result = TryGetResource(path);
-			if (result != nullptr)
+			castl::function<void(IResource*)> resourceCallback;
+			if (callback)
 			{
-				callback(static_cast<TRes*>(result));
+				resourceCallback = [callback = castl::move(callback)](IResource* resource)
+					{
+						callback(static_cast<TRes*>(resource));
+					};
 			}
-			else
+			uint64_t callbackID = 0;
+			auto request = RequestResourceLoad(path, typeid(TRes).name(), priority, callbackThreadKey
+				, [this](castl::vector<uint8_t>& data) -> IResource*
+				{
+					TRes* newResult = AllocResource<TRes>("");
+					newResult->Deserialzie(data);
+					return newResult;
+				}
+				, castl::move(resourceCallback)
+				, callbackID);
+			return ResourceLoadHandle<TRes>(request, callbackID);
+		}
+
+		//Blocks until the resource is loaded, the callback runs on the caller's thread.
+		//The loaded resource is pinned, it stays resident until ReleaseResourceReference is called for it
+		template<typename TRes>
+		void LoadResource(castl::string const& path, std::function<void(TRes*)> callback)
+		{
+			auto handle = LoadResourceAsync<TRes>(path, EResourceLoadPriority::eCritical, {});
+			TRes* resource = handle.Wait();
+			if (resource != nullptr)
 			{
-				auto data = LoadBinaryFile(path);
-				TRes* newResult = AllocResource<TRes>(path);
-				newResult->Deserialzie(data);
-				callback(newResult);
+				AddResourceReference(resource);
 			}
+			callback(resource);
 		}
 
 		template<typename TRes, typename...TArgs>
@@ -65,6 +161,7 @@ namespace resource_management
 		void ReleaseResource(TRes* releasingRes)
 		{
 			static_assert(std::is_base_of<IResource, TRes>::value, "Type T not derived from IResource");
+			releasingRes->~TRes();
 			ReleaseResourceMemory(typeid(TRes).name(), releasingRes);
 		}
 	};
@@ -0,0 +1,116 @@
+#include "ImportDatabase.h"
+#include <FileLoader.h>
+#include <Serialization.h>
+#include <Hasher.h>
+#include <DebugUtils.h>
+#include <CASTL/CAAlgorithm.h>
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t IMPORT_DATABASE_FILE_MAGIC = 0x42444941;//AIDB
+		//Bump when the layout of the records changes
+		constexpr uint32_t IMPORT_DATABASE_FILE_VERSION = 1;
+
+		struct ImportDatabaseFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t dataSize;
+			uint64_t dataHash;
+		};
+	}
+
+	void ImportDatabase::Load(std::filesystem::path const& databasePath)
+	{
+		m_DatabasePath = databasePath;
+		m_Records.clear();
+		castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(castl::to_ca(databasePath.string()));
+		if (fileData.size() < sizeof(ImportDatabaseFileHeader))
+		{
+			return;
+		}
+		ImportDatabaseFileHeader fileHeader{};
+		memcpy(&fileHeader, fileData.data(), sizeof(ImportDatabaseFileHeader));
+		if (fileHeader.magic != IMPORT_DATABASE_FILE_MAGIC
+			|| fileHeader.version != IMPORT_DATABASE_FILE_VERSION
+			|| !cacore::verify_payload(fileHeader.dataSize, fileHeader.dataHash, fileData.data() + sizeof(ImportDatabaseFileHeader), fileData.size() - sizeof(ImportDatabaseFileHeader)))
+		{
+			CA_LOG_ERR("Import database is outdated or corrupted, every resource will be imported again");
+			return;
+		}
+		castl::vector<ImportRecord> records;
+		cacore::deserialize(fileData, records, sizeof(ImportDatabaseFileHeader));
+		for (auto& record : records)
+		{
+			castl::string sourcePath = record.source.path;
+			m_Records.insert(castl::make_pair(sourcePath, castl::move(record)));
+		}
+	}
+
+	void ImportDatabase::Save() const
+	{
+		castl::vector<uint8_t> fileData(sizeof(ImportDatabaseFileHeader));
+		cacore::serialize(fileData, GetRecords());
+		ImportDatabaseFileHeader fileHeader{};
+		fileHeader.magic = IMPORT_DATABASE_FILE_MAGIC;
+		fileHeader.version = IMPORT_DATABASE_FILE_VERSION;
+		fileHeader.dataSize = fileData.size() - sizeof(ImportDatabaseFileHeader);
+		fileHeader.dataHash = cacore::hash_bytes(fileData.data() + sizeof(ImportDatabaseFileHeader), fileHeader.dataSize);
+		memcpy(fileData.data(), &fileHeader, sizeof(ImportDatabaseFileHeader));
+		std::error_code ec;
+		std::filesystem::create_directories(m_DatabasePath.parent_path(), ec);
+		cacore::WriteBinaryFile(castl::to_ca(m_DatabasePath.string()), fileData.data(), fileData.size());
+	}
+
+	ImportRecord const* ImportDatabase::Find(castl::string const& sourcePath) const
+	{
+		auto found = m_Records.find(sourcePath);
+		return found == m_Records.end() ? nullptr : &found->second;
+	}
+
+	void ImportDatabase::Update(ImportRecord&& record)
+	{
+		castl::string sourcePath = record.source.path;
+		m_Records[sourcePath] = castl::move(record);
+	}
+
+	castl::vector<ImportRecord> ImportDatabase::GetRecords() const
+	{
+		//Sorted, so unchanged databases are written byte identical
+		castl::vector<ImportRecord> records;
+		records.reserve(m_Records.size());
+		for (auto& pair : m_Records)
+		{
+			records.push_back(pair.second);
+		}
+		castl::sort(records.begin(), records.end(), [](ImportRecord const& lhs, ImportRecord const& rhs)
+			{
+				return lhs.source.path < rhs.source.path;
+			});
+		return records;
+	}
+
+	bool ImportDatabase::RecordFile(std::filesystem::path const& filePath, castl::string const& recordedPath, ImportedFileRecord const* pPrevious, ImportedFileRecord& outRecord)
+	{
+		std::error_code ec;
+		uint64_t size = std::filesystem::file_size(filePath, ec);
+		if (ec)
+		{
+			return false;
+		}
+		int64_t writeTime = static_cast<int64_t>(std::filesystem::last_write_time(filePath, ec).time_since_epoch().count());
+		outRecord.path = recordedPath;
+		outRecord.size = size;
+		outRecord.writeTime = writeTime;
+		if (pPrevious != nullptr && pPrevious->size == size && pPrevious->writeTime == writeTime)
+		{
+			outRecord.contentHash = pPrevious->contentHash;
+			return true;
+		}
+		castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(castl::to_ca(filePath.string()));
+		outRecord.contentHash = cacore::hash_bytes(fileData.data(), fileData.size());
+		return true;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <CAResource/ImportRecord.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <filesystem>
+
+namespace resource_management
+{
+	//Import records of every source, persisted next to the imported resources
+	class ImportDatabase
+	{
+	public:
+		//Records of another database file or an outdated format are dropped, everything is imported again then
+		void Load(std::filesystem::path const& databasePath);
+		void Save() const;
+		bool Loaded() const { return !m_DatabasePath.empty(); }
+
+		ImportRecord const* Find(castl::string const& sourcePath) const;
+		void Update(ImportRecord&& record);
+		castl::vector<ImportRecord> GetRecords() const;
+
+		//Size, write time and content hash of a file, the hash of a previous record is reused while size and write time match.
+		//Returns false when the file does not exist
+		static bool RecordFile(std::filesystem::path const& filePath, castl::string const& recordedPath, ImportedFileRecord const* pPrevious, ImportedFileRecord& outRecord);
+	private:
+		std::filesystem::path m_DatabasePath;
+		castl::unordered_map<castl::string, ImportRecord> m_Records;
+	};
+}
@@ -0,0 +1,183 @@
+#include "LZ4Block.h"
+#include <cstring>
+
+namespace resource_management
+{
+	namespace lz4_block
+	{
+		namespace
+		{
+			constexpr size_t MIN_MATCH = 4;
+			//The format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end
+			constexpr size_t LAST_LITERALS = 5;
+			constexpr size_t MATCH_FIND_LIMIT = 12;
+			constexpr size_t MAX_OFFSET = 65535;
+			constexpr uint32_t HASH_BITS = 16;
+
+			uint32_t Read32(uint8_t const* p)
+			{
+				uint32_t result;
+				memcpy(&result, p, sizeof(result));
+				return result;
+			}
+
+			uint32_t HashSequence(uint32_t sequence)
+			{
+				return (sequence * 2654435761u) >> (32 - HASH_BITS);
+			}
+
+			void WriteLength(castl::vector<uint8_t>& out, size_t length)
+			{
+				while (length >= 255)
+				{
+					out.push_back(255);
+					length -= 255;
+				}
+				out.push_back(static_cast<uint8_t>(length));
+			}
+
+			void WriteSequence(castl::vector<uint8_t>& out, uint8_t const* pLiterals, size_t literalLength, size_t offset, size_t matchLength)
+			{
+				size_t matchCode = matchLength - MIN_MATCH;
+				uint8_t token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+				token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+				out.push_back(token);
+				if (literalLength >= 15)
+				{
+					WriteLength(out, literalLength - 15);
+				}
+				out.insert(out.end(), pLiterals, pLiterals + literalLength);
+				out.push_back(static_cast<uint8_t>(offset & 0xFF));
+				out.push_back(static_cast<uint8_t>(offset >> 8));
+				if (matchCode >= 15)
+				{
+					WriteLength(out, matchCode - 15);
+				}
+			}
+
+			void WriteLastLiterals(castl::vector<uint8_t>& out, uint8_t const* pLiterals, size_t literalLength)
+			{
+				out.push_back(static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4));
+				if (literalLength >= 15)
+				{
+					WriteLength(out, literalLength - 15);
+				}
+				out.insert(out.end(), pLiterals, pLiterals + literalLength);
+			}
+
+			bool ReadLength(uint8_t const*& ip, uint8_t const* pEnd, size_t& inoutLength)
+			{
+				uint8_t value;
+				do
+				{
+					if (ip >= pEnd)
+					{
+						return false;
+					}
+					value = *ip++;
+					inoutLength += value;
+				} while (value == 255);
+				return true;
+			}
+		}
+
+		void Compress(uint8_t const* pSource, size_t sourceSize, castl::vector<uint8_t>& outCompressed)
+		{
+			outCompressed.clear();
+			outCompressed.reserve(sourceSize + sourceSize / 255 + 16);
+			uint8_t const* anchor = pSource;
+			if (sourceSize > MATCH_FIND_LIMIT)
+			{
+				uint8_t const* ip = pSource;
+				uint8_t const* matchLimit = pSource + sourceSize - LAST_LITERALS;
+				uint8_t const* findLimit = pSource + sourceSize - MATCH_FIND_LIMIT;
+				castl::vector<int32_t> table(1u << HASH_BITS, -1);
+				while (ip < findLimit)
+				{
+					uint32_t sequence = Read32(ip);
+					uint32_t hash = HashSequence(sequence);
+					int32_t candidate = table[hash];
+					table[hash] = static_cast<int32_t>(ip - pSource);
+					if (candidate < 0
+						|| static_cast<size_t>(ip - pSource - candidate) > MAX_OFFSET
+						|| Read32(pSource + candidate) != sequence)
+					{
+						++ip;
+						continue;
+					}
+					uint8_t const* match = pSource + candidate;
+					size_t matchLength = MIN_MATCH;
+					while (ip + matchLength < matchLimit && ip[matchLength] == match[matchLength])
+					{
+						++matchLength;
+					}
+					WriteSequence(outCompressed, anchor, ip - anchor, ip - match, matchLength);
+					ip += matchLength;
+					anchor = ip;
+				}
+			}
+			WriteLastLiterals(outCompressed, anchor, pSource + sourceSize - anchor);
+		}
+
+		bool Decompress(uint8_t const* pSource, size_t sourceSize, uint8_t* pDest, size_t destSize)
+		{
+			uint8_t const* ip = pSource;
+			uint8_t const* pSourceEnd = pSource + sourceSize;
+			uint8_t* op = pDest;
+			uint8_t* pDestEnd = pDest + destSize;
+			while (ip < pSourceEnd)
+			{
+				uint8_t token = *ip++;
+				size_t literalLength = token >> 4;
+				if (literalLength == 15 && !ReadLength(ip, pSourceEnd, literalLength))
+				{
+					return false;
+				}
+				if (literalLength > static_cast<size_t>(pSourceEnd - ip) || literalLength > static_cast<size_t>(pDestEnd - op))
+				{
+					return false;
+				}
+				if (literalLength > 0)
+				{
+					memcpy(op, ip, literalLength);
+				}
+				ip += literalLength;
+				op += literalLength;
+				if (ip == pSourceEnd)
+				{
+					//The last sequence has literals only
+					break;
+				}
+
+				if (pSourceEnd - ip < 2)
+				{
+					return false;
+				}
+				size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+				ip += 2;
+				if (offset == 0 || offset > static_cast<size_t>(op - pDest))
+				{
+					return false;
+				}
+				size_t matchLength = token & 15;
+				if (matchLength == 15 && !ReadLength(ip, pSourceEnd, matchLength))
+				{
+					return false;
+				}
+				matchLength += MIN_MATCH;
+				if (matchLength > static_cast<size_t>(pDestEnd - op))
+				{
+					return false;
+				}
+				//Matches may overlap the bytes they produce
+				uint8_t const* match = op - offset;
+				for (size_t byteID = 0; byteID < matchLength; ++byteID)
+				{
+					op[byteID] = match[byteID];
+				}
+				op += matchLength;
+			}
+			return op == pDestEnd;
+		}
+	}
+}
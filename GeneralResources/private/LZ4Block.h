@@ -0,0 +1,14 @@
+#pragma once
+#include <CASTL/CAVector.h>
+
+namespace resource_management
+{
+	//Compression in the LZ4 block format, fast to decode and written by every LZ4 implementation.
+	//Blocks carry no size, the decompressed size is stored by the caller
+	namespace lz4_block
+	{
+		void Compress(uint8_t const* pSource, size_t sourceSize, castl::vector<uint8_t>& outCompressed);
+		//False when the block is malformed or does not decompress to exactly destSize bytes
+		bool Decompress(uint8_t const* pSource, size_t sourceSize, uint8_t* pDest, size_t destSize);
+	}
+}
@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+#if !CA_PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace resource_management
+{
+	bool MappedFile::Open(std::filesystem::path const& filePath)
+	{
+		Close();
+#if CA_PLATFORM_WINDOWS
+		HANDLE file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		m_Data = static_cast<uint8_t const*>(data);
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int file = open(filePath.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+		struct stat fileStat {};
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+		void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		//The mapping keeps the file alive
+		close(file);
+		if (data == MAP_FAILED)
+		{
+			return false;
+		}
+		m_Data = static_cast<uint8_t const*>(data);
+		m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data == nullptr)
+		{
+			return;
+		}
+#if CA_PLATFORM_WINDOWS
+		UnmapViewOfFile(m_Data);
+		CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+		CloseHandle(static_cast<HANDLE>(m_FileHandle));
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+#else
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+}
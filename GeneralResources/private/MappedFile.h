@@ -0,0 +1,30 @@
+#pragma once
+#include <Platform.h>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+namespace resource_management
+{
+	//Read only mapping of a whole file, pages are read by the OS on first access
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+		~MappedFile() { Close(); }
+
+		bool Open(std::filesystem::path const& filePath);
+		void Close();
+		uint8_t const* Data() const { return m_Data; }
+		size_t Size() const { return m_Size; }
+	private:
+		uint8_t const* m_Data = nullptr;
+		size_t m_Size = 0;
+#if CA_PLATFORM_WINDOWS
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+	};
+}
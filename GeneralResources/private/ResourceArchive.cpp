@@ -0,0 +1,253 @@
+#include "ResourceArchive.h"
+#include "LZ4Block.h"
+#include <FileLoader.h>
+#include <Hasher.h>
+#include <DebugUtils.h>
+#include <CASTL/CAAlgorithm.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t RESOURCE_ARCHIVE_MAGIC = 0x4B504143;//CAPK
+		constexpr uint32_t RESOURCE_ARCHIVE_VERSION = 1;
+		//Cache line and GPU upload friendly, small enough for archives of many tiny resources
+		constexpr uint32_t PAYLOAD_ALIGNMENT = 256;
+
+		//Archives are looked up with the same path whatever separators the caller used
+		castl::string NormalizeArchivePath(castl::string const& path)
+		{
+			castl::string result = path;
+			castl::replace(result.begin(), result.end(), '\\', '/');
+			while (result.compare(0, 2, "./") == 0)
+			{
+				result.erase(0, 2);
+			}
+			return result;
+		}
+
+		uint64_t AlignOffset(uint64_t offset)
+		{
+			return (offset + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+		}
+
+		bool EntryLess(ResourceArchiveEntry const& entry, uint64_t pathHash)
+		{
+			return entry.pathHash < pathHash;
+		}
+	}
+
+	bool ResourceArchive::Open(std::filesystem::path const& archivePath)
+	{
+		m_ArchivePath = archivePath;
+		m_Header = nullptr;
+		if (!m_File.Open(archivePath))
+		{
+			return false;
+		}
+		uint8_t const* pData = m_File.Data();
+		size_t fileSize = m_File.Size();
+		if (fileSize < sizeof(ResourceArchiveHeader))
+		{
+			CA_LOG_ERR("Resource archive is too small: " + castl::to_ca(archivePath.string()));
+			m_File.Close();
+			return false;
+		}
+		auto pHeader = reinterpret_cast<ResourceArchiveHeader const*>(pData);
+		uint64_t entriesSize = static_cast<uint64_t>(pHeader->entryCount) * sizeof(ResourceArchiveEntry);
+		if (pHeader->magic != RESOURCE_ARCHIVE_MAGIC
+			|| pHeader->version != RESOURCE_ARCHIVE_VERSION
+			|| pHeader->stringsOffset != sizeof(ResourceArchiveHeader) + entriesSize
+			|| pHeader->stringsOffset + pHeader->stringsSize > fileSize
+			|| pHeader->tableHash != cacore::hash_bytes(pData + sizeof(ResourceArchiveHeader), entriesSize + pHeader->stringsSize))
+		{
+			CA_LOG_ERR("Resource archive is outdated or corrupted: " + castl::to_ca(archivePath.string()));
+			m_File.Close();
+			return false;
+		}
+		m_Header = pHeader;
+		m_Entries = reinterpret_cast<ResourceArchiveEntry const*>(pData + sizeof(ResourceArchiveHeader));
+		m_Strings = reinterpret_cast<char const*>(pData + pHeader->stringsOffset);
+		return true;
+	}
+
+	ResourceArchiveEntry const* ResourceArchive::Find(castl::string const& path) const
+	{
+		if (m_Header == nullptr)
+		{
+			return nullptr;
+		}
+		castl::string normalizedPath = NormalizeArchivePath(path);
+		uint64_t pathHash = cacore::hash_bytes(normalizedPath.data(), normalizedPath.size());
+		ResourceArchiveEntry const* pEnd = m_Entries + m_Header->entryCount;
+		for (auto pEntry = castl::lower_bound(m_Entries, pEnd, pathHash, EntryLess); pEntry != pEnd && pEntry->pathHash == pathHash; ++pEntry)
+		{
+			if (pEntry->pathOffset + static_cast<uint64_t>(pEntry->pathLength) <= m_Header->stringsSize
+				&& normalizedPath.size() == pEntry->pathLength
+				&& memcmp(m_Strings + pEntry->pathOffset, normalizedPath.data(), pEntry->pathLength) == 0)
+			{
+				return pEntry;
+			}
+		}
+		return nullptr;
+	}
+
+	bool ResourceArchive::Read(castl::string const& path, castl::vector<uint8_t>& outData) const
+	{
+		ResourceArchiveEntry const* pEntry = Find(path);
+		if (pEntry == nullptr)
+		{
+			return false;
+		}
+		if (pEntry->dataOffset > m_File.Size() || pEntry->storedSize > m_File.Size() - pEntry->dataOffset)
+		{
+			CA_LOG_ERR("Resource archive entry out of range: " + path);
+			return false;
+		}
+		uint8_t const* pStored = m_File.Data() + pEntry->dataOffset;
+		bool unpacked = false;
+		switch (pEntry->compression)
+		{
+		case EResourceArchiveCompression::eNone:
+			outData.assign(pStored, pStored + pEntry->storedSize);
+			unpacked = true;
+			break;
+		case EResourceArchiveCompression::eLZ4:
+			outData.resize(pEntry->size);
+			unpacked = lz4_block::Decompress(pStored, pEntry->storedSize, outData.data(), outData.size());
+			break;
+		}
+		//The content hash covers the uncompressed bytes, a damaged payload never reaches the resource
+		if (unpacked && cacore::verify_payload(pEntry->size, pEntry->contentHash, outData.data(), outData.size()))
+		{
+			return true;
+		}
+		CA_LOG_ERR("Resource archive entry is corrupted: " + path);
+		outData.clear();
+		return false;
+	}
+
+	bool ResourceArchive::Build(std::filesystem::path const& resourceRoot, std::filesystem::path const& archivePath, EResourceArchiveCompression compression, bool verbose)
+	{
+		struct PendingEntry
+		{
+			castl::string path;
+			std::filesystem::path filePath;
+			uint64_t pathHash;
+		};
+		castl::vector<PendingEntry> pendingEntries;
+		std::error_code ec;
+		for (auto& entry : std::filesystem::recursive_directory_iterator(resourceRoot, ec))
+		{
+			if (!entry.is_regular_file()
+				|| entry.path().extension() == FILE_EXTENSION
+				|| entry.path().filename() == "ImportDatabase.bin")
+			{
+				continue;
+			}
+			castl::string path = castl::to_ca(entry.path().lexically_relative(resourceRoot).generic_string());
+			uint64_t pathHash = cacore::hash_bytes(path.data(), path.size());
+			pendingEntries.push_back(PendingEntry{ path, entry.path(), pathHash });
+		}
+		castl::sort(pendingEntries.begin(), pendingEntries.end(), [](PendingEntry const& lhs, PendingEntry const& rhs)
+			{
+				return lhs.pathHash != rhs.pathHash ? lhs.pathHash < rhs.pathHash : lhs.path < rhs.path;
+			});
+
+		castl::vector<ResourceArchiveEntry> entries(pendingEntries.size());
+		castl::string strings;
+		for (size_t entryID = 0; entryID < pendingEntries.size(); ++entryID)
+		{
+			entries[entryID] = ResourceArchiveEntry{};
+			entries[entryID].pathHash = pendingEntries[entryID].pathHash;
+			entries[entryID].pathOffset = static_cast<uint32_t>(strings.size());
+			entries[entryID].pathLength = static_cast<uint32_t>(pendingEntries[entryID].path.size());
+			strings += pendingEntries[entryID].path;
+		}
+
+		ResourceArchiveHeader header{};
+		header.magic = RESOURCE_ARCHIVE_MAGIC;
+		header.version = RESOURCE_ARCHIVE_VERSION;
+		header.entryCount = static_cast<uint32_t>(entries.size());
+		header.payloadAlignment = PAYLOAD_ALIGNMENT;
+		header.stringsOffset = sizeof(ResourceArchiveHeader) + entries.size() * sizeof(ResourceArchiveEntry);
+		header.stringsSize = strings.size();
+
+		//Payloads are streamed one file at a time, the table is written again once their offsets are known
+		std::filesystem::create_directories(archivePath.parent_path(), ec);
+		std::filesystem::path writingPath = archivePath;
+		writingPath += ".writing";
+		std::ofstream archiveFile(writingPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!archiveFile.is_open())
+		{
+			CA_LOG_ERR("Failed to write resource archive " + castl::to_ca(archivePath.string()));
+			return false;
+		}
+		uint64_t writeOffset = header.stringsOffset + header.stringsSize;
+		castl::vector<uint8_t> compressedData;
+		uint64_t totalSize = 0;
+		for (size_t entryID = 0; entryID < pendingEntries.size(); ++entryID)
+		{
+			castl::vector<uint8_t> data = cacore::LoadBinaryFile(castl::to_ca(pendingEntries[entryID].filePath.string()));
+			auto& entry = entries[entryID];
+			entry.size = data.size();
+			entry.contentHash = cacore::hash_bytes(data.data(), data.size());
+			entry.compression = EResourceArchiveCompression::eNone;
+			castl::vector<uint8_t> const* pStored = &data;
+			if (compression == EResourceArchiveCompression::eLZ4 && !data.empty())
+			{
+				lz4_block::Compress(data.data(), data.size(), compressedData);
+				//Barely compressible data is not worth decompressing
+				if (compressedData.size() < data.size() - data.size() / 16)
+				{
+					entry.compression = EResourceArchiveCompression::eLZ4;
+					pStored = &compressedData;
+				}
+			}
+			//Empty entries point inside the file without padding it
+			entry.dataOffset = pStored->empty() ? writeOffset : AlignOffset(writeOffset);
+			entry.storedSize = pStored->size();
+			archiveFile.seekp(entry.dataOffset);
+			archiveFile.write(reinterpret_cast<char const*>(pStored->data()), pStored->size());
+			writeOffset = entry.dataOffset + entry.storedSize;
+			totalSize += entry.size;
+		}
+
+		castl::vector<uint8_t> table(entries.size() * sizeof(ResourceArchiveEntry) + strings.size());
+		if (!entries.empty())
+		{
+			memcpy(table.data(), entries.data(), entries.size() * sizeof(ResourceArchiveEntry));
+		}
+		if (!strings.empty())
+		{
+			memcpy(table.data() + entries.size() * sizeof(ResourceArchiveEntry), strings.data(), strings.size());
+		}
+		header.tableHash = cacore::hash_bytes(table.data(), table.size());
+		archiveFile.seekp(0);
+		archiveFile.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		archiveFile.write(reinterpret_cast<char const*>(table.data()), table.size());
+		archiveFile.close();
+		if (!archiveFile)
+		{
+			CA_LOG_ERR("Failed to write resource archive " + castl::to_ca(archivePath.string()));
+			std::filesystem::remove(writingPath, ec);
+			return false;
+		}
+		std::filesystem::rename(writingPath, archivePath, ec);
+		if (ec)
+		{
+			CA_LOG_ERR("Failed to replace resource archive " + castl::to_ca(archivePath.string()));
+			std::filesystem::remove(writingPath, ec);
+			return false;
+		}
+		if (verbose)
+		{
+			std::cout << "Packed " << entries.size() << " resources into " << archivePath.string() << ", "
+				<< (totalSize / (1024.0 * 1024.0)) << " MB -> " << (writeOffset / (1024.0 * 1024.0)) << " MB" << std::endl;
+		}
+		return true;
+	}
+}
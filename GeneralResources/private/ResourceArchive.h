@@ -0,0 +1,61 @@
+#pragma once
+#include <CAResource/ResourceArchive.h>
+#include <CASTL/CAString.h>
+#include <CASTL/CAVector.h>
+#include <filesystem>
+#include "MappedFile.h"
+
+namespace resource_management
+{
+	//Layout: header, entries sorted by path hash and path, path strings, then payloads at PAYLOAD_ALIGNMENT.
+	//Everything before the payloads is read straight from the mapping
+	struct ResourceArchiveHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t payloadAlignment;
+		uint64_t stringsOffset;
+		uint64_t stringsSize;
+		//Of the entries and strings
+		uint64_t tableHash;
+	};
+
+	struct ResourceArchiveEntry
+	{
+		uint64_t pathHash;
+		uint32_t pathOffset;
+		uint32_t pathLength;
+		uint64_t dataOffset;
+		uint64_t storedSize;
+		uint64_t size;
+		EResourceArchiveCompression compression;
+		uint32_t padding;
+		//Of the uncompressed data
+		uint64_t contentHash;
+	};
+
+	//Cooked resources packed into one memory mapped file, paths are relative to the resource root
+	class ResourceArchive
+	{
+	public:
+		static constexpr char const* FILE_EXTENSION = ".capack";
+
+		bool Open(std::filesystem::path const& archivePath);
+		bool Contains(castl::string const& path) const { return Find(path) != nullptr; }
+		//False when the path is not in the archive or its data is corrupted
+		bool Read(castl::string const& path, castl::vector<uint8_t>& outData) const;
+		std::filesystem::path const& GetPath() const { return m_ArchivePath; }
+
+		//Packs every file under the resource root except archives and the import database
+		static bool Build(std::filesystem::path const& resourceRoot, std::filesystem::path const& archivePath, EResourceArchiveCompression compression, bool verbose = false);
+	private:
+		ResourceArchiveEntry const* Find(castl::string const& path) const;
+
+		std::filesystem::path m_ArchivePath;
+		MappedFile m_File;
+		ResourceArchiveHeader const* m_Header = nullptr;
+		ResourceArchiveEntry const* m_Entries = nullptr;
+		char const* m_Strings = nullptr;
+	};
+}
@@ -3,12 +3,22 @@
 #include <CAResource/ResourceSystemFactory.h>
 #include <CASTL/CAUnorderedMap.h>
 #include <CASTL/CADeque.h>
+#include <CASTL/CAList.h>
 #include <CASTL/CAString.h>
 #include <CASTL/CAVector.h>
+#include <CASTL/CAUniquePtr.h>
+#include <CASTL/CAAtomic.h>
+#include <CASTL/CAAlgorithm.h>
 #include <filesystem>
+#include <chrono>
+#include <iostream>
+#include <shared_mutex>
 #include <LibraryExportCommon.h>
 #include <DebugUtils.h>
 #include <FileLoader.h>
+#include "ImportDatabase.h"
+#include "ResourceLoader.h"
+#include "ResourceArchive.h"
 
 namespace resource_management
 {
@@ -29,23 +39,188 @@ namespace resource_management
 			{
 				m_PostfixToImporterIndex[postfix] = m_Importers.size();
 				m_Importers.push_back(importer);
+				importer->SetVerbose(m_Verbose);
 			}
 		}
 
 		virtual void ScanSourceDirectory(const castl::string& sourceDirectory) override
 		{
-			path rootPath(castl::to_std(sourceDirectory));
-			if(!exists(rootPath))
+			if (!CollectImportingResources(sourceDirectory))
 			{
 				return;
 			}
-			m_ReservedSpace.resize(m_Importers.size());
-			m_ImportingResources.resize(m_Importers.size());
-			std::fill(m_ReservedSpace.begin(), m_ReservedSpace.end(), 0);
-			for (auto& strVec : m_ImportingResources)
+			BeginImportBatch();
+			for (uint32_t importerID = 0; importerID < m_Importers.size(); ++importerID)
+			{
+				for (uint32_t itrResource = 0; itrResource < m_ReservedSpace[importerID]; ++itrResource)
+				{
+					ImportOne(importerID, itrResource);
+				}
+			}
+			EndImportBatch(nullptr);
+			m_ResourceManagingSystem->SerializeAllResources();
+			UpdateImportDatabase();
+			LogImportThroughput();
+		}
+
+		virtual castl::vector<castl::string> CollectOutdatedSources(const castl::string& sourceDirectory) override
+		{
+			castl::vector<castl::vector<ImportingResource>> outdatedResources;
+			castl::vector<castl::string> result;
+			if (FindOutdatedResources(sourceDirectory, outdatedResources))
+			{
+				for (auto& importingResources : outdatedResources)
+				{
+					for (auto& importingResource : importingResources)
+					{
+						result.push_back(importingResource.record.source.path);
+					}
+				}
+			}
+			return result;
+		}
+
+		virtual castl::vector<ImportRecord> GetImportRecords() override
+		{
+			return GetImportDatabase().GetRecords();
+		}
+
+		virtual bool BuildResourceArchive(castl::string const& archivePath, EResourceArchiveCompression compression) override
+		{
+			return ResourceArchive::Build(castl::to_std(m_ResourceManagingSystem->GetResourceRootPath()), castl::to_std(archivePath), compression, m_Verbose);
+		}
+
+		virtual void SetVerbose(bool verbose) override
+		{
+			m_Verbose = verbose;
+			for (auto importer : m_Importers)
+			{
+				importer->SetVerbose(verbose);
+			}
+		}
+
+		virtual void ScanSourceDirectory(const castl::string& sourceDirectory, thread_management::TaskScheduler* scheduler) override
+		{
+			if (!CollectImportingResources(sourceDirectory))
+			{
+				return;
+			}
+			BeginImportBatch();
+			//Each lane imports resources of one importer one after another, importers get at most GetMaxParallelImports lanes
+			m_ImportLanes.clear();
+			for (uint32_t importerID = 0; importerID < m_Importers.size(); ++importerID)
+			{
+				uint32_t laneCount = castl::min(static_cast<uint32_t>(m_ReservedSpace[importerID])
+					, castl::max(m_Importers[importerID]->GetMaxParallelImports(), 1u));
+				for (uint32_t laneID = 0; laneID < laneCount; ++laneID)
+				{
+					m_ImportLanes.push_back(importerID);
+				}
+			}
+
+			auto imports = scheduler->NewTaskParallelFor()
+				->Name("Import Resources")
+				->JobCount(m_ImportLanes.size())
+				->Functor([this](uint32_t laneID)
+					{
+						uint32_t importerID = m_ImportLanes[laneID];
+						uint32_t resourceID = m_NextResourceIDs[importerID].fetch_add(1, castl::memory_order_relaxed);
+						while (resourceID < m_ReservedSpace[importerID])
+						{
+							ImportOne(importerID, resourceID);
+							resourceID = m_NextResourceIDs[importerID].fetch_add(1, castl::memory_order_relaxed);
+						}
+					});
+			auto finishImports = scheduler->NewTaskGraph()
+				->Name("Finish Import Batch")
+				->DependsOn(imports)
+				->Func([this](thread_management::TaskScheduler* batchScheduler)
+					{
+						EndImportBatch(batchScheduler);
+					});
+			scheduler->NewTask()
+				->Name("Serialize Imported Resources")
+				->DependsOn(finishImports)
+				->Functor([this]()
+					{
+						m_ResourceManagingSystem->SerializeAllResources();
+						UpdateImportDatabase();
+						LogImportThroughput();
+					});
+		}
+	private:
+		struct ImportingResource
+		{
+			std::filesystem::path sourcePath;
+			//Relative to the scanned directory, with the extension of the imported resource
+			std::filesystem::path relativePath;
+			//Outputs are filled in once the resource is serialized
+			ImportRecord record;
+			bool imported = false;
+		};
+
+		ImportDatabase& GetImportDatabase()
+		{
+			std::filesystem::path databasePath = std::filesystem::path(castl::to_std(m_ResourceManagingSystem->GetResourceRootPath())) / "ImportDatabase.bin";
+			if (!m_ImportDatabase.Loaded() || m_ImportDatabasePath != databasePath)
+			{
+				m_ImportDatabasePath = databasePath;
+				m_ImportDatabase.Load(databasePath);
+			}
+			return m_ImportDatabase;
+		}
+
+		static castl::string ToRecordedPath(std::filesystem::path const& filePath, std::filesystem::path const& basePath)
+		{
+			return castl::to_ca(filePath.lexically_normal().lexically_relative(basePath.lexically_normal()).generic_string());
+		}
+
+		//Outputs are recorded with the hash they were written with, edited or deleted outputs are imported again
+		bool OutputsChanged(ImportRecord const& previousRecord, std::filesystem::path const& targetRootPath) const
+		{
+			if (previousRecord.outputs.empty())
+			{
+				return true;
+			}
+			for (auto& output : previousRecord.outputs)
+			{
+				ImportedFileRecord currentOutput;
+				if (!ImportDatabase::RecordFile(targetRootPath / castl::to_std(output.path), output.path, &output, currentOutput)
+					|| currentOutput.contentHash != output.contentHash)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static bool SameFiles(castl::vector<ImportedFileRecord> const& lhs, castl::vector<ImportedFileRecord> const& rhs)
+		{
+			if (lhs.size() != rhs.size())
+			{
+				return false;
+			}
+			for (size_t fileID = 0; fileID < lhs.size(); ++fileID)
+			{
+				if (lhs[fileID].path != rhs[fileID].path || lhs[fileID].contentHash != rhs[fileID].contentHash)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//Sources whose content, dependencies, importer settings or outputs differ from the import database, per importer
+		bool FindOutdatedResources(const castl::string& sourceDirectory, castl::vector<castl::vector<ImportingResource>>& outResources)
+		{
+			path rootPath(castl::to_std(sourceDirectory));
+			if(!exists(rootPath))
 			{
-				strVec.clear();
+				return false;
 			}
+			outResources.clear();
+			outResources.resize(m_Importers.size());
+			ImportDatabase& importDatabase = GetImportDatabase();
 			std::filesystem::path targetRootPath = m_ResourceManagingSystem->GetResourceRootPath().c_str();
 			for(auto& p : recursive_directory_iterator(rootPath))
 			{
@@ -58,52 +233,214 @@ namespace resource_management
 						auto importer = m_Importers[found->second];
 
 						auto relativePath = std::filesystem::relative(p.path(), rootPath);
+						castl::string sourceRecordPath = castl::to_ca(relativePath.generic_string());
 						relativePath.replace_extension(castl::to_std(importer->GetDestFilePostfix()));
 						//relativePath.replace_extension("");
-						auto destPath = targetRootPath / relativePath;
 
-						bool needImport = true;
-						if (std::filesystem::exists(destPath))
+						ImportRecord const* pPreviousRecord = importDatabase.Find(sourceRecordPath);
+						ImportRecord record;
+						if (!ImportDatabase::RecordFile(p.path(), sourceRecordPath, pPreviousRecord ? &pPreviousRecord->source : nullptr, record.source))
+						{
+							continue;
+						}
+						record.importerType = importer->GetResourceType();
+						record.importerVersion = importer->GetImporterVersion();
+						record.importerTags = importer->GetTags();
+						for (auto& dependency : importer->GetSourceDependencies(castl::to_ca(p.path().string())))
 						{
-							bool hasFile = true;
-							auto targetTime = std::filesystem::last_write_time(destPath);
-							if (!destPath.has_extension())
+							std::filesystem::path dependencyPath = std::filesystem::absolute(castl::to_std(dependency));
+							castl::string dependencyRecordPath = ToRecordedPath(dependencyPath, std::filesystem::absolute(rootPath));
+							ImportedFileRecord const* pPreviousDependency = nullptr;
+							if (pPreviousRecord != nullptr)
 							{
-								hasFile = false;
-								using Entry = std::filesystem::directory_entry;
-								for (Entry const& entry : std::filesystem::directory_iterator(destPath))
-								{
-									hasFile = true;
-									targetTime = targetTime < entry.last_write_time() ? targetTime : entry.last_write_time();
-								}
+								auto previousFound = castl::find_if(pPreviousRecord->dependencies.begin(), pPreviousRecord->dependencies.end()
+									, [&](ImportedFileRecord const& previous) { return previous.path == dependencyRecordPath; });
+								pPreviousDependency = previousFound == pPreviousRecord->dependencies.end() ? nullptr : &*previousFound;
+							}
+							ImportedFileRecord dependencyRecord;
+							if (ImportDatabase::RecordFile(dependencyPath, dependencyRecordPath, pPreviousDependency, dependencyRecord))
+							{
+								record.dependencies.push_back(castl::move(dependencyRecord));
 							}
-
-							needImport = (!hasFile) || targetTime < p.last_write_time();
 						}
+
+						bool needImport = pPreviousRecord == nullptr
+							|| pPreviousRecord->source.contentHash != record.source.contentHash
+							|| pPreviousRecord->importerType != record.importerType
+							|| pPreviousRecord->importerVersion != record.importerVersion
+							|| pPreviousRecord->importerTags != record.importerTags
+							|| !SameFiles(pPreviousRecord->dependencies, record.dependencies)
+							|| OutputsChanged(*pPreviousRecord, targetRootPath);
 						if (needImport)
 						{
-							++m_ReservedSpace[found->second];
-							m_ImportingResources[found->second].push_back(castl::make_pair(p.path(), relativePath));
+							outResources[found->second].push_back(ImportingResource{ p.path(), relativePath, castl::move(record) });
+						}
+						else if (pPreviousRecord->source.writeTime != record.source.writeTime
+							|| !castl::equal(pPreviousRecord->dependencies.begin(), pPreviousRecord->dependencies.end(), record.dependencies.begin()
+								, [](ImportedFileRecord const& lhs, ImportedFileRecord const& rhs) { return lhs.writeTime == rhs.writeTime; }))
+						{
+							//Only touched, the new write times spare hashing the files next time
+							record.outputs = pPreviousRecord->outputs;
+							importDatabase.Update(castl::move(record));
+							m_ImportDatabaseDirty = true;
 						}
 					}
 				}
 			}
-			for (size_t i = 0; i < m_Importers.size(); ++i)
+			return true;
+		}
+
+		bool CollectImportingResources(const castl::string& sourceDirectory)
+		{
+			if (!FindOutdatedResources(sourceDirectory, m_ImportingResources))
+			{
+				return false;
+			}
+			m_ReservedSpace.resize(m_Importers.size());
+			m_ImportingSourceBytes = 0;
+			for (uint32_t importerID = 0; importerID < m_Importers.size(); ++importerID)
 			{
-				for(uint32_t itrResource = 0; itrResource < m_ReservedSpace[i]; ++itrResource)
+				m_ReservedSpace[importerID] = m_ImportingResources[importerID].size();
+				for (auto& importingResource : m_ImportingResources[importerID])
 				{
-					m_Importers[i]->ImportResource(m_ResourceManagingSystem
-						, castl::to_ca(m_ImportingResources[i][itrResource].first.string())
-						, castl::to_ca(m_ImportingResources[i][itrResource].second.string()));
+					m_ImportingSourceBytes += importingResource.record.source.size;
 				}
 			}
-			m_ResourceManagingSystem->SerializeAllResources();
+			return true;
 		}
-	private:
+
+		//Records what every imported resource wrote, called once the resources are serialized
+		void UpdateImportDatabase()
+		{
+			ImportDatabase& importDatabase = GetImportDatabase();
+			std::filesystem::path targetRootPath = m_ResourceManagingSystem->GetResourceRootPath().c_str();
+			for (auto& importingResources : m_ImportingResources)
+			{
+				for (auto& importingResource : importingResources)
+				{
+					//Failed imports keep their previous record, the new source hash would mark stale outputs as up to date
+					if (!importingResource.imported)
+					{
+						continue;
+					}
+					std::filesystem::path destPath = targetRootPath / importingResource.relativePath;
+					castl::vector<std::filesystem::path> outputPaths;
+					std::error_code ec;
+					if (std::filesystem::is_directory(destPath, ec))
+					{
+						for (auto& entry : recursive_directory_iterator(destPath, ec))
+						{
+							if (entry.is_regular_file())
+							{
+								outputPaths.push_back(entry.path());
+							}
+						}
+						castl::sort(outputPaths.begin(), outputPaths.end());
+					}
+					else
+					{
+						outputPaths.push_back(destPath);
+					}
+					ImportRecord& record = importingResource.record;
+					record.outputs.clear();
+					for (auto& outputPath : outputPaths)
+					{
+						ImportedFileRecord outputRecord;
+						if (ImportDatabase::RecordFile(outputPath, ToRecordedPath(outputPath, targetRootPath), nullptr, outputRecord))
+						{
+							record.outputs.push_back(castl::move(outputRecord));
+						}
+					}
+					//Nothing was written, the import failed after all
+					if (record.outputs.empty())
+					{
+						continue;
+					}
+					importDatabase.Update(castl::move(record));
+					m_ImportDatabaseDirty = true;
+				}
+			}
+			if (m_ImportDatabaseDirty)
+			{
+				importDatabase.Save();
+				m_ImportDatabaseDirty = false;
+			}
+		}
+
+		void BeginImportBatch()
+		{
+			m_ImportingResourceCount = 0;
+			m_NextResourceIDs = castl::make_unique<castl::atomic<uint32_t>[]>(m_Importers.size());
+			for (uint32_t importerID = 0; importerID < m_Importers.size(); ++importerID)
+			{
+				m_NextResourceIDs[importerID].store(0, castl::memory_order_relaxed);
+				m_ImportingResourceCount += m_ReservedSpace[importerID];
+				if (m_ReservedSpace[importerID] > 0)
+				{
+					m_Importers[importerID]->BeginImportBatch();
+				}
+			}
+			m_ImportedResourceCount.store(0, castl::memory_order_relaxed);
+			m_ImportStartTime = std::chrono::steady_clock::now();
+		}
+
+		void EndImportBatch(thread_management::TaskScheduler* scheduler)
+		{
+			for (uint32_t importerID = 0; importerID < m_Importers.size(); ++importerID)
+			{
+				if (m_ReservedSpace[importerID] > 0)
+				{
+					m_Importers[importerID]->EndImportBatch(scheduler);
+				}
+			}
+		}
+
+		void ImportOne(uint32_t importerID, uint32_t resourceID)
+		{
+			auto& importingResource = m_ImportingResources[importerID][resourceID];
+			importingResource.imported = m_Importers[importerID]->ImportResource(m_ResourceManagingSystem
+				, castl::to_ca(importingResource.sourcePath.string())
+				, castl::to_ca(importingResource.relativePath.string()));
+			if (!m_Verbose)
+				return;
+			//Progress at every tenth of the scan instead of every resource
+			size_t importedCount = m_ImportedResourceCount.fetch_add(1, castl::memory_order_relaxed) + 1;
+			size_t progressStep = castl::max(m_ImportingResourceCount / 10, static_cast<size_t>(1));
+			if (importedCount % progressStep == 0 || importedCount == m_ImportingResourceCount)
+			{
+				char progress[64];
+				snprintf(progress, sizeof(progress), "[%zu/%zu] resources imported\n", importedCount, m_ImportingResourceCount);
+				std::cout << progress;
+			}
+		}
+
+		void LogImportThroughput() const
+		{
+			if (!m_Verbose || m_ImportingResourceCount == 0)
+				return;
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_ImportStartTime).count();
+			double sourceMegaBytes = static_cast<double>(m_ImportingSourceBytes) / (1024.0 * 1024.0);
+			std::cout << "Imported " << m_ImportingResourceCount << " resources (" << sourceMegaBytes << " MB of sources) in " << seconds << " s, "
+				<< (m_ImportingResourceCount / castl::max(seconds, 1e-6)) << " resources/s, "
+				<< (sourceMegaBytes / castl::max(seconds, 1e-6)) << " MB/s" << std::endl;
+		}
+
 		castl::unordered_map<castl::string, uint32_t> m_PostfixToImporterIndex;
 		castl::vector<ResourceImporterBase*> m_Importers;
 		castl::vector<size_t> m_ReservedSpace;
-		castl::vector<castl::vector<castl::pair<std::filesystem::path, std::filesystem::path>>> m_ImportingResources;
+		castl::vector<castl::vector<ImportingResource>> m_ImportingResources;
+		ImportDatabase m_ImportDatabase;
+		std::filesystem::path m_ImportDatabasePath;
+		//Records were updated without importing anything, e.g. after sources were only touched
+		bool m_ImportDatabaseDirty = false;
+		//Importer index of every lane of the parallel scan, lanes pull resources from m_NextResourceIDs
+		castl::vector<uint32_t> m_ImportLanes;
+		castl::unique_ptr<castl::atomic<uint32_t>[]> m_NextResourceIDs;
+		castl::atomic<size_t> m_ImportedResourceCount{ 0 };
+		size_t m_ImportingResourceCount = 0;
+		uint64_t m_ImportingSourceBytes = 0;
+		std::chrono::steady_clock::time_point m_ImportStartTime;
+		bool m_Verbose = false;
 		ResourceManagingSystem* m_ResourceManagingSystem;
 	};
 
@@ -113,8 +450,10 @@ namespace resource_management
 		struct ChunkedMemoryAllocator
 		{
 		public:
+			//Chunks are aligned for any resource type
 			ChunkedMemoryAllocator(size_t page_size, size_t chunk_size) : m_PageSize(page_size)
-				, m_ChunkSizeByte(chunk_size), m_LastPageUsedChunkCount(m_PageSize)
+				, m_ChunkSizeByte((chunk_size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t))
+				, m_LastPageUsedChunkCount(m_PageSize)
 			{
 
 			}
@@ -134,27 +473,63 @@ namespace resource_management
 			{
 				m_AvailableChunks.push_back(releasedChunk);
 			}
+
+			size_t GetChunkSize() const { return m_ChunkSizeByte; }
 		private:
 			void* AllocNew()
 			{
 				if (m_LastPageUsedChunkCount == m_PageSize)
 				{
-					m_MemoryPages.emplace_back();
-					m_MemoryPages.back().resize(m_PageSize * m_ChunkSizeByte);
+					//Pages never move, resources allocated earlier stay valid while others are allocated
+					m_MemoryPages.push_back(castl::unique_ptr<uint8_t[]>(new uint8_t[m_PageSize * m_ChunkSizeByte]));
 					m_LastPageUsedChunkCount = 0;
 				}
-				void* result = m_MemoryPages.back().data() + m_LastPageUsedChunkCount * m_ChunkSizeByte;
+				void* result = m_MemoryPages.back().get() + m_LastPageUsedChunkCount * m_ChunkSizeByte;
 				++m_LastPageUsedChunkCount;
 				return result;
 			}
 		private:
 			size_t m_PageSize;
 			size_t m_ChunkSizeByte;
-			castl::vector<castl::vector<uint8_t>> m_MemoryPages;
+			castl::vector<castl::unique_ptr<uint8_t[]>> m_MemoryPages;
 			size_t m_LastPageUsedChunkCount;
 			castl::deque<void*> m_AvailableChunks;
 		};
 
+		//Residency of a resource loaded through the loader, other resources are never evicted
+		struct ResidentResource
+		{
+			castl::string typeName;
+			uint32_t referenceCount = 0;
+			uint64_t sizeInBytes = 0;
+			uint64_t externalSizeInBytes = 0;
+			//Valid while unreferenced
+			castl::list<void*>::iterator evictionPosition;
+		};
+
+		struct TypeResidency
+		{
+			uint64_t budgetInBytes = 0;
+			uint64_t residentBytes = 0;
+			uint64_t externalBytes = 0;
+			uint32_t residentCount = 0;
+			uint32_t referencedCount = 0;
+			uint64_t evictedCount = 0;
+			//Unreferenced resources, least recently released first
+			castl::list<void*> evictionOrder;
+		};
+
+		using EvictedResources = castl::vector<castl::pair<castl::string, void*>>;
+
+		ResourceManagingSystemImpl() :
+			m_Loader(
+				[this](castl::string const& path) { return LoadBinaryFile(path); }
+				, [this](castl::string const& path) { return AcquireLoadedResource(path); }
+				, [this](castl::string const& path, castl::string const& typeName, IResource* resource) { PublishResource(path, typeName, resource); }
+				, [this](IResource* resource) { ReleaseResourceReference(resource); })
+		{
+		}
+
 		virtual void SetResourceRootPath(castl::string const& path) override
 		{
 			m_AssetRootPath = castl::to_std(path);
@@ -179,10 +554,34 @@ namespace resource_management
 
 		virtual castl::vector<uint8_t> LoadBinaryFile(castl::string const& path) override
 		{
+			{
+				std::shared_lock<std::shared_mutex> lock(m_ArchiveMutex);
+				//Archives mounted later override earlier ones
+				for (auto itr = m_Archives.rbegin(); itr != m_Archives.rend(); ++itr)
+				{
+					castl::vector<uint8_t> result;
+					if ((*itr)->Read(path, result))
+					{
+						return result;
+					}
+				}
+			}
 			auto resourcePath = m_AssetRootPath / to_std(path);
 			return cacore::LoadBinaryFile(to_ca(resourcePath.string()));
 		}
 
+		virtual bool MountResourceArchive(castl::string const& archivePath) override
+		{
+			auto archive = castl::make_unique<ResourceArchive>();
+			if (!archive->Open(castl::to_std(archivePath)))
+			{
+				return false;
+			}
+			std::lock_guard<std::shared_mutex> lock(m_ArchiveMutex);
+			m_Archives.push_back(castl::move(archive));
+			return true;
+		}
+
 		virtual void* AllocResourceMemory(
 			castl::string type_name
 			, castl::string const& resource_path
@@ -214,6 +613,12 @@ namespace resource_management
 			CA_ASSERT(found != m_TypeNameToMemoryAllocator.end(), ("try release memory to void: " + type_name).c_str());
 			found->second.ReleaseChunk(pointer);
 
+			auto resident = m_ResidentResources.find(pointer);
+			if (resident != m_ResidentResources.end())
+			{
+				RemoveResident_NoLock(resident);
+			}
+
 			auto resourceToPath = m_ResourceAddressToAssetPath.find(pointer);
 			if (resourceToPath != m_ResourceAddressToAssetPath.end())
 			{
@@ -222,6 +627,105 @@ namespace resource_management
 			}
 		}
 
+		virtual void SetLoadingThreadCount(uint32_t threadCount) override
+		{
+			m_Loader.SetThreadCount(threadCount);
+		}
+
+		virtual castl::shared_ptr<IResourceLoadRequest> RequestResourceLoad(castl::string const& path
+			, castl::string const& typeName
+			, EResourceLoadPriority priority
+			, cacore::HashObj<castl::string> const& callbackThreadKey
+			, ResourceDeserializer&& deserializer
+			, castl::function<void(IResource*)>&& callback
+			, uint64_t& outCallbackID) override
+		{
+			return m_Loader.Request(path, typeName, priority, callbackThreadKey, castl::move(deserializer), castl::move(callback), outCallbackID);
+		}
+
+		virtual uint32_t DispatchLoadCallbacks(cacore::HashObj<castl::string> const& threadKey) override
+		{
+			return m_Loader.DispatchCallbacks(threadKey);
+		}
+
+		virtual void SetResourceBudget(castl::string const& typeName, uint64_t budgetInBytes) override
+		{
+			EvictedResources evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_TypeResidencies[typeName].budgetInBytes = budgetInBytes;
+				Evict_NoLock(typeName, evicted);
+			}
+			DestroyEvicted(evicted);
+		}
+
+		virtual void SetExternalMemorySize(IResource* resource, uint64_t sizeInBytes) override
+		{
+			EvictedResources evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				auto found = m_ResidentResources.find(resource);
+				if (found == m_ResidentResources.end())
+				{
+					return;
+				}
+				auto& typeResidency = m_TypeResidencies[found->second.typeName];
+				typeResidency.externalBytes = typeResidency.externalBytes - found->second.externalSizeInBytes + sizeInBytes;
+				found->second.externalSizeInBytes = sizeInBytes;
+				Evict_NoLock(found->second.typeName, evicted);
+			}
+			DestroyEvicted(evicted);
+		}
+
+		virtual void AddResourceReference(IResource* resource) override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			AddReference_NoLock(resource);
+		}
+
+		virtual void ReleaseResourceReference(IResource* resource) override
+		{
+			EvictedResources evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				auto found = m_ResidentResources.find(resource);
+				if (found == m_ResidentResources.end())
+				{
+					return;
+				}
+				auto& resident = found->second;
+				CA_ASSERT(resident.referenceCount > 0, "Resource reference released too often");
+				if (--resident.referenceCount == 0)
+				{
+					auto& typeResidency = m_TypeResidencies[resident.typeName];
+					--typeResidency.referencedCount;
+					resident.evictionPosition = typeResidency.evictionOrder.insert(typeResidency.evictionOrder.end(), found->first);
+					Evict_NoLock(resident.typeName, evicted);
+				}
+			}
+			DestroyEvicted(evicted);
+		}
+
+		virtual castl::vector<ResourceMemoryStatistics> GetMemoryStatistics() override
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			castl::vector<ResourceMemoryStatistics> result;
+			result.reserve(m_TypeResidencies.size());
+			for (auto& pair : m_TypeResidencies)
+			{
+				ResourceMemoryStatistics statistics{};
+				statistics.typeName = pair.first;
+				statistics.residentCount = pair.second.residentCount;
+				statistics.referencedCount = pair.second.referencedCount;
+				statistics.residentBytes = pair.second.residentBytes;
+				statistics.externalBytes = pair.second.externalBytes;
+				statistics.budgetBytes = pair.second.budgetInBytes;
+				statistics.evictedCount = pair.second.evictedCount;
+				result.push_back(statistics);
+			}
+			return result;
+		}
+
 		virtual void SerializeAllResources() override
 		{
 			for (auto& pair : m_ResourceAddressToAssetPath)
@@ -235,12 +739,126 @@ namespace resource_management
 			}
 		}
 	private:
+		IResource* AcquireLoadedResource(castl::string const& path)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto found = m_AssetPathToResourceAddress.find(path);
+			if (found == m_AssetPathToResourceAddress.end())
+			{
+				return nullptr;
+			}
+			IResource* resource = static_cast<IResource*>(found->second);
+			AddReference_NoLock(resource);
+			return resource;
+		}
+
+		//Loaded resources are allocated without a path, the path is assigned once they are deserialized
+		void PublishResource(castl::string const& path, castl::string const& typeName, IResource* resource)
+		{
+			EvictedResources evicted;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				CA_ASSERT(m_AssetPathToResourceAddress.find(path) == m_AssetPathToResourceAddress.end(), "Asset Already Exist!");
+				m_AssetPathToResourceAddress[path] = resource;
+				m_ResourceAddressToAssetPath[resource] = path;
+
+				ResidentResource resident{};
+				resident.typeName = typeName;
+				resident.referenceCount = 1;
+				resident.sizeInBytes = m_TypeNameToMemoryAllocator.find(typeName)->second.GetChunkSize() + resource->GetMemorySizeInByte();
+				auto& typeResidency = m_TypeResidencies[typeName];
+				typeResidency.residentBytes += resident.sizeInBytes;
+				++typeResidency.residentCount;
+				++typeResidency.referencedCount;
+				m_ResidentResources.insert(castl::make_pair(static_cast<void*>(resource), resident));
+				Evict_NoLock(typeName, evicted);
+			}
+			DestroyEvicted(evicted);
+		}
+
+		void AddReference_NoLock(IResource* resource)
+		{
+			auto found = m_ResidentResources.find(resource);
+			if (found == m_ResidentResources.end())
+			{
+				return;
+			}
+			auto& resident = found->second;
+			if (resident.referenceCount++ == 0)
+			{
+				auto& typeResidency = m_TypeResidencies[resident.typeName];
+				typeResidency.evictionOrder.erase(resident.evictionPosition);
+				++typeResidency.referencedCount;
+			}
+		}
+
+		void RemoveResident_NoLock(castl::unordered_map<void*, ResidentResource>::iterator resident)
+		{
+			auto& typeResidency = m_TypeResidencies[resident->second.typeName];
+			if (resident->second.referenceCount == 0)
+			{
+				typeResidency.evictionOrder.erase(resident->second.evictionPosition);
+			}
+			else
+			{
+				--typeResidency.referencedCount;
+			}
+			typeResidency.residentBytes -= resident->second.sizeInBytes;
+			typeResidency.externalBytes -= resident->second.externalSizeInBytes;
+			--typeResidency.residentCount;
+			m_ResidentResources.erase(resident);
+		}
+
+		//Unreferenced resources leave the maps right away so no load finds them, they are destroyed by DestroyEvicted
+		void Evict_NoLock(castl::string const& typeName, EvictedResources& outEvicted)
+		{
+			auto& typeResidency = m_TypeResidencies[typeName];
+			if (typeResidency.budgetInBytes == 0)
+			{
+				return;
+			}
+			while (typeResidency.residentBytes + typeResidency.externalBytes > typeResidency.budgetInBytes
+				&& !typeResidency.evictionOrder.empty())
+			{
+				void* address = typeResidency.evictionOrder.front();
+				RemoveResident_NoLock(m_ResidentResources.find(address));
+				++typeResidency.evictedCount;
+				auto resourceToPath = m_ResourceAddressToAssetPath.find(address);
+				if (resourceToPath != m_ResourceAddressToAssetPath.end())
+				{
+					m_AssetPathToResourceAddress.erase(resourceToPath->second);
+					m_ResourceAddressToAssetPath.erase(resourceToPath);
+				}
+				outEvicted.push_back(castl::make_pair(typeName, address));
+			}
+		}
+
+		//Outside of the lock, unloading may release other resources
+		void DestroyEvicted(EvictedResources const& evicted)
+		{
+			for (auto& pair : evicted)
+			{
+				IResource* resource = static_cast<IResource*>(pair.second);
+				resource->Unload();
+				resource->~IResource();
+				ReleaseResourceMemory(pair.first, pair.second);
+			}
+		}
+
 		std::mutex m_Mutex;
 		castl::unordered_map<castl::string, ChunkedMemoryAllocator> m_TypeNameToMemoryAllocator;
 		castl::unordered_map<castl::string, void*> m_AssetPathToResourceAddress;
 		castl::unordered_map<void*, castl::string> m_ResourceAddressToAssetPath;
 
+		castl::unordered_map<void*, ResidentResource> m_ResidentResources;
+		castl::unordered_map<castl::string, TypeResidency> m_TypeResidencies;
+
 		std::filesystem::path m_AssetRootPath;
+
+		std::shared_mutex m_ArchiveMutex;
+		castl::vector<castl::unique_ptr<ResourceArchive>> m_Archives;
+		//Declared last, its threads are stopped before the resource maps are destroyed
+		ResourceLoader m_Loader;
 	};
 
 	class ResourceFactoryImpl : public ResourceFactory
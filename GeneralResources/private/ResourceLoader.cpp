@@ -0,0 +1,309 @@
+#include "ResourceLoader.h"
+#include <CASTL/CAAlgorithm.h>
+#include <DebugUtils.h>
+
+namespace resource_management
+{
+	ResourceLoadRequest::~ResourceLoadRequest()
+	{
+		IResource* resource = GetResource();
+		if (resource != nullptr)
+		{
+			m_Loader->m_ReleaseFunction(resource);
+		}
+	}
+
+	void ResourceLoadRequest::Wait()
+	{
+		m_Loader->Wait(this);
+	}
+
+	void ResourceLoadRequest::RaisePriority(EResourceLoadPriority priority)
+	{
+		m_Loader->RaisePriority(this, priority);
+	}
+
+	void ResourceLoadRequest::Cancel(uint64_t callbackID)
+	{
+		m_Loader->Cancel(this, callbackID);
+	}
+
+	ResourceLoader::ResourceLoader(ReadFunction&& readFunction
+		, AcquireFunction&& acquireFunction
+		, PublishFunction&& publishFunction
+		, ReleaseFunction&& releaseFunction) :
+		m_ReadFunction(castl::move(readFunction))
+		, m_AcquireFunction(castl::move(acquireFunction))
+		, m_PublishFunction(castl::move(publishFunction))
+		, m_ReleaseFunction(castl::move(releaseFunction))
+	{
+	}
+
+	ResourceLoader::~ResourceLoader()
+	{
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			m_Stop = true;
+			for (auto& queue : m_Queues)
+			{
+				for (auto& request : queue)
+				{
+					Finish_NoLock(request, EResourceLoadState::eCanceled);
+				}
+				queue.clear();
+			}
+		}
+		m_WorkAvailable.notify_all();
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+		m_Threads.clear();
+	}
+
+	void ResourceLoader::SetThreadCount(uint32_t threadCount)
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		StartThreads_NoLock(threadCount);
+	}
+
+	castl::shared_ptr<IResourceLoadRequest> ResourceLoader::Request(castl::string const& path
+		, castl::string const& typeName
+		, EResourceLoadPriority priority
+		, cacore::HashObj<castl::string> const& callbackThreadKey
+		, ResourceManagingSystem::ResourceDeserializer&& deserializer
+		, castl::function<void(IResource*)>&& callback
+		, uint64_t& outCallbackID)
+	{
+		castl::unique_lock<castl::mutex> lock(m_Mutex);
+		outCallbackID = m_NextCallbackID++;
+		if (m_Stop)
+		{
+			auto canceledRequest = castl::make_shared<ResourceLoadRequest>(this, path, typeName, priority);
+			canceledRequest->m_State.store(EResourceLoadState::eCanceled, castl::memory_order_release);
+			return canceledRequest;
+		}
+
+		auto found = m_InFlightRequests.find(path);
+		if (found != m_InFlightRequests.end())
+		{
+			auto request = found->second;
+			request->m_Callbacks.push_back(ResourceLoadRequest::Callback{ outCallbackID, callbackThreadKey, castl::move(callback) });
+			lock.unlock();
+			RaisePriority(request.get(), priority);
+			return request;
+		}
+
+		auto request = castl::make_shared<ResourceLoadRequest>(this, path, typeName, priority);
+		IResource* loadedResource = m_AcquireFunction(path);
+		if (loadedResource != nullptr)
+		{
+			request->m_Resource.store(loadedResource, castl::memory_order_release);
+			request->m_State.store(EResourceLoadState::eLoaded, castl::memory_order_release);
+			if (callback)
+			{
+				m_FinishedCallbacks[callbackThreadKey].push_back(FinishedCallback{ outCallbackID, castl::move(callback), request });
+			}
+			return request;
+		}
+
+		request->m_Deserializer = castl::move(deserializer);
+		request->m_Callbacks.push_back(ResourceLoadRequest::Callback{ outCallbackID, callbackThreadKey, castl::move(callback) });
+		m_InFlightRequests.insert(castl::make_pair(path, request));
+		m_Queues[static_cast<uint32_t>(priority)].push_back(request);
+		if (m_Threads.empty())
+		{
+			StartThreads_NoLock(1);
+		}
+		lock.unlock();
+		m_WorkAvailable.notify_one();
+		return request;
+	}
+
+	uint32_t ResourceLoader::DispatchCallbacks(cacore::HashObj<castl::string> const& threadKey)
+	{
+		castl::vector<FinishedCallback> callbacks;
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			auto found = m_FinishedCallbacks.find(threadKey);
+			if (found == m_FinishedCallbacks.end())
+			{
+				return 0;
+			}
+			callbacks = castl::move(found->second);
+			m_FinishedCallbacks.erase(found);
+		}
+		for (auto& callback : callbacks)
+		{
+			callback.functor(callback.request->GetResource());
+		}
+		return static_cast<uint32_t>(callbacks.size());
+	}
+
+	void ResourceLoader::Wait(ResourceLoadRequest* request)
+	{
+		castl::unique_lock<castl::mutex> lock(m_Mutex);
+		castl::shared_ptr<ResourceLoadRequest> queuedRequest;
+		if (TakeQueued_NoLock(request, queuedRequest))
+		{
+			//Nothing to wait for but the queue, load it here
+			queuedRequest->m_State.store(EResourceLoadState::eLoading, castl::memory_order_release);
+			lock.unlock();
+			Execute(queuedRequest);
+			return;
+		}
+		m_LoadFinished.wait(lock, [request]()
+			{
+				EResourceLoadState state = request->GetState();
+				return state != EResourceLoadState::eQueued && state != EResourceLoadState::eLoading;
+			});
+	}
+
+	void ResourceLoader::RaisePriority(ResourceLoadRequest* request, EResourceLoadPriority priority)
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		if (priority <= request->m_Priority)
+		{
+			return;
+		}
+		castl::shared_ptr<ResourceLoadRequest> queuedRequest;
+		bool queued = TakeQueued_NoLock(request, queuedRequest);
+		request->m_Priority = priority;
+		if (queued)
+		{
+			m_Queues[static_cast<uint32_t>(priority)].push_back(queuedRequest);
+		}
+	}
+
+	void ResourceLoader::Cancel(ResourceLoadRequest* request, uint64_t callbackID)
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		auto& callbacks = request->m_Callbacks;
+		auto found = castl::find_if(callbacks.begin(), callbacks.end(), [callbackID](ResourceLoadRequest::Callback const& callback)
+			{
+				return callback.callbackID == callbackID;
+			});
+		if (found == callbacks.end())
+		{
+			//The request already finished, the callback may still wait for its dispatch
+			for (auto& finishedCallbacks : m_FinishedCallbacks)
+			{
+				auto& bucket = finishedCallbacks.second;
+				auto foundFinished = castl::find_if(bucket.begin(), bucket.end(), [callbackID](FinishedCallback const& callback)
+					{
+						return callback.callbackID == callbackID;
+					});
+				if (foundFinished != bucket.end())
+				{
+					bucket.erase(foundFinished);
+					return;
+				}
+			}
+			return;
+		}
+		callbacks.erase(found);
+		castl::shared_ptr<ResourceLoadRequest> queuedRequest;
+		if (callbacks.empty() && TakeQueued_NoLock(request, queuedRequest))
+		{
+			Finish_NoLock(queuedRequest, EResourceLoadState::eCanceled);
+		}
+	}
+
+	void ResourceLoader::WorkLoop()
+	{
+		while (true)
+		{
+			castl::shared_ptr<ResourceLoadRequest> request;
+			{
+				castl::unique_lock<castl::mutex> lock(m_Mutex);
+				m_WorkAvailable.wait(lock, [this]()
+					{
+						return m_Stop || castl::any_of(castl::begin(m_Queues), castl::end(m_Queues), [](auto const& queue) { return !queue.empty(); });
+					});
+				if (m_Stop)
+				{
+					return;
+				}
+				for (uint32_t priority = static_cast<uint32_t>(EResourceLoadPriority::eCount); priority > 0; --priority)
+				{
+					auto& queue = m_Queues[priority - 1];
+					if (!queue.empty())
+					{
+						request = castl::move(queue.front());
+						queue.pop_front();
+						break;
+					}
+				}
+				request->m_State.store(EResourceLoadState::eLoading, castl::memory_order_release);
+			}
+			Execute(request);
+		}
+	}
+
+	bool ResourceLoader::TakeQueued_NoLock(ResourceLoadRequest* request, castl::shared_ptr<ResourceLoadRequest>& outRequest)
+	{
+		if (request->GetState() != EResourceLoadState::eQueued)
+		{
+			return false;
+		}
+		auto& queue = m_Queues[static_cast<uint32_t>(request->m_Priority)];
+		auto found = castl::find_if(queue.begin(), queue.end(), [request](castl::shared_ptr<ResourceLoadRequest> const& queued)
+			{
+				return queued.get() == request;
+			});
+		if (found == queue.end())
+		{
+			return false;
+		}
+		outRequest = castl::move(*found);
+		queue.erase(found);
+		return true;
+	}
+
+	void ResourceLoader::Execute(castl::shared_ptr<ResourceLoadRequest> const& request)
+	{
+		castl::vector<uint8_t> data = m_ReadFunction(request->m_Path);
+		if (data.empty())
+		{
+			CA_LOG_ERR("Failed to load resource " + request->m_Path);
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			Finish_NoLock(request, EResourceLoadState::eFailed);
+			return;
+		}
+		//Published before the request leaves the in flight map, so later requests of the path find the resource.
+		//The reference it is published with belongs to the request
+		IResource* resource = request->m_Deserializer(data);
+		m_PublishFunction(request->m_Path, request->m_TypeName, resource);
+		request->m_Resource.store(resource, castl::memory_order_release);
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		Finish_NoLock(request, EResourceLoadState::eLoaded);
+	}
+
+	void ResourceLoader::Finish_NoLock(castl::shared_ptr<ResourceLoadRequest> const& request, EResourceLoadState state)
+	{
+		for (auto& callback : request->m_Callbacks)
+		{
+			if (callback.functor)
+			{
+				m_FinishedCallbacks[callback.threadKey].push_back(FinishedCallback{ callback.callbackID, castl::move(callback.functor), request });
+			}
+		}
+		request->m_Callbacks.clear();
+		request->m_Deserializer = nullptr;
+		request->m_State.store(state, castl::memory_order_release);
+		m_InFlightRequests.erase(request->m_Path);
+		m_LoadFinished.notify_all();
+	}
+
+	void ResourceLoader::StartThreads_NoLock(uint32_t threadCount)
+	{
+		if (m_Stop)
+		{
+			return;
+		}
+		while (m_Threads.size() < threadCount)
+		{
+			m_Threads.emplace_back(&ResourceLoader::WorkLoop, this);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <CAResource/ResourceManagingSystem.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CADeque.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAAtomic.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <thread>
+
+namespace resource_management
+{
+	class ResourceLoader;
+
+	class ResourceLoadRequest : public IResourceLoadRequest
+	{
+	public:
+		ResourceLoadRequest(ResourceLoader* loader, castl::string const& path, castl::string const& typeName, EResourceLoadPriority priority) :
+			m_Loader(loader)
+			, m_Path(path)
+			, m_TypeName(typeName)
+			, m_Priority(priority)
+		{
+		}
+		//Drops the reference to the loaded resource
+		virtual ~ResourceLoadRequest() override;
+		virtual castl::string const& GetPath() const override { return m_Path; }
+		virtual EResourceLoadState GetState() const override { return m_State.load(castl::memory_order_acquire); }
+		virtual IResource* GetResource() const override { return m_Resource.load(castl::memory_order_acquire); }
+		virtual void Wait() override;
+		virtual void RaisePriority(EResourceLoadPriority priority) override;
+		virtual void Cancel(uint64_t callbackID) override;
+	private:
+		struct Callback
+		{
+			uint64_t callbackID;
+			cacore::HashObj<castl::string> threadKey;
+			castl::function<void(IResource*)> functor;
+		};
+
+		ResourceLoader* m_Loader;
+		castl::string m_Path;
+		castl::string m_TypeName;
+		castl::atomic<EResourceLoadState> m_State{ EResourceLoadState::eQueued };
+		castl::atomic<IResource*> m_Resource{ nullptr };
+		//Guarded by the loader's mutex
+		EResourceLoadPriority m_Priority;
+		ResourceManagingSystem::ResourceDeserializer m_Deserializer;
+		//One per handle that did not cancel yet, the functor may be empty
+		castl::vector<Callback> m_Callbacks;
+
+		friend class ResourceLoader;
+	};
+
+	//Reads and deserializes resources on its own threads, most urgent loads first.
+	//Frame task graphs are not used because a loop iteration only ends when all of its tasks finished
+	class ResourceLoader
+	{
+	public:
+		using ReadFunction = castl::function<castl::vector<uint8_t>(castl::string const& path)>;
+		//Returns a loaded resource with one more reference
+		using AcquireFunction = castl::function<IResource*(castl::string const& path)>;
+		//Makes a deserialized resource visible under its path, with one reference
+		using PublishFunction = castl::function<void(castl::string const& path, castl::string const& typeName, IResource* resource)>;
+		using ReleaseFunction = castl::function<void(IResource* resource)>;
+
+		ResourceLoader(ReadFunction&& readFunction
+			, AcquireFunction&& acquireFunction
+			, PublishFunction&& publishFunction
+			, ReleaseFunction&& releaseFunction);
+		ResourceLoader(ResourceLoader const&) = delete;
+		ResourceLoader& operator=(ResourceLoader const&) = delete;
+		//Queued loads are canceled, running loads are waited for
+		~ResourceLoader();
+
+		//Threads are only ever added
+		void SetThreadCount(uint32_t threadCount);
+		castl::shared_ptr<IResourceLoadRequest> Request(castl::string const& path
+			, castl::string const& typeName
+			, EResourceLoadPriority priority
+			, cacore::HashObj<castl::string> const& callbackThreadKey
+			, ResourceManagingSystem::ResourceDeserializer&& deserializer
+			, castl::function<void(IResource*)>&& callback
+			, uint64_t& outCallbackID);
+		uint32_t DispatchCallbacks(cacore::HashObj<castl::string> const& threadKey);
+	private:
+		struct FinishedCallback
+		{
+			//Canceling the handle drops the callback until it is dispatched
+			uint64_t callbackID;
+			castl::function<void(IResource*)> functor;
+			//Keeps the resource referenced until the callback ran
+			castl::shared_ptr<ResourceLoadRequest> request;
+		};
+
+		void Wait(ResourceLoadRequest* request);
+		void RaisePriority(ResourceLoadRequest* request, EResourceLoadPriority priority);
+		void Cancel(ResourceLoadRequest* request, uint64_t callbackID);
+
+		void WorkLoop();
+		//Removes the request from its queue, false when a thread already took it
+		bool TakeQueued_NoLock(ResourceLoadRequest* request, castl::shared_ptr<ResourceLoadRequest>& outRequest);
+		void Execute(castl::shared_ptr<ResourceLoadRequest> const& request);
+		//Hands the callbacks to their threads, the request is not in flight anymore
+		void Finish_NoLock(castl::shared_ptr<ResourceLoadRequest> const& request, EResourceLoadState state);
+		void StartThreads_NoLock(uint32_t threadCount);
+
+		ReadFunction m_ReadFunction;
+		AcquireFunction m_AcquireFunction;
+		PublishFunction m_PublishFunction;
+		ReleaseFunction m_ReleaseFunction;
+
+		castl::mutex m_Mutex;
+		castl::condition_variable m_WorkAvailable;
+		castl::condition_variable m_LoadFinished;
+		castl::deque<castl::shared_ptr<ResourceLoadRequest>> m_Queues[static_cast<uint32_t>(EResourceLoadPriority::eCount)];
+		castl::unordered_map<castl::string, castl::shared_ptr<ResourceLoadRequest>> m_InFlightRequests;
+		castl::unordered_map<cacore::HashObj<castl::string>, castl::vector<FinishedCallback>> m_FinishedCallbacks;
+		castl::vector<std::thread> m_Threads;
+		uint64_t m_NextCallbackID = 1;
+		bool m_Stop = false;
+
+		friend class ResourceLoadRequest;
+	};
+}
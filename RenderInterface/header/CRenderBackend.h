@@ -2,6 +2,7 @@
 #include <CASTL/CAVector.h>
 #include <CASTL/CASharedPtr.h>
 #include <CASTL/CAString.h>
+#include <CASTL/CAFunctional.h>
 #include <CAWindow/WindowSystem.h>
 #include <CATimer/Timer.h>
 #include "Common.h"
@@ -24,12 +25,25 @@ namespace thread_management
 namespace graphics_backend
 {
 	using namespace thread_management;
+
+	struct GPUMemoryStatistics
+	{
+		//Device memory bound to the textures and buffers of the backend, the frame bound pools of transient graph resources included
+		uint64_t textureBytes = 0;
+		uint64_t bufferBytes = 0;
+		//Device local heap blocks allocated by the backend's allocators and the budget of those heaps
+		uint64_t deviceLocalUsage = 0;
+		uint64_t deviceLocalBudget = 0;
+	};
+
 	class CRenderBackend
 	{
 	public:
 		virtual void Initialize(catimer::TimerSystem* timer, castl::string const& appName, castl::string const& engineName) = 0;
 		virtual void InitializeThreadContextCount(uint32_t threadContextCount) = 0;
 		virtual void ScheduleGPUFrame(TaskScheduler* scheduler, GPUFrame const& gpuFrame) = 0;
+		//Compiles pipelines recorded by previous runs on worker tasks, call it while loading
+		virtual void PrewarmPipelines(TaskScheduler* scheduler) = 0;
 		virtual void Release() = 0;
 
 		virtual castl::shared_ptr<GPUBuffer> CreateGPUBuffer(GPUBufferDescriptor const& descriptor) = 0;
@@ -40,8 +54,15 @@ namespace graphics_backend
 			return CreateGPUBuffer(GPUBufferDescriptor::Create(usageFlags, count, stride));
 		}
 		virtual castl::shared_ptr<GPUTexture> CreateGPUTexture(GPUTextureDescriptor const& inDescriptor) = 0;
+		//Streams data on the transfer queue without going through frame graphs, the resource must not be used by graphs until onComplete runs.
+		//Data must stay valid until onComplete runs, texture data holds leading mips one after another, largest first
+		virtual void UploadBufferAsync(castl::shared_ptr<GPUBuffer> const& buffer, void const* pData, uint64_t size, uint64_t offset = 0, castl::function<void()> onComplete = {}) = 0;
+		virtual void UploadTextureAsync(castl::shared_ptr<GPUTexture> const& texture, void const* pData, uint64_t size, castl::function<void()> onComplete = {}) = 0;
 		virtual castl::shared_ptr<WindowHandle> GetWindowHandle(castl::shared_ptr<cawindow::IWindow> window) = 0;
 		virtual bool AnyWindowRunning() = 0;
+		//False when DrawCallBatch::DrawIndexedIndirect can not be used on this device
+		virtual bool SupportsIndirectDrawCount() = 0;
+		virtual GPUMemoryStatistics GetGPUMemoryStatistics() = 0;
 	};
 }
 
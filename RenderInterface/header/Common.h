@@ -102,6 +102,16 @@ enum class EIndexBufferType : uint8_t
 	e32
 };
 
+//Layout of one indexed indirect draw, matches VkDrawIndexedIndirectCommand
+struct DrawIndexedIndirectArgs
+{
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t vertexOffset;
+	uint32_t firstInstance;
+};
+
 enum class ETextureAspect : uint8_t
 {
 	//Color for non-depth format, depth for depth format
@@ -146,6 +156,19 @@ enum class ETextureFormat : uint8_t
 
 	E_R32_SFLOAT,
 	E_R32G32B32A32_SFLOAT,
+
+	E_R8G8B8A8_SRGB,
+
+	//4x4 texel blocks
+	E_BLOCK_COMPRESSED_TYPE_CATEGORY_BEGIN,///Block Compressed Type Begin
+	E_BC1_RGBA_UNORM,
+	E_BC1_RGBA_SRGB,
+	E_BC3_UNORM,
+	E_BC3_SRGB,
+	E_BC5_UNORM,
+	E_BC7_UNORM,
+	E_BC7_SRGB,
+	E_BLOCK_COMPRESSED_TYPE_CATEGORY_END,///Block Compressed Type End
 	E_FLOAT_TYPE_CATEGORY_END,////FLoat Type End
 
 	//标记整形值
@@ -193,6 +216,61 @@ constexpr static bool IsFloatFormat(ETextureFormat format)
 	return (format > ETextureFormat::E_FLOAT_TYPE_CATEGORY_BEGIN && format < ETextureFormat::E_FLOAT_TYPE_CATEGORY_END);
 }
 
+constexpr static bool IsBlockCompressedFormat(ETextureFormat format)
+{
+	return (format > ETextureFormat::E_BLOCK_COMPRESSED_TYPE_CATEGORY_BEGIN && format < ETextureFormat::E_BLOCK_COMPRESSED_TYPE_CATEGORY_END);
+}
+
+constexpr static bool IsSRGBFormat(ETextureFormat format)
+{
+	return format == ETextureFormat::E_R8G8B8A8_SRGB
+		|| format == ETextureFormat::E_BC1_RGBA_SRGB
+		|| format == ETextureFormat::E_BC3_SRGB
+		|| format == ETextureFormat::E_BC7_SRGB;
+}
+
+//Texels per block side, 1 for uncompressed formats
+constexpr static uint32_t GetFormatBlockExtent(ETextureFormat format)
+{
+	return IsBlockCompressedFormat(format) ? 4 : 1;
+}
+
+//Bytes of a texel, or of a block for block compressed formats
+constexpr static uint32_t GetFormatBlockBytes(ETextureFormat format)
+{
+	switch (format)
+	{
+	case ETextureFormat::E_R8_UNORM:
+		return 1;
+	case ETextureFormat::E_R16_UNORM:
+	case ETextureFormat::E_R16_SFLOAT:
+	case ETextureFormat::E_R8G8_UNORM:
+		return 2;
+	case ETextureFormat::E_R16G16_SFLOAT:
+	case ETextureFormat::E_R8G8B8A8_UNORM:
+	case ETextureFormat::E_R8G8B8A8_SRGB:
+	case ETextureFormat::E_B8G8R8A8_UNORM:
+	case ETextureFormat::E_R32_SFLOAT:
+	case ETextureFormat::E_D32_SFLOAT:
+		return 4;
+	case ETextureFormat::E_R16G16B16A16_UNORM:
+	case ETextureFormat::E_R16G16B16A16_SFLOAT:
+	case ETextureFormat::E_D32_SFLOAT_S8_UINT:
+	case ETextureFormat::E_BC1_RGBA_UNORM:
+	case ETextureFormat::E_BC1_RGBA_SRGB:
+		return 8;
+	case ETextureFormat::E_R32G32B32A32_SFLOAT:
+	case ETextureFormat::E_BC3_UNORM:
+	case ETextureFormat::E_BC3_SRGB:
+	case ETextureFormat::E_BC5_UNORM:
+	case ETextureFormat::E_BC7_UNORM:
+	case ETextureFormat::E_BC7_SRGB:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
 constexpr static bool IsIntFormat(ETextureFormat format)
 {
 	return (format > ETextureFormat::E_INT_TYPE_CATEGORY_BEGIN && format < ETextureFormat::E_INT_TYPE_CATEGORY_END);
@@ -211,7 +289,8 @@ enum class EBufferUsage : uint16_t
 	eIndexBuffer = 1 << 3,
 	eDataSrc = 1 << 4,
 	eDataDst = 1 << 5,
-	eMaxBit = 5
+	eIndirectBuffer = 1 << 6,
+	eMaxBit = 6
 };
 
 template <>
@@ -365,6 +444,8 @@ enum class VertexInputFormat
 	eR8G8B8A8_UNorm,
 	eR32_UInt,
 	eR32_SInt,
+	eR16G16_SFloat,
+	eR8G8B8A8_SNorm,
 };
 
 union GraphicsClearValue
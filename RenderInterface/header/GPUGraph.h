@@ -10,30 +10,74 @@
 #include <CASTL/CAFunctional.h>
 #include <CASTL/CAUnorderedMap.h>
 #include <CASTL/CAMap.h>
+#include <CASTL/CADeque.h>
 
 namespace graphics_backend
 {
 #pragma region Upload Data Holder
+	template<typename T>
+	struct UploadDataSpan
+	{
+		T* m_Data = nullptr;
+		uint64_t m_Count = 0;
+		T* data() const { return m_Data; }
+		uint64_t size() const { return m_Count; }
+		bool empty() const { return m_Count == 0; }
+		T* begin() const { return m_Data; }
+		T* end() const { return m_Data + m_Count; }
+		T& operator[](uint64_t index) const { return m_Data[index]; }
+	};
+
+	//Upload data is stored in pages, reserved memory never moves so spans returned by GPUGraph::ScheduleData stay valid while the graph is built
 	struct UploadDataHolder
 	{
-		castl::vector<uint8_t> m_Data;
+		static constexpr uint64_t PAGE_SIZE = 256 * 1024;
+		static constexpr uint64_t DATA_ALIGNMENT = 16;
+		castl::deque<castl::vector<uint8_t>> m_Pages;
+		uint32_t m_CurrentPage = 0;
+		uint64_t m_CurrentPageOffset = 0;
+
+		uint64_t Reserve(uint64_t byteSize)
+		{
+			uint64_t alignedOffset = (m_CurrentPageOffset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+			if (m_Pages.empty() || alignedOffset + byteSize > m_Pages[m_CurrentPage].size())
+			{
+				//Big uploads get a page of their own
+				m_Pages.emplace_back();
+				m_Pages.back().resize(castl::max(byteSize, PAGE_SIZE));
+				m_CurrentPage = m_Pages.size() - 1;
+				alignedOffset = 0;
+			}
+			m_CurrentPageOffset = alignedOffset + byteSize;
+			return MakeIndex(m_CurrentPage, alignedOffset);
+		}
 		uint64_t AddData(void const* pData, uint64_t byteSize)
 		{
-			uint64_t startPos = m_Data.size();
+			uint64_t index = Reserve(byteSize);
 			if (byteSize > 0)
 			{
-				m_Data.resize(startPos + byteSize);
-				memcpy(&m_Data[startPos], pData, byteSize);
+				memcpy(GetPtr(index), pData, byteSize);
 			}
-			return startPos;
+			return index;
+		}
+		void* GetPtr(uint64_t index)
+		{
+			return m_Pages[index >> 32].data() + (index & 0xffffffffull);
 		}
 		void const* GetPtr(uint64_t index) const
 		{
-			return &m_Data[index];
+			return m_Pages[index >> 32].data() + (index & 0xffffffffull);
 		}
 		void Clear()
 		{
-			m_Data.clear();
+			m_Pages.clear();
+			m_CurrentPage = 0;
+			m_CurrentPageOffset = 0;
+		}
+	private:
+		static uint64_t MakeIndex(uint64_t pageIndex, uint64_t pageOffset)
+		{
+			return (pageIndex << 32) | pageOffset;
 		}
 	};
 #pragma endregion
@@ -74,6 +118,16 @@ namespace graphics_backend
 			return {};
 		}
 
+		//Draws whose arguments are written on the GPU, the draw count is read from countBuffer and clamped to maxDrawCount
+		struct IndirectDraw
+		{
+			BufferHandle argsBuffer;
+			uint32_t argsOffset;
+			BufferHandle countBuffer;
+			uint32_t countOffset;
+			uint32_t maxDrawCount;
+		};
+
 		//PSO
 		PipelineDescData pipelineStateDesc;
 		//Draw Calls
@@ -82,6 +136,7 @@ namespace graphics_backend
 		BufferHandle m_BoundIndexBuffer;
 		EIndexBufferType m_IndexBufferType = EIndexBufferType::e16;
 		uint32_t m_IndexBufferOffset = 0;
+		castl::vector<IndirectDraw> m_IndirectDraws;
 
 		inline DrawCallBatch& SetPipelineState(const CPipelineStateObject& pipelineState)
 		{
@@ -115,6 +170,9 @@ namespace graphics_backend
 		inline DrawCallBatch& SetVertexBuffer(cacore::HashObj<VertexInputsDescriptor> const& vertexInputDesc, BufferHandle const& bufferHandle);
 		inline DrawCallBatch& SetIndexBuffer(EIndexBufferType indexBufferType, BufferHandle const& bufferHandle, uint32_t byteOffset = 0);
 		inline DrawCallBatch& Draw(castl::function<void(CommandList&)> commandFunc);
+		//argsBuffer holds DrawIndexedIndirectArgs, countBuffer a uint32_t draw count
+		inline DrawCallBatch& DrawIndexedIndirect(BufferHandle const& argsBuffer, uint32_t argsOffset
+			, BufferHandle const& countBuffer, uint32_t countOffset, uint32_t maxDrawCount);
 	};
 
 	struct AttachmentConfig
@@ -381,8 +439,14 @@ namespace graphics_backend
 		inline GPUGraph& AddPass(RenderPass const& renderPass);
 		inline GPUGraph& AddPass(ComputeBatch const& computePass);
 		//Data Transition
+		//Image data holds consecutive mips largest first, offset is GPUTextureDescriptor::GetMipDataOffset of the first one
 		inline GPUGraph& ScheduleData(ImageHandle const& imageHandle, void const* data, uint64_t size, uint64_t offset = 0);
 		inline GPUGraph& ScheduleData(BufferHandle const& bufferHandle, void const* data, uint64_t size, uint64_t offset = 0);
+		//Reserve upload memory for count elements and write it in place, avoids copying from a temporary array
+		template<typename T>
+		UploadDataSpan<T> ScheduleData(ImageHandle const& imageHandle, uint64_t count, uint64_t offset = 0);
+		template<typename T>
+		UploadDataSpan<T> ScheduleData(BufferHandle const& bufferHandle, uint64_t count, uint64_t offset = 0);
 		//Allocate a graph local image
 		inline GPUGraph& AllocImage(ImageHandle const& imageHandle, GPUTextureDescriptor const& desc);
 		//Allocate a graph local buffer
@@ -397,6 +461,7 @@ namespace graphics_backend
 		GraphResourceManager<GPUTextureDescriptor> const& GetImageManager() const { return m_InternalImageManager; }
 		GraphResourceManager<GPUBufferDescriptor> const& GetBufferManager() const { return m_InternalBufferManager; }
 	private:
+		inline GPUDataTransfers& GetCurrentDataTransfers();
 		//Render Passes
 		castl::deque<RenderPass> m_RenderPasses;
 		//Compute Passes
@@ -433,6 +498,12 @@ namespace graphics_backend
 		m_DrawCommands.push_back(commandFunc);
 		return *this;
 	}
+	DrawCallBatch& DrawCallBatch::DrawIndexedIndirect(BufferHandle const& argsBuffer, uint32_t argsOffset
+		, BufferHandle const& countBuffer, uint32_t countOffset, uint32_t maxDrawCount)
+	{
+		m_IndirectDraws.push_back(IndirectDraw{ argsBuffer, argsOffset, countBuffer, countOffset, maxDrawCount });
+		return *this;
+	}
 
 	RenderPass& RenderPass::SetPipelineState(const CPipelineStateObject& pipelineState)
 	{
@@ -479,38 +550,50 @@ namespace graphics_backend
 		return *this;
 	}
 	
-	GPUGraph& GPUGraph::ScheduleData(ImageHandle const& imageHandle, void const* data, uint64_t size, uint64_t offset)
+	GPUDataTransfers& GPUGraph::GetCurrentDataTransfers()
 	{
 		if (m_StageTypes.empty() || m_StageTypes.back() != EGraphStageType::eTransferPass)
 		{
 			m_StageTypes.push_back(EGraphStageType::eTransferPass);
 			m_PassIndices.push_back(m_DataTransfers.size());
-		}
-		if (m_DataTransfers.empty())
-		{
 			m_DataTransfers.emplace_back();
 		}
+		return m_DataTransfers.back();
+	}
+	GPUGraph& GPUGraph::ScheduleData(ImageHandle const& imageHandle, void const* data, uint64_t size, uint64_t offset)
+	{
 		uint64_t dataIndex = m_DataHolder.AddData(data, size);
-		m_DataTransfers.back().m_ImageDataUploads.push_back(castl::make_pair( imageHandle
+		GetCurrentDataTransfers().m_ImageDataUploads.push_back(castl::make_pair( imageHandle
 			, GPUDataTransfers::DataReference::Create(data, dataIndex, offset, size, true) ));
 		return *this;
 	}
 	GPUGraph& GPUGraph::ScheduleData(BufferHandle const& bufferHandle, void const* data, uint64_t size, uint64_t offset)
 	{
-		if (m_StageTypes.empty() || m_StageTypes.back() != EGraphStageType::eTransferPass)
-		{
-			m_StageTypes.push_back(EGraphStageType::eTransferPass);
-			m_PassIndices.push_back(m_DataTransfers.size());
-		}
-		if (m_DataTransfers.empty())
-		{
-			m_DataTransfers.emplace_back();
-		}
 		uint64_t dataIndex = m_DataHolder.AddData(data, size);
-		m_DataTransfers.back().m_BufferDataUploads.push_back(castl::make_pair(bufferHandle
+		GetCurrentDataTransfers().m_BufferDataUploads.push_back(castl::make_pair(bufferHandle
 			, GPUDataTransfers::DataReference::Create(data, dataIndex, offset, size, true)));
 		return *this;
 	}
+	template<typename T>
+	UploadDataSpan<T> GPUGraph::ScheduleData(ImageHandle const& imageHandle, uint64_t count, uint64_t offset)
+	{
+		uint64_t size = count * sizeof(T);
+		uint64_t dataIndex = m_DataHolder.Reserve(size);
+		T* pData = static_cast<T*>(m_DataHolder.GetPtr(dataIndex));
+		GetCurrentDataTransfers().m_ImageDataUploads.push_back(castl::make_pair(imageHandle
+			, GPUDataTransfers::DataReference::Create(pData, dataIndex, offset, size, true)));
+		return UploadDataSpan<T>{ pData, count };
+	}
+	template<typename T>
+	UploadDataSpan<T> GPUGraph::ScheduleData(BufferHandle const& bufferHandle, uint64_t count, uint64_t offset)
+	{
+		uint64_t size = count * sizeof(T);
+		uint64_t dataIndex = m_DataHolder.Reserve(size);
+		T* pData = static_cast<T*>(m_DataHolder.GetPtr(dataIndex));
+		GetCurrentDataTransfers().m_BufferDataUploads.push_back(castl::make_pair(bufferHandle
+			, GPUDataTransfers::DataReference::Create(pData, dataIndex, offset, size, true)));
+		return UploadDataSpan<T>{ pData, count };
+	}
 	GPUGraph& GPUGraph::AllocImage(ImageHandle const& imageHandle, GPUTextureDescriptor const& desc)
 	{
 		if (imageHandle.GetType() != ImageHandle::ImageType::Internal)
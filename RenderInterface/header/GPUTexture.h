@@ -17,6 +17,31 @@ namespace graphics_backend
 
 		auto operator<=>(const GPUTextureDescriptor&) const = default;
 
+		constexpr uint32_t GetMipWidth(uint32_t mip) const { return castl::max(width >> mip, 1u); }
+		constexpr uint32_t GetMipHeight(uint32_t mip) const { return castl::max(height >> mip, 1u); }
+		//Depth slices of 3D textures shrink with the mips, array layers do not
+		constexpr uint32_t GetMipLayers(uint32_t mip) const { return textureType == ETextureType::e3D ? castl::max(layers >> mip, 1u) : layers; }
+
+		//Bytes of one mip of every layer, block compressed mips are rounded up to whole blocks
+		constexpr uint64_t GetMipDataSize(uint32_t mip) const
+		{
+			uint32_t blockExtent = GetFormatBlockExtent(format);
+			uint64_t blocksX = (GetMipWidth(mip) + blockExtent - 1) / blockExtent;
+			uint64_t blocksY = (GetMipHeight(mip) + blockExtent - 1) / blockExtent;
+			return blocksX * blocksY * GetMipLayers(mip) * GetFormatBlockBytes(format);
+		}
+
+		//Offset of a mip in texture data that holds the mips one after another, largest first
+		constexpr uint64_t GetMipDataOffset(uint32_t mip) const
+		{
+			uint64_t offset = 0;
+			for (uint32_t mipID = 0; mipID < mip; ++mipID)
+			{
+				offset += GetMipDataSize(mipID);
+			}
+			return offset;
+		}
+
 		static GPUTextureDescriptor Create(
 			uint32_t width, uint32_t height
 			, ETextureFormat format
@@ -121,6 +146,14 @@ namespace graphics_backend
 			return desc;
 		}
 
+		//Samples the mips from firstResidentMip on, the finer ones are skipped until they are uploaded
+		constexpr static GPUTextureView CreateForResidentMips(ETextureFormat format, uint32_t firstResidentMip, GPUTextureSwizzle swizzle = GPUTextureSwizzle::Create())
+		{
+			GPUTextureView desc = CreateDefaultForSampling(format, swizzle);
+			desc.baseMip = firstResidentMip;
+			return desc;
+		}
+
 		constexpr void Sanitize(GPUTextureDescriptor const& textureDesc)
 		{
 			baseMip = castl::clamp(baseMip, 0u, textureDesc.mipLevels - 1);
@@ -4,6 +4,7 @@
 #include "TextureSampler.h"
 #include <CASTL/CAVector.h>
 #include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAAtomic.h>
 
 namespace graphics_backend
 {
@@ -15,6 +16,25 @@ namespace graphics_backend
 			uint32_t offset;
 			uint32_t size;
 		};
+
+		ShaderArgList() : m_ID(NewID()) {}
+		//Copies get their own id, backends cache data addresses per list
+		ShaderArgList(ShaderArgList const& other) : m_NameToNumericArrayList(other.m_NameToNumericArrayList)
+			, m_NameToImage(other.m_NameToImage)
+			, m_NameToBuffer(other.m_NameToBuffer)
+			, m_NameToSubArgLists(other.m_NameToSubArgLists)
+			, m_NameToSamplers(other.m_NameToSamplers)
+			, m_NameToDataPosition(other.m_NameToDataPosition)
+			, m_NumericDataList(other.m_NumericDataList)
+			, m_ID(NewID())
+		{
+		}
+		ShaderArgList& operator=(ShaderArgList const&) = delete;
+
+		//Unique for every list
+		uint64_t GetID() const { return m_ID; }
+		//Changes whenever a name is added or the storage of a value moves, values set in place keep the version
+		uint64_t GetStructureVersion() const { return m_StructureVersion; }
 		inline ShaderArgList& SetValueInternal(castl::string const& name, void const* pValue, uint32_t sizeInBytes)
 		{
 			auto found = m_NameToDataPosition.find(name);
@@ -26,6 +46,7 @@ namespace graphics_backend
 			{
 				uint32_t offset = m_NumericDataList.size();
 				m_NumericDataList.resize(offset + sizeInBytes);
+				++m_StructureVersion;
 				found = m_NameToDataPosition.insert(castl::make_pair(name, NumericDataPos{ offset, sizeInBytes })).first;
 			}
 			memcpy(&m_NumericDataList[found->second.offset], pValue, castl::min(found->second.size, sizeInBytes));
@@ -35,7 +56,11 @@ namespace graphics_backend
 		inline ShaderArgList& SetValueArrayInternal(castl::string const& name, void const* pValue, uint32_t sizeInBytes)
 		{
 			auto& arrayData = m_NameToNumericArrayList[name];
-			arrayData.resize(sizeInBytes);
+			if (arrayData.size() != sizeInBytes)
+			{
+				arrayData.resize(sizeInBytes);
+				++m_StructureVersion;
+			}
 			memcpy(arrayData.data(), pValue, sizeInBytes);
 			return *this;
 		}
@@ -51,9 +76,11 @@ namespace graphics_backend
 			return SetValueArrayInternal(name, pValue, sizeof(T) * count);
 		}
 
+		//Images and buffers set under the name of a uint uniform are passed to bindless shaders as indices into the global descriptor heap
 		inline ShaderArgList& SetImage(castl::string const& name
 			, ImageHandle const& imageHandle, GPUTextureView const& view)
 		{
+			MarkNewName(m_NameToImage, name);
 			m_NameToImage[name] = { castl::make_pair<ImageHandle, GPUTextureView>(imageHandle, view) };
 			return *this;
 		}
@@ -67,6 +94,7 @@ namespace graphics_backend
 		inline ShaderArgList& SetBuffer(castl::string const& name
 			, BufferHandle const& bufferHandle)
 		{
+			MarkNewName(m_NameToBuffer, name);
 			m_NameToBuffer[name] = { bufferHandle };
 			return *this;
 		}
@@ -74,7 +102,9 @@ namespace graphics_backend
 		inline ShaderArgList& SetSampler(castl::string const& name
 			, TextureSamplerDescriptor const& samplerDesc)
 		{
-			m_NameToSamplers[name] = samplerDesc;
+			//Hashed once here, the backend looks samplers up by the precomputed key
+			MarkNewName(m_NameToSamplers, name);
+			m_NameToSamplers[name] = TextureSamplerDescriptorObj{ samplerDesc };
 			return *this;
 		}
 
@@ -82,6 +112,7 @@ namespace graphics_backend
 			, castl::shared_ptr<ShaderArgList> const& subArgList)
 		{
 			m_NameToSubArgLists[name] = subArgList;
+			++m_StructureVersion;
 			return *this;
 		}
 
@@ -129,7 +160,26 @@ namespace graphics_backend
 			return {};
 		}
 
-		TextureSamplerDescriptor FindSampler(castl::string const& name) const
+		//Entries stay at the same address until the structure version changes
+		castl::vector<castl::pair<ImageHandle, GPUTextureView>> const* FindImageHandleEntry(castl::string const& name) const
+		{
+			auto found = m_NameToImage.find(name);
+			return found != m_NameToImage.end() ? &found->second : nullptr;
+		}
+
+		castl::vector<BufferHandle> const* FindBufferHandleEntry(castl::string const& name) const
+		{
+			auto found = m_NameToBuffer.find(name);
+			return found != m_NameToBuffer.end() ? &found->second : nullptr;
+		}
+
+		TextureSamplerDescriptorObj const* FindSamplerEntry(castl::string const& name) const
+		{
+			auto found = m_NameToSamplers.find(name);
+			return found != m_NameToSamplers.end() ? &found->second : nullptr;
+		}
+
+		TextureSamplerDescriptorObj FindSampler(castl::string const& name) const
 		{
 			auto found = m_NameToSamplers.find(name);
 			if (found != m_NameToSamplers.end())
@@ -154,13 +204,30 @@ namespace graphics_backend
 			return m_NameToSubArgLists;
 		}
 	private:
+		static uint64_t NewID()
+		{
+			static castl::atomic<uint64_t> s_NextID{ 0 };
+			return s_NextID.fetch_add(1, castl::memory_order_relaxed);
+		}
+
+		template<typename MapType>
+		void MarkNewName(MapType const& map, castl::string const& name)
+		{
+			if (map.find(name) == map.end())
+			{
+				++m_StructureVersion;
+			}
+		}
+
 		castl::unordered_map<castl::string, castl::vector<uint8_t>> m_NameToNumericArrayList;
 		castl::unordered_map<castl::string, castl::vector<castl::pair<ImageHandle, GPUTextureView>>> m_NameToImage;
 		castl::unordered_map<castl::string, castl::vector<BufferHandle>> m_NameToBuffer;
 		castl::unordered_map<castl::string, castl::shared_ptr<ShaderArgList>> m_NameToSubArgLists;
-		castl::unordered_map<castl::string, TextureSamplerDescriptor> m_NameToSamplers;
+		castl::unordered_map<castl::string, TextureSamplerDescriptorObj> m_NameToSamplers;
 		castl::unordered_map<castl::string, NumericDataPos> m_NameToDataPosition;
 		castl::vector<uint8_t> m_NumericDataList;
+		uint64_t m_ID = 0;
+		uint64_t m_StructureVersion = 0;
 		//castl::unordered_set<BufferHandle> m_ExternalManagedBuffers;
 	};
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <CASTL/CAString.h>
+#include <CASTL/CAAtomic.h>
 #include <Hasher.h>
 #include <Compiler.h>
 
@@ -9,15 +10,57 @@ struct ShaderSourceInfo
 	uint64_t dataLength;
 	void const* dataPtr;
 	castl::string entryPoint;
-	auto operator<=>(const ShaderSourceInfo&) const = default;
+	//Content hash of the byte code written when cooking, identical byte code of different shader sets shares one shader module.
+	//0 when unknown, the data pointer identifies the byte code then
+	uint64_t dataHash = 0;
+	bool operator==(ShaderSourceInfo const& other) const
+	{
+		return compileShaderType == other.compileShaderType
+			&& dataLength == other.dataLength
+			&& dataHash == other.dataHash
+			&& (dataHash != 0 || dataPtr == other.dataPtr)
+			&& entryPoint == other.entryPoint;
+	}
+};
+
+template<>
+struct cacore::custom_hash_trait<ShaderSourceInfo>
+{
+	constexpr static void hash(ShaderSourceInfo const& obj, auto& hasher)
+	{
+		hasher.hash(obj.compileShaderType);
+		hasher.hash(obj.dataLength);
+		if (obj.dataHash != 0)
+		{
+			hasher.hash(obj.dataHash);
+		}
+		else
+		{
+			hasher.hash(obj.dataPtr);
+		}
+		hasher.hash(obj.entryPoint);
+	}
 };
 
 struct IShaderSet
 {
+	IShaderSet() : m_ShaderSetID(NewShaderSetID()) {}
+	//Copies get their own id, backends cache data addresses per shader set
+	IShaderSet(IShaderSet const&) : m_ShaderSetID(NewShaderSetID()) {}
+	IShaderSet& operator=(IShaderSet const&) { return *this; }
+	//Unique for every shader set and never reused, unlike its address
+	uint64_t GetShaderSetID() const { return m_ShaderSetID; }
 	virtual EShaderTypeFlags GetShaderTypeFlags(ShaderCompilerSlang::EShaderTargetType shaderTargetType) const = 0;
 	virtual ShaderSourceInfo GetShaderSourceInfo(ShaderCompilerSlang::EShaderTargetType shaderTargetType
 		, ECompileShaderType compileShaderType
 		, castl::string_view entryPoint = "") const = 0;
 	virtual ShaderCompilerSlang::ShaderReflectionData const& GetShaderReflectionData(ShaderCompilerSlang::EShaderTargetType shaderTargetType) const = 0;
 	virtual castl::string GetUniqueName() const = 0;
+private:
+	static uint64_t NewShaderSetID()
+	{
+		static castl::atomic<uint64_t> s_NextID{ 0 };
+		return s_NextID.fetch_add(1, castl::memory_order_relaxed);
+	}
+	uint64_t m_ShaderSetID;
 };
\ No newline at end of file
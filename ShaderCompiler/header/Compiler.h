@@ -237,6 +237,9 @@ namespace ShaderCompilerSlang
 		}
 
 		uint32_t m_BindingSpace;
+		//Space declares unbounded resource arrays, the backend binds its global bindless descriptor set to it.
+		//Such a space may only hold the arrays of that set, the backend rejects shaders whose space does not match
+		bool m_Bindless = false;
 
 		//UniformBuffer
 		castl::vector<UniformBufferData> m_UniformBuffers;
@@ -269,6 +272,30 @@ namespace ShaderCompilerSlang
 	public:
 		castl::vector<ShaderBindingSpaceData> m_BindingData;
 		castl::vector<ShaderVertexAttributeData> m_VertexAttributes;
+		//Uniforms declared as [[vk::push_constant]], group 0 is the push constant block
+		UniformBufferData m_PushConstants{};
+
+		int32_t InitPushConstantGroup(int32_t parentGroupID
+			, castl::string const& name, uint32_t memoryOffset, uint32_t memorySize, uint32_t memoryStride, uint32_t elementCount = 1)
+		{
+			if (memorySize == 0 || memoryStride == 0 || elementCount == 0)
+			{
+				return parentGroupID;
+			}
+			int32_t newGroupID = m_PushConstants.NewGroup();
+			m_PushConstants.GetGroup(newGroupID).Init(name, memoryOffset, memorySize, memoryStride, elementCount);
+			if (parentGroupID >= 0)
+			{
+				m_PushConstants.AddSubGroupToGroup(parentGroupID, newGroupID);
+			}
+			return newGroupID;
+		}
+
+		uint32_t GetPushConstantSize() const
+		{
+			return m_PushConstants.m_Groups.empty() ? 0 : m_PushConstants.m_Groups[0].m_MemoryOffset + m_PushConstants.m_Groups[0].m_MemorySize;
+		}
+
 		ShaderBindingSpaceData& EnsureBindingSpace(uint32_t bindingSpace)
 		{
 			if(m_BindingData.size() < bindingSpace + 1)
@@ -289,6 +316,8 @@ namespace ShaderCompilerSlang
 		ECompileShaderType shaderType;
 		castl::vector<uint8_t> data;
 		castl::string entryPointName;
+		//Content hash of data written when cooking, 0 when unknown
+		uint64_t dataHash = 0;
 	};
 
 	struct ShaderCompileTargetResult
@@ -310,6 +339,7 @@ namespace ShaderCompilerSlang
 		virtual void AddSourceFile(const char* path) = 0;
 		virtual int AddEntryPoint(const char* name, ECompileShaderType shader_type) = 0;
 		virtual void EnableDebugInfo() = 0;
+		virtual void EnableOptimization() = 0;
 		virtual void Compile() = 0;
 		virtual bool HasError() const = 0;
 		virtual void const* GetOutputData(int entryPointID, uint64_t& dataSize) const = 0;
@@ -322,6 +352,8 @@ namespace ShaderCompilerSlang
 		virtual IShaderCompiler* AquireShaderCompiler() = 0;
 		virtual void ReturnShaderCompiler(IShaderCompiler* compiler) = 0;
 		virtual void InitializePoolSize(uint32_t compiler_count) = 0;
+		//Compilers keep their sessions and loaded modules between compile tasks, drop them after sources changed
+		virtual void ResetSessionCache() = 0;
 
 		inline castl::shared_ptr<IShaderCompiler> AquireShaderCompilerShared()
 		{
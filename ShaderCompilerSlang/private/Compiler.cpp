@@ -11,6 +11,9 @@
 #include <CASTL/CASet.h>
 #include <CASTL/CAString.h>
 #include <CASTL/CAMutex.h>
+#include <CASTL/CAAtomic.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <Hasher.h>
 #include <DebugUtils.h>
 #include <LibraryExportCommon.h>
 
@@ -49,13 +52,15 @@ namespace ShaderCompilerSlang
 		{
 		}
 
-		void Init()
+		void Init(castl::atomic<uint64_t> const* pSessionGeneration)
 		{
+			m_pSessionGeneration = pSessionGeneration;
 			slang::createGlobalSession(m_Session.writeRef());
 		}
 
 		void Release()
 		{
+			m_CachedSessions.clear();
 			m_Session.setNull();
 		}
 
@@ -105,6 +110,12 @@ namespace ShaderCompilerSlang
 
 		virtual void EnableDebugInfo() override
 		{
+			m_DebugInfo = true;
+		}
+
+		virtual void EnableOptimization() override
+		{
+			m_Optimization = true;
 		}
 
 		virtual void Compile() override
@@ -138,6 +149,12 @@ namespace ShaderCompilerSlang
 		/// </summary>
 		Slang::ComPtr<ISession> m_CompileSession;
 
+		//Sessions of target, search path and macro sets compiled before.
+		//Modules imported by several sources are loaded once per session and linked into each program
+		castl::unordered_map<uint64_t, Slang::ComPtr<ISession>> m_CachedSessions;
+		castl::atomic<uint64_t> const* m_pSessionGeneration = nullptr;
+		uint64_t m_CachedSessionGeneration = 0;
+
 		SessionDesc m_CompileSessionDesc = {};
 		castl::vector<TargetDesc> m_TargetDescs;
 		castl::vector<castl::string> m_SearchPaths;
@@ -145,14 +162,23 @@ namespace ShaderCompilerSlang
 		castl::vector<castl::string> m_ModuleNames;
 		castl::vector<castl::string> m_ErrorList;
 		castl::vector<ShaderCompileTargetResult> m_CompileResults;
-		castl::vector<CompilerOptionEntry> m_CompilerOptionEntries = { 
-			CompilerOptionEntry{ CompilerOptionName::VulkanUseEntryPointName , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }} ,
-			//CompilerOptionEntry{ CompilerOptionName::EmitSpirvDirectly , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }} ,
-			CompilerOptionEntry{ CompilerOptionName::DebugInformation , CompilerOptionValue{ CompilerOptionValueKind::Int, SLANG_DEBUG_INFO_LEVEL_STANDARD  }} ,
-			CompilerOptionEntry{ CompilerOptionName::Optimization , CompilerOptionValue{ CompilerOptionValueKind::Int, SlangOptimizationLevel::SLANG_OPTIMIZATION_LEVEL_NONE }},
-			CompilerOptionEntry{ CompilerOptionName::MatrixLayoutRow , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }},
-			CompilerOptionEntry{ CompilerOptionName::MatrixLayoutColumn , CompilerOptionValue{ CompilerOptionValueKind::Int, 0 }},
-		};
+		bool m_DebugInfo = false;
+		bool m_Optimization = false;
+		castl::vector<CompilerOptionEntry> m_CompilerOptionEntries;
+
+		void BuildCompilerOptionEntries()
+		{
+			int debugInfoLevel = m_DebugInfo ? SLANG_DEBUG_INFO_LEVEL_STANDARD : SLANG_DEBUG_INFO_LEVEL_NONE;
+			int optimizationLevel = m_Optimization ? SlangOptimizationLevel::SLANG_OPTIMIZATION_LEVEL_HIGH : SlangOptimizationLevel::SLANG_OPTIMIZATION_LEVEL_NONE;
+			m_CompilerOptionEntries = {
+				CompilerOptionEntry{ CompilerOptionName::VulkanUseEntryPointName , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }} ,
+				//CompilerOptionEntry{ CompilerOptionName::EmitSpirvDirectly , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }} ,
+				CompilerOptionEntry{ CompilerOptionName::DebugInformation , CompilerOptionValue{ CompilerOptionValueKind::Int, debugInfoLevel }} ,
+				CompilerOptionEntry{ CompilerOptionName::Optimization , CompilerOptionValue{ CompilerOptionValueKind::Int, optimizationLevel }},
+				CompilerOptionEntry{ CompilerOptionName::MatrixLayoutRow , CompilerOptionValue{ CompilerOptionValueKind::Int, 1 }},
+				CompilerOptionEntry{ CompilerOptionName::MatrixLayoutColumn , CompilerOptionValue{ CompilerOptionValueKind::Int, 0 }},
+			};
+		}
 
 		void PushTarget(SlangCompileTarget targetType, const char* profileStr)
 		{
@@ -288,6 +314,8 @@ namespace ShaderCompilerSlang
 			//
 			int uniformGroupID = -1;
 			int resourceGroupID = -1;
+			//Uniforms under a push constant buffer go to the push constant block instead of a uniform buffer
+			bool pushConstant = false;
 
 			BindingData OffsetSpace(uint32_t spaceOffset) const
 			{
@@ -406,6 +434,10 @@ namespace ShaderCompilerSlang
 			}
 			//到这里时不应该有Mixed类型
 			BindingData newBinding = OffsetBindingDataBySingleCategory(bindingData, variable, variableCategory);
+			if (variableCategory == ParameterCategory::PushConstantBuffer)
+			{
+				newBinding.pushConstant = true;
+			}
 
 			ShaderBindingSpaceData& bindingSpace = reflectionData.EnsureBindingSpace(newBinding.bindingSpace);
 
@@ -414,7 +446,14 @@ namespace ShaderCompilerSlang
 			//如果是Array类型，重定向为Array元素类型
 			if (kind == slang::TypeReflection::Kind::Array)
 			{
-				elementCount = typeLayout->getElementCount();
+				size_t arrayLength = typeLayout->getElementCount();
+				//Unbounded arrays are indexed with bindless indices, their element count is left as zero
+				if (arrayLength == SLANG_UNBOUNDED_SIZE)
+				{
+					bindingSpace.m_Bindless = true;
+					arrayLength = 0;
+				}
+				elementCount = static_cast<uint32_t>(arrayLength);
 				typeLayout = typeLayout->getElementTypeLayout();
 				kind = typeLayout->getKind();
 			}
@@ -451,9 +490,17 @@ namespace ShaderCompilerSlang
 				{
 					uint32_t strideInBytes = typeLayout->getStride(SLANG_PARAMETER_CATEGORY_UNIFORM);
 					uint32_t sizeInBytes = typeLayout->getSize(SLANG_PARAMETER_CATEGORY_UNIFORM);
-					newBinding.uniformGroupID = bindingSpace.InitUniformGroup(newBinding.bindingIndex
-						, newBinding.uniformGroupID
-						, newBinding.elementName, newBinding.memoryByteOffset, sizeInBytes, strideInBytes, elementCount);
+					if (newBinding.pushConstant)
+					{
+						newBinding.uniformGroupID = reflectionData.InitPushConstantGroup(newBinding.uniformGroupID
+							, newBinding.elementName, newBinding.memoryByteOffset, sizeInBytes, strideInBytes, elementCount);
+					}
+					else
+					{
+						newBinding.uniformGroupID = bindingSpace.InitUniformGroup(newBinding.bindingIndex
+							, newBinding.uniformGroupID
+							, newBinding.elementName, newBinding.memoryByteOffset, sizeInBytes, strideInBytes, elementCount);
+					}
 					fprintf(stderr, "%s space: %d binding: %d arrayLength: %d category: %s\n", newBinding.path.c_str(), newBinding.bindingSpace, newBinding.bindingIndex, elementCount, GetCategoryName(variableCategory));
 				}
 				else
@@ -485,7 +532,14 @@ namespace ShaderCompilerSlang
 				uint32_t sizeInBytes = typeLayout->getSize(SLANG_PARAMETER_CATEGORY_UNIFORM);
 				UniformElement newElement = {};
 				newElement.Init(newBinding.elementName, newBinding.memoryByteOffset, sizeInBytes, strideInBytes, elementCount);
-				bindingSpace.AddElementToGroup(newBinding.bindingIndex, newBinding.uniformGroupID, newElement);
+				if (newBinding.pushConstant)
+				{
+					reflectionData.m_PushConstants.AddElementToGroup(newBinding.uniformGroupID, newElement);
+				}
+				else
+				{
+					bindingSpace.AddElementToGroup(newBinding.bindingIndex, newBinding.uniformGroupID, newElement);
+				}
 				fprintf(stderr, "%s space: %d binding: %d arrayLength: %d category: %s\n", newBinding.path.c_str(), newBinding.bindingSpace, newBinding.bindingIndex, elementCount, GetCategoryName(variableCategory));
 			}
 			else if (kind == slang::TypeReflection::Kind::Resource
@@ -587,12 +641,13 @@ namespace ShaderCompilerSlang
 			m_CompileSessionDesc.searchPaths = searchPaths.data();
 			m_CompileSessionDesc.preprocessorMacroCount = macroNames.size();
 			m_CompileSessionDesc.preprocessorMacros = macroNames.data();
+			BuildCompilerOptionEntries();
 			m_CompileSessionDesc.compilerOptionEntryCount = m_CompilerOptionEntries.size();
 			m_CompileSessionDesc.compilerOptionEntries = m_CompilerOptionEntries.data();
 
 			Slang::ComPtr<ISlangBlob> diagnostics;
 			//Initialize Session
-			m_Session->createSession(m_CompileSessionDesc, m_CompileSession.writeRef());
+			AcquireCompileSession();
 			std::vector<IComponentType*> components;
 			components.reserve(m_ModuleNames.size());
 			for (auto& module : m_ModuleNames)
@@ -782,6 +837,49 @@ namespace ShaderCompilerSlang
 			}
 		}
 
+		uint64_t ComputeSessionKey() const
+		{
+			cacore::fnv1a hasher{};
+			hasher(static_cast<uint64_t>(m_DebugInfo));
+			hasher(static_cast<uint64_t>(m_Optimization));
+			for (auto& targetDesc : m_TargetDescs)
+			{
+				hasher(static_cast<uint64_t>(targetDesc.format));
+				hasher(static_cast<uint64_t>(targetDesc.profile));
+			}
+			for (auto& searchPath : m_SearchPaths)
+			{
+				hasher(searchPath.data(), searchPath.size() + 1);
+			}
+			for (auto& pair : m_Macros)
+			{
+				if (pair.second.empty())
+					continue;
+				hasher(pair.first.data(), pair.first.size() + 1);
+				hasher(pair.second.data(), pair.second.size() + 1);
+			}
+			return static_cast<uint64_t>(hasher);
+		}
+
+		void AcquireCompileSession()
+		{
+			uint64_t generation = m_pSessionGeneration->load(castl::memory_order_acquire);
+			if (generation != m_CachedSessionGeneration)
+			{
+				m_CachedSessions.clear();
+				m_CachedSessionGeneration = generation;
+			}
+			uint64_t sessionKey = ComputeSessionKey();
+			auto found = m_CachedSessions.find(sessionKey);
+			if (found != m_CachedSessions.end())
+			{
+				m_CompileSession = found->second;
+				return;
+			}
+			m_Session->createSession(m_CompileSessionDesc, m_CompileSession.writeRef());
+			m_CachedSessions.insert(castl::make_pair(sessionKey, m_CompileSession));
+		}
+
 		void ClearCompileTask()
 		{
 			m_CompileSessionDesc = {};
@@ -792,6 +890,8 @@ namespace ShaderCompilerSlang
 			m_ModuleNames.clear();
 			m_ErrorList.clear();
 			m_CompileResults.clear();
+			m_DebugInfo = false;
+			m_Optimization = false;
 		}
 
 	};
@@ -839,12 +939,18 @@ namespace ShaderCompilerSlang
 				m_AvailableCompilers.resize(compiler_count);
 				for (uint32_t i = 0; i < compiler_count; ++i)
 				{
-					m_Compilers[i].Init();
+					m_Compilers[i].Init(&m_SessionGeneration);
 					m_AvailableCompilers[i] = &m_Compilers[i];
 				}
 			}
 		}
 
+		virtual void ResetSessionCache() override
+		{
+			m_SessionGeneration.fetch_add(1, castl::memory_order_release);
+		}
+
+		castl::atomic<uint64_t> m_SessionGeneration{ 0 };
 		castl::condition_variable m_ConditinalVariable;
 		castl::mutex m_Mutex;
 		castl::vector<IShaderCompiler*> m_AvailableCompilers;
@@ -15,9 +15,14 @@ namespace graphics_backend
 		void Release() override;
 		castl::shared_ptr<WindowHandle> GetWindowHandle(castl::shared_ptr<cawindow::IWindow> window) override;
 		bool AnyWindowRunning() override;
+		bool SupportsIndirectDrawCount() override;
+		GPUMemoryStatistics GetGPUMemoryStatistics() override;
 		virtual void ScheduleGPUFrame(TaskScheduler* scheduler, GPUFrame const& gpuFrame) override;
+		virtual void PrewarmPipelines(TaskScheduler* scheduler) override;
 		virtual castl::shared_ptr<GPUBuffer> CreateGPUBuffer(GPUBufferDescriptor const& descriptor) override;
 		virtual castl::shared_ptr<GPUTexture> CreateGPUTexture(GPUTextureDescriptor const& inDescriptor) override;
+		virtual void UploadBufferAsync(castl::shared_ptr<GPUBuffer> const& buffer, void const* pData, uint64_t size, uint64_t offset, castl::function<void()> onComplete) override;
+		virtual void UploadTextureAsync(castl::shared_ptr<GPUTexture> const& texture, void const* pData, uint64_t size, castl::function<void()> onComplete) override;
 	private:
 		CVulkanApplication m_Application;
 	};
@@ -18,6 +18,10 @@ namespace graphics_backend
 	{
 		m_Application.ScheduleGPUFrame(scheduler, gpuFrame);
 	}
+	void CRenderBackend_Vulkan::PrewarmPipelines(TaskScheduler* scheduler)
+	{
+		m_Application.GetGPUObjectManager().GetPersistentPipelineCache().Prewarm(scheduler);
+	}
 	castl::shared_ptr<GPUBuffer> CRenderBackend_Vulkan::CreateGPUBuffer(GPUBufferDescriptor const& descriptor)
 	{
 		return castl::shared_ptr<GPUBuffer>(m_Application.NewGPUBuffer(descriptor), [this](GPUBuffer* releaseBuffer)
@@ -39,6 +43,22 @@ namespace graphics_backend
 		return m_Application.AnyWindowRunning();
 	}
 
+	bool CRenderBackend_Vulkan::SupportsIndirectDrawCount()
+	{
+		return m_Application.SupportsIndirectDrawCount();
+	}
+
+	GPUMemoryStatistics CRenderBackend_Vulkan::GetGPUMemoryStatistics()
+	{
+		//Every allocator only sees its own blocks, the frame bound pools allocate from allocators of their own
+		GPUMemoryStatistics result = m_Application.GetGlobalMemoryManager().GetMemoryStatistics();
+		GPUMemoryStatistics frameBoundStatistics = m_Application.GetFrameContext().GetMemoryStatistics();
+		result.textureBytes += frameBoundStatistics.textureBytes;
+		result.bufferBytes += frameBoundStatistics.bufferBytes;
+		result.deviceLocalUsage += frameBoundStatistics.deviceLocalUsage;
+		return result;
+	}
+
 	castl::shared_ptr<GPUTexture> CRenderBackend_Vulkan::CreateGPUTexture(GPUTextureDescriptor const& inDescriptor)
 	{
 		return castl::shared_ptr<GPUTexture>(m_Application.NewGPUTexture(inDescriptor)
@@ -47,4 +67,14 @@ namespace graphics_backend
 				m_Application.ReleaseGPUTexture(releaseTex);
 			});
 	}
+
+	void CRenderBackend_Vulkan::UploadBufferAsync(castl::shared_ptr<GPUBuffer> const& buffer, void const* pData, uint64_t size, uint64_t offset, castl::function<void()> onComplete)
+	{
+		m_Application.GetAsyncUploadService().UploadBuffer(buffer, pData, size, offset, castl::move(onComplete));
+	}
+
+	void CRenderBackend_Vulkan::UploadTextureAsync(castl::shared_ptr<GPUTexture> const& texture, void const* pData, uint64_t size, castl::function<void()> onComplete)
+	{
+		m_Application.GetAsyncUploadService().UploadTexture(texture, pData, size, castl::move(onComplete));
+	}
 }
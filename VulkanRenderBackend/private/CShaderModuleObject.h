@@ -16,9 +16,12 @@ namespace graphics_backend
 		void Release();
 		vk::ShaderModule GetShaderModule() const { return m_ShaderModule; }
 		castl::string const& GetEntryPointName() const { return m_EntryPointName; }
+		//Hash of the byte code, entry point and stage, stable between runs
+		uint64_t GetSourceHash() const { return m_SourceHash; }
 	private:
 		vk::ShaderModule m_ShaderModule = nullptr;
 		castl::string m_EntryPointName;
+		uint64_t m_SourceHash = 0;
 	};
 
 	using ShaderModuleObjectDic = HashPool<ShaderSourceInfo, CShaderModuleObject>;
@@ -2,6 +2,7 @@
 #include <ShaderProvider.h>
 #include "CShaderModuleObject.h"
 #include "VulkanApplication.h"
+#include "GPUObjectManager.h"
 
 namespace graphics_backend
 {
@@ -19,6 +20,13 @@ namespace graphics_backend
 			, nullptr
 		};
 		m_ShaderModule = GetDevice().createShaderModule(shaderModuelCreateInfo);
+
+		cacore::fnv1a hasher{};
+		hasher(shaderSourceInfo.dataPtr, shaderSourceInfo.dataLength);
+		hasher(m_EntryPointName.data(), m_EntryPointName.size());
+		hasher(static_cast<uint64_t>(shaderSourceInfo.compileShaderType));
+		m_SourceHash = static_cast<uint64_t>(hasher);
+		GetGPUObjectManager().GetPersistentPipelineCache().RecordShader(m_SourceHash, shaderSourceInfo);
 	}
 	void CShaderModuleObject::Release()
 	{
@@ -0,0 +1,207 @@
+#include <pch.h>
+#include <VulkanApplication.h>
+#include <RenderBackendSettings.h>
+#include <VulkanDebug.h>
+#include "BindlessDescriptorHeap.h"
+#include "DescriptorSetCache.h"
+
+namespace graphics_backend
+{
+	bool BindlessDescriptorHeap::IsSupported(vk::PhysicalDeviceVulkan12Features const& features)
+	{
+		return features.descriptorIndexing
+			&& features.runtimeDescriptorArray
+			&& features.descriptorBindingPartiallyBound
+			&& features.descriptorBindingSampledImageUpdateAfterBind
+			&& features.descriptorBindingStorageBufferUpdateAfterBind
+			&& features.descriptorBindingUpdateUnusedWhilePending
+			&& features.shaderSampledImageArrayNonUniformIndexing
+			&& features.shaderStorageBufferArrayNonUniformIndexing;
+	}
+
+	void BindlessDescriptorHeap::EnableFeatures(vk::PhysicalDeviceVulkan12Features& inoutFeatures)
+	{
+		inoutFeatures.descriptorIndexing = VK_TRUE;
+		inoutFeatures.runtimeDescriptorArray = VK_TRUE;
+		inoutFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		inoutFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		inoutFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		inoutFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		inoutFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		inoutFeatures.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+	}
+
+	bool BindlessDescriptorHeap::IsCompatible(ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace)
+	{
+		castl::string spaceName = "Bindless binding space " + castl::to_string(bindingSpace.m_BindingSpace);
+		bool compatible = true;
+		if (!bindingSpace.m_UniformBuffers.empty())
+		{
+			CA_LOG_ERR(spaceName + " declares uniform buffers");
+			compatible = false;
+		}
+		if (!bindingSpace.m_Samplers.empty())
+		{
+			CA_LOG_ERR(spaceName + " declares samplers");
+			compatible = false;
+		}
+		for (auto& texture : bindingSpace.m_Textures)
+		{
+			if (texture.m_BindingIndex != BINDLESS_TEXTURE_BINDING || texture.m_Count != 0
+				|| (texture.m_Access != ShaderCompilerSlang::EShaderResourceAccess::eReadOnly && texture.m_Access != ShaderCompilerSlang::EShaderResourceAccess::eUnknown))
+			{
+				CA_LOG_ERR(spaceName + ": " + texture.m_Name + " is not a read only unbounded texture array at binding " + castl::to_string(BINDLESS_TEXTURE_BINDING));
+				compatible = false;
+			}
+		}
+		for (auto& buffer : bindingSpace.m_Buffers)
+		{
+			if (buffer.m_BindingIndex != BINDLESS_BUFFER_BINDING || buffer.m_Count != 0)
+			{
+				CA_LOG_ERR(spaceName + ": " + buffer.m_Name + " is not an unbounded buffer array at binding " + castl::to_string(BINDLESS_BUFFER_BINDING));
+				compatible = false;
+			}
+		}
+		return compatible;
+	}
+
+	BindlessDescriptorHeap::BindlessDescriptorHeap(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void BindlessDescriptorHeap::Initialize()
+	{
+		auto features = GetPhysicalDevice().getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+		if (!IsSupported(features.get<vk::PhysicalDeviceVulkan12Features>()))
+		{
+			return;
+		}
+		auto properties = GetPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+		auto& limits = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+		m_TextureCapacity = castl::min(BINDLESS_TEXTURE_CAPACITY
+			, castl::min(limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages));
+		m_BufferCapacity = castl::min(BINDLESS_BUFFER_CAPACITY
+			, castl::min(limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers));
+
+		m_SetDesc.descs = {
+			DescriptorDesc{ vk::DescriptorType::eSampledImage, BINDLESS_TEXTURE_BINDING, m_TextureCapacity },
+			DescriptorDesc{ vk::DescriptorType::eStorageBuffer, BINDLESS_BUFFER_BINDING, m_BufferCapacity },
+		};
+		m_SetDesc.updateAfterBind = true;
+		m_Layout = GetGPUObjectManager().GetDescriptorSetLayoutCache().GetOrCreate(m_SetDesc)->GetLayout();
+
+		castl::vector<vk::DescriptorPoolSize> poolSizes{
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, m_TextureCapacity },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, m_BufferCapacity },
+		};
+		vk::DescriptorPoolCreateInfo poolInfo{ vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes };
+		m_DescriptorPool = GetDevice().createDescriptorPool(poolInfo);
+		vk::DescriptorSetAllocateInfo allocInfo{ m_DescriptorPool, 1, &m_Layout };
+		m_DescriptorSet = GetDevice().allocateDescriptorSets(allocInfo).front();
+		SetVKObjectDebugName(GetDevice(), m_DescriptorSet, "Bindless Descriptor Set");
+	}
+
+	void BindlessDescriptorHeap::Release()
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		if (m_DescriptorPool != vk::DescriptorPool(nullptr))
+		{
+			GetDevice().destroyDescriptorPool(m_DescriptorPool);
+			m_DescriptorPool = nullptr;
+		}
+		m_DescriptorSet = nullptr;
+		m_Layout = nullptr;
+		m_ImageViewSlots.clear();
+		m_ImageToViews.clear();
+		m_BufferSlots.clear();
+		m_FreeTextureSlots.clear();
+		m_FreeBufferSlots.clear();
+		m_TextureSlotCount = 0;
+		m_BufferSlotCount = 0;
+	}
+
+	uint32_t BindlessDescriptorHeap::GetTextureIndex(vk::Image image, vk::ImageView imageView)
+	{
+		uint64_t viewKey = VulkanHandleToKey(imageView);
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		auto found = m_ImageViewSlots.find(viewKey);
+		if (found != m_ImageViewSlots.end())
+		{
+			return found->second;
+		}
+		uint32_t slot = AllocateSlot(m_FreeTextureSlots, m_TextureSlotCount, m_TextureCapacity);
+		if (slot == INVALID_INDEX)
+		{
+			CA_LOG_ERR("Bindless Texture Slots Exhausted");
+			return slot;
+		}
+		vk::DescriptorImageInfo imageInfo{ {}, imageView, vk::ImageLayout::eShaderReadOnlyOptimal };
+		GetDevice().updateDescriptorSets(vk::WriteDescriptorSet{ m_DescriptorSet, BINDLESS_TEXTURE_BINDING, slot, 1, vk::DescriptorType::eSampledImage, &imageInfo }, {});
+		m_ImageViewSlots.insert(castl::make_pair(viewKey, slot));
+		m_ImageToViews[VulkanHandleToKey(image)].push_back(viewKey);
+		return slot;
+	}
+
+	uint32_t BindlessDescriptorHeap::GetBufferIndex(vk::Buffer buffer)
+	{
+		uint64_t bufferKey = VulkanHandleToKey(buffer);
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		auto found = m_BufferSlots.find(bufferKey);
+		if (found != m_BufferSlots.end())
+		{
+			return found->second;
+		}
+		uint32_t slot = AllocateSlot(m_FreeBufferSlots, m_BufferSlotCount, m_BufferCapacity);
+		if (slot == INVALID_INDEX)
+		{
+			CA_LOG_ERR("Bindless Buffer Slots Exhausted");
+			return slot;
+		}
+		vk::DescriptorBufferInfo bufferInfo{ buffer, 0, VK_WHOLE_SIZE };
+		GetDevice().updateDescriptorSets(vk::WriteDescriptorSet{ m_DescriptorSet, BINDLESS_BUFFER_BINDING, slot, 1, vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfo }, {});
+		m_BufferSlots.insert(castl::make_pair(bufferKey, slot));
+		return slot;
+	}
+
+	void BindlessDescriptorHeap::ReleaseResources(castl::array_ref<vk::Image> images, castl::array_ref<vk::Buffer> buffers)
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		//Frames that could read the slots are finished, descriptors left in freed slots are never accessed because of partial binding
+		for (vk::Image image : images)
+		{
+			auto found = m_ImageToViews.find(VulkanHandleToKey(image));
+			if (found == m_ImageToViews.end())
+				continue;
+			for (uint64_t viewKey : found->second)
+			{
+				auto foundSlot = m_ImageViewSlots.find(viewKey);
+				m_FreeTextureSlots.push_back(foundSlot->second);
+				m_ImageViewSlots.erase(foundSlot);
+			}
+			m_ImageToViews.erase(found);
+		}
+		for (vk::Buffer buffer : buffers)
+		{
+			auto found = m_BufferSlots.find(VulkanHandleToKey(buffer));
+			if (found == m_BufferSlots.end())
+				continue;
+			m_FreeBufferSlots.push_back(found->second);
+			m_BufferSlots.erase(found);
+		}
+	}
+
+	uint32_t BindlessDescriptorHeap::AllocateSlot(castl::vector<uint32_t>& inoutFreeSlots, uint32_t& inoutSlotCount, uint32_t capacity)
+	{
+		if (!inoutFreeSlots.empty())
+		{
+			uint32_t slot = inoutFreeSlots.back();
+			inoutFreeSlots.pop_back();
+			return slot;
+		}
+		if (inoutSlotCount < capacity)
+		{
+			return inoutSlotCount++;
+		}
+		return INVALID_INDEX;
+	}
+}
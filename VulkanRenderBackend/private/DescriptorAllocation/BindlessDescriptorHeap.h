@@ -0,0 +1,63 @@
+#pragma once
+#include <VulkanIncludes.h>
+#include <VulkanApplicationSubobjectBase.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAArrayRef.h>
+#include <Compiler.h>
+#include "DescriptorLayoutPool.h"
+
+namespace graphics_backend
+{
+	//Global descriptor set of every external texture and buffer referenced by index.
+	//Shaders declare an unbounded Texture2D array at binding BINDLESS_TEXTURE_BINDING and an unbounded storage buffer array
+	//at binding BINDLESS_BUFFER_BINDING of their own binding space, that space is bound to this set instead of a per batch set.
+	//Resources are registered on first use, their slots are recycled once the release queue destroys them
+	class BindlessDescriptorHeap : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		static constexpr uint32_t BINDLESS_TEXTURE_BINDING = 0;
+		static constexpr uint32_t BINDLESS_BUFFER_BINDING = 1;
+		static constexpr uint32_t INVALID_INDEX = (castl::numeric_limits<uint32_t>::max)();
+
+		static bool IsSupported(vk::PhysicalDeviceVulkan12Features const& features);
+		static void EnableFeatures(vk::PhysicalDeviceVulkan12Features& inoutFeatures);
+		//The space may only declare the unbounded arrays of the heap, logs what does not match
+		static bool IsCompatible(ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace);
+
+		BindlessDescriptorHeap(CVulkanApplication& app);
+		//Does nothing when the device does not support descriptor indexing
+		void Initialize();
+		void Release();
+		bool Enabled() const { return m_DescriptorSet != vk::DescriptorSet(nullptr); }
+
+		DescriptorSetDesc const& GetDescriptorSetDesc() const { return m_SetDesc; }
+		vk::DescriptorSetLayout GetLayout() const { return m_Layout; }
+		vk::DescriptorSet GetDescriptorSet() const { return m_DescriptorSet; }
+
+		uint32_t GetTextureIndex(vk::Image image, vk::ImageView imageView);
+		uint32_t GetBufferIndex(vk::Buffer buffer);
+		//Called right before the resources are destroyed
+		void ReleaseResources(castl::array_ref<vk::Image> images, castl::array_ref<vk::Buffer> buffers);
+	private:
+		uint32_t AllocateSlot(castl::vector<uint32_t>& inoutFreeSlots, uint32_t& inoutSlotCount, uint32_t capacity);
+
+		DescriptorSetDesc m_SetDesc{};
+		vk::DescriptorSetLayout m_Layout = nullptr;
+		vk::DescriptorPool m_DescriptorPool = nullptr;
+		vk::DescriptorSet m_DescriptorSet = nullptr;
+
+		castl::mutex m_Mutex;
+		uint32_t m_TextureCapacity = 0;
+		uint32_t m_BufferCapacity = 0;
+		uint32_t m_TextureSlotCount = 0;
+		uint32_t m_BufferSlotCount = 0;
+		castl::vector<uint32_t> m_FreeTextureSlots;
+		castl::vector<uint32_t> m_FreeBufferSlots;
+		//Image views are registered individually, released with their image
+		castl::unordered_map<uint64_t, uint32_t> m_ImageViewSlots;
+		castl::unordered_map<uint64_t, castl::vector<uint64_t>> m_ImageToViews;
+		castl::unordered_map<uint64_t, uint32_t> m_BufferSlots;
+	};
+}
@@ -22,6 +22,17 @@ namespace graphics_backend
 			binding.stageFlags = vk::ShaderStageFlagBits::eAll;
 		}
 		vk::DescriptorSetLayoutCreateInfo layoutCreateInfo{ {}, bindings };
+		castl::vector<vk::DescriptorBindingFlags> bindingFlags;
+		vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{};
+		if (desc.updateAfterBind)
+		{
+			bindingFlags.resize(bindings.size(), vk::DescriptorBindingFlagBits::ePartiallyBound
+				| vk::DescriptorBindingFlagBits::eUpdateAfterBind
+				| vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending);
+			bindingFlagsCreateInfo.setBindingFlags(bindingFlags);
+			layoutCreateInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+			layoutCreateInfo.setPNext(&bindingFlagsCreateInfo);
+		}
 		m_Layout = GetDevice().createDescriptorSetLayout(layoutCreateInfo);
 		//p_SetPool = GetGPUObjectManager().m_DescriptorSetPoolDic.GetOrCreate(desc.GetPoolDesc()).get();
 	}
@@ -114,6 +125,7 @@ namespace graphics_backend
 		castl::vector<vk::DescriptorPoolSize> poolSizes{};
 		poolSizes.reserve(3);
 		EmplaceDescriptorPoolSize(poolSizes, vk::DescriptorType::eUniformBuffer, m_PoolDesc.UBONum, m_ChunkSize);
+		EmplaceDescriptorPoolSize(poolSizes, vk::DescriptorType::eUniformBufferDynamic, m_PoolDesc.DynamicUBONum, m_ChunkSize);
 		EmplaceDescriptorPoolSize(poolSizes, vk::DescriptorType::eStorageBuffer, m_PoolDesc.SSBONum, m_ChunkSize);
 		EmplaceDescriptorPoolSize(poolSizes, vk::DescriptorType::eSampler, m_PoolDesc.SamplerNum, m_ChunkSize);
 		EmplaceDescriptorPoolSize(poolSizes, vk::DescriptorType::eSampledImage, m_PoolDesc.TexNum, m_ChunkSize);
@@ -9,6 +9,7 @@ namespace graphics_backend
 	struct DescriptorPoolDesc
 	{
 		uint32_t UBONum;
+		uint32_t DynamicUBONum;
 		uint32_t SSBONum;
 		uint32_t TexNum;
 		uint32_t SamplerNum;
@@ -26,6 +27,8 @@ namespace graphics_backend
 	struct DescriptorSetDesc
 	{
 		castl::vector<DescriptorDesc> descs;
+		//Bindings are partially bound and can be updated after the set is bound
+		bool updateAfterBind = false;
 		auto operator<=>(const DescriptorSetDesc&) const = default;
 
 		DescriptorPoolDesc GetPoolDesc() const
@@ -38,6 +41,9 @@ namespace graphics_backend
 				case vk::DescriptorType::eUniformBuffer:
 					result.UBONum++;
 					break;
+				case vk::DescriptorType::eUniformBufferDynamic:
+					result.DynamicUBONum++;
+					break;
 				case vk::DescriptorType::eStorageBuffer:
 					result.SSBONum++;
 					break;
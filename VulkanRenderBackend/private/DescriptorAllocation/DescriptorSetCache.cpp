@@ -0,0 +1,154 @@
+#include <pch.h>
+#include <VulkanApplication.h>
+#include <RenderBackendSettings.h>
+#include <CASTL/CAAlgorithm.h>
+#include "DescriptorSetCache.h"
+
+namespace graphics_backend
+{
+	static_assert(DESCRIPTOR_SET_CACHE_RETIRE_FRAME_COUNT >= FRAMEBOUND_RESOURCE_POOL_COUNT
+		, "Cached descriptor sets must not be retired while frames using them are in flight");
+
+	DescriptorSetCache::DescriptorSetCache(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void DescriptorSetCache::Release()
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		m_CachedSets.clear();
+		for (auto& poolPair : m_Pools)
+		{
+			for (auto& pool : poolPair.second)
+			{
+				GetDevice().destroyDescriptorPool(pool.pool);
+			}
+		}
+		m_Pools.clear();
+	}
+
+	vk::DescriptorSet DescriptorSetCache::GetOrCreate(DescriptorSetCacheKey const& key
+		, vk::DescriptorSetLayout layout
+		, DescriptorPoolDesc const& poolDesc
+		, castl::vector<vk::WriteDescriptorSet>& descriptorWrites
+		, castl::array_ref<vk::Image> referencedImages
+		, castl::array_ref<vk::Buffer> referencedBuffers)
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		auto found = m_CachedSets.find(key);
+		if (found != m_CachedSets.end())
+		{
+			found->second.lastUsedFrame = m_CurrentFrame;
+			return found->second.set;
+		}
+
+		CachedSet newSet{};
+		newSet.set = AllocateSet(layout, poolDesc, newSet.poolIndex);
+		newSet.poolDesc = poolDesc;
+		newSet.lastUsedFrame = m_CurrentFrame;
+		newSet.images.assign(referencedImages.begin(), referencedImages.end());
+		newSet.buffers.assign(referencedBuffers.begin(), referencedBuffers.end());
+		if (!descriptorWrites.empty())
+		{
+			for (auto& write : descriptorWrites)
+			{
+				write.setDstSet(newSet.set);
+			}
+			GetDevice().updateDescriptorSets(descriptorWrites, {});
+		}
+		vk::DescriptorSet result = newSet.set;
+		m_CachedSets.insert(castl::make_pair(key, castl::move(newSet)));
+		return result;
+	}
+
+	void DescriptorSetCache::NextFrame()
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		++m_CurrentFrame;
+		for (auto itr = m_CachedSets.begin(); itr != m_CachedSets.end();)
+		{
+			if (m_CurrentFrame - itr->second.lastUsedFrame > DESCRIPTOR_SET_CACHE_RETIRE_FRAME_COUNT)
+			{
+				FreeSet(itr->second);
+				itr = m_CachedSets.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+
+	void DescriptorSetCache::ReleaseSetsReferencing(castl::array_ref<vk::Image> images, castl::array_ref<vk::Buffer> buffers)
+	{
+		if (images.empty() && buffers.empty())
+			return;
+		castl::unordered_set<uint64_t> releasingImages;
+		castl::unordered_set<uint64_t> releasingBuffers;
+		for (vk::Image image : images)
+		{
+			releasingImages.insert(VulkanHandleToKey(image));
+		}
+		for (vk::Buffer buffer : buffers)
+		{
+			releasingBuffers.insert(VulkanHandleToKey(buffer));
+		}
+
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		for (auto itr = m_CachedSets.begin(); itr != m_CachedSets.end();)
+		{
+			auto& cachedSet = itr->second;
+			bool referencing = castl::any_of(cachedSet.images.begin(), cachedSet.images.end()
+				, [&](vk::Image image) { return releasingImages.find(VulkanHandleToKey(image)) != releasingImages.end(); })
+				|| castl::any_of(cachedSet.buffers.begin(), cachedSet.buffers.end()
+				, [&](vk::Buffer buffer) { return releasingBuffers.find(VulkanHandleToKey(buffer)) != releasingBuffers.end(); });
+			if (referencing)
+			{
+				FreeSet(cachedSet);
+				itr = m_CachedSets.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+
+	vk::DescriptorSet DescriptorSetCache::AllocateSet(vk::DescriptorSetLayout layout, DescriptorPoolDesc const& poolDesc, uint32_t& outPoolIndex)
+	{
+		auto& pools = m_Pools[poolDesc];
+		auto foundPool = castl::find_if(pools.begin(), pools.end(), [](CachedSetPool const& pool) { return pool.freeSetCount > 0; });
+		if (foundPool == pools.end())
+		{
+			//Every set of a pool has the same pool desc, so a pool with free sets always has enough descriptors
+			castl::vector<vk::DescriptorPoolSize> poolSizes{};
+			auto addPoolSize = [&poolSizes](vk::DescriptorType descType, uint32_t descNum)
+				{
+					if (descNum > 0)
+					{
+						poolSizes.emplace_back(descType, descNum * DESCRIPTOR_SET_CACHE_SETS_PER_POOL);
+					}
+				};
+			addPoolSize(vk::DescriptorType::eUniformBuffer, poolDesc.UBONum);
+			addPoolSize(vk::DescriptorType::eUniformBufferDynamic, poolDesc.DynamicUBONum);
+			addPoolSize(vk::DescriptorType::eStorageBuffer, poolDesc.SSBONum);
+			addPoolSize(vk::DescriptorType::eSampler, poolDesc.SamplerNum);
+			addPoolSize(vk::DescriptorType::eSampledImage, poolDesc.TexNum);
+
+			vk::DescriptorPoolCreateInfo poolInfo{ vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, DESCRIPTOR_SET_CACHE_SETS_PER_POOL, poolSizes };
+			pools.push_back(CachedSetPool{ GetDevice().createDescriptorPool(poolInfo), DESCRIPTOR_SET_CACHE_SETS_PER_POOL });
+			foundPool = pools.end() - 1;
+		}
+		outPoolIndex = static_cast<uint32_t>(foundPool - pools.begin());
+		--foundPool->freeSetCount;
+		vk::DescriptorSetAllocateInfo allocInfo{ foundPool->pool, 1, &layout };
+		return GetDevice().allocateDescriptorSets(allocInfo).front();
+	}
+
+	void DescriptorSetCache::FreeSet(CachedSet const& cachedSet)
+	{
+		auto& pool = m_Pools[cachedSet.poolDesc][cachedSet.poolIndex];
+		GetDevice().freeDescriptorSets(pool.pool, cachedSet.set);
+		++pool.freeSetCount;
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <VulkanIncludes.h>
+#include <VulkanApplicationSubobjectBase.h>
+#include <Hasher.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAMap.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAUnorderedSet.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAArrayRef.h>
+#include "DescriptorLayoutPool.h"
+
+namespace graphics_backend
+{
+	template<typename HandleType>
+	uint64_t VulkanHandleToKey(HandleType handle)
+	{
+		return (uint64_t)static_cast<typename HandleType::CType>(handle);
+	}
+
+	//Identity of one written descriptor
+	struct DescriptorWriteKey
+	{
+		uint64_t resource = 0;
+		uint32_t binding = 0;
+		uint32_t arrayElement = 0;
+		vk::DescriptorType descType = vk::DescriptorType::eSampler;
+		vk::ImageLayout imageLayout = vk::ImageLayout::eUndefined;
+		//Bound range of dynamic uniform buffers, their offsets are given when the set is bound
+		uint64_t range = 0;
+		bool operator==(DescriptorWriteKey const&) const = default;
+	};
+
+	struct DescriptorSetCacheKey
+	{
+		uint64_t layout = 0;
+		castl::vector<DescriptorWriteKey> writes;
+		bool operator==(DescriptorSetCacheKey const&) const = default;
+	};
+
+	//Descriptor sets keyed by layout and bound resource handles, shared by every frame that binds the same resources.
+	//Only sets referencing persistent resources (external textures and buffers, samplers) can be cached,
+	//sets of released resources are freed when the resources are destroyed,
+	//sets unused for DESCRIPTOR_SET_CACHE_RETIRE_FRAME_COUNT frames are freed once the frames that used them are fenced
+	class DescriptorSetCache : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		DescriptorSetCache(CVulkanApplication& app);
+		void Release();
+
+		//Returns the cached set, a missing set is allocated and written with the descriptor writes under the cache lock
+		vk::DescriptorSet GetOrCreate(DescriptorSetCacheKey const& key
+			, vk::DescriptorSetLayout layout
+			, DescriptorPoolDesc const& poolDesc
+			, castl::vector<vk::WriteDescriptorSet>& descriptorWrites
+			, castl::array_ref<vk::Image> referencedImages
+			, castl::array_ref<vk::Buffer> referencedBuffers);
+
+		//Called after the fence of the reused frame pool is signaled
+		void NextFrame();
+		//Called right before the resources are destroyed
+		void ReleaseSetsReferencing(castl::array_ref<vk::Image> images, castl::array_ref<vk::Buffer> buffers);
+	private:
+		struct CachedSetPool
+		{
+			vk::DescriptorPool pool = nullptr;
+			uint32_t freeSetCount = 0;
+		};
+
+		struct CachedSet
+		{
+			vk::DescriptorSet set = nullptr;
+			DescriptorPoolDesc poolDesc{};
+			uint32_t poolIndex = 0;
+			uint64_t lastUsedFrame = 0;
+			castl::vector<vk::Image> images;
+			castl::vector<vk::Buffer> buffers;
+		};
+
+		vk::DescriptorSet AllocateSet(vk::DescriptorSetLayout layout, DescriptorPoolDesc const& poolDesc, uint32_t& outPoolIndex);
+		void FreeSet(CachedSet const& cachedSet);
+
+		castl::mutex m_Mutex;
+		uint64_t m_CurrentFrame = 0;
+		castl::unordered_map<DescriptorSetCacheKey, CachedSet> m_CachedSets;
+		castl::map<DescriptorPoolDesc, castl::vector<CachedSetPool>> m_Pools;
+	};
+}
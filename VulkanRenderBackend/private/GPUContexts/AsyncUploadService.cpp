@@ -0,0 +1,361 @@
+#include "AsyncUploadService.h"
+#include <CATimer/Timer.h>
+#include <VulkanApplication.h>
+#include <VulkanBarrierCollector.h>
+#include <VulkanDebug.h>
+#include <InterfaceTranslator.h>
+#include <RenderBackendSettings.h>
+#include <GPUResources/VKGPUBuffer.h>
+#include <GPUResources/VKGPUTexture.h>
+
+namespace graphics_backend
+{
+	namespace
+	{
+		constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	AsyncUploadService::AsyncUploadService(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void AsyncUploadService::Initialize()
+	{
+		auto& queueContext = GetQueueContext();
+		int transferFamily = queueContext.GetTransferQueueFamily();
+		m_QueueFamily = static_cast<uint32_t>(transferFamily >= 0 ? transferFamily : queueContext.GetGraphicsQueueFamily());
+
+		vk::SemaphoreTypeCreateInfo semaphoreTypeInfo(vk::SemaphoreType::eTimeline, 0);
+		vk::SemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.pNext = &semaphoreTypeInfo;
+		m_TimelineSemaphore = GetDevice().createSemaphore(semaphoreInfo);
+		SetVKObjectDebugName(GetDevice(), m_TimelineSemaphore, "Async Upload Timeline");
+		m_LastSubmittedValue = 0;
+
+		m_ImageTransferGranularity = GetPhysicalDevice().getQueueFamilyProperties()[m_QueueFamily].minImageTransferGranularity;
+		m_CommandPool = GetDevice().createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_QueueFamily));
+
+		auto limits = GetPhysicalDevice().getProperties().limits;
+		m_MinAlignment = castl::max(uint64_t(16), static_cast<uint64_t>(limits.optimalBufferCopyOffsetAlignment));
+		m_StagingCapacity = ASYNC_UPLOAD_STAGING_BUDGET;
+		m_StagingBuffer = GetDevice().createBuffer(vk::BufferCreateInfo({}, m_StagingCapacity, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive));
+		SetVKObjectDebugName(GetDevice(), m_StagingBuffer, "Async Upload Staging Buffer");
+		m_StagingAllocation = GetGlobalMemoryManager().AllocatePersistentMemory(m_StagingBuffer
+			, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+		GetGlobalMemoryManager().BindMemory(m_StagingBuffer, m_StagingAllocation);
+		m_pStagingMemory = static_cast<uint8_t*>(GetGlobalMemoryManager().MapMemory(m_StagingAllocation));
+		m_StagingHead = 0;
+		m_StagingUsed = 0;
+	}
+
+	void AsyncUploadService::Release()
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		if (m_TimelineSemaphore != vk::Semaphore{ nullptr })
+		{
+			VKResultCheck(GetDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_TimelineSemaphore, m_LastSubmittedValue)
+				, castl::numeric_limits<uint64_t>::max()), "Async Upload Timeline Wait Failed!");
+			GetDevice().destroySemaphore(m_TimelineSemaphore);
+			m_TimelineSemaphore = nullptr;
+		}
+		m_PendingRequests.clear();
+		m_InFlightBatches.clear();
+		m_FreeCommandBuffers.clear();
+		if (m_CommandPool != vk::CommandPool{ nullptr })
+		{
+			GetDevice().destroyCommandPool(m_CommandPool);
+			m_CommandPool = nullptr;
+		}
+		if (m_StagingBuffer != vk::Buffer{ nullptr })
+		{
+			GetGlobalMemoryManager().UnmapMemory(m_StagingAllocation);
+			GetGlobalMemoryManager().FreePersistentMemory(m_StagingAllocation);
+			GetDevice().destroyBuffer(m_StagingBuffer);
+			m_StagingBuffer = nullptr;
+			m_StagingAllocation = nullptr;
+			m_pStagingMemory = nullptr;
+		}
+	}
+
+	void AsyncUploadService::UploadBuffer(castl::shared_ptr<GPUBuffer> const& buffer, void const* pData, uint64_t size, uint64_t offset, castl::function<void()> onComplete)
+	{
+		UploadRequest request{};
+		request.buffer = buffer;
+		request.pData = static_cast<uint8_t const*>(pData);
+		request.size = size;
+		request.dstOffset = offset;
+		request.onComplete = castl::move(onComplete);
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		m_PendingRequests.push_back(castl::move(request));
+	}
+
+	void AsyncUploadService::UploadTexture(castl::shared_ptr<GPUTexture> const& texture, void const* pData, uint64_t size, castl::function<void()> onComplete)
+	{
+		UploadRequest request{};
+		request.texture = texture;
+		request.pData = static_cast<uint8_t const*>(pData);
+		request.size = size;
+		request.onComplete = castl::move(onComplete);
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		m_PendingRequests.push_back(castl::move(request));
+	}
+
+	void AsyncUploadService::Tick(TaskScheduler* scheduler)
+	{
+		CPUTIMER_SCOPE("Tick Async Uploads");
+		RetireFinishedBatches(scheduler);
+		SubmitPendingRequests();
+	}
+
+	uint64_t AsyncUploadService::GetInFlightBytes() const
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		return m_StagingUsed;
+	}
+
+	bool AsyncUploadService::AllocateStaging(uint64_t size, uint64_t& outOffset, uint64_t& inoutBatchBytes)
+	{
+		//Staging memory is handed out in submission order and retired in the same order,
+		//so the free range is always the one starting at the head, wrapping around the end of the buffer
+		uint64_t offset = AlignUp(m_StagingHead, m_MinAlignment);
+		uint64_t padding = offset - m_StagingHead;
+		if (offset + size > m_StagingCapacity)
+		{
+			padding = m_StagingCapacity - m_StagingHead;
+			offset = 0;
+		}
+		if (m_StagingUsed + padding + size > m_StagingCapacity)
+		{
+			return false;
+		}
+		m_StagingUsed += padding + size;
+		m_StagingHead = offset + size;
+		inoutBatchBytes += padding + size;
+		outOffset = offset;
+		return true;
+	}
+
+	bool AsyncUploadService::RecordNextChunk(vk::CommandBuffer commandBuffer, UploadRequest& request, uint64_t& inoutBatchBytes)
+	{
+		if (request.uploadedSize >= request.size)
+		{
+			return true;
+		}
+		if (request.buffer != nullptr)
+		{
+			auto vkBuffer = castl::static_shared_pointer_cast<VKGPUBuffer>(request.buffer);
+			uint64_t chunkSize = castl::min(request.size - request.uploadedSize, ASYNC_UPLOAD_CHUNK_SIZE);
+			uint64_t stagingOffset = 0;
+			if (!AllocateStaging(chunkSize, stagingOffset, inoutBatchBytes))
+			{
+				return false;
+			}
+			memcpy(m_pStagingMemory + stagingOffset, request.pData + request.uploadedSize, chunkSize);
+			commandBuffer.copyBuffer(m_StagingBuffer, vkBuffer->GetBuffer().buffer
+				, vk::BufferCopy(stagingOffset, request.dstOffset + request.uploadedSize, chunkSize));
+			request.uploadedSize += chunkSize;
+			return true;
+		}
+
+		auto vkTexture = castl::static_shared_pointer_cast<VKGPUTexture>(request.texture);
+		auto& desc = vkTexture->GetDescriptor();
+		vk::Image image = vkTexture->GetImage().image;
+		bool is3D = desc.textureType == ETextureType::e3D;
+
+		bool rowGranularity = m_ImageTransferGranularity == vk::Extent3D{ 1, 1, 1 };
+
+		//Data holds the mip chain largest first, mips are padded to the staging alignment so every copy starts aligned
+		uint32_t mipCount = 0;
+		uint64_t dataSize = 0;
+		uint64_t stagingSize = 0;
+		for (; mipCount < desc.mipLevels && dataSize < request.size; ++mipCount)
+		{
+			dataSize += desc.GetMipDataSize(mipCount);
+			stagingSize = AlignUp(stagingSize, m_MinAlignment) + desc.GetMipDataSize(mipCount);
+		}
+		CA_ASSERT(dataSize == request.size, "Texture Upload Size Does Not Match Texture Mips");
+		if (!rowGranularity)
+		{
+			//Coarse transfer granularity, the whole texture goes in one copy per mip
+			if (stagingSize > m_StagingCapacity)
+			{
+				//Would not fit even into the drained ring
+				CA_LOG_ERR("Texture Too Large For Async Upload On This Queue Family");
+				request.failed = true;
+				request.uploadedSize = request.size;
+				return true;
+			}
+			uint64_t stagingOffset = 0;
+			if (!AllocateStaging(stagingSize, stagingOffset, inoutBatchBytes))
+			{
+				return false;
+			}
+			RecordTransferDestBarrier(commandBuffer, *vkTexture);
+			uint64_t dataOffset = 0;
+			for (uint32_t mipID = 0; mipID < mipCount; ++mipID)
+			{
+				uint64_t mipSize = desc.GetMipDataSize(mipID);
+				memcpy(m_pStagingMemory + stagingOffset, request.pData + dataOffset, mipSize);
+				vk::BufferImageCopy region = GPUTextureDescriptorToBufferImageCopy(desc, mipID);
+				region.bufferOffset = stagingOffset;
+				commandBuffer.copyBufferToImage(m_StagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, region);
+				stagingOffset = AlignUp(stagingOffset + mipSize, m_MinAlignment);
+				dataOffset += mipSize;
+			}
+			request.uploadedSize = request.size;
+			return true;
+		}
+
+		//Copy whole block rows of a single slice of a single mip per region, every region gets its own aligned staging range
+		uint32_t mip = 0;
+		uint64_t mipOffset = 0;
+		while (mip + 1 < mipCount && request.uploadedSize >= mipOffset + desc.GetMipDataSize(mip))
+		{
+			mipOffset += desc.GetMipDataSize(mip);
+			++mip;
+		}
+		uint32_t blockExtent = GetFormatBlockExtent(desc.format);
+		uint32_t mipWidth = desc.GetMipWidth(mip);
+		uint32_t mipHeight = desc.GetMipHeight(mip);
+		uint32_t blockRowsPerSlice = (mipHeight + blockExtent - 1) / blockExtent;
+		uint64_t rowSize = static_cast<uint64_t>((mipWidth + blockExtent - 1) / blockExtent) * GetFormatBlockBytes(desc.format);
+		uint64_t rowsPerChunk = castl::max(uint64_t(1), ASYNC_UPLOAD_CHUNK_SIZE / rowSize);
+		uint64_t startRow = (request.uploadedSize - mipOffset) / rowSize;
+		uint32_t slice = static_cast<uint32_t>(startRow / blockRowsPerSlice);
+		uint32_t row = static_cast<uint32_t>(startRow % blockRowsPerSlice);
+		uint32_t rows = static_cast<uint32_t>(castl::min(rowsPerChunk, static_cast<uint64_t>(blockRowsPerSlice - row)));
+		uint64_t regionSize = rows * rowSize;
+		uint64_t stagingOffset = 0;
+		if (!AllocateStaging(regionSize, stagingOffset, inoutBatchBytes))
+		{
+			return false;
+		}
+		if (request.uploadedSize == 0)
+		{
+			RecordTransferDestBarrier(commandBuffer, *vkTexture);
+		}
+		memcpy(m_pStagingMemory + stagingOffset, request.pData + request.uploadedSize, regionSize);
+		vk::BufferImageCopy region = GPUTextureDescriptorToBufferImageCopy(desc, mip);
+		region.bufferOffset = stagingOffset;
+		region.imageSubresource.baseArrayLayer = is3D ? 0 : slice;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = vk::Offset3D{ 0, static_cast<int32_t>(row * blockExtent), is3D ? static_cast<int32_t>(slice) : 0 };
+		//The last block row of a block compressed mip may reach past its edge
+		region.imageExtent = vk::Extent3D{ mipWidth, castl::min(rows * blockExtent, mipHeight - row * blockExtent), 1 };
+		commandBuffer.copyBufferToImage(m_StagingBuffer, image, vk::ImageLayout::eTransferDstOptimal, region);
+		request.uploadedSize += regionSize;
+		return true;
+	}
+
+	void AsyncUploadService::RecordTransferDestBarrier(vk::CommandBuffer commandBuffer, VKGPUTexture const& texture)
+	{
+		//Recorded with the first copy, a chunk that did not fit the ring records nothing and is retried by the next batch
+		VulkanBarrierCollector barrierCollector{ GetQueueContext().QueueFamilyIndexToPipelineStageMask(m_QueueFamily), m_QueueFamily };
+		barrierCollector.PushImageBarrier(texture.GetImage().image, texture.GetDescriptor().format, ResourceUsage::eDontCare, ResourceUsage::eTransferDest);
+		barrierCollector.ExecuteBarrier(commandBuffer);
+	}
+
+	void AsyncUploadService::RetireFinishedBatches(TaskScheduler* scheduler)
+	{
+		castl::vector<castl::function<void()>> callbacks;
+		uint64_t finishedValue = GetDevice().getSemaphoreCounterValue(m_TimelineSemaphore);
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			while (!m_InFlightBatches.empty() && m_InFlightBatches.front().timelineValue <= finishedValue)
+			{
+				auto& batch = m_InFlightBatches.front();
+				m_StagingUsed -= batch.stagingBytes;
+				batch.commandBuffer.reset();
+				m_FreeCommandBuffers.push_back(batch.commandBuffer);
+				for (auto& request : batch.finishedRequests)
+				{
+					//Graphs pick up the transfer queue ownership and release it to their own queues
+					if (request.failed)
+					{
+						//Nothing to hand over, the callback still runs so the caller can free its data
+					}
+					else if (request.buffer != nullptr)
+					{
+						auto vkBuffer = castl::static_shared_pointer_cast<VKGPUBuffer>(request.buffer);
+						vkBuffer->SetUsage(ResourceUsage::eTransferDest);
+						vkBuffer->SetQueueFamily(m_QueueFamily);
+					}
+					else if (request.texture != nullptr)
+					{
+						auto vkTexture = castl::static_shared_pointer_cast<VKGPUTexture>(request.texture);
+						vkTexture->SetUsage(ResourceUsage::eTransferDest);
+						vkTexture->SetQueueFamily(m_QueueFamily);
+					}
+					if (request.onComplete)
+					{
+						callbacks.push_back(castl::move(request.onComplete));
+					}
+				}
+				m_InFlightBatches.pop_front();
+			}
+			if (m_StagingUsed == 0)
+			{
+				m_StagingHead = 0;
+			}
+		}
+		for (auto& callback : callbacks)
+		{
+			scheduler->NewTask()
+				->Name("Async Upload Completed")
+				->Functor(castl::move(callback));
+		}
+	}
+
+	void AsyncUploadService::SubmitPendingRequests()
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		if (m_PendingRequests.empty())
+		{
+			return;
+		}
+		UploadBatch batch{};
+		batch.commandBuffer = AllocCommandBuffer();
+		batch.commandBuffer.begin(vk::CommandBufferBeginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+		bool anyRecorded = false;
+		while (!m_PendingRequests.empty())
+		{
+			auto& request = m_PendingRequests.front();
+			if (!RecordNextChunk(batch.commandBuffer, request, batch.stagingBytes))
+			{
+				break;
+			}
+			anyRecorded = true;
+			if (request.uploadedSize >= request.size)
+			{
+				batch.finishedRequests.push_back(castl::move(request));
+				m_PendingRequests.pop_front();
+			}
+		}
+		batch.commandBuffer.end();
+		if (!anyRecorded)
+		{
+			batch.commandBuffer.reset();
+			m_FreeCommandBuffers.push_back(batch.commandBuffer);
+			return;
+		}
+		batch.timelineValue = ++m_LastSubmittedValue;
+		GetQueueContext().SubmitCommandsSignalTimeline(m_QueueFamily, 0, batch.commandBuffer, m_TimelineSemaphore, batch.timelineValue);
+		m_InFlightBatches.push_back(castl::move(batch));
+	}
+
+	vk::CommandBuffer AsyncUploadService::AllocCommandBuffer()
+	{
+		if (!m_FreeCommandBuffers.empty())
+		{
+			vk::CommandBuffer result = m_FreeCommandBuffers.back();
+			m_FreeCommandBuffers.pop_back();
+			return result;
+		}
+		vk::CommandBuffer result = GetDevice().allocateCommandBuffers(vk::CommandBufferAllocateInfo(m_CommandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+		SetVKObjectDebugName(GetDevice(), result, "Async Upload Command");
+		return result;
+	}
+}
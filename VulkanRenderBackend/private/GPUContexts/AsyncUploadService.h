@@ -0,0 +1,85 @@
+#pragma once
+#include <ThreadManager.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CADeque.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CASharedPtr.h>
+#include <CASTL/CAFunctional.h>
+#include <GPUBuffer.h>
+#include <GPUTexture.h>
+#include <VMA.h>
+#include <VulkanApplicationSubobjectBase.h>
+
+namespace graphics_backend
+{
+	using namespace thread_management;
+	class VKGPUTexture;
+
+	//Streams large buffer and texture uploads on the transfer queue outside of frame graphs.
+	//Uploads are split into chunks that are copied through a persistently mapped staging ring with a bounded in flight byte budget,
+	//progress is tracked with a timeline semaphore and resources are left owned by the transfer queue family,
+	//so the first graph that uses them releases and aquires ownership through the external resource barriers
+	class AsyncUploadService : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		AsyncUploadService(CVulkanApplication& app);
+		void Initialize();
+		void Release();
+
+		//Data must stay valid until onComplete is called, it is also called when the upload failed
+		void UploadBuffer(castl::shared_ptr<GPUBuffer> const& buffer, void const* pData, uint64_t size, uint64_t offset, castl::function<void()> onComplete);
+		void UploadTexture(castl::shared_ptr<GPUTexture> const& texture, void const* pData, uint64_t size, castl::function<void()> onComplete);
+
+		//Retires finished uploads, schedules their callbacks as tasks and submits pending chunks within the staging budget
+		void Tick(TaskScheduler* scheduler);
+		uint64_t GetInFlightBytes() const;
+	private:
+		struct UploadRequest
+		{
+			castl::shared_ptr<GPUBuffer> buffer;
+			castl::shared_ptr<GPUTexture> texture;
+			uint8_t const* pData = nullptr;
+			uint64_t size = 0;
+			uint64_t dstOffset = 0;
+			uint64_t uploadedSize = 0;
+			//Nothing was copied, the resource keeps its usage and queue family
+			bool failed = false;
+			castl::function<void()> onComplete;
+		};
+
+		struct UploadBatch
+		{
+			uint64_t timelineValue = 0;
+			uint64_t stagingBytes = 0;
+			vk::CommandBuffer commandBuffer = nullptr;
+			castl::vector<UploadRequest> finishedRequests;
+		};
+
+		bool AllocateStaging(uint64_t size, uint64_t& outOffset, uint64_t& inoutBatchBytes);
+		//Records copies of the next chunk of the request, returns false if the staging ring is full
+		bool RecordNextChunk(vk::CommandBuffer commandBuffer, UploadRequest& request, uint64_t& inoutBatchBytes);
+		void RecordTransferDestBarrier(vk::CommandBuffer commandBuffer, VKGPUTexture const& texture);
+		void RetireFinishedBatches(TaskScheduler* scheduler);
+		void SubmitPendingRequests();
+		vk::CommandBuffer AllocCommandBuffer();
+
+		uint32_t m_QueueFamily = 0;
+		vk::Extent3D m_ImageTransferGranularity = { 1, 1, 1 };
+		vk::Semaphore m_TimelineSemaphore = nullptr;
+		uint64_t m_LastSubmittedValue = 0;
+		vk::CommandPool m_CommandPool = nullptr;
+		castl::vector<vk::CommandBuffer> m_FreeCommandBuffers;
+
+		vk::Buffer m_StagingBuffer = nullptr;
+		VmaAllocation m_StagingAllocation = nullptr;
+		uint8_t* m_pStagingMemory = nullptr;
+		uint64_t m_StagingCapacity = 0;
+		uint64_t m_StagingHead = 0;
+		uint64_t m_StagingUsed = 0;
+		uint64_t m_MinAlignment = 16;
+
+		mutable castl::mutex m_Mutex;
+		castl::deque<UploadRequest> m_PendingRequests;
+		castl::deque<UploadBatch> m_InFlightBatches;
+	};
+}
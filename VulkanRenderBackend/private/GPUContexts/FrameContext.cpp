@@ -45,6 +45,20 @@ namespace graphics_backend
 		return result;
 	}
 
+	GPUMemoryStatistics FrameContext::GetMemoryStatistics()
+	{
+		GPUMemoryStatistics result{};
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		for (auto& frameBoundResourceManager : m_FrameBoundResourceManagers)
+		{
+			GPUMemoryStatistics poolStatistics = frameBoundResourceManager.memoryManager.GetMemoryStatistics();
+			result.textureBytes += poolStatistics.textureBytes;
+			result.bufferBytes += poolStatistics.bufferBytes;
+			result.deviceLocalUsage += poolStatistics.deviceLocalUsage;
+		}
+		return result;
+	}
+
 	void FrameContext::Release()
 	{
 		for(auto &frameBoundResourceManager : m_FrameBoundResourceManagers)
@@ -14,6 +14,8 @@ namespace graphics_backend
 		FrameContext(CVulkanApplication& owner);
 		void InitFrameCapacity(uint32_t capacity);
 		castl::shared_ptr<FrameBoundResourcePool> GetFrameBoundResourceManager();
+		//Summed over the memory managers of all frame bound pools, whether in flight or not
+		GPUMemoryStatistics GetMemoryStatistics();
 		void Release();
 	private:
 		castl::mutex m_Mutex;
@@ -107,8 +107,20 @@ namespace graphics_backend
 		, vk::ArrayProxyNoTemporaries<const vk::Semaphore> signalSemaphores)
 	{
 		vk::SubmitInfo submitInfo(waitSemaphores, waitStages, commandbuffers, signalSemaphores);
+		castl::lock_guard<castl::mutex> guard(m_SubmitMutex);
 		GetDevice().getQueue(familyIndex, queueIndex).submit(submitInfo, fence);
 	}
+	void QueueContext::SubmitCommandsSignalTimeline(int familyIndex, int queueIndex
+		, vk::CommandBuffer commandBuffer
+		, vk::Semaphore timelineSemaphore
+		, uint64_t signalValue)
+	{
+		vk::CommandBufferSubmitInfo commandInfo(commandBuffer);
+		vk::SemaphoreSubmitInfo signalInfo(timelineSemaphore, signalValue, vk::PipelineStageFlagBits2::eAllCommands);
+		vk::SubmitInfo2 submitInfo({}, {}, commandInfo, signalInfo);
+		castl::lock_guard<castl::mutex> guard(m_SubmitMutex);
+		GetDevice().getQueue(familyIndex, queueIndex).submit2(submitInfo);
+	}
 	bool QueueContext::QueueFamilySupportsPresent(vk::SurfaceKHR surface, int familyIndex) const
 	{
 		return GetPhysicalDevice().getSurfaceSupportKHR(familyIndex, surface);
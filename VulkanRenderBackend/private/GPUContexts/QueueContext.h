@@ -2,6 +2,7 @@
 #include <Common.h>
 #include "VulkanApplicationSubobjectBase.h"
 #include "RenderBackendSettings.h"
+#include <CASTL/CAMutex.h>
 
 namespace graphics_backend
 {
@@ -45,6 +46,12 @@ namespace graphics_backend
 			, vk::ArrayProxyNoTemporaries<const vk::Semaphore> waitSemaphores = {}
 			, vk::ArrayProxyNoTemporaries<const vk::PipelineStageFlags> waitStages = {}
 			, vk::ArrayProxyNoTemporaries<const vk::Semaphore> signalSemaphores = {});
+
+		//Submits a command buffer that signals signalValue on a timeline semaphore once it completes
+		void SubmitCommandsSignalTimeline(int familyIndex, int queueIndex
+			, vk::CommandBuffer commandBuffer
+			, vk::Semaphore timelineSemaphore
+			, uint64_t signalValue);
 		
 		bool QueueFamilySupportsPresent(vk::SurfaceKHR surface, int familyIndex) const;
 		int FindPresentQueueFamily(vk::SurfaceKHR surface) const;
@@ -123,5 +130,7 @@ namespace graphics_backend
 		int m_VideoDecodeFamilyIndex = -1;
 		vk::PipelineStageFlags m_VideoDecodeStageMask;
 		castl::vector<QueueFamilyInfo> m_QueueFamilyList;
+		//Queues are submitted from frame graphs and the async upload service on different threads
+		castl::mutex m_SubmitMutex;
 	};
 }
\ No newline at end of file
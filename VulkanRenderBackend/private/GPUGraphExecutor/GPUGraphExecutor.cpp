@@ -75,7 +75,7 @@ namespace graphics_backend
 
 	ResourceState MakeNewResourceState(int passID, uint32_t queueFamilyIndex, ResourceUsageFlags usage)
 	{
-		return ResourceState(passID, usage, queueFamilyIndex);
+		return ResourceState(passID, usage, queueFamilyIndex, passID);
 	}
 
 	CVertexInputDescriptor MakeVertexInputDescriptorsNew(castl::vector<ShaderCompilerSlang::ShaderVertexAttributeData> const& vertexAttributes
@@ -273,13 +273,13 @@ namespace graphics_backend
 					WriteDescriptorSets(graph);
 				});
 
-		auto prepareResourceBarriers = taskGraph->NewTask()
+		auto prepareResourceBarriers = taskGraph->NewTaskGraph()
 			->Name("Prepare Resource Barriers")
 			->DependsOn(writeShaderArgs)
-			->Functor([this]()
+			->Func([this](auto graph)
 				{
 					//Prepare Resource Barriers
-					PrepareResourceBarriers();
+					PrepareResourceBarriers(graph);
 				});
 
 		auto recordGraphs = taskGraph->NewTaskGraph()
@@ -305,6 +305,8 @@ namespace graphics_backend
 					Submit();
 					//Sync Final Usages
 					SyncExternalResources();
+					//Barrier Statistics
+					CollectBarrierStatistics();
 				});
 	}
 
@@ -402,6 +404,17 @@ namespace graphics_backend
 								m_BufferManager.AllocResourceIndex(vertexBuffer.GetKey(), bufferManager.GetDescriptorIndex(vertexBuffer.GetKey()));
 							}
 						}
+						//Indirect Arguments
+						for (auto& indirectDraw : batch.m_IndirectDraws)
+						{
+							for (auto indirectBuffer : { indirectDraw.argsBuffer, indirectDraw.countBuffer })
+							{
+								if (indirectBuffer.GetType() == BufferHandle::BufferType::Internal)
+								{
+									m_BufferManager.AllocResourceIndex(indirectBuffer.GetKey(), bufferManager.GetDescriptorIndex(indirectBuffer.GetKey()));
+								}
+							}
+						}
 					}
 
 				}
@@ -681,6 +694,17 @@ namespace graphics_backend
 								m_BufferManager.AllocResourceIndex(vertexBuffer.GetKey(), bufferManager.GetDescriptorIndex(vertexBuffer.GetKey()));
 							}
 						}
+						//Indirect Arguments
+						for (auto& indirectDraw : batch.m_IndirectDraws)
+						{
+							for (auto indirectBuffer : { indirectDraw.argsBuffer, indirectDraw.countBuffer })
+							{
+								if (indirectBuffer.GetType() == BufferHandle::BufferType::Internal)
+								{
+									m_BufferManager.AllocResourceIndex(indirectBuffer.GetKey(), bufferManager.GetDescriptorIndex(indirectBuffer.GetKey()));
+								}
+							}
+						}
 					}
 
 				}
@@ -908,11 +932,6 @@ namespace graphics_backend
 		{
 			auto pass = GetBasePassInfo(passID);
 			uint32_t startCommandID = m_FinalCommandBuffers.size();
-			//先执行准备资源的命令
-			for (vk::CommandBuffer prepareCmd : pass->m_PrepareShaderArgCommands)
-			{
-				m_FinalCommandBuffers.push_back(prepareCmd);
-			}
 			for (vk::CommandBuffer cmd : pass->m_CommandBuffers)
 			{
 				m_FinalCommandBuffers.push_back(cmd);
@@ -1023,6 +1042,21 @@ namespace graphics_backend
 		}
 	}
 
+	void GPUGraphExecutor::CollectBarrierStatistics()
+	{
+		BarrierStatistics statistics{};
+		auto& graphStages = m_Graph->GetGraphStages();
+		for (uint32_t passID = 0; passID < graphStages.size(); ++passID)
+		{
+			statistics += GetBasePassInfo(passID)->m_BarrierCollector.GetStatistics();
+		}
+		for (auto& pair : m_ExternalResourceReleasingBarriers.queueFamilyToBarrierCollector)
+		{
+			statistics += pair.second.barrierCollector.GetStatistics();
+		}
+		m_FrameBoundResourceManager->AddBarrierStatistics(statistics);
+	}
+
 	void GPUGraphExecutor::UpdateExternalBufferUsage(PassInfoBase* passInfo, BufferHandle const& handle, ResourceState const& initUsageState, ResourceState const& newUsageState)
 	{
 		if (handle.GetType() == BufferHandle::BufferType::External)
@@ -1087,8 +1121,7 @@ namespace graphics_backend
 		return defaultState;
 	};
 
-	void GPUGraphExecutor::PrepareVertexBuffersBarriers(VulkanBarrierCollector& inoutBarrierCollector
-		, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+	void GPUGraphExecutor::PrepareVertexBuffersBarriers(PassResourceAccesses& inoutAccesses
 		, DrawCallBatch const& batch
 		, GPUPassBatchInfo const& batchInfo
 		, uint32_t passID
@@ -1097,7 +1130,7 @@ namespace graphics_backend
 		if (batch.m_BoundIndexBuffer.GetType() != BufferHandle::BufferType::Invalid)
 		{
 			ResourceUsageFlags usageFlags = ResourceUsage::eVertexAttribute;
-			UpdateBufferDependency(passID, batch.m_BoundIndexBuffer, usageFlags, inoutBufferUsageFlagCache);
+			GatherBufferAccess(inoutAccesses, passID, batch.m_BoundIndexBuffer, usageFlags);
 		}
 		for (auto bindingPair : batchInfo.m_VertexAttributeBindings)
 		{
@@ -1105,9 +1138,15 @@ namespace graphics_backend
 			if (foundBuffer != batch.m_BoundVertexBuffers.end())
 			{
 				ResourceUsageFlags usageFlags = ResourceUsage::eVertexAttribute;
-				UpdateBufferDependency(passID, foundBuffer->second, usageFlags, inoutBufferUsageFlagCache);
+				GatherBufferAccess(inoutAccesses, passID, foundBuffer->second, usageFlags);
 			}
 		}
+		for (auto& indirectDraw : batch.m_IndirectDraws)
+		{
+			ResourceUsageFlags usageFlags = ResourceUsage::eIndirectRead;
+			GatherBufferAccess(inoutAccesses, passID, indirectDraw.argsBuffer, usageFlags);
+			GatherBufferAccess(inoutAccesses, passID, indirectDraw.countBuffer, usageFlags);
+		}
 	}
 
 	//VulkanBarrierCollector& GPUGraphExecutor::GetBarrierCollector(uint32_t passID)
@@ -1125,11 +1164,10 @@ namespace graphics_backend
 	//	}
 	//}
 
-	void GPUGraphExecutor::UpdateBufferDependency(
-		uint32_t destPassID
+	void GPUGraphExecutor::GatherBufferAccess(PassResourceAccesses& inoutAccesses
+		, uint32_t passID
 		, BufferHandle const& bufferHandle
-		, ResourceUsageFlags newUsageFlags
-		, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache)
+		, ResourceUsageFlags usageFlags)
 	{
 		if (bufferHandle.GetType() == BufferHandle::BufferType::Invalid)
 		{
@@ -1138,34 +1176,14 @@ namespace graphics_backend
 		auto buffer = GetBufferHandleBufferObject(bufferHandle);
 		if (buffer == vk::Buffer{ nullptr })
 			return;
-
-		auto dstInfo = GetBasePassInfo(destPassID);
-		CA_ASSERT(dstInfo != nullptr, "Invalid Dest Pass ID");
-
-		auto usageStates = GetResourceUsage(inoutBufferUsageFlagCache, buffer, GetHandleInitializeUsage(bufferHandle, destPassID, *dstInfo));
-		auto newUsageState = MakeNewResourceState(destPassID, dstInfo->GetQueueFamily(), newUsageFlags);
-		CA_ASSERT(newUsageState.usage != ResourceUsage::eDontCare, "why dst usage is dont care?");
-		if (usageStates.usage != newUsageState.usage)
-		{
-			auto sourceInfo = GetBasePassInfo(usageStates.passID);
-			if (sourceInfo != nullptr)
-			{
-				if (NeedReleaseBarrier(usageStates, newUsageState))
-				{
-					sourceInfo->m_BarrierCollector.PushBufferReleaseBarrier(newUsageState.queueFamily, buffer, usageStates.usage, newUsageState.usage);
-					sourceInfo->m_SuccessorPasses.insert(newUsageState.passID);
-					dstInfo->m_PredecessorPasses.insert(usageStates.passID);
-				}
-			}
-			dstInfo->m_BarrierCollector.PushBufferAquireBarrier(usageStates.queueFamily, buffer, usageStates.usage, newUsageState.usage);
-			UpdateResourceUsageFlags(inoutBufferUsageFlagCache, buffer, newUsageState);
-			UpdateExternalBufferUsage(dstInfo, bufferHandle, usageStates, newUsageState);
-		}
+		auto& bucket = inoutAccesses.m_BufferAccesses[cacore::hash<vk::Buffer>{}(buffer) % RESOURCE_BARRIER_BUCKET_COUNT];
+		bucket.push_back(BufferAccessRecord{ bufferHandle, buffer, usageFlags, passID });
 	}
 
-	void GPUGraphExecutor::UpdateImageDependency(uint32_t destPassID, ImageHandle const& imageHandle
-		, ResourceUsageFlags newUsageFlags
-		, castl::unordered_map<vk::Image, ResourceState>& inoutImageUsageFlagCache)
+	void GPUGraphExecutor::GatherImageAccess(PassResourceAccesses& inoutAccesses
+		, uint32_t passID
+		, ImageHandle const& imageHandle
+		, ResourceUsageFlags usageFlags)
 	{
 		if (!ValidImageHandle(imageHandle))
 		{
@@ -1174,31 +1192,144 @@ namespace graphics_backend
 		auto image = GetTextureHandleImageObject(imageHandle);
 		if (image == vk::Image{ nullptr })
 			return;
+		auto& bucket = inoutAccesses.m_ImageAccesses[cacore::hash<vk::Image>{}(image) % RESOURCE_BARRIER_BUCKET_COUNT];
+		bucket.push_back(ImageAccessRecord{ imageHandle, image, usageFlags, passID });
+	}
 
-		auto dstInfo = GetBasePassInfo(destPassID);
-		CA_ASSERT(dstInfo != nullptr, "Invalid Dest Pass ID");
-
-		auto pDesc = GetTextureHandleDescriptor(imageHandle);
-
-		auto usageStates = GetResourceUsage(inoutImageUsageFlagCache, image, GetHandleInitializeUsage(imageHandle, destPassID, *dstInfo));
-		auto newUsageState = MakeNewResourceState(destPassID, dstInfo->GetQueueFamily(), newUsageFlags);
-
-		if (usageStates.usage != newUsageState.usage)
+	void GPUGraphExecutor::ResolveResourceTransitions(uint32_t bucketID)
+	{
+		castl::unordered_map<vk::Image, ResourceState> imageUsageFlagCache;
+		castl::unordered_map<vk::Buffer, ResourceState> bufferUsageFlagCache;
+		ResourceTransitionBucket& transitions = m_ResourceTransitionBuckets[bucketID];
+		//Passes are visited in graph order, every resource of this bucket sees its accesses in submission order
+		for (PassResourceAccesses const& passAccesses : m_PassResourceAccesses)
 		{
-			auto sourceInfo = GetBasePassInfo(usageStates.passID);
-			if (sourceInfo != nullptr)
+			for (BufferAccessRecord const& access : passAccesses.m_BufferAccesses[bucketID])
+			{
+				auto dstInfo = GetBasePassInfo(access.passID);
+				CA_ASSERT(dstInfo != nullptr, "Invalid Dest Pass ID");
+				auto usageStates = GetResourceUsage(bufferUsageFlagCache, access.buffer, GetHandleInitializeUsage(access.handle, access.passID, *dstInfo));
+				auto newUsageState = MakeNewResourceState(access.passID, dstInfo->GetQueueFamily(), access.usage);
+				CA_ASSERT(newUsageState.usage != ResourceUsage::eDontCare, "why dst usage is dont care?");
+				if (usageStates.usage != newUsageState.usage)
+				{
+					transitions.m_BufferTransitions.push_back(BufferTransitionRecord{ access.handle, access.buffer, usageStates, newUsageState });
+					UpdateResourceUsageFlags(bufferUsageFlagCache, access.buffer, newUsageState);
+				}
+				else if (usageStates.passID >= 0 && usageStates.lastAccessPassID < static_cast<int>(access.passID))
+				{
+					usageStates.lastAccessPassID = access.passID;
+					UpdateResourceUsageFlags(bufferUsageFlagCache, access.buffer, usageStates);
+				}
+			}
+
+			for (ImageAccessRecord const& access : passAccesses.m_ImageAccesses[bucketID])
 			{
-				if (NeedReleaseBarrier(usageStates, newUsageState))
+				auto dstInfo = GetBasePassInfo(access.passID);
+				CA_ASSERT(dstInfo != nullptr, "Invalid Dest Pass ID");
+				auto usageStates = GetResourceUsage(imageUsageFlagCache, access.image, GetHandleInitializeUsage(access.handle, access.passID, *dstInfo));
+				auto newUsageState = MakeNewResourceState(access.passID, dstInfo->GetQueueFamily(), access.usage);
+				if (usageStates.usage != newUsageState.usage)
 				{
-					sourceInfo->m_BarrierCollector.PushImageReleaseBarrier(newUsageState.queueFamily, image, pDesc->format, usageStates.usage, newUsageState.usage);
-					sourceInfo->m_SuccessorPasses.insert(newUsageState.passID);
-					dstInfo->m_PredecessorPasses.insert(usageStates.passID);
+					transitions.m_ImageTransitions.push_back(ImageTransitionRecord{ access.handle, access.image, usageStates, newUsageState });
+					UpdateResourceUsageFlags(imageUsageFlagCache, access.image, newUsageState);
 				}
+				else if (usageStates.passID >= 0 && usageStates.lastAccessPassID < static_cast<int>(access.passID))
+				{
+					usageStates.lastAccessPassID = access.passID;
+					UpdateResourceUsageFlags(imageUsageFlagCache, access.image, usageStates);
+				}
+			}
+		}
+	}
+
+	void GPUGraphExecutor::UpdateBufferDependency(BufferTransitionRecord const& transition)
+	{
+		vk::Buffer buffer = transition.buffer;
+		ResourceState const& usageStates = transition.srcState;
+		ResourceState const& newUsageState = transition.dstState;
+		auto dstInfo = GetBasePassInfo(newUsageState.passID);
+		auto sourceInfo = GetBasePassInfo(usageStates.passID);
+		if (sourceInfo != nullptr)
+		{
+			if (NeedReleaseBarrier(usageStates, newUsageState))
+			{
+				sourceInfo->m_BarrierCollector.PushBufferReleaseBarrier(newUsageState.queueFamily, buffer, usageStates.usage, newUsageState.usage);
+				sourceInfo->m_SuccessorPasses.insert(newUsageState.passID);
+				dstInfo->m_PredecessorPasses.insert(usageStates.passID);
+			}
+		}
+		if (SplitBarrier* splitBarrier = TryGetSplitBarrier(usageStates, newUsageState))
+		{
+			dstInfo->m_BarrierCollector.PushBufferSplitBarrier(*splitBarrier, buffer, usageStates.usage, newUsageState.usage);
+		}
+		else
+		{
+			dstInfo->m_BarrierCollector.PushBufferAquireBarrier(usageStates.queueFamily, buffer, usageStates.usage, newUsageState.usage);
+		}
+		UpdateExternalBufferUsage(dstInfo, transition.handle, usageStates, newUsageState);
+	}
+
+	void GPUGraphExecutor::UpdateImageDependency(ImageTransitionRecord const& transition)
+	{
+		vk::Image image = transition.image;
+		ResourceState const& usageStates = transition.srcState;
+		ResourceState const& newUsageState = transition.dstState;
+		auto dstInfo = GetBasePassInfo(newUsageState.passID);
+		auto pDesc = GetTextureHandleDescriptor(transition.handle);
+		auto sourceInfo = GetBasePassInfo(usageStates.passID);
+		if (sourceInfo != nullptr)
+		{
+			if (NeedReleaseBarrier(usageStates, newUsageState))
+			{
+				sourceInfo->m_BarrierCollector.PushImageReleaseBarrier(newUsageState.queueFamily, image, pDesc->format, usageStates.usage, newUsageState.usage);
+				sourceInfo->m_SuccessorPasses.insert(newUsageState.passID);
+				dstInfo->m_PredecessorPasses.insert(usageStates.passID);
 			}
+		}
+		if (SplitBarrier* splitBarrier = TryGetSplitBarrier(usageStates, newUsageState))
+		{
+			dstInfo->m_BarrierCollector.PushImageSplitBarrier(*splitBarrier, image, pDesc->format, usageStates.usage, newUsageState.usage);
+		}
+		else
+		{
 			dstInfo->m_BarrierCollector.PushImageAquireBarrier(usageStates.queueFamily, image, pDesc->format, usageStates.usage, newUsageState.usage);
-			UpdateResourceUsageFlags(inoutImageUsageFlagCache, image, newUsageState);
-			UpdateExternalImageUsage(dstInfo, imageHandle, usageStates, newUsageState);
 		}
+		UpdateExternalImageUsage(dstInfo, transition.handle, usageStates, newUsageState);
+	}
+
+	SplitBarrier* GPUGraphExecutor::TryGetSplitBarrier(ResourceState const& srcState, ResourceState const& dstState)
+	{
+		//Signal after the last pass touching the resource, otherwise its accesses would not be covered by the event
+		int signalPassID = castl::max(srcState.passID, srcState.lastAccessPassID);
+		//Adjacent passes and external resources keep using pipeline barriers
+		if (signalPassID < 0 || dstState.passID <= signalPassID + 1)
+		{
+			return nullptr;
+		}
+		//Events only work within the same queue
+		if (srcState.queueFamily != dstState.queueFamily)
+		{
+			return nullptr;
+		}
+		PassInfoBase* signalPass = GetBasePassInfo(signalPassID);
+		PassInfoBase* waitPass = GetBasePassInfo(dstState.passID);
+		if (signalPass == nullptr || waitPass == nullptr || signalPass->GetQueueFamily() != dstState.queueFamily)
+		{
+			return nullptr;
+		}
+
+		auto key = castl::make_pair(static_cast<uint32_t>(signalPassID), static_cast<uint32_t>(dstState.passID));
+		auto found = m_SplitBarriers.find(key);
+		if (found == m_SplitBarriers.end())
+		{
+			SplitBarrier newSplitBarrier{};
+			newSplitBarrier.m_Event = m_FrameBoundResourceManager->eventPool.AllocEvent();
+			found = m_SplitBarriers.emplace(key, castl::move(newSplitBarrier)).first;
+			signalPass->m_BarrierCollector.PushSplitBarrierSignal(&found->second);
+			waitPass->m_BarrierCollector.PushSplitBarrierWait(&found->second);
+		}
+		return &found->second;
 	}
 
 	GPUGraphExecutor::GPUGraphExecutor(CVulkanApplication& application) : VKAppSubObjectBaseNoCopy(application)
@@ -1228,14 +1359,18 @@ namespace graphics_backend
 		m_ExternBufferFinalUsageStates.clear();
 		m_ExternImageFinalUsageStates.clear();
 		m_ExternalResourceReleasingBarriers.Release();
+		//Barrier Analysis
+		m_PassResourceAccesses.clear();
+		m_ResourceTransitionBuckets.clear();
+		//Split Barriers
+		m_SplitBarriers.clear();
 		//Command Buffers
+		m_SecondaryCommandRanges.clear();
 		m_FinalCommandBuffers.clear();
 		m_CommandBufferBatchList.clear();
 	}
 
-	void GPUGraphExecutor::PrepareShaderArgsResourceBarriers(VulkanBarrierCollector& inoutBarrierCollector
-		, castl::unordered_map<vk::Image, ResourceState>& inoutResourceUsageFlagCache
-		, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+	void GPUGraphExecutor::PrepareShaderArgsResourceBarriers(PassResourceAccesses& inoutAccesses
 		, ShaderArgList const* shaderArgList
 		, uint32_t passID)
 	{
@@ -1255,7 +1390,7 @@ namespace graphics_backend
 				{
 					auto& imgHandle = img.first;
 					ResourceUsageFlags usageFlags = ResourceUsage::eVertexRead | ResourceUsage::eFragmentRead;
-					UpdateImageDependency(passID, imgHandle, usageFlags, inoutResourceUsageFlagCache);
+					GatherImageAccess(inoutAccesses, passID, imgHandle, usageFlags);
 				}
 			}
 			for (auto& bufferPair : shaderArgs.GetBufferList())
@@ -1264,15 +1399,13 @@ namespace graphics_backend
 				for (auto& buf : bufs)
 				{
 					ResourceUsageFlags usageFlags = ResourceUsage::eVertexRead | ResourceUsage::eFragmentRead;
-					UpdateBufferDependency(passID, buf, usageFlags, inoutBufferUsageFlagCache);
+					GatherBufferAccess(inoutAccesses, passID, buf, usageFlags);
 				}
 			}
 		}
 	}
 
-	void GPUGraphExecutor::PrepareShaderBindingResourceBarriers(VulkanBarrierCollector& inoutBarrierCollector
-		, castl::unordered_map<vk::Image, ResourceState>& inoutImageUsageFlagCache
-		, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+	void GPUGraphExecutor::PrepareShaderBindingResourceBarriers(PassResourceAccesses& inoutAccesses
 		, ShaderBindingInstance const& shaderBindingInstance
 		, uint32_t passID)
 	{
@@ -1307,17 +1440,17 @@ namespace graphics_backend
 			{
 			case ShaderCompilerSlang::EShaderResourceAccess::eReadOnly:
 			{
-				UpdateBufferDependency(passID, bufferHandlePairs.first, readFlags, inoutBufferUsageFlagCache);
+				GatherBufferAccess(inoutAccesses, passID, bufferHandlePairs.first, readFlags);
 				break;
 			}
 			case ShaderCompilerSlang::EShaderResourceAccess::eWriteOnly:
 			{
-				UpdateBufferDependency(passID, bufferHandlePairs.first, writeFlags, inoutBufferUsageFlagCache);
+				GatherBufferAccess(inoutAccesses, passID, bufferHandlePairs.first, writeFlags);
 				break;
 			}
 			case ShaderCompilerSlang::EShaderResourceAccess::eReadWrite:
 			{
-				UpdateBufferDependency(passID, bufferHandlePairs.first, readFlags | writeFlags, inoutBufferUsageFlagCache);
+				GatherBufferAccess(inoutAccesses, passID, bufferHandlePairs.first, readFlags | writeFlags);
 				break;
 			}
 			}
@@ -1328,17 +1461,17 @@ namespace graphics_backend
 			{
 			case ShaderCompilerSlang::EShaderResourceAccess::eReadOnly:
 			{
-				UpdateImageDependency(passID, imageHandlePairs.first, readFlags, inoutImageUsageFlagCache);
+				GatherImageAccess(inoutAccesses, passID, imageHandlePairs.first, readFlags);
 				break;
 			}
 			case ShaderCompilerSlang::EShaderResourceAccess::eWriteOnly:
 			{
-				UpdateImageDependency(passID, imageHandlePairs.first, writeFlags, inoutImageUsageFlagCache);
+				GatherImageAccess(inoutAccesses, passID, imageHandlePairs.first, writeFlags);
 				break;
 			}
 			case ShaderCompilerSlang::EShaderResourceAccess::eReadWrite:
 			{
-				UpdateImageDependency(passID, imageHandlePairs.first, readFlags | writeFlags, inoutImageUsageFlagCache);
+				GatherImageAccess(inoutAccesses, passID, imageHandlePairs.first, readFlags | writeFlags);
 				break;
 			}
 			}
@@ -1474,8 +1607,14 @@ namespace graphics_backend
 
 									//Shader Binding Holder
 									//Dont Need To Make Instance here, We Only Need Descriptor Set Layouts
-									newBatchInfo.m_ShaderBindingInstance.InitShaderBindingLayouts(GetVulkanApplication(), resolvedPSODesc.m_ShaderSet->GetShaderReflectionData(ShaderCompilerSlang::EShaderTargetType::eSpirV));
-									newBatchInfo.m_ShaderBindingInstance.InitShaderBindingSets(m_FrameBoundResourceManager);
+									bool bindingsValid = newBatchInfo.m_ShaderBindingInstance.InitShaderBindingLayouts(GetVulkanApplication(), *resolvedPSODesc.m_ShaderSet);
+									newBatchInfo.m_ShaderBindingInstance.InitShaderBindingSets();
+									if (!bindingsValid)
+									{
+										//Batches without a pipeline are skipped
+										newBatchInfo.m_PSO = nullptr;
+										return;
+									}
 
 									//auto& vertexInputBindings = resolvedPSODesc.m_VertexInputBindings;
 									auto& vertexAttributes = resolvedPSODesc.m_ShaderSet->GetShaderReflectionData(ShaderCompilerSlang::EShaderTargetType::eSpirV).m_VertexAttributes;
@@ -1491,9 +1630,10 @@ namespace graphics_backend
 									psoDescObj.shaderState = { vertShader, fragShader };
 									psoDescObj.renderPassObject = passInfo.m_RenderPassObject;
 									psoDescObj.descriptorSetLayouts = newBatchInfo.m_ShaderBindingInstance.m_DescriptorSetsLayouts;
+									psoDescObj.pushConstantSize = newBatchInfo.m_ShaderBindingInstance.GetPushConstantSize();
 
-									newBatchInfo.m_PSO = GetGPUObjectManager().GetPipelineCache().GetOrCreate(psoDescObj);
-									CA_ASSERT(newBatchInfo.m_PSO != nullptr, "Invalid PSO");
+									auto psoFuture = GetGPUObjectManager().GetPipelineCache().GetOrCreateAsync(psoDescObj, GetGPUObjectManager().GetPipelineCompileQueue());
+									newBatchInfo.m_PSO = psoFuture->IsReady() ? psoFuture->Get() : nullptr;
 								}
 							});
 				});
@@ -1512,9 +1652,14 @@ namespace graphics_backend
 			{
 				GPUComputePassInfo::ComputeDispatchInfo newDispatchInfo{};
 				//Dont Need To Make Instance here, We Only Need Descriptor Set Layouts
-				newDispatchInfo.m_ShaderBindingInstance.InitShaderBindingLayouts(GetVulkanApplication()
-					, dispatch.shader->GetShaderReflectionData(ShaderCompilerSlang::EShaderTargetType::eSpirV));
-				newDispatchInfo.m_ShaderBindingInstance.InitShaderBindingSets(m_FrameBoundResourceManager);
+				bool bindingsValid = newDispatchInfo.m_ShaderBindingInstance.InitShaderBindingLayouts(GetVulkanApplication(), *dispatch.shader);
+				newDispatchInfo.m_ShaderBindingInstance.InitShaderBindingSets();
+				if (!bindingsValid)
+				{
+					//Dispatches without a pipeline are skipped
+					newComputePass.m_DispatchInfos.push_back(newDispatchInfo);
+					continue;
+				}
 
 				auto comp = GetGPUObjectManager()
 					.GetShaderModuleCache()
@@ -1525,6 +1670,7 @@ namespace graphics_backend
 				ComputePipelineDescriptor pipelineDesc{};
 				pipelineDesc.computeShader = comp;
 				pipelineDesc.descriptorSetLayouts = newDispatchInfo.m_ShaderBindingInstance.m_DescriptorSetsLayouts;
+				pipelineDesc.pushConstantSize = newDispatchInfo.m_ShaderBindingInstance.GetPushConstantSize();
 				newDispatchInfo.m_ComputePipeline = GetGPUObjectManager()
 					.GetComputePipelineCache().GetOrCreate(pipelineDesc);
 
@@ -1554,7 +1700,6 @@ namespace graphics_backend
 						auto& drawcallBatchData = renderPassData.m_Batches;
 						CA_ASSERT(drawcallBatchs.size() == drawcallBatchData.size(), "InCompatible Render Pass Batch Sizes");
 						auto& passLevelPsoDesc = renderPass.GetPipelineStates();
-						renderPassData.m_PrepareShaderArgCommands.resize(drawcallBatchs.size());
 
 						passGraph->NewTaskParallelFor()
 							->Name("Rasterize Batch ShaderArgs")
@@ -1562,15 +1707,11 @@ namespace graphics_backend
 							->Functor([&](uint32_t batchID)
 							{
 								//CPUTIMER_SCOPE("Rasterize Batch ShaderArgs");
-								auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
-								vk::CommandBuffer writeConstantsCommand = cmdPool->AllocCommand(QueueType::eGraphics, "Write Descriptors");
 								auto& batch = drawcallBatchs[batchID];
 								GPUPassBatchInfo& newBatchInfo = drawcallBatchData[batchID];
 								auto& batchLevelPsoDesc = batch.pipelineStateDesc;
 								auto resolvedPSODesc = PipelineDescData::CombindDescData(passLevelPsoDesc, batchLevelPsoDesc);
-								newBatchInfo.m_ShaderBindingInstance.FillShaderData(GetVulkanApplication(), *this, m_FrameBoundResourceManager, writeConstantsCommand, resolvedPSODesc.shaderArgLists);
-								writeConstantsCommand.end();
-								renderPassData.m_PrepareShaderArgCommands[batchID] = writeConstantsCommand;
+								newBatchInfo.m_ShaderBindingInstance.FillShaderData(GetVulkanApplication(), *this, m_FrameBoundResourceManager, resolvedPSODesc.shaderArgLists);
 							});
 					});
 			}
@@ -1589,8 +1730,6 @@ namespace graphics_backend
 						castl::vector <castl::pair<castl::string, castl::shared_ptr<ShaderArgList>>> shaderArgs;
 						auto& computePass = computePasses[passID];
 						auto& computePassData = m_ComputePasses[passID];
-						auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
-						vk::CommandBuffer writeConstantsCommand = cmdPool->AllocCommand(QueueType::eCompute, "Write Descriptors");
 						shaderArgs.resize(computePass.shaderArgLists.size());
 						castl::copy(computePass.shaderArgLists.begin(), computePass.shaderArgLists.end(), shaderArgs.begin());
 						for (size_t dispatchID = 0; dispatchID < computePass.dispatchs.size(); ++dispatchID)
@@ -1603,136 +1742,154 @@ namespace graphics_backend
 							{
 								shaderArgs[computePass.shaderArgLists.size() + copyID] = dispatchData.shaderArgLists[copyID];
 							}
-							dispatchData1.m_ShaderBindingInstance.FillShaderData(GetVulkanApplication(), *this, m_FrameBoundResourceManager, writeConstantsCommand, shaderArgs);
+							dispatchData1.m_ShaderBindingInstance.FillShaderData(GetVulkanApplication(), *this, m_FrameBoundResourceManager, shaderArgs);
 						}
-						writeConstantsCommand.end();
-						computePassData.m_PrepareShaderArgCommands.push_back(writeConstantsCommand);
 					});
 			}
 		}
 	}
 
-	void GPUGraphExecutor::PrepareResourceBarriers()
+	void GPUGraphExecutor::PrepareResourceBarriers(thread_management::TaskScheduler* taskGraph)
 	{
 		auto& graphStages = m_Graph->GetGraphStages();
-		auto& renderPasses = m_Graph->GetRenderPasses();
-		auto& computePasses = m_Graph->GetComputePasses();
-		auto& dataTransfers = m_Graph->GetDataTransfers();
-		auto& passIndices = m_Graph->GetPassIndices();
-
-		castl::unordered_map<vk::Image, ResourceState> imageUsageFlagCache;
-		castl::unordered_map<vk::Buffer, ResourceState> bufferUsageFlagCache;
-
-		uint32_t currentRenderPassIndex = 0;
-		uint32_t currentComputePassIndex = 0;
-		uint32_t currentTransferPassIndex = 0;
+		m_PassResourceAccesses.clear();
+		m_PassResourceAccesses.resize(graphStages.size());
+		m_ResourceTransitionBuckets.clear();
+		m_ResourceTransitionBuckets.resize(RESOURCE_BARRIER_BUCKET_COUNT);
+
+		//Collect resource accesses of each pass
+		auto gatherAccesses = taskGraph->NewTaskParallelFor()
+			->Name("Gather Pass Resource Accesses")
+			->JobCount(graphStages.size())
+			->Functor([this](uint32_t passID)
+				{
+					GatherPassResourceAccesses(passID);
+				});
 
-		uint32_t passID = 0;
-		for (auto stage : graphStages)
-		{
-			uint32_t realPassID = passIndices[passID];
-			switch (stage)
-			{
-			case GPUGraph::EGraphStageType::eRenderPass:
-			{
-				CA_ASSERT(realPassID == currentRenderPassIndex, "Render Pass Index Mismatch");
-				++currentRenderPassIndex;
-				auto& renderPass = renderPasses[realPassID];
-				auto& renderPassData = m_Passes[realPassID];
-				auto& attachments = renderPass.GetAttachments();
-				auto& drawcallBatchs = renderPass.GetDrawCallBatches();
-				//Barriers
+		//Resolve transitions per resource bucket
+		auto resolveTransitions = taskGraph->NewTaskParallelFor()
+			->Name("Resolve Resource Transitions")
+			->DependsOn(gatherAccesses)
+			->JobCount(RESOURCE_BARRIER_BUCKET_COUNT)
+			->Functor([this](uint32_t bucketID)
 				{
-					renderPassData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetGraphicsPipelineStageMask(), GetQueueContext().GetGraphicsQueueFamily());
+					ResolveResourceTransitions(bucketID);
+				});
 
-					for (size_t batchID = 0; batchID < drawcallBatchs.size(); ++batchID)
+		//Push resolved transitions to pass barrier collectors
+		taskGraph->NewTask()
+			->Name("Apply Resource Transitions")
+			->DependsOn(resolveTransitions)
+			->Functor([this]()
+				{
+					for (ResourceTransitionBucket const& bucket : m_ResourceTransitionBuckets)
 					{
-						auto& batch = drawcallBatchs[batchID];
-						auto& batchData = renderPassData.m_Batches[batchID];
-						PrepareVertexBuffersBarriers(renderPassData.m_BarrierCollector, bufferUsageFlagCache, batch, batchData, passID);
-						PrepareShaderBindingResourceBarriers(renderPassData.m_BarrierCollector
-							, imageUsageFlagCache
-							, bufferUsageFlagCache
-							, batchData.m_ShaderBindingInstance
-							, passID);
-
-						for (auto& bufferSet : batchData.m_ShaderBindingInstance.m_UniformBuffers)
+						for (BufferTransitionRecord const& transition : bucket.m_BufferTransitions)
 						{
-							for (auto& bufferObject : bufferSet.second)
-							{
-								renderPassData.m_BarrierCollector.PushBufferBarrier(bufferObject.buffer, ResourceUsage::eTransferDest, ResourceUsage::eFragmentRead | ResourceUsage::eVertexRead);
-							}
+							UpdateBufferDependency(transition);
+						}
+						for (ImageTransitionRecord const& transition : bucket.m_ImageTransitions)
+						{
+							UpdateImageDependency(transition);
 						}
 					}
-					for (size_t i = 0; i < attachments.size(); ++i)
-					{
-						auto& attachment = attachments[i];
-						ResourceUsageFlags usageFlags = i == renderPass.GetDepthAttachmentIndex() ? ResourceUsage::eDepthStencilAttachment : ResourceUsage::eColorAttachmentOutput;
-						UpdateImageDependency(passID, attachment, usageFlags, imageUsageFlagCache);
-					}
-				}
-				break;
-			}
-			case GPUGraph::EGraphStageType::eComputePass:
+				});
+	}
+
+	void GPUGraphExecutor::GatherPassResourceAccesses(uint32_t passID)
+	{
+		auto& graphStages = m_Graph->GetGraphStages();
+		auto& renderPasses = m_Graph->GetRenderPasses();
+		auto& computePasses = m_Graph->GetComputePasses();
+		auto& dataTransfers = m_Graph->GetDataTransfers();
+		auto& passIndices = m_Graph->GetPassIndices();
+
+		PassResourceAccesses& passAccesses = m_PassResourceAccesses[passID];
+		uint32_t realPassID = passIndices[passID];
+		switch (graphStages[passID])
+		{
+		case GPUGraph::EGraphStageType::eRenderPass:
+		{
+			auto& renderPass = renderPasses[realPassID];
+			auto& renderPassData = m_Passes[realPassID];
+			auto& attachments = renderPass.GetAttachments();
+			auto& drawcallBatchs = renderPass.GetDrawCallBatches();
+			//Barriers
 			{
-				CA_ASSERT(realPassID == currentComputePassIndex, "Compute Pass Index Mismatch");
-				++currentComputePassIndex;
-				auto& computePass = computePasses[realPassID];
-				auto& computePassData = m_ComputePasses[realPassID];
-				computePassData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetComputePipelineStageMask(), GetQueueContext().GetComputeQueueFamily());
-				for (size_t dispatchID = 0; dispatchID < computePass.dispatchs.size(); ++dispatchID)
+				renderPassData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetGraphicsPipelineStageMask(), GetQueueContext().GetGraphicsQueueFamily());
+
+				for (size_t batchID = 0; batchID < drawcallBatchs.size(); ++batchID)
 				{
-					auto& dispatchData = computePass.dispatchs[dispatchID];
-					auto& dispatchData1 = computePassData.m_DispatchInfos[dispatchID];
-
-					//TODO: 重写这个函数
-					//PrepareShaderArgsResourceBarriers(computePassData.m_BarrierCollector, imageUsageFlagCache, bufferUsageFlagCache, batch.shaderArgs.get(), passID);
-					PrepareShaderBindingResourceBarriers(computePassData.m_BarrierCollector
-						, imageUsageFlagCache
-						, bufferUsageFlagCache
-						, dispatchData1.m_ShaderBindingInstance
+					auto& batch = drawcallBatchs[batchID];
+					auto& batchData = renderPassData.m_Batches[batchID];
+					PrepareVertexBuffersBarriers(passAccesses, batch, batchData, passID);
+					PrepareShaderBindingResourceBarriers(passAccesses
+						, batchData.m_ShaderBindingInstance
 						, passID);
 
-					for (auto& bufferSet : dispatchData1.m_ShaderBindingInstance.m_UniformBuffers)
+					for (auto& bufferSet : batchData.m_ShaderBindingInstance.m_UniformBuffers)
 					{
 						for (auto& bufferObject : bufferSet.second)
 						{
-							computePassData.m_BarrierCollector.PushBufferBarrier(bufferObject.buffer, ResourceUsage::eTransferDest, ResourceUsage::eComputeRead);
+							renderPassData.m_BarrierCollector.PushBufferBarrier(bufferObject.buffer, ResourceUsage::eTransferDest, ResourceUsage::eFragmentRead | ResourceUsage::eVertexRead);
 						}
 					}
 				}
-				break;
+				for (size_t i = 0; i < attachments.size(); ++i)
+				{
+					auto& attachment = attachments[i];
+					ResourceUsageFlags usageFlags = i == renderPass.GetDepthAttachmentIndex() ? ResourceUsage::eDepthStencilAttachment : ResourceUsage::eColorAttachmentOutput;
+					GatherImageAccess(passAccesses, passID, attachment, usageFlags);
+				}
 			}
-			case GPUGraph::EGraphStageType::eTransferPass:
+			break;
+		}
+		case GPUGraph::EGraphStageType::eComputePass:
+		{
+			auto& computePass = computePasses[realPassID];
+			auto& computePassData = m_ComputePasses[realPassID];
+			computePassData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetComputePipelineStageMask(), GetQueueContext().GetComputeQueueFamily());
+			for (size_t dispatchID = 0; dispatchID < computePass.dispatchs.size(); ++dispatchID)
 			{
-				CA_ASSERT(realPassID == currentTransferPassIndex, "Render Pass Index Mismatch");
-				++currentTransferPassIndex;
-				GPUTransferInfo& transfersData = m_TransferPasses[realPassID];
-				transfersData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetTransferPipelineStageMask(), GetQueueContext().GetTransferQueueFamily());
-				auto& transfersInfo = dataTransfers[realPassID];
+				auto& dispatchData1 = computePassData.m_DispatchInfos[dispatchID];
 
-				for (auto& bufferUpload : transfersInfo.m_BufferDataUploads)
-				{
+				//TODO: 重写这个函数
+				//PrepareShaderArgsResourceBarriers(passAccesses, batch.shaderArgs.get(), passID);
+				PrepareShaderBindingResourceBarriers(passAccesses
+					, dispatchData1.m_ShaderBindingInstance
+					, passID);
 
-					auto [bufferHandle, uploadRef] = bufferUpload;
-					if (bufferHandle.GetType() != BufferHandle::BufferType::Invalid)
+				for (auto& bufferSet : dispatchData1.m_ShaderBindingInstance.m_UniformBuffers)
+				{
+					for (auto& bufferObject : bufferSet.second)
 					{
-						ResourceUsageFlags usageFlags = ResourceUsage::eTransferDest;
-						UpdateBufferDependency(passID, bufferHandle, usageFlags, bufferUsageFlagCache);
+						computePassData.m_BarrierCollector.PushBufferBarrier(bufferObject.buffer, ResourceUsage::eTransferDest, ResourceUsage::eComputeRead);
 					}
 				}
-				for (auto& imageUpload : transfersInfo.m_ImageDataUploads)
-				{
-					auto [imageHandle, uploadRef] = imageUpload;
-					ResourceUsageFlags usageFlags = ResourceUsage::eTransferDest;
-					UpdateImageDependency(passID, imageHandle, usageFlags, imageUsageFlagCache);
-				}
-				break;
-			}
 			}
-			++passID;
+			break;
 		}
+		case GPUGraph::EGraphStageType::eTransferPass:
+		{
+			GPUTransferInfo& transfersData = m_TransferPasses[realPassID];
+			transfersData.m_BarrierCollector.SetCurrentQueueFamilyIndex(GetQueueContext().GetTransferPipelineStageMask(), GetQueueContext().GetTransferQueueFamily());
+			auto& transfersInfo = dataTransfers[realPassID];
 
+			for (auto& bufferUpload : transfersInfo.m_BufferDataUploads)
+			{
+				auto [bufferHandle, uploadRef] = bufferUpload;
+				ResourceUsageFlags usageFlags = ResourceUsage::eTransferDest;
+				GatherBufferAccess(passAccesses, passID, bufferHandle, usageFlags);
+			}
+			for (auto& imageUpload : transfersInfo.m_ImageDataUploads)
+			{
+				auto [imageHandle, uploadRef] = imageUpload;
+				ResourceUsageFlags usageFlags = ResourceUsage::eTransferDest;
+				GatherImageAccess(passAccesses, passID, imageHandle, usageFlags);
+			}
+			break;
+		}
+		}
 	}
 
 	void GPUGraphExecutor::RecordGraph(thread_management::TaskScheduler* taskGraph)
@@ -1769,8 +1926,29 @@ namespace graphics_backend
 					});
 		}
 
+		//Large render passes are split into secondary command buffers recorded before their primary ones
+		PrepareSecondaryCommandRanges();
+		auto recordSecondaryCommands = taskGraph->NewTaskParallelFor()
+			->Name("Record Secondary Commands")
+			->JobCount(m_SecondaryCommandRanges.size())
+			->Functor([&](uint32_t rangeID)
+			{
+				SecondaryCommandRange const& range = m_SecondaryCommandRanges[rangeID];
+				auto& passData = m_Passes[range.realPassID];
+				vk::CommandBufferInheritanceInfo inheritanceInfo{
+					passData.m_RenderPassObject->GetRenderPass()
+					, 0
+					, passData.m_FrameBufferObject->GetFramebuffer() };
+				auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
+				vk::CommandBuffer secondaryCommandBuffer = cmdPool->AllocSecondaryCommand(inheritanceInfo, "Render Pass Secondary");
+				RecordDrawBatches(secondaryCommandBuffer, passData, renderPasses[range.realPassID], range.beginBatch, range.endBatch);
+				secondaryCommandBuffer.end();
+				passData.m_SecondaryCommandBuffers[range.secondaryCommandIndex] = secondaryCommandBuffer;
+			});
+
 		taskGraph->NewTaskParallelFor()
 			->Name("Record Pass Commands")
+			->DependsOn(recordSecondaryCommands)
 			->JobCount(graphStages.size())
 			->Functor([&](uint32_t passID)
 			{
@@ -1790,10 +1968,11 @@ namespace graphics_backend
 					auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
 					vk::CommandBuffer renderPassCommandBuffer = cmdPool->AllocCommand(QueueType::eGraphics, "Render Pass");
 
-					passData.m_BarrierCollector.ExecuteBarrier(renderPassCommandBuffer);
+					passData.m_BarrierCollector.ExecuteBarrier(renderPassCommandBuffer, &m_FrameBoundResourceManager->timestampQueryPool);
 
 					if (passData.ValidPassData())
 					{
+						bool useSecondaryCommands = !passData.m_SecondaryCommandBuffers.empty();
 						renderPassCommandBuffer.beginRenderPass(
 							vk::RenderPassBeginInfo{
 								passData.m_RenderPassObject->GetRenderPass()
@@ -1801,42 +1980,15 @@ namespace graphics_backend
 								, vk::Rect2D{{0, 0}, { passData.m_FrameBufferObject->GetWidth(), passData.m_FrameBufferObject->GetHeight() }}
 								, passData.m_ClearValues
 							}
-						, vk::SubpassContents::eInline);
-
-						renderPassCommandBuffer.setViewport(0, { vk::Viewport(0.0f, 0.0f, (float)passData.m_FrameBufferObject->GetWidth(), (float)passData.m_FrameBufferObject->GetHeight(), 0.0f, 1.0f) });
-						renderPassCommandBuffer.setScissor(0, { vk::Rect2D({0, 0}, { passData.m_FrameBufferObject->GetWidth(), passData.m_FrameBufferObject->GetHeight() }) });
-
-						CommandList_Impl commandList{ renderPassCommandBuffer };
+						, useSecondaryCommands ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline);
 
-						for (uint32_t batchID = 0; batchID < drawcallBatchs.size(); ++batchID)
+						if (useSecondaryCommands)
 						{
-							auto& batchData = batchDatas[batchID];
-							auto& drawcallBatch = drawcallBatchs[batchID];
-
-							renderPassCommandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, batchData.m_PSO->GetPipeline());
-
-							renderPassCommandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, batchData.m_PSO->GetPipelineLayout(), 0, batchData.m_ShaderBindingInstance.m_DescriptorSets, {});
-
-							if (drawcallBatch.m_BoundIndexBuffer.GetType() != BufferHandle::BufferType::Invalid)
-							{
-								auto buffer = GetBufferHandleBufferObject(drawcallBatch.m_BoundIndexBuffer);
-								renderPassCommandBuffer.bindIndexBuffer(buffer, drawcallBatch.m_IndexBufferOffset, EIndexBufferTypeTranslate(drawcallBatch.m_IndexBufferType));
-							}
-
-							for (auto& attributePair : batchData.m_VertexAttributeBindings)
-							{
-								auto foundVertexBuffer = drawcallBatch.m_BoundVertexBuffers.find(attributePair.first);
-								if (foundVertexBuffer != drawcallBatch.m_BoundVertexBuffers.end())
-								{
-									auto buffer = GetBufferHandleBufferObject(foundVertexBuffer->second);
-									renderPassCommandBuffer.bindVertexBuffers(attributePair.second.bindingIndex, { buffer }, { 0 });
-								}
-							}
-
-							for (auto& drawFunc : drawcallBatch.m_DrawCommands)
-							{
-								drawFunc(commandList);
-							}
+							renderPassCommandBuffer.executeCommands(passData.m_SecondaryCommandBuffers);
+						}
+						else
+						{
+							RecordDrawBatches(renderPassCommandBuffer, passData, renderPass, 0, drawcallBatchs.size());
 						}
 						renderPassCommandBuffer.endRenderPass();
 					}
@@ -1852,13 +2004,17 @@ namespace graphics_backend
 					auto& computePassData = m_ComputePasses[realPassID];
 					auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
 					vk::CommandBuffer computeCommandBuffer = cmdPool->AllocCommand(QueueType::eCompute, "Compute Pass");
-					computePassData.m_BarrierCollector.ExecuteBarrier(computeCommandBuffer);
+					computePassData.m_BarrierCollector.ExecuteBarrier(computeCommandBuffer, &m_FrameBoundResourceManager->timestampQueryPool);
 					for (size_t dispatchID = 0; dispatchID < computePass.dispatchs.size(); ++dispatchID)
 					{
 						auto& dispatchData = computePass.dispatchs[dispatchID];
 						auto& dispatchData1 = computePassData.m_DispatchInfos[dispatchID];
+						if (dispatchData1.m_ComputePipeline == nullptr)
+						{
+							continue;
+						}
 						computeCommandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, dispatchData1.m_ComputePipeline->GetPipeline());
-						computeCommandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, dispatchData1.m_ComputePipeline->GetPipelineLayout(), 0, dispatchData1.m_ShaderBindingInstance.m_DescriptorSets, {});
+						dispatchData1.m_ShaderBindingInstance.BindShaderData(computeCommandBuffer, vk::PipelineBindPoint::eCompute, dispatchData1.m_ComputePipeline->GetPipelineLayout());
 						computeCommandBuffer.dispatch(dispatchData.x, dispatchData.y, dispatchData.z);
 					}
 					computePassData.m_BarrierCollector.ExecuteReleaseBarrier(computeCommandBuffer);
@@ -1873,7 +2029,7 @@ namespace graphics_backend
 
 					auto cmdPool = m_FrameBoundResourceManager->commandBufferThreadPool.AquireCommandBufferPool();
 					vk::CommandBuffer dataTransferCommandBuffer = cmdPool->AllocCommand(QueueType::eTransfer, "Data Transfer");
-					transfersData.m_BarrierCollector.ExecuteBarrier(dataTransferCommandBuffer);
+					transfersData.m_BarrierCollector.ExecuteBarrier(dataTransferCommandBuffer, &m_FrameBoundResourceManager->timestampQueryPool);
 
 					for (auto& bufferUpload : transfersInfo.m_BufferDataUploads)
 					{
@@ -1883,12 +2039,9 @@ namespace graphics_backend
 							auto buffer = GetBufferHandleBufferObject(bufferHandle);
 							if (buffer != vk::Buffer{ nullptr })
 							{
-								auto srcBuffer = m_FrameBoundResourceManager->CreateStagingBuffer(uploadRef.dataSize, EBufferUsage::eDataSrc, "Staging Buffer " + bufferHandle.GetName());
-								{
-									auto mappedSrcBuffer = m_FrameBoundResourceManager->memoryManager.ScopedMapMemory(srcBuffer.allocation);
-									memcpy(mappedSrcBuffer.mappedMemory, uploadData.GetPtr(uploadRef.dataIndex), uploadRef.dataSize);
-								}
-								dataTransferCommandBuffer.copyBuffer(srcBuffer.buffer, buffer, vk::BufferCopy(0, uploadRef.dstOffset, uploadRef.dataSize));
+								auto srcAllocation = m_FrameBoundResourceManager->stagingRingBuffer.Allocate(uploadRef.dataSize);
+								memcpy(srcAllocation.pMappedData, uploadData.GetPtr(uploadRef.dataIndex), uploadRef.dataSize);
+								dataTransferCommandBuffer.copyBuffer(srcAllocation.buffer, buffer, vk::BufferCopy(srcAllocation.offset, uploadRef.dstOffset, uploadRef.dataSize));
 							}
 						}
 					}
@@ -1902,18 +2055,33 @@ namespace graphics_backend
 							auto pDesc = GetTextureHandleDescriptor(imageHandle);
 							if (image != vk::Image{ nullptr })
 							{
-								auto srcBuffer = m_FrameBoundResourceManager->CreateStagingBuffer(uploadRef.dataSize, EBufferUsage::eDataSrc);
+								//Data holds consecutive mips largest first, starting at the mip the offset points at in the mip chain layout.
+								//Mips beyond the data are left untouched, every mip gets its own staging range so its offset is aligned for the format
+								uint8_t const* pData = static_cast<uint8_t const*>(uploadData.GetPtr(uploadRef.dataIndex));
+								uint32_t firstMip = 0;
+								while (firstMip < pDesc->mipLevels && pDesc->GetMipDataOffset(firstMip) < uploadRef.dstOffset)
 								{
-									auto mappedSrcBuffer = m_FrameBoundResourceManager->memoryManager.ScopedMapMemory(srcBuffer.allocation);
-									memcpy(mappedSrcBuffer.mappedMemory, uploadData.GetPtr(uploadRef.dataIndex), uploadRef.dataSize);
+									++firstMip;
+								}
+								CA_ASSERT(firstMip == pDesc->mipLevels || pDesc->GetMipDataOffset(firstMip) == uploadRef.dstOffset, "Texture Upload Offset Is Not At A Mip");
+								uint64_t mipOffset = 0;
+								for (uint32_t mipID = firstMip; mipID < pDesc->mipLevels; ++mipID)
+								{
+									uint64_t mipSize = pDesc->GetMipDataSize(mipID);
+									if (mipOffset + mipSize > uploadRef.dataSize)
+									{
+										break;
+									}
+									auto srcAllocation = m_FrameBoundResourceManager->stagingRingBuffer.Allocate(mipSize, GetFormatBlockBytes(pDesc->format));
+									memcpy(srcAllocation.pMappedData, pData + mipOffset, mipSize);
+									std::array<vk::BufferImageCopy, 1> bufferImageCopy = { GPUTextureDescriptorToBufferImageCopy(*pDesc, mipID) };
+									bufferImageCopy[0].bufferOffset = srcAllocation.offset;
+									dataTransferCommandBuffer.copyBufferToImage(srcAllocation.buffer
+										, image
+										, vk::ImageLayout::eTransferDstOptimal
+										, bufferImageCopy);
+									mipOffset += mipSize;
 								}
-
-								//TODO: offset is not used here for now
-								std::array<vk::BufferImageCopy, 1> bufferImageCopy = { GPUTextureDescriptorToBufferImageCopy(*pDesc) };
-								dataTransferCommandBuffer.copyBufferToImage(srcBuffer.buffer
-									, image
-									, vk::ImageLayout::eTransferDstOptimal
-									, bufferImageCopy);
 							}
 						}
 					}
@@ -2100,6 +2268,95 @@ namespace graphics_backend
 			m_Images.push_back(castl::move(imgObj));
 		}
 	}
+	void GPUGraphExecutor::PrepareSecondaryCommandRanges()
+	{
+		m_SecondaryCommandRanges.clear();
+		for (uint32_t realPassID = 0; realPassID < m_Passes.size(); ++realPassID)
+		{
+			auto& passData = m_Passes[realPassID];
+			passData.m_SecondaryCommandBuffers.clear();
+			if (!passData.ValidPassData())
+			{
+				continue;
+			}
+			uint32_t batchCount = passData.m_Batches.size();
+			uint32_t secondaryCommandCount = castl::min(batchCount / MIN_DRAW_BATCHES_PER_SECONDARY_COMMAND, MAX_SECONDARY_COMMANDS_PER_RENDER_PASS);
+			//Not worth splitting, record inline
+			if (secondaryCommandCount < 2)
+			{
+				continue;
+			}
+			passData.m_SecondaryCommandBuffers.resize(secondaryCommandCount);
+			uint32_t batchesPerCommand = (batchCount + secondaryCommandCount - 1) / secondaryCommandCount;
+			for (uint32_t commandID = 0; commandID < secondaryCommandCount; ++commandID)
+			{
+				uint32_t beginBatch = castl::min(commandID * batchesPerCommand, batchCount);
+				uint32_t endBatch = castl::min(beginBatch + batchesPerCommand, batchCount);
+				m_SecondaryCommandRanges.push_back(SecondaryCommandRange{ realPassID, commandID, beginBatch, endBatch });
+			}
+		}
+	}
+
+	void GPUGraphExecutor::RecordDrawBatches(vk::CommandBuffer commandBuffer
+		, GPUPassInfo const& passData
+		, RenderPass const& renderPass
+		, uint32_t beginBatch
+		, uint32_t endBatch)
+	{
+		auto& drawcallBatchs = renderPass.GetDrawCallBatches();
+		auto& batchDatas = passData.m_Batches;
+
+		//Dynamic states are not inherited by secondary command buffers
+		commandBuffer.setViewport(0, { vk::Viewport(0.0f, 0.0f, (float)passData.m_FrameBufferObject->GetWidth(), (float)passData.m_FrameBufferObject->GetHeight(), 0.0f, 1.0f) });
+		commandBuffer.setScissor(0, { vk::Rect2D({0, 0}, { passData.m_FrameBufferObject->GetWidth(), passData.m_FrameBufferObject->GetHeight() }) });
+
+		CommandList_Impl commandList{ commandBuffer };
+
+		for (uint32_t batchID = beginBatch; batchID < endBatch; ++batchID)
+		{
+			auto& batchData = batchDatas[batchID];
+			auto& drawcallBatch = drawcallBatchs[batchID];
+
+			//Pipeline is still compiling in the background
+			if (batchData.m_PSO == nullptr)
+			{
+				continue;
+			}
+
+			commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, batchData.m_PSO->GetPipeline());
+
+			batchData.m_ShaderBindingInstance.BindShaderData(commandBuffer, vk::PipelineBindPoint::eGraphics, batchData.m_PSO->GetPipelineLayout());
+
+			if (drawcallBatch.m_BoundIndexBuffer.GetType() != BufferHandle::BufferType::Invalid)
+			{
+				auto buffer = GetBufferHandleBufferObject(drawcallBatch.m_BoundIndexBuffer);
+				commandBuffer.bindIndexBuffer(buffer, drawcallBatch.m_IndexBufferOffset, EIndexBufferTypeTranslate(drawcallBatch.m_IndexBufferType));
+			}
+
+			for (auto& attributePair : batchData.m_VertexAttributeBindings)
+			{
+				auto foundVertexBuffer = drawcallBatch.m_BoundVertexBuffers.find(attributePair.first);
+				if (foundVertexBuffer != drawcallBatch.m_BoundVertexBuffers.end())
+				{
+					auto buffer = GetBufferHandleBufferObject(foundVertexBuffer->second);
+					commandBuffer.bindVertexBuffers(attributePair.second.bindingIndex, { buffer }, { 0 });
+				}
+			}
+
+			for (auto& drawFunc : drawcallBatch.m_DrawCommands)
+			{
+				drawFunc(commandList);
+			}
+
+			for (auto& indirectDraw : drawcallBatch.m_IndirectDraws)
+			{
+				commandBuffer.drawIndexedIndirectCount(GetBufferHandleBufferObject(indirectDraw.argsBuffer), indirectDraw.argsOffset
+					, GetBufferHandleBufferObject(indirectDraw.countBuffer), indirectDraw.countOffset
+					, indirectDraw.maxDrawCount, sizeof(DrawIndexedIndirectArgs));
+			}
+		}
+	}
+
 	GPUGraphExecutor::ExternalResourceReleaser& GPUGraphExecutor::ExternalResourceReleasingBarriers::GetQueueFamilyReleaser(CVulkanApplication& app, uint32_t queueFamily)
 	{
 		auto found = queueFamilyToBarrierCollector.find(queueFamily);
@@ -1,6 +1,7 @@
 #pragma once
 #include <CASTL/CASharedPtr.h>
 #include <CASTL/CAUnorderedSet.h>
+#include <CASTL/CAArray.h>
 #include <ThreadManager.h>
 #include <GPUGraph.h>
 #include <VulkanApplicationSubobjectBase.h>
@@ -25,6 +26,7 @@ namespace graphics_backend
 
 	struct GPUPassBatchInfo
 	{
+		//Null while the pipeline is compiling in the background
 		castl::shared_ptr<CPipelineObject> m_PSO;
 		castl::unordered_map<cacore::HashObj<VertexInputsDescriptor>, VertexAttributeBindingData> m_VertexAttributeBindings;
 		ShaderBindingInstance m_ShaderBindingInstance;
@@ -36,7 +38,6 @@ namespace graphics_backend
 		castl::set<uint32_t> m_PredecessorPasses;
 		castl::set<uint32_t> m_SuccessorPasses;
 		castl::set<uint32_t> m_WaitingQueueFamilies;
-		castl::vector<vk::CommandBuffer> m_PrepareShaderArgCommands;
 		castl::vector<vk::CommandBuffer> m_CommandBuffers;
 		int GetQueueFamily() const { return m_BarrierCollector.GetQueueFamily(); }
 		virtual GPUGraph::EGraphStageType GetStageType() const = 0;
@@ -48,6 +49,7 @@ namespace graphics_backend
 		castl::shared_ptr<RenderPassObject> m_RenderPassObject;
 		castl::vector<vk::ClearValue> m_ClearValues;
 		castl::vector<GPUPassBatchInfo> m_Batches;
+		castl::vector<vk::CommandBuffer> m_SecondaryCommandBuffers;
 		bool ValidPassData() const
 		{
 			return m_FrameBufferObject != nullptr && m_RenderPassObject != nullptr;
@@ -324,6 +326,64 @@ namespace graphics_backend
 		int passID;
 		ResourceUsageFlags usage;
 		uint32_t queueFamily;
+		//Last pass accessing the resource with the same usage, split barriers are signaled after it
+		int lastAccessPassID = -1;
+	};
+
+	//Resource accesses of a pass are partitioned by resource, each bucket resolves its transitions independently
+	constexpr uint32_t RESOURCE_BARRIER_BUCKET_COUNT = 16;
+
+	struct ImageAccessRecord
+	{
+		ImageHandle handle;
+		vk::Image image;
+		ResourceUsageFlags usage;
+		uint32_t passID;
+	};
+
+	struct BufferAccessRecord
+	{
+		BufferHandle handle;
+		vk::Buffer buffer;
+		ResourceUsageFlags usage;
+		uint32_t passID;
+	};
+
+	struct PassResourceAccesses
+	{
+		castl::array<castl::vector<ImageAccessRecord>, RESOURCE_BARRIER_BUCKET_COUNT> m_ImageAccesses;
+		castl::array<castl::vector<BufferAccessRecord>, RESOURCE_BARRIER_BUCKET_COUNT> m_BufferAccesses;
+	};
+
+	struct ImageTransitionRecord
+	{
+		ImageHandle handle;
+		vk::Image image;
+		ResourceState srcState;
+		ResourceState dstState;
+	};
+
+	struct BufferTransitionRecord
+	{
+		BufferHandle handle;
+		vk::Buffer buffer;
+		ResourceState srcState;
+		ResourceState dstState;
+	};
+
+	struct ResourceTransitionBucket
+	{
+		castl::vector<ImageTransitionRecord> m_ImageTransitions;
+		castl::vector<BufferTransitionRecord> m_BufferTransitions;
+	};
+
+	//Range of draw batches of a render pass recorded into one secondary command buffer
+	struct SecondaryCommandRange
+	{
+		uint32_t realPassID;
+		uint32_t secondaryCommandIndex;
+		uint32_t beginBatch;
+		uint32_t endBatch;
 	};
 
 	class GPUGraphExecutor : public VKAppSubObjectBaseNoCopy, public ShadderResourceProvider
@@ -341,22 +401,17 @@ namespace graphics_backend
 		void PrepareGraphLocalBufferResources();
 		void WaitBackbuffers();
 
-		void PrepareVertexBuffersBarriers(VulkanBarrierCollector& inoutBarrierCollector
-			, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+		void PrepareVertexBuffersBarriers(PassResourceAccesses& inoutAccesses
 			, DrawCallBatch const& batch
 			, GPUPassBatchInfo const& batchInfo
 			, uint32_t passID
 		);
 
-		void PrepareShaderArgsResourceBarriers(VulkanBarrierCollector& inoutBarrierCollector
-			, castl::unordered_map<vk::Image, ResourceState>& inoutImageUsageFlagCache
-			, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+		void PrepareShaderArgsResourceBarriers(PassResourceAccesses& inoutAccesses
 			, ShaderArgList const* shaderArgList
 			, uint32_t passID
 		);
-		void PrepareShaderBindingResourceBarriers(VulkanBarrierCollector& inoutBarrierCollector
-			, castl::unordered_map<vk::Image, ResourceState>& inoutImageUsageFlagCache
-			, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache
+		void PrepareShaderBindingResourceBarriers(PassResourceAccesses& inoutAccesses
 			, ShaderBindingInstance const& shaderBindingInstance
 			, uint32_t passID
 		);
@@ -364,21 +419,29 @@ namespace graphics_backend
 		PassInfoBase* GetBasePassInfo(int passID);
 
 #pragma region Shader Resource Dependencies
-		void UpdateBufferDependency(uint32_t passID, BufferHandle const& bufferHandle
-			, ResourceUsageFlags newUsageFlags
-			, castl::unordered_map<vk::Buffer, ResourceState>& inoutBufferUsageFlagCache);
-		void UpdateImageDependency(uint32_t passID, ImageHandle const& imageHandle
-			, ResourceUsageFlags newUsageFlags
-			, castl::unordered_map<vk::Image, ResourceState>& inoutImageUsageFlagCache);
+		void GatherPassResourceAccesses(uint32_t passID);
+		void GatherBufferAccess(PassResourceAccesses& inoutAccesses, uint32_t passID, BufferHandle const& bufferHandle, ResourceUsageFlags usageFlags);
+		void GatherImageAccess(PassResourceAccesses& inoutAccesses, uint32_t passID, ImageHandle const& imageHandle, ResourceUsageFlags usageFlags);
+		void ResolveResourceTransitions(uint32_t bucketID);
+		void UpdateBufferDependency(BufferTransitionRecord const& transition);
+		void UpdateImageDependency(ImageTransitionRecord const& transition);
+		SplitBarrier* TryGetSplitBarrier(ResourceState const& srcState, ResourceState const& dstState);
 #pragma endregion
 		void PrepareFrameBufferAndPSOs(thread_management::TaskScheduler* taskGraph);
 		void PrepareComputePSOs();
 		void WriteDescriptorSets(thread_management::TaskScheduler* taskGraph);
-		void PrepareResourceBarriers();
+		void PrepareResourceBarriers(thread_management::TaskScheduler* taskGraph);
 		void RecordGraph(thread_management::TaskScheduler* taskGraph);
+		void PrepareSecondaryCommandRanges();
+		void RecordDrawBatches(vk::CommandBuffer commandBuffer
+			, GPUPassInfo const& passData
+			, RenderPass const& renderPass
+			, uint32_t beginBatch
+			, uint32_t endBatch);
 		void ScanCommandBatchs();
 		void Submit();
 		void SyncExternalResources();
+		void CollectBarrierStatistics();
 
 		GPUTextureDescriptor const* GetTextureHandleDescriptor(ImageHandle const& handle) const;
 		vk::ImageView GetTextureHandleImageView(ImageHandle const& handle, GPUTextureView const& view) const;
@@ -430,7 +493,15 @@ namespace graphics_backend
 		castl::unordered_map<ImageHandle, ResourceState> m_ExternImageFinalUsageStates;
 		castl::unordered_map<BufferHandle, ResourceState> m_ExternBufferFinalUsageStates;
 
+		//Barrier Analysis
+		castl::vector<PassResourceAccesses> m_PassResourceAccesses;
+		castl::vector<ResourceTransitionBucket> m_ResourceTransitionBuckets;
+
+		//Split Barriers, Keyed By (Signal Pass, Wait Pass)
+		castl::map<castl::pair<uint32_t, uint32_t>, SplitBarrier> m_SplitBarriers;
+
 		//Command Buffers
+		castl::vector<SecondaryCommandRange> m_SecondaryCommandRanges;
 		castl::vector<vk::CommandBuffer> m_FinalCommandBuffers;
 		castl::vector<CommandBatchRange> m_CommandBufferBatchList;
 
@@ -0,0 +1,283 @@
+#include <pch.h>
+#include <VulkanApplication.h>
+#include <RenderBackendSettings.h>
+#include "ShaderArgBinding.h"
+
+namespace graphics_backend
+{
+	struct ShaderArgBindingPlanBuilder
+	{
+		bool resolveBindlessIndices;
+		ShaderArgBindingPlan& plan;
+
+		void AddDependency(ShaderArgList const& shaderArgList)
+		{
+			plan.m_Dependencies.push_back(castl::make_pair(&shaderArgList, shaderArgList.GetStructureVersion()));
+		}
+
+		ShaderArgList const* FindSubArgList(ShaderArgList const& shaderArgList, castl::string const& name)
+		{
+			ShaderArgList const* found = shaderArgList.FindSubArgList(name);
+			if (found != nullptr)
+			{
+				AddDependency(*found);
+			}
+			return found;
+		}
+
+		void CollectUniforms(ShaderArgList const& shaderArgList
+			, ShaderCompilerSlang::UniformBufferData const& bufferData
+			, uint32_t uniformBufferIndex
+			, int32_t bufferGroupID)
+		{
+			auto& group = bufferData.m_Groups[bufferGroupID];
+			for (auto& element : group.m_Elements)
+			{
+				if (auto pDataPos = shaderArgList.FindNumericDataPointer(element.m_Name))
+				{
+					plan.m_UniformCopies.push_back(ShaderArgBindingPlan::UniformCopy{ pDataPos
+						, uniformBufferIndex
+						, element.m_MemoryOffset
+						, element.m_ElementMemorySize
+						, element.m_Stride
+						, element.m_ElementCount });
+				}
+				else if (resolveBindlessIndices && element.m_ElementMemorySize == sizeof(uint32_t))
+				{
+					auto pImages = shaderArgList.FindImageHandleEntry(element.m_Name);
+					auto pBuffers = shaderArgList.FindBufferHandleEntry(element.m_Name);
+					if (pImages != nullptr || pBuffers != nullptr)
+					{
+						plan.m_BindlessIndexWrites.push_back(ShaderArgBindingPlan::BindlessIndexWrite{ pImages
+							, pBuffers
+							, uniformBufferIndex
+							, element.m_MemoryOffset
+							, element.m_Stride
+							, element.m_ElementCount });
+					}
+				}
+			}
+			for (uint32_t subGroupID : group.m_SubGroups)
+			{
+				if (auto found = FindSubArgList(shaderArgList, bufferData.m_Groups[subGroupID].m_Name))
+				{
+					CollectUniforms(*found, bufferData, uniformBufferIndex, subGroupID);
+				}
+			}
+		}
+
+		void CollectUniformBuffer(ShaderArgListBinding const& shaderArgLists
+			, ShaderCompilerSlang::UniformBufferData const& bufferData
+			, uint32_t uniformBufferIndex)
+		{
+			auto& group = bufferData.m_Groups[0];
+			for (auto& shaderArgList : shaderArgLists)
+			{
+				if (shaderArgList.first == group.m_Name || (group.m_Name == "__Global" && shaderArgList.first.empty()))
+				{
+					CollectUniforms(*shaderArgList.second, bufferData, uniformBufferIndex, 0);
+				}
+				//Global下的subgroup可以被认为是单独的资源组
+				else if (group.m_Name == "__Global")
+				{
+					for (uint32_t subgroupID : group.m_SubGroups)
+					{
+						if (bufferData.m_Groups[subgroupID].m_Name == shaderArgList.first)
+						{
+							CollectUniforms(*shaderArgList.second, bufferData, uniformBufferIndex, subgroupID);
+						}
+					}
+				}
+			}
+		}
+
+		void CollectResources(ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace
+			, ShaderArgList const& shaderArgList
+			, int32_t resourceGroupID)
+		{
+			auto& currentGroup = bindingSpace.m_ResourceGroups[resourceGroupID];
+			for (uint32_t texID : currentGroup.m_Textures)
+			{
+				auto& textureData = bindingSpace.m_Textures[texID];
+				if (auto pImages = shaderArgList.FindImageHandleEntry(textureData.m_Name))
+				{
+					plan.m_TextureSlots.push_back(ShaderArgBindingPlan::TextureSlot{ pImages, &textureData });
+				}
+			}
+			for (uint32_t samplerID : currentGroup.m_Samplers)
+			{
+				auto& samplerData = bindingSpace.m_Samplers[samplerID];
+				plan.m_SamplerSlots.push_back(ShaderArgBindingPlan::SamplerSlot{ shaderArgList.FindSamplerEntry(samplerData.m_Name), &samplerData });
+			}
+			for (uint32_t bufferID : currentGroup.m_Buffers)
+			{
+				auto& bufferData = bindingSpace.m_Buffers[bufferID];
+				if (auto pBuffers = shaderArgList.FindBufferHandleEntry(bufferData.m_Name))
+				{
+					plan.m_BufferSlots.push_back(ShaderArgBindingPlan::BufferSlot{ pBuffers, &bufferData });
+				}
+			}
+			for (uint32_t subGroupID : currentGroup.m_SubGroups)
+			{
+				if (auto found = FindSubArgList(shaderArgList, bindingSpace.m_ResourceGroups[subGroupID].m_Name))
+				{
+					CollectResources(bindingSpace, *found, subGroupID);
+				}
+			}
+		}
+	};
+
+	ShaderArgBindingPlan ShaderArgBindingPlan::Compile(ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace
+		, ShaderArgListBinding const& shaderArgLists
+		, bool resolveBindlessIndices)
+	{
+		ShaderArgBindingPlan plan{};
+		ShaderArgBindingPlanBuilder builder{ resolveBindlessIndices, plan };
+		for (auto& shaderArgList : shaderArgLists)
+		{
+			builder.AddDependency(*shaderArgList.second);
+		}
+
+		//Uniform Buffers
+		for (uint32_t ubid = 0; ubid < bindingSpace.m_UniformBuffers.size(); ++ubid)
+		{
+			builder.CollectUniformBuffer(shaderArgLists, bindingSpace.m_UniformBuffers[ubid], ubid);
+		}
+
+		//Non Uniform Buffer Resources
+		if (!bindingSpace.m_ResourceGroups.empty())
+		{
+			auto& group = bindingSpace.m_ResourceGroups[0];
+			for (auto& shaderArgList : shaderArgLists)
+			{
+				if (shaderArgList.first == group.m_Name || (group.m_Name == "__Global" && shaderArgList.first.empty()))
+				{
+					builder.CollectResources(bindingSpace, *shaderArgList.second, 0);
+				}
+				else if (group.m_Name == "__Global")
+				{
+					for (uint32_t subgroupID : group.m_SubGroups)
+					{
+						if (bindingSpace.m_ResourceGroups[subgroupID].m_Name == shaderArgList.first)
+						{
+							builder.CollectResources(bindingSpace, *shaderArgList.second, subgroupID);
+						}
+					}
+				}
+			}
+		}
+		return plan;
+	}
+
+	ShaderArgBindingPlan ShaderArgBindingPlan::CompilePushConstants(ShaderCompilerSlang::UniformBufferData const& pushConstants
+		, ShaderArgListBinding const& shaderArgLists
+		, bool resolveBindlessIndices)
+	{
+		ShaderArgBindingPlan plan{};
+		ShaderArgBindingPlanBuilder builder{ resolveBindlessIndices, plan };
+		for (auto& shaderArgList : shaderArgLists)
+		{
+			builder.AddDependency(*shaderArgList.second);
+		}
+		if (!pushConstants.m_Groups.empty())
+		{
+			builder.CollectUniformBuffer(shaderArgLists, pushConstants, 0);
+		}
+		return plan;
+	}
+
+	bool ShaderArgBindingPlan::IsValid() const
+	{
+		//Sub lists are only touched while their parents are unchanged, so they are still owned by them
+		for (auto& dependency : m_Dependencies)
+		{
+			if (dependency.first->GetStructureVersion() != dependency.second)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	ShaderArgBindingCache::ShaderArgBindingCache(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void ShaderArgBindingCache::Release()
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		m_Plans.clear();
+	}
+
+	template<typename CompileFunc>
+	castl::shared_ptr<ShaderArgBindingPlan const> ShaderArgBindingCache::FindOrCompile(uint64_t shaderSetID
+		, uint32_t bindingSpace
+		, ShaderArgListBinding const& shaderArgLists
+		, CompileFunc&& compileFunc)
+	{
+		ShaderArgBindingKey key{};
+		key.shaderSetID = shaderSetID;
+		key.bindingSpace = bindingSpace;
+		key.argLists.reserve(shaderArgLists.size());
+		for (auto& shaderArgList : shaderArgLists)
+		{
+			key.argLists.push_back(ShaderArgBindingKeyEntry{ shaderArgList.first, shaderArgList.second->GetID() });
+		}
+
+		{
+			castl::lock_guard<castl::mutex> lock(m_Mutex);
+			auto found = m_Plans.find(key);
+			if (found != m_Plans.end() && found->second.plan->IsValid())
+			{
+				found->second.lastUsedFrame = m_CurrentFrame;
+				return found->second.plan;
+			}
+		}
+
+		auto plan = castl::make_shared<ShaderArgBindingPlan>(compileFunc());
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		auto& cachedPlan = m_Plans[key];
+		cachedPlan.plan = plan;
+		cachedPlan.lastUsedFrame = m_CurrentFrame;
+		return plan;
+	}
+
+	castl::shared_ptr<ShaderArgBindingPlan const> ShaderArgBindingCache::GetOrCompile(uint64_t shaderSetID
+		, ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace
+		, ShaderArgListBinding const& shaderArgLists
+		, bool resolveBindlessIndices)
+	{
+		return FindOrCompile(shaderSetID, bindingSpace.m_BindingSpace, shaderArgLists, [&]()
+			{
+				return ShaderArgBindingPlan::Compile(bindingSpace, shaderArgLists, resolveBindlessIndices);
+			});
+	}
+
+	castl::shared_ptr<ShaderArgBindingPlan const> ShaderArgBindingCache::GetOrCompilePushConstants(uint64_t shaderSetID
+		, ShaderCompilerSlang::UniformBufferData const& pushConstants
+		, ShaderArgListBinding const& shaderArgLists
+		, bool resolveBindlessIndices)
+	{
+		return FindOrCompile(shaderSetID, PUSH_CONSTANT_SPACE, shaderArgLists, [&]()
+			{
+				return ShaderArgBindingPlan::CompilePushConstants(pushConstants, shaderArgLists, resolveBindlessIndices);
+			});
+	}
+
+	void ShaderArgBindingCache::NextFrame()
+	{
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		++m_CurrentFrame;
+		for (auto itr = m_Plans.begin(); itr != m_Plans.end();)
+		{
+			if (m_CurrentFrame - itr->second.lastUsedFrame > SHADER_ARG_BINDING_RETIRE_FRAME_COUNT)
+			{
+				itr = m_Plans.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <ShaderArgList.h>
+#include <Compiler.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAString.h>
+#include <CASTL/CASharedPtr.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAMutex.h>
+#include <VulkanApplicationSubobjectBase.h>
+
+namespace graphics_backend
+{
+	using ShaderArgListBinding = castl::vector<castl::pair<castl::string, castl::shared_ptr<ShaderArgList>>>;
+
+	//Shader arguments of one binding space resolved against its reflection data.
+	//Names are matched once, filling a set walks the resolved data pointers and slots
+	struct ShaderArgBindingPlan
+	{
+		struct UniformCopy
+		{
+			void const* pSrc;
+			uint32_t uniformBufferIndex;
+			uint32_t dstOffset;
+			uint32_t size;
+			uint32_t stride;
+			uint32_t count;
+		};
+
+		//Resources referenced from uniform data by bindless index
+		struct BindlessIndexWrite
+		{
+			castl::vector<castl::pair<ImageHandle, GPUTextureView>> const* pImages;
+			castl::vector<BufferHandle> const* pBuffers;
+			uint32_t uniformBufferIndex;
+			uint32_t dstOffset;
+			uint32_t stride;
+			uint32_t count;
+		};
+
+		struct TextureSlot
+		{
+			castl::vector<castl::pair<ImageHandle, GPUTextureView>> const* pImages;
+			ShaderCompilerSlang::TextureData const* pTextureData;
+		};
+
+		struct SamplerSlot
+		{
+			//Null when the sampler is not set, the default sampler is bound
+			TextureSamplerDescriptorObj const* pSampler;
+			ShaderCompilerSlang::SamplerData const* pSamplerData;
+		};
+
+		struct BufferSlot
+		{
+			castl::vector<BufferHandle> const* pBuffers;
+			ShaderCompilerSlang::ShaderBufferData const* pBufferData;
+		};
+
+		static ShaderArgBindingPlan Compile(ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace
+			, ShaderArgListBinding const& shaderArgLists
+			, bool resolveBindlessIndices);
+		//Only uniform copies and bindless indices, uniformBufferIndex is always 0
+		static ShaderArgBindingPlan CompilePushConstants(ShaderCompilerSlang::UniformBufferData const& pushConstants
+			, ShaderArgListBinding const& shaderArgLists
+			, bool resolveBindlessIndices);
+		//False once any resolved argument list changed its structure
+		bool IsValid() const;
+
+		//Argument lists the plan reads from, parents before their sub lists
+		castl::vector<castl::pair<ShaderArgList const*, uint64_t>> m_Dependencies;
+		castl::vector<UniformCopy> m_UniformCopies;
+		castl::vector<BindlessIndexWrite> m_BindlessIndexWrites;
+		castl::vector<TextureSlot> m_TextureSlots;
+		castl::vector<SamplerSlot> m_SamplerSlots;
+		castl::vector<BufferSlot> m_BufferSlots;
+	};
+
+	struct ShaderArgBindingKeyEntry
+	{
+		castl::string name;
+		uint64_t argListID = 0;
+		bool operator==(ShaderArgBindingKeyEntry const&) const = default;
+	};
+
+	struct ShaderArgBindingKey
+	{
+		uint64_t shaderSetID = 0;
+		//Binding space index, PUSH_CONSTANT_SPACE for the push constant block
+		uint32_t bindingSpace = 0;
+		castl::vector<ShaderArgBindingKeyEntry> argLists;
+		bool operator==(ShaderArgBindingKey const&) const = default;
+	};
+
+	//Plans of binding spaces and argument lists used in the recent frames
+	class ShaderArgBindingCache : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		static constexpr uint32_t PUSH_CONSTANT_SPACE = ~0u;
+
+		ShaderArgBindingCache(CVulkanApplication& app);
+		void Release();
+		//Plans point into the reflection data, they are cached by IShaderSet::GetShaderSetID so a released shader set's plans are never matched again
+		castl::shared_ptr<ShaderArgBindingPlan const> GetOrCompile(uint64_t shaderSetID
+			, ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpace
+			, ShaderArgListBinding const& shaderArgLists
+			, bool resolveBindlessIndices);
+		castl::shared_ptr<ShaderArgBindingPlan const> GetOrCompilePushConstants(uint64_t shaderSetID
+			, ShaderCompilerSlang::UniformBufferData const& pushConstants
+			, ShaderArgListBinding const& shaderArgLists
+			, bool resolveBindlessIndices);
+		//Plans unused for SHADER_ARG_BINDING_RETIRE_FRAME_COUNT frames are dropped, their argument lists may be gone
+		void NextFrame();
+	private:
+		template<typename CompileFunc>
+		castl::shared_ptr<ShaderArgBindingPlan const> FindOrCompile(uint64_t shaderSetID
+			, uint32_t bindingSpace
+			, ShaderArgListBinding const& shaderArgLists
+			, CompileFunc&& compileFunc);
+
+		struct CachedPlan
+		{
+			castl::shared_ptr<ShaderArgBindingPlan const> plan;
+			uint64_t lastUsedFrame = 0;
+		};
+
+		castl::mutex m_Mutex;
+		uint64_t m_CurrentFrame = 0;
+		castl::unordered_map<ShaderArgBindingKey, CachedPlan> m_Plans;
+	};
+}
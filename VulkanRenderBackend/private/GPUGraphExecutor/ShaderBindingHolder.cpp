@@ -1,6 +1,12 @@
 #include <pch.h>
 #include <VulkanApplication.h>
 #include <DescriptorAllocation/DescriptorLayoutPool.h>
+#include <DescriptorAllocation/DescriptorSetCache.h>
+#include <DescriptorAllocation/BindlessDescriptorHeap.h>
+#include <GPUResources/VKGPUTexture.h>
+#include <GPUResources/VKGPUBuffer.h>
+#include <CASTL/CAAlgorithm.h>
+#include "ShaderArgBinding.h"
 #include "ShaderBindingHolder.h"
 
 namespace graphics_backend
@@ -11,21 +17,26 @@ namespace graphics_backend
 		castl::vector<vk::DescriptorImageInfo> imageInfoList;
 		castl::vector<vk::DescriptorBufferInfo> bufferInfoList;
 
-		vk::DescriptorSet descriptorSet;
+		//Written resource identities, sets referencing only persistent resources are shared through the descriptor set cache
+		DescriptorSetCacheKey cacheKey;
+		bool cacheable = true;
+		castl::vector<vk::Image> referencedImages;
+		castl::vector<vk::Buffer> referencedBuffers;
 
-		void Initialize(vk::DescriptorSet set, uint32_t imageReserve, uint32_t samplerReserve, uint32_t constantBufferReserve, uint32_t bufferReserve)
+		void Initialize(vk::DescriptorSetLayout layout, uint32_t imageReserve, uint32_t samplerReserve, uint32_t constantBufferReserve, uint32_t bufferReserve)
 		{
-			descriptorSet = set;
+			cacheKey.layout = VulkanHandleToKey(layout);
+			cacheKey.writes.reserve(imageReserve + samplerReserve + bufferReserve + constantBufferReserve);
 			descriptorWrites.reserve(imageReserve + samplerReserve + bufferReserve + constantBufferReserve);
 			imageInfoList.reserve(imageReserve + samplerReserve);
 			bufferInfoList.reserve(bufferReserve + constantBufferReserve);
 		}
 
-		void AddWriteBuffer(vk::Buffer buffer, uint32_t binding, vk::DescriptorType descriptorType, uint32_t arrayIndex)
+		void AddWriteBuffer(vk::Buffer buffer, uint32_t binding, vk::DescriptorType descriptorType, uint32_t arrayIndex, vk::DeviceSize range = VK_WHOLE_SIZE)
 		{
-			bufferInfoList.push_back(vk::DescriptorBufferInfo(buffer, 0, VK_WHOLE_SIZE));
+			cacheKey.writes.push_back(DescriptorWriteKey{ VulkanHandleToKey(buffer), binding, arrayIndex, descriptorType, vk::ImageLayout::eUndefined, range });
+			bufferInfoList.push_back(vk::DescriptorBufferInfo(buffer, 0, range));
 			descriptorWrites.push_back(vk::WriteDescriptorSet()
-				.setDstSet(descriptorSet)
 				.setDstBinding(binding)
 				.setDstArrayElement(arrayIndex)
 				.setDescriptorType(descriptorType)
@@ -35,9 +46,9 @@ namespace graphics_backend
 
 		void AddWriteImageView(vk::ImageView imageView, uint32_t binding, vk::DescriptorType descriptorType, vk::ImageLayout layout, uint32_t arrayIndex)
 		{
+			cacheKey.writes.push_back(DescriptorWriteKey{ VulkanHandleToKey(imageView), binding, arrayIndex, descriptorType, layout });
 			imageInfoList.push_back(vk::DescriptorImageInfo({}, imageView, layout));
 			descriptorWrites.push_back(vk::WriteDescriptorSet()
-				.setDstSet(descriptorSet)
 				.setDstBinding(binding)
 				.setDstArrayElement(arrayIndex)
 				.setDescriptorType(descriptorType)
@@ -47,9 +58,9 @@ namespace graphics_backend
 
 		void AddWriteSampler(vk::Sampler sampler, uint32_t binding)
 		{
+			cacheKey.writes.push_back(DescriptorWriteKey{ VulkanHandleToKey(sampler), binding, 0, vk::DescriptorType::eSampler });
 			imageInfoList.push_back(vk::DescriptorImageInfo(sampler, {}, {}));
 			descriptorWrites.push_back(vk::WriteDescriptorSet()
-				.setDstSet(descriptorSet)
 				.setDstBinding(binding)
 				.setDstArrayElement(0)
 				.setDescriptorType(vk::DescriptorType::eSampler)
@@ -57,25 +68,50 @@ namespace graphics_backend
 				.setPImageInfo(&imageInfoList.back()));
 		}
 
-		void Apply(vk::Device device)
+		void Apply(vk::Device device, vk::DescriptorSet descriptorSet)
 		{
 			if (descriptorWrites.size() > 0)
 			{
+				for (auto& write : descriptorWrites)
+				{
+					write.setDstSet(descriptorSet);
+				}
 				device.updateDescriptorSets(descriptorWrites, {});
 			}
 		}
 	};
 
-	void ShaderBindingInstance::InitShaderBindingLayouts(CVulkanApplication& application
-		, ShaderCompilerSlang::ShaderReflectionData const& reflectionData)
+	bool ShaderBindingInstance::InitShaderBindingLayouts(CVulkanApplication& application
+		, IShaderSet const& shaderSet)
 	{
+		auto& reflectionData = shaderSet.GetShaderReflectionData(ShaderCompilerSlang::EShaderTargetType::eSpirV);
 		p_Application = &application;
 		p_ReflectionData = &reflectionData;
+		m_ShaderSetID = shaderSet.GetShaderSetID();
+		m_Valid = false;
 		m_DescriptorSetsLayouts.resize(reflectionData.m_BindingData.size());
 		m_DescriptorSetDescs.resize(reflectionData.m_BindingData.size());
 		for (int sid = 0; sid < reflectionData.m_BindingData.size(); ++sid)
 		{
 			auto& sourceSet = reflectionData.m_BindingData[sid];
+			if (sourceSet.m_Bindless)
+			{
+				//The space is bound to the global heap set, it must declare exactly what the heap layout provides
+				auto& bindlessHeap = application.GetGPUObjectManager().GetBindlessDescriptorHeap();
+				if (!bindlessHeap.Enabled())
+				{
+					CA_LOG_ERR("Shader " + shaderSet.GetUniqueName() + " uses bindless resources but the device does not support descriptor indexing");
+					return false;
+				}
+				if (!BindlessDescriptorHeap::IsCompatible(sourceSet))
+				{
+					CA_LOG_ERR("Shader " + shaderSet.GetUniqueName() + " declares a bindless space that does not match the bindless descriptor heap");
+					return false;
+				}
+				m_DescriptorSetDescs[sid] = bindlessHeap.GetDescriptorSetDesc();
+				m_DescriptorSetsLayouts[sid] = bindlessHeap.GetLayout();
+				continue;
+			}
 			uint32_t bindingCount = sourceSet.GetBindingCount();
 
 			DescriptorSetDesc descSetDesc;
@@ -85,7 +121,7 @@ namespace graphics_backend
 				DescriptorDesc bindingDesc;
 				bindingDesc.bindingIndex = uniformBuf.m_BindingIndex;
 				bindingDesc.arraySize = 1;
-				bindingDesc.descType = vk::DescriptorType::eUniformBuffer;
+				bindingDesc.descType = vk::DescriptorType::eUniformBufferDynamic;
 				descSetDesc.descs.push_back(bindingDesc);
 			}
 			for (auto& textureBinding : sourceSet.m_Textures)
@@ -116,159 +152,113 @@ namespace graphics_backend
 			m_DescriptorSetDescs[sid] = descSetDesc;
 			m_DescriptorSetsLayouts[sid] = descSetLayout->GetLayout();
 		}
+		m_Valid = true;
+		return true;
 	}
 
-	void ShaderBindingInstance::InitShaderBindingSets(FrameBoundResourcePool* pResourcePool)
+	void ShaderBindingInstance::InitShaderBindingSets()
 	{
+		//Sets are allocated when filled, from the descriptor set cache or from the frame pool
 		m_DescriptorSets.resize(p_ReflectionData->m_BindingData.size());
-		m_UniformBuffers.clear();
-		for (int sid = 0; sid < p_ReflectionData->m_BindingData.size(); ++sid)
-		{
-			auto& targetDescSet = m_DescriptorSets[sid];
-			auto& sourceSet = p_ReflectionData->m_BindingData[sid];
-			uint32_t bindingCount = sourceSet.GetBindingCount();
-
-			auto& descSetDesc = m_DescriptorSetDescs[sid];
-			auto descriptorPool = pResourcePool->descriptorPools.AquirePool();
-			auto descSetAllocator = descriptorPool->GetOrCreate(descSetDesc->GetPoolDesc());
-
-			auto layout = m_DescriptorSetsLayouts[sid];
-			targetDescSet = descSetAllocator->AllocateSet(layout);
-
-			if (!sourceSet.m_UniformBuffers.empty())
-			{
-				castl::vector<VKBufferObject> bufferObjects;
-				bufferObjects.reserve(sourceSet.m_UniformBuffers.size());
-				for (int ubid = 0; ubid < sourceSet.m_UniformBuffers.size(); ++ubid)
-				{
-					auto& sourceUniformBuffer = sourceSet.m_UniformBuffers[ubid];
-					auto bufferObject = pResourcePool->CreateBufferWithMemory(GPUBufferDescriptor::Create(
-						EBufferUsage::eConstantBuffer | EBufferUsage::eDataDst
-						, 1, sourceUniformBuffer.m_Groups[0].m_MemorySize), vk::MemoryPropertyFlagBits::eDeviceLocal);
-					bufferObjects.push_back(castl::move(bufferObject));
-				}
-				m_UniformBuffers.insert(castl::make_pair(sid, bufferObjects));
-			}
-		}
+		m_DynamicOffsets.clear();
+		m_PushConstantData.clear();
 	}
 
-	void ShaderBindingInstance::InitShaderBindings(CVulkanApplication& application, FrameBoundResourcePool* pResourcePool, ShaderCompilerSlang::ShaderReflectionData const& reflectionData)
+	//Textures and buffers set under the name of a uint uniform are written as their index in the bindless heap
+	struct BindlessIndexResolver
 	{
-		p_Application = &application;
-		p_ReflectionData = &reflectionData;
-		m_DescriptorSets.resize(reflectionData.m_BindingData.size());
-		m_DescriptorSetsLayouts.resize(reflectionData.m_BindingData.size());
-		for (int sid = 0; sid < reflectionData.m_BindingData.size(); ++sid)
-		{
-			auto& targetDescSet = m_DescriptorSets[sid];
-			auto& sourceSet = reflectionData.m_BindingData[sid];
-			uint32_t bindingCount = sourceSet.GetBindingCount();
-
-			DescriptorSetDesc descSetDesc;
-			descSetDesc.descs.reserve(bindingCount);
-			for (auto& uniformBuf : sourceSet.m_UniformBuffers)
-			{
-				DescriptorDesc bindingDesc;
-				bindingDesc.bindingIndex = uniformBuf.m_BindingIndex;
-				bindingDesc.arraySize = 1;
-				bindingDesc.descType = vk::DescriptorType::eUniformBuffer;
-				descSetDesc.descs.push_back(bindingDesc);
-			}
-			for (auto& textureBinding : sourceSet.m_Textures)
-			{
-				DescriptorDesc bindingDesc;
-				bindingDesc.bindingIndex = textureBinding.m_BindingIndex;
-				bindingDesc.arraySize = textureBinding.m_Count;
-				bindingDesc.descType = vk::DescriptorType::eSampledImage;
-				descSetDesc.descs.push_back(bindingDesc);
-			}
-			for (auto& samplerBinding : sourceSet.m_Samplers)
-			{
-				DescriptorDesc bindingDesc;
-				bindingDesc.bindingIndex = samplerBinding.m_BindingIndex;
-				bindingDesc.arraySize = samplerBinding.m_Count;
-				bindingDesc.descType = vk::DescriptorType::eSampler;
-				descSetDesc.descs.push_back(bindingDesc);
-			}
-			for (auto& storageBufferBinding : sourceSet.m_Buffers)
-			{
-				DescriptorDesc bindingDesc;
-				bindingDesc.bindingIndex = storageBufferBinding.m_BindingIndex;
-				bindingDesc.arraySize = storageBufferBinding.m_Count;
-				bindingDesc.descType = vk::DescriptorType::eStorageBuffer;
-				descSetDesc.descs.push_back(bindingDesc);
-			}
-			auto descSetLayout = application.GetGPUObjectManager().GetDescriptorSetLayoutCache().GetOrCreate(descSetDesc);
-			auto descriptorPool = pResourcePool->descriptorPools.AquirePool();
-			auto descSetAllocator = descriptorPool->GetOrCreate(descSetDesc.GetPoolDesc());
-
-			m_DescriptorSetsLayouts[sid] = descSetLayout->GetLayout();
-			targetDescSet = descSetAllocator->AllocateSet(descSetLayout->GetLayout());
+		BindlessDescriptorHeap& bindlessHeap;
+		ShadderResourceProvider& resourceProvider;
+		castl::vector<castl::pair<BufferHandle, ShaderCompilerSlang::EShaderResourceAccess>>& inoutBufferHandles;
+		castl::vector<castl::pair<ImageHandle, ShaderCompilerSlang::EShaderResourceAccess>>& inoutImageHandles;
 
-			if (!sourceSet.m_UniformBuffers.empty())
+		void WriteIndices(ShaderArgBindingPlan::BindlessIndexWrite const& indexWrite, char* dataDst)
+		{
+			uint32_t imageCount = indexWrite.pImages == nullptr ? 0 : indexWrite.pImages->size();
+			uint32_t bufferCount = indexWrite.pBuffers == nullptr ? 0 : indexWrite.pBuffers->size();
+			for (uint32_t elementID = 0; elementID < indexWrite.count; ++elementID)
 			{
-				castl::vector<VKBufferObject> bufferObjects;
-				bufferObjects.reserve(sourceSet.m_UniformBuffers.size());
-				for (int ubid = 0; ubid < sourceSet.m_UniformBuffers.size(); ++ubid)
+				uint32_t index = BindlessDescriptorHeap::INVALID_INDEX;
+				if (elementID < imageCount)
 				{
-					auto& sourceUniformBuffer = sourceSet.m_UniformBuffers[ubid];
-					auto bufferObject = pResourcePool->CreateBufferWithMemory(GPUBufferDescriptor::Create(
-						EBufferUsage::eConstantBuffer | EBufferUsage::eDataDst
-						, 1, sourceUniformBuffer.m_Groups[0].m_MemorySize), vk::MemoryPropertyFlagBits::eDeviceLocal);
-					bufferObjects.push_back(castl::move(bufferObject));
+					auto& imagePair = (*indexWrite.pImages)[elementID];
+					if (imagePair.first.GetType() == ImageHandle::ImageType::External)
+					{
+						auto texture = castl::static_shared_pointer_cast<VKGPUTexture>(imagePair.first.GetExternalManagedTexture());
+						index = bindlessHeap.GetTextureIndex(texture->GetImage().image, resourceProvider.GetImageView(imagePair.first, imagePair.second));
+						inoutImageHandles.push_back(castl::make_pair(imagePair.first, ShaderCompilerSlang::EShaderResourceAccess::eReadOnly));
+					}
+					else
+					{
+						CA_LOG_ERR("Only external textures can be referenced by bindless index");
+					}
+				}
+				else if (elementID < bufferCount)
+				{
+					auto& bufferHandle = (*indexWrite.pBuffers)[elementID];
+					if (bufferHandle.GetType() == BufferHandle::BufferType::External)
+					{
+						auto buffer = castl::static_shared_pointer_cast<VKGPUBuffer>(bufferHandle.GetExternalManagedBuffer());
+						index = bindlessHeap.GetBufferIndex(buffer->GetBuffer().buffer);
+						inoutBufferHandles.push_back(castl::make_pair(bufferHandle, ShaderCompilerSlang::EShaderResourceAccess::eReadWrite));
+					}
+					else
+					{
+						CA_LOG_ERR("Only external buffers can be referenced by bindless index");
+					}
 				}
-				m_UniformBuffers.insert(castl::make_pair(sid, bufferObjects));
+				else
+				{
+					break;
+				}
+				memcpy(dataDst + indexWrite.dstOffset + indexWrite.stride * elementID, &index, sizeof(uint32_t));
 			}
 		}
-	}
+	};
 
-	void WriteUniformBuffer(ShaderArgList const& shaderArgList
-		, ShaderCompilerSlang::UniformBufferData const& bufferData
-		, int32_t bufferGroupID
-		, char* dataDst)
+	void WriteUniformData(ShaderArgBindingPlan const& plan
+		, castl::vector<char*> const& uniformData
+		, BindlessIndexResolver& bindlessResolver)
 	{
-		auto& group = bufferData.m_Groups[bufferGroupID];
-		for (auto& element : group.m_Elements)
+		for (auto& uniformCopy : plan.m_UniformCopies)
 		{
-			if (auto pDataPos = shaderArgList.FindNumericDataPointer(element.m_Name))
+			char* dataDst = uniformData[uniformCopy.uniformBufferIndex];
+			for (uint32_t elementID = 0; elementID < uniformCopy.count; ++elementID)
 			{
-				//CA_LOG_ERR("Find Binding " + element.m_Name);
-				uint32_t memoryOffset = element.m_MemoryOffset;
-				for (uint32_t elementID = 0; elementID < element.m_ElementCount; ++elementID)
-				{
-					uint32_t elementOffset = memoryOffset + element.m_Stride * elementID;
-					memcpy(dataDst + elementOffset, pDataPos, element.m_ElementMemorySize);
-				}
+				memcpy(dataDst + uniformCopy.dstOffset + uniformCopy.stride * elementID, uniformCopy.pSrc, uniformCopy.size);
 			}
 		}
-		for (uint32_t subGroupID : group.m_SubGroups)
+		for (auto& indexWrite : plan.m_BindlessIndexWrites)
 		{
-			auto found = shaderArgList.FindSubArgList(bufferData.m_Groups[subGroupID].m_Name);
-			if (found)
-			{
-				WriteUniformBuffer(*found, bufferData, subGroupID, dataDst);
-			}
+			bindlessResolver.WriteIndices(indexWrite, uniformData[indexWrite.uniformBufferIndex]);
 		}
 	}
 
 	void WriteResources(CVulkanApplication& application
-		, ShaderArgList const& shaderArgList
+		, ShaderArgBindingPlan const& plan
 		, ShadderResourceProvider& resourceProvider
-		, ShaderCompilerSlang::ShaderBindingSpaceData const& bindingSpaceData
-		, int32_t resourceGroupID
 		, DescritprorWriter& writer
 		, castl::vector<castl::pair<BufferHandle, ShaderCompilerSlang::EShaderResourceAccess>>& inoutBufferHandles
 		, castl::vector<castl::pair<ImageHandle, ShaderCompilerSlang::EShaderResourceAccess>>& inoutImageHandles)
 	{
-		auto& currentGroup = bindingSpaceData.m_ResourceGroups[resourceGroupID];
-		for (uint32_t texID : currentGroup.m_Textures)
+		for (auto& textureSlot : plan.m_TextureSlots)
 		{
-			auto& textureData = bindingSpaceData.m_Textures[texID];
-			auto imageHandles = shaderArgList.FindImageHandle(textureData.m_Name);
+			auto& textureData = *textureSlot.pTextureData;
+			auto& imageHandles = *textureSlot.pImages;
 			for (uint32_t imgID = 0; imgID < imageHandles.size(); ++imgID)
 			{
 				inoutImageHandles.push_back(castl::make_pair(imageHandles[imgID].first, textureData.m_Access));
 				auto& imagePair = imageHandles[imgID];
+				if (imagePair.first.GetType() == ImageHandle::ImageType::External)
+				{
+					auto texture = castl::static_shared_pointer_cast<VKGPUTexture>(imagePair.first.GetExternalManagedTexture());
+					writer.referencedImages.push_back(texture->GetImage().image);
+				}
+				else
+				{
+					//Graph internal images and backbuffers are recycled every frame
+					writer.cacheable = false;
+				}
 				vk::ImageView imageView = resourceProvider.GetImageView(imagePair.first, imagePair.second);
 
 				vk::ImageLayout targetLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
@@ -289,142 +279,133 @@ namespace graphics_backend
 					, imgID);
 			}
 		}
-		for (uint32_t samplerID : currentGroup.m_Samplers)
+		for (auto& samplerSlot : plan.m_SamplerSlots)
 		{
-			auto& samplerData = bindingSpaceData.m_Samplers[samplerID];
-			auto samplerDescs = shaderArgList.FindSampler(samplerData.m_Name);
-			auto sampler = application.GetGPUObjectManager().GetTextureSamplerCache().GetOrCreate(samplerDescs);
-			writer.AddWriteSampler(sampler->GetSampler(), samplerData.m_BindingIndex);
+			auto sampler = application.GetGPUObjectManager().GetTextureSamplerCache().GetOrCreate(samplerSlot.pSampler != nullptr ? *samplerSlot.pSampler : TextureSamplerDescriptorObj{});
+			writer.AddWriteSampler(sampler->GetSampler(), samplerSlot.pSamplerData->m_BindingIndex);
 		}
-		for (uint32_t bufferID : currentGroup.m_Buffers)
+		for (auto& bufferSlot : plan.m_BufferSlots)
 		{
-			auto& bufferData = bindingSpaceData.m_Buffers[bufferID];
-			auto bufferHandles = shaderArgList.FindBufferHandle(bufferData.m_Name);
+			auto& bufferData = *bufferSlot.pBufferData;
+			auto& bufferHandles = *bufferSlot.pBuffers;
 			for (uint32_t bufID = 0; bufID < bufferHandles.size(); ++bufID)
 			{
 				inoutBufferHandles.push_back(castl::make_pair(bufferHandles[bufID], bufferData.m_Access));
+				if (bufferHandles[bufID].GetType() == BufferHandle::BufferType::External)
+				{
+					auto externalBuffer = castl::static_shared_pointer_cast<VKGPUBuffer>(bufferHandles[bufID].GetExternalManagedBuffer());
+					writer.referencedBuffers.push_back(externalBuffer->GetBuffer().buffer);
+				}
+				else
+				{
+					writer.cacheable = false;
+				}
 				vk::Buffer buffer = resourceProvider.GetBufferFromHandle(bufferHandles[bufID]);
 				writer.AddWriteBuffer(buffer, bufferData.m_BindingIndex, vk::DescriptorType::eStorageBuffer, bufID);
 			}
 		}
-
-		for (uint32_t subGroupID : currentGroup.m_SubGroups)
-		{
-			auto found = shaderArgList.FindSubArgList(bindingSpaceData.m_ResourceGroups[subGroupID].m_Name);
-			if (found)
-			{
-				WriteResources(application
-					, *found
-					, resourceProvider
-					, bindingSpaceData
-					, subGroupID
-					, writer
-					, inoutBufferHandles
-					, inoutImageHandles);
-			}
-		}
 	}
 
 	void ShaderBindingInstance::FillShaderData(CVulkanApplication& application
 		, ShadderResourceProvider& resourceProvider
 		, FrameBoundResourcePool* pResourcePool
-		, vk::CommandBuffer& command
 		, castl::vector <castl::pair <castl::string, castl::shared_ptr<ShaderArgList>>> const& shaderArgLists)
 	{
-		if (p_ReflectionData == nullptr)
+		if (p_ReflectionData == nullptr || !m_Valid)
 			return;
+		auto& gpuObjectManager = application.GetGPUObjectManager();
+		auto& bindlessHeap = gpuObjectManager.GetBindlessDescriptorHeap();
+		BindlessIndexResolver bindlessResolver{ bindlessHeap, resourceProvider, m_BufferHandles, m_ImageHandles };
+
+		//Push Constants
+		uint32_t pushConstantSize = p_ReflectionData->GetPushConstantSize();
+		m_PushConstantData.clear();
+		if (pushConstantSize > 0)
+		{
+			m_PushConstantData.resize(pushConstantSize);
+			auto plan = gpuObjectManager.GetShaderArgBindingCache().GetOrCompilePushConstants(m_ShaderSetID, p_ReflectionData->m_PushConstants, shaderArgLists, bindlessHeap.Enabled());
+			WriteUniformData(*plan, { reinterpret_cast<char*>(m_PushConstantData.data()) }, bindlessResolver);
+		}
+
+		m_DynamicOffsets.clear();
 		for (int sid = 0; sid < p_ReflectionData->m_BindingData.size(); ++sid)
 		{
 			DescritprorWriter writer;
 
 			auto& targetDescSet = m_DescriptorSets[sid];
 			auto& sourceSet = p_ReflectionData->m_BindingData[sid];
+			if (sourceSet.m_Bindless)
+			{
+				targetDescSet = bindlessHeap.GetDescriptorSet();
+				continue;
+			}
+
+			//Argument names are resolved against the reflection data once, until the argument lists change their structure
+			auto plan = gpuObjectManager.GetShaderArgBindingCache().GetOrCompile(m_ShaderSetID, sourceSet, shaderArgLists, bindlessHeap.Enabled());
 
-			writer.Initialize(targetDescSet, sourceSet.m_Textures.size(), sourceSet.m_Samplers.size(), sourceSet.m_UniformBuffers.size(), sourceSet.m_Buffers.size());
+			writer.Initialize(m_DescriptorSetsLayouts[sid], sourceSet.m_Textures.size(), sourceSet.m_Samplers.size(), sourceSet.m_UniformBuffers.size(), sourceSet.m_Buffers.size());
 
 			//Uniform Buffers
-			auto foundUniformBuffers = m_UniformBuffers.find(sid);
-			if (foundUniformBuffers != m_UniformBuffers.end())
+			if (!sourceSet.m_UniformBuffers.empty())
 			{
-				auto& uniformBuffers = foundUniformBuffers->second;
+				//Uniform blocks are sub-allocated from the frame arena, the set only binds the arena and stays cacheable
+				castl::vector<char*> uniformData;
+				castl::vector<castl::pair<uint32_t, uint32_t>> bindingOffsets;
+				uniformData.resize(sourceSet.m_UniformBuffers.size());
+				bindingOffsets.reserve(sourceSet.m_UniformBuffers.size());
 				for (int ubid = 0; ubid < sourceSet.m_UniformBuffers.size(); ++ubid)
 				{
 					auto& sourceUniformBuffer = sourceSet.m_UniformBuffers[ubid];
-					auto& bufferHandle = uniformBuffers[ubid];
-					auto& group = sourceUniformBuffer.m_Groups[0];
-					writer.AddWriteBuffer(bufferHandle.buffer, sourceUniformBuffer.m_BindingIndex, vk::DescriptorType::eUniformBuffer, 0);
-					vk::DeviceSize memorySize = group.m_MemorySize;
-					auto stageBuffer = pResourcePool->CreateStagingBuffer(memorySize, EBufferUsage::eDataSrc);
-
-					{
-						auto tmpMap = pResourcePool->memoryManager.ScopedMapMemory(stageBuffer.allocation);
-						for (auto shaderArgList : shaderArgLists)
-						{
-							if (shaderArgList.first == group.m_Name || (group.m_Name == "__Global" && shaderArgList.first.empty()))
-							{
-								WriteUniformBuffer(*shaderArgList.second, sourceUniformBuffer, 0, static_cast<char*>(tmpMap.mappedMemory));
-							}
-							//Global下的subgroup可以被认为是单独的资源组
-							else if (group.m_Name == "__Global")
-							{
-								for (uint32_t subgroupID : group.m_SubGroups)
-								{
-									auto& subgroup = sourceUniformBuffer.m_Groups[subgroupID];
-									if (subgroup.m_Name == shaderArgList.first)
-									{
-										WriteUniformBuffer(*shaderArgList.second, sourceUniformBuffer, subgroupID, static_cast<char*>(tmpMap.mappedMemory));
-									}
-								}
-							}
-						}
-					}
-					command.copyBuffer(stageBuffer.buffer, bufferHandle.buffer, vk::BufferCopy(0, 0, memorySize));
+					vk::DeviceSize memorySize = sourceUniformBuffer.m_Groups[0].m_MemorySize;
+					auto uniformAllocation = pResourcePool->uniformRingBuffer.Allocate(memorySize);
+					uniformData[ubid] = static_cast<char*>(uniformAllocation.pMappedData);
+					writer.AddWriteBuffer(uniformAllocation.buffer, sourceUniformBuffer.m_BindingIndex, vk::DescriptorType::eUniformBufferDynamic, 0, memorySize);
+					writer.referencedBuffers.push_back(uniformAllocation.buffer);
+					bindingOffsets.push_back(castl::make_pair(sourceUniformBuffer.m_BindingIndex, static_cast<uint32_t>(uniformAllocation.offset)));
+				}
+				WriteUniformData(*plan, uniformData, bindlessResolver);
+				//Dynamic offsets are consumed in binding order
+				castl::sort(bindingOffsets.begin(), bindingOffsets.end());
+				for (auto& bindingOffset : bindingOffsets)
+				{
+					m_DynamicOffsets.push_back(bindingOffset.second);
 				}
 			}
 
 			//Non Uniform Buffer Resources
-			if (!sourceSet.m_ResourceGroups.empty())
+			WriteResources(application
+				, *plan
+				, resourceProvider
+				, writer
+				, m_BufferHandles
+				, m_ImageHandles);
+
+			auto poolDesc = m_DescriptorSetDescs[sid]->GetPoolDesc();
+			if (writer.cacheable)
 			{
-				for (auto shaderArgList : shaderArgLists)
-				{
-					auto& group = sourceSet.m_ResourceGroups[0];
-					if (shaderArgList.first == group.m_Name || (group.m_Name == "__Global" && shaderArgList.first.empty()))
-					{
-						WriteResources(
-							application
-							, *shaderArgList.second
-							, resourceProvider
-							, sourceSet
-							, 0
-							, writer
-							, m_BufferHandles
-							, m_ImageHandles);
-					}
-					//Global下的subgroup可以被认为是单独的资源组
-					else if (group.m_Name == "__Global")
-					{
-						for (uint32_t subgroupID : group.m_SubGroups)
-						{
-							auto& subgroup = sourceSet.m_ResourceGroups[subgroupID];
-							if (subgroup.m_Name == shaderArgList.first)
-							{
-								WriteResources(
-									application
-									, *shaderArgList.second
-									, resourceProvider
-									, sourceSet
-									, subgroupID
-									, writer
-									, m_BufferHandles
-									, m_ImageHandles);
-							}
-						}
-					}
-				}
+				targetDescSet = gpuObjectManager.GetDescriptorSetCache().GetOrCreate(writer.cacheKey
+					, m_DescriptorSetsLayouts[sid]
+					, poolDesc
+					, writer.descriptorWrites
+					, writer.referencedImages
+					, writer.referencedBuffers);
+			}
+			else
+			{
+				auto descriptorPool = pResourcePool->descriptorPools.AquirePool();
+				targetDescSet = descriptorPool->GetOrCreate(poolDesc)->AllocateSet(m_DescriptorSetsLayouts[sid]);
+				writer.Apply(application.GetDevice(), targetDescSet);
 			}
-			writer.Apply(application.GetDevice());
 		}
 	}
 
+	void ShaderBindingInstance::BindShaderData(vk::CommandBuffer commandBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout) const
+	{
+		commandBuffer.bindDescriptorSets(bindPoint, pipelineLayout, 0, m_DescriptorSets, m_DynamicOffsets);
+		if (!m_PushConstantData.empty())
+		{
+			vk::ShaderStageFlags pushConstantStages = bindPoint == vk::PipelineBindPoint::eCompute ? vk::ShaderStageFlags{ vk::ShaderStageFlagBits::eCompute } : vk::ShaderStageFlagBits::eAllGraphics;
+			commandBuffer.pushConstants(pipelineLayout, pushConstantStages, 0, static_cast<uint32_t>(m_PushConstantData.size()), m_PushConstantData.data());
+		}
+	}
 }
-
@@ -1,6 +1,7 @@
 #pragma once
 #include "ShaderArgList.h"
 #include <Compiler.h>
+#include <ShaderProvider.h>
 #include <ResourcePool/FrameBoundResourcePool.h>
 #include <GPUResources/GPUResourceInternal.h>
 
@@ -16,19 +17,26 @@ namespace graphics_backend
 	class ShaderBindingInstance
 	{
 	public:
-		void InitShaderBindingLayouts(CVulkanApplication& application, ShaderCompilerSlang::ShaderReflectionData const& reflectionData);
-		void InitShaderBindingSets(FrameBoundResourcePool* pResourcePool);
-		void InitShaderBindings(CVulkanApplication& application, FrameBoundResourcePool* pResourcePool, ShaderCompilerSlang::ShaderReflectionData const& reflectionData);
+		//False when a binding space cannot be bound, the shader is not used then
+		bool InitShaderBindingLayouts(CVulkanApplication& application, IShaderSet const& shaderSet);
+		void InitShaderBindingSets();
 		void FillShaderData(CVulkanApplication& application
 			, ShadderResourceProvider& resourceProvider
 			, FrameBoundResourcePool* pResourcePool
-			, vk::CommandBuffer& command
 			, castl::vector <castl::pair <castl::string, castl::shared_ptr<ShaderArgList>>> const& shaderArgLists);
+		//Binds the filled sets with their dynamic uniform offsets and pushes the push constant block
+		void BindShaderData(vk::CommandBuffer commandBuffer, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout) const;
+		uint32_t GetPushConstantSize() const { return p_ReflectionData == nullptr ? 0 : p_ReflectionData->GetPushConstantSize(); }
 		castl::vector<vk::DescriptorSet> m_DescriptorSets;
 		castl::vector<vk::DescriptorSetLayout> m_DescriptorSetsLayouts;
 		castl::vector<cacore::HashObj<DescriptorSetDesc>> m_DescriptorSetDescs;
-		castl::map<uint32_t, castl::vector<VKBufferObject>> m_UniformBuffers;
+		//Offsets of the uniform blocks in the frame uniform arena, ordered by set and binding
+		castl::vector<uint32_t> m_DynamicOffsets;
+		castl::vector<uint8_t> m_PushConstantData;
 		ShaderCompilerSlang::ShaderReflectionData const* p_ReflectionData;
+		//Binding plans are cached by it, the reflection data address may be reused by another shader set
+		uint64_t m_ShaderSetID = 0;
+		bool m_Valid = false;
 		CVulkanApplication* p_Application;
 
 		//Collected Resources For Barrier Use
@@ -1,10 +1,16 @@
 #include "ComputePipelineObject.h"
+#include <GPUObjectManager.h>
 
 namespace graphics_backend
 {
 	void ComputePipelineObject::Create(ComputePipelineDescriptor const& computeshaderModule)
 	{
+		vk::PushConstantRange pushConstantRange{ vk::ShaderStageFlagBits::eCompute, 0, computeshaderModule.pushConstantSize };
 		vk::PipelineLayoutCreateInfo layoutCreateInfo{ {}, computeshaderModule.descriptorSetLayouts, {} };
+		if (pushConstantRange.size > 0)
+		{
+			layoutCreateInfo.setPushConstantRanges(pushConstantRange);
+		}
 		m_PipelineLayout = GetDevice().createPipelineLayout(layoutCreateInfo);
 
 		vk::PipelineShaderStageCreateInfo computeShaderStageInfo{};
@@ -18,7 +24,9 @@ namespace graphics_backend
 		pipelineCreateInfo.layout = m_PipelineLayout;
 		pipelineCreateInfo.flags = vk::PipelineCreateFlags{};
 
-		m_Pipeline = GetDevice().createComputePipeline(nullptr, pipelineCreateInfo).value;
+		auto& pipelineCache = GetGPUObjectManager().GetPersistentPipelineCache();
+		m_Pipeline = GetDevice().createComputePipeline(pipelineCache.GetPipelineCache(), pipelineCreateInfo).value;
+		pipelineCache.RecordComputePipeline(computeshaderModule);
 	}
 	void ComputePipelineObject::Release()
 	{
@@ -13,6 +13,7 @@ namespace graphics_backend
 	public:
 		castl::shared_ptr<CShaderModuleObject> computeShader = nullptr;
 		castl::vector<vk::DescriptorSetLayout> descriptorSetLayouts{};
+		uint32_t pushConstantSize = 0;
 		auto operator<=>(const ComputePipelineDescriptor&) const = default;
 	};
 
@@ -0,0 +1,367 @@
+#include "PersistentPipelineCache.h"
+#include <FileLoader.h>
+#include <Serialization.h>
+#include <Hasher.h>
+#include <CATimer/Timer.h>
+#include <VulkanApplication.h>
+#include <VulkanPipelineObject.h>
+#include <GPUObject/ComputePipelineObject.h>
+
+namespace graphics_backend
+{
+	namespace
+	{
+		constexpr uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x43505043;//CPPC
+		constexpr uint32_t PIPELINE_MANIFEST_FILE_MAGIC = 0x4D505043;//CPPM
+		//Bump when the layout of the manifest structs changes
+		constexpr uint32_t PIPELINE_MANIFEST_FILE_VERSION = 3;
+	}
+
+	PersistentPipelineCache::PersistentPipelineCache(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void PersistentPipelineCache::Initialize(castl::string const& cacheFilePath, castl::string const& manifestFilePath)
+	{
+		CPUTIMER_SCOPE("Load Pipeline Cache");
+		m_CacheFilePath = cacheFilePath;
+		m_ManifestFilePath = manifestFilePath;
+		castl::vector<uint8_t> cacheData = LoadPipelineCacheData();
+		vk::PipelineCacheCreateInfo cacheCreateInfo{ {}, cacheData.size(), cacheData.empty() ? nullptr : cacheData.data() };
+		m_PipelineCache = GetDevice().createPipelineCache(cacheCreateInfo);
+		LoadManifest();
+	}
+
+	void PersistentPipelineCache::Release()
+	{
+		if (m_PipelineCache != vk::PipelineCache{ nullptr })
+		{
+			SavePipelineCacheData();
+			SaveManifest();
+			GetDevice().destroyPipelineCache(m_PipelineCache);
+			m_PipelineCache = nullptr;
+		}
+		castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+		m_Manifest = {};
+		m_ShaderIndices.clear();
+		m_RecordedEntries.clear();
+	}
+
+	PersistentPipelineCache::PipelineCacheFileHeader PersistentPipelineCache::MakePipelineCacheFileHeader() const
+	{
+		auto properties = GetPhysicalDevice().getProperties();
+		PipelineCacheFileHeader header{};
+		header.magic = PIPELINE_CACHE_FILE_MAGIC;
+		header.version = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+		header.vendorID = properties.vendorID;
+		header.deviceID = properties.deviceID;
+		header.driverVersion = properties.driverVersion;
+		memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+		return header;
+	}
+
+	castl::vector<uint8_t> PersistentPipelineCache::LoadPipelineCacheData() const
+	{
+		castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(m_CacheFilePath);
+		if (fileData.size() < sizeof(PipelineCacheFileHeader))
+		{
+			return {};
+		}
+		PipelineCacheFileHeader fileHeader{};
+		memcpy(&fileHeader, fileData.data(), sizeof(PipelineCacheFileHeader));
+		PipelineCacheFileHeader expectedHeader = MakePipelineCacheFileHeader();
+		bool deviceMatch = fileHeader.magic == expectedHeader.magic
+			&& fileHeader.version == expectedHeader.version
+			&& fileHeader.vendorID == expectedHeader.vendorID
+			&& fileHeader.deviceID == expectedHeader.deviceID
+			&& fileHeader.driverVersion == expectedHeader.driverVersion
+			&& memcmp(fileHeader.pipelineCacheUUID, expectedHeader.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		if (!deviceMatch)
+		{
+			CA_LOG_ERR("Pipeline cache was created by another device or driver, it will be rebuilt");
+			return {};
+		}
+		uint8_t const* pCacheData = fileData.data() + sizeof(PipelineCacheFileHeader);
+		if (!cacore::verify_payload(fileHeader.dataSize, fileHeader.dataHash, pCacheData, fileData.size() - sizeof(PipelineCacheFileHeader)))
+		{
+			CA_LOG_ERR("Pipeline cache file is corrupted, it will be rebuilt");
+			return {};
+		}
+		return castl::vector<uint8_t>(pCacheData, pCacheData + fileHeader.dataSize);
+	}
+
+	void PersistentPipelineCache::SavePipelineCacheData() const
+	{
+		CPUTIMER_SCOPE("Save Pipeline Cache");
+		auto cacheData = GetDevice().getPipelineCacheData(m_PipelineCache);
+		PipelineCacheFileHeader fileHeader = MakePipelineCacheFileHeader();
+		fileHeader.dataSize = cacheData.size();
+		fileHeader.dataHash = cacore::hash_bytes(cacheData.data(), cacheData.size());
+		castl::vector<uint8_t> fileData(sizeof(PipelineCacheFileHeader) + cacheData.size());
+		memcpy(fileData.data(), &fileHeader, sizeof(PipelineCacheFileHeader));
+		if (!cacheData.empty())
+		{
+			memcpy(fileData.data() + sizeof(PipelineCacheFileHeader), cacheData.data(), cacheData.size());
+		}
+		cacore::WriteBinaryFile(m_CacheFilePath, fileData.data(), fileData.size());
+	}
+
+	void PersistentPipelineCache::LoadManifest()
+	{
+		castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(m_ManifestFilePath);
+		if (fileData.size() < sizeof(ManifestFileHeader))
+		{
+			return;
+		}
+		ManifestFileHeader fileHeader{};
+		memcpy(&fileHeader, fileData.data(), sizeof(ManifestFileHeader));
+		if (fileHeader.magic != PIPELINE_MANIFEST_FILE_MAGIC
+			|| fileHeader.version != PIPELINE_MANIFEST_FILE_VERSION
+			|| !cacore::verify_payload(fileHeader.dataSize, fileHeader.dataHash, fileData.data() + sizeof(ManifestFileHeader), fileData.size() - sizeof(ManifestFileHeader)))
+		{
+			CA_LOG_ERR("Pipeline manifest is outdated or corrupted, it will be rebuilt");
+			return;
+		}
+		PipelineManifest loadedManifest{};
+		cacore::deserialize(fileData, loadedManifest, sizeof(ManifestFileHeader));
+
+		castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+		m_Manifest = castl::move(loadedManifest);
+		for (uint32_t shaderID = 0; shaderID < m_Manifest.shaders.size(); ++shaderID)
+		{
+			m_ShaderIndices[m_Manifest.shaders[shaderID].sourceHash] = shaderID;
+		}
+		for (auto& entry : m_Manifest.graphicsPipelines)
+		{
+			castl::vector<uint8_t> entryData;
+			cacore::serialize(entryData, entry);
+			m_RecordedEntries.insert(cacore::hash_bytes(entryData.data(), entryData.size()));
+		}
+		for (auto& entry : m_Manifest.computePipelines)
+		{
+			castl::vector<uint8_t> entryData;
+			cacore::serialize(entryData, entry);
+			m_RecordedEntries.insert(cacore::hash_bytes(entryData.data(), entryData.size()));
+		}
+	}
+
+	void PersistentPipelineCache::SaveManifest() const
+	{
+		castl::vector<uint8_t> fileData(sizeof(ManifestFileHeader));
+		{
+			castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+			//Shader modules that never ended up in a pipeline are not worth keeping
+			PipelineManifest savedManifest{};
+			savedManifest.graphicsPipelines = m_Manifest.graphicsPipelines;
+			savedManifest.computePipelines = m_Manifest.computePipelines;
+			castl::unordered_set<uint64_t> usedShaders;
+			for (auto& entry : m_Manifest.graphicsPipelines)
+			{
+				usedShaders.insert(entry.vertexShader);
+				usedShaders.insert(entry.fragmentShader);
+			}
+			for (auto& entry : m_Manifest.computePipelines)
+			{
+				usedShaders.insert(entry.computeShader);
+			}
+			for (auto& shader : m_Manifest.shaders)
+			{
+				if (usedShaders.find(shader.sourceHash) != usedShaders.end())
+				{
+					savedManifest.shaders.push_back(shader);
+				}
+			}
+			cacore::serialize(fileData, savedManifest);
+		}
+		ManifestFileHeader fileHeader{};
+		fileHeader.magic = PIPELINE_MANIFEST_FILE_MAGIC;
+		fileHeader.version = PIPELINE_MANIFEST_FILE_VERSION;
+		fileHeader.dataSize = fileData.size() - sizeof(ManifestFileHeader);
+		fileHeader.dataHash = cacore::hash_bytes(fileData.data() + sizeof(ManifestFileHeader), fileHeader.dataSize);
+		memcpy(fileData.data(), &fileHeader, sizeof(ManifestFileHeader));
+		cacore::WriteBinaryFile(m_ManifestFilePath, fileData.data(), fileData.size());
+	}
+
+	void PersistentPipelineCache::RecordShader(uint64_t sourceHash, ShaderSourceInfo const& shaderSourceInfo)
+	{
+		castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+		if (m_ShaderIndices.find(sourceHash) != m_ShaderIndices.end())
+		{
+			return;
+		}
+		PipelineManifestShader newShader{};
+		newShader.sourceHash = sourceHash;
+		newShader.shaderType = shaderSourceInfo.compileShaderType;
+		newShader.entryPoint = shaderSourceInfo.entryPoint;
+		uint8_t const* pByteCode = static_cast<uint8_t const*>(shaderSourceInfo.dataPtr);
+		newShader.byteCode.assign(pByteCode, pByteCode + shaderSourceInfo.dataLength);
+		m_ShaderIndices[sourceHash] = static_cast<uint32_t>(m_Manifest.shaders.size());
+		m_Manifest.shaders.push_back(castl::move(newShader));
+	}
+
+	bool PersistentPipelineCache::TranslateDescriptorSetLayouts(castl::vector<vk::DescriptorSetLayout> const& layouts
+		, castl::vector<DescriptorSetDesc>& outDescs)
+	{
+		outDescs.clear();
+		outDescs.resize(layouts.size());
+		uint32_t foundCount = 0;
+		GetGPUObjectManager().GetDescriptorSetLayoutCache().Foreach([&](DescriptorSetDesc const& desc, DescriptorSetAllocator* allocator)
+			{
+				for (uint32_t layoutID = 0; layoutID < layouts.size(); ++layoutID)
+				{
+					if (layouts[layoutID] == allocator->GetLayout())
+					{
+						outDescs[layoutID] = desc;
+						++foundCount;
+					}
+				}
+			});
+		return foundCount == layouts.size();
+	}
+
+	template<typename EntryType>
+	void PersistentPipelineCache::AddManifestEntry(EntryType const& entry, castl::vector<EntryType>& inoutEntries)
+	{
+		castl::vector<uint8_t> entryData;
+		cacore::serialize(entryData, entry);
+		uint64_t entryHash = cacore::hash_bytes(entryData.data(), entryData.size());
+		castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+		if (m_RecordedEntries.insert(entryHash).second)
+		{
+			inoutEntries.push_back(entry);
+		}
+	}
+
+	void PersistentPipelineCache::RecordGraphicsPipeline(CPipelineObjectDescriptor const& descriptor)
+	{
+		GraphicsPipelineManifestEntry entry{};
+		if (!TranslateDescriptorSetLayouts(descriptor.descriptorSetLayouts, entry.descriptorSets))
+		{
+			return;
+		}
+		entry.pso = descriptor.pso;
+		entry.pushConstantSize = descriptor.pushConstantSize;
+		entry.assemblyStates = descriptor.vertexInputs.assemblyStates;
+		entry.vertexBindings.reserve(descriptor.vertexInputs.m_PrimitiveDescriptions.size());
+		for (auto& primitiveDesc : descriptor.vertexInputs.m_PrimitiveDescriptions)
+		{
+			entry.vertexBindings.push_back(PipelineManifestVertexBinding{
+				castl::get<0>(primitiveDesc)
+				, castl::get<2>(primitiveDesc)
+				, castl::get<1>(primitiveDesc) });
+		}
+		entry.vertexShader = descriptor.shaderState.vertexShader->GetSourceHash();
+		entry.fragmentShader = descriptor.shaderState.fragmentShader->GetSourceHash();
+		entry.renderPassInfo = descriptor.renderPassObject->GetDescriptor()->renderPassInfo;
+		entry.subpassIndex = descriptor.subpassIndex;
+		AddManifestEntry(entry, m_Manifest.graphicsPipelines);
+	}
+
+	void PersistentPipelineCache::RecordComputePipeline(ComputePipelineDescriptor const& descriptor)
+	{
+		ComputePipelineManifestEntry entry{};
+		if (!TranslateDescriptorSetLayouts(descriptor.descriptorSetLayouts, entry.descriptorSets))
+		{
+			return;
+		}
+		entry.computeShader = descriptor.computeShader->GetSourceHash();
+		entry.pushConstantSize = descriptor.pushConstantSize;
+		AddManifestEntry(entry, m_Manifest.computePipelines);
+	}
+
+	PipelineManifestShader const* PersistentPipelineCache::FindShader(PipelineManifest const& manifest, uint64_t sourceHash)
+	{
+		for (auto& shader : manifest.shaders)
+		{
+			if (shader.sourceHash == sourceHash)
+			{
+				return &shader;
+			}
+		}
+		return nullptr;
+	}
+
+	void PersistentPipelineCache::Prewarm(TaskScheduler* scheduler)
+	{
+		//Snapshot the manifest, pipelines created while prewarming are recorded again
+		auto manifest = castl::make_shared<PipelineManifest>();
+		{
+			castl::lock_guard<castl::mutex> guard(m_ManifestMutex);
+			*manifest = m_Manifest;
+		}
+		uint32_t graphicsPipelineCount = static_cast<uint32_t>(manifest->graphicsPipelines.size());
+		uint32_t pipelineCount = graphicsPipelineCount + static_cast<uint32_t>(manifest->computePipelines.size());
+		if (pipelineCount == 0)
+		{
+			return;
+		}
+		scheduler->NewTaskParallelFor()
+			->Name("Prewarm Pipelines")
+			->JobCount(pipelineCount)
+			->Functor([this, manifest, graphicsPipelineCount](uint32_t pipelineID)
+				{
+					if (pipelineID < graphicsPipelineCount)
+					{
+						PrewarmGraphicsPipeline(*manifest, manifest->graphicsPipelines[pipelineID]);
+					}
+					else
+					{
+						PrewarmComputePipeline(*manifest, manifest->computePipelines[pipelineID - graphicsPipelineCount]);
+					}
+				});
+	}
+
+	void PersistentPipelineCache::PrewarmGraphicsPipeline(PipelineManifest const& manifest, GraphicsPipelineManifestEntry const& entry)
+	{
+		CPUTIMER_SCOPE("Prewarm Graphics Pipeline");
+		auto pVertexShader = FindShader(manifest, entry.vertexShader);
+		auto pFragmentShader = FindShader(manifest, entry.fragmentShader);
+		if (pVertexShader == nullptr || pFragmentShader == nullptr)
+		{
+			return;
+		}
+		auto& gpuObjectManager = GetGPUObjectManager();
+		CPipelineObjectDescriptor descriptor{};
+		descriptor.pso = entry.pso;
+		descriptor.vertexInputs.assemblyStates = entry.assemblyStates;
+		for (auto& binding : entry.vertexBindings)
+		{
+			descriptor.vertexInputs.AddPrimitiveDescriptor(binding.stride, binding.attributes, binding.perInstance);
+		}
+		//Shader modules are keyed by source pointer in the module cache, so they are created standalone here
+		descriptor.shaderState.vertexShader = GetVulkanApplication().NewSubObject_Shared<CShaderModuleObject>(ShaderSourceInfo{
+			pVertexShader->shaderType, pVertexShader->byteCode.size(), pVertexShader->byteCode.data(), pVertexShader->entryPoint });
+		descriptor.shaderState.fragmentShader = GetVulkanApplication().NewSubObject_Shared<CShaderModuleObject>(ShaderSourceInfo{
+			pFragmentShader->shaderType, pFragmentShader->byteCode.size(), pFragmentShader->byteCode.data(), pFragmentShader->entryPoint });
+		//Layouts and render passes are shared with the frame graphs
+		for (auto& setDesc : entry.descriptorSets)
+		{
+			descriptor.descriptorSetLayouts.push_back(gpuObjectManager.GetDescriptorSetLayoutCache().GetOrCreate(setDesc)->GetLayout());
+		}
+		descriptor.renderPassObject = gpuObjectManager.GetRenderPassCache().GetOrCreate(RenderPassDescriptor{ entry.renderPassInfo });
+		descriptor.pushConstantSize = entry.pushConstantSize;
+		descriptor.subpassIndex = entry.subpassIndex;
+		//The pipeline is only needed for its side effect on the pipeline cache
+		GetVulkanApplication().NewSubObject_Shared<CPipelineObject>(descriptor);
+	}
+
+	void PersistentPipelineCache::PrewarmComputePipeline(PipelineManifest const& manifest, ComputePipelineManifestEntry const& entry)
+	{
+		CPUTIMER_SCOPE("Prewarm Compute Pipeline");
+		auto pComputeShader = FindShader(manifest, entry.computeShader);
+		if (pComputeShader == nullptr)
+		{
+			return;
+		}
+		auto& gpuObjectManager = GetGPUObjectManager();
+		ComputePipelineDescriptor descriptor{};
+		descriptor.computeShader = GetVulkanApplication().NewSubObject_Shared<CShaderModuleObject>(ShaderSourceInfo{
+			pComputeShader->shaderType, pComputeShader->byteCode.size(), pComputeShader->byteCode.data(), pComputeShader->entryPoint });
+		for (auto& setDesc : entry.descriptorSets)
+		{
+			descriptor.descriptorSetLayouts.push_back(gpuObjectManager.GetDescriptorSetLayoutCache().GetOrCreate(setDesc)->GetLayout());
+		}
+		descriptor.pushConstantSize = entry.pushConstantSize;
+		GetVulkanApplication().NewSubObject_Shared<ComputePipelineObject>(descriptor);
+	}
+}
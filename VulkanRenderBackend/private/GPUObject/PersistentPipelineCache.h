@@ -0,0 +1,127 @@
+#pragma once
+#include <ThreadManager.h>
+#include <ShaderProvider.h>
+#include <CPipelineStateObject.h>
+#include <CVertexInputDescriptor.h>
+#include <CNativeRenderPassInfo.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAString.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAUnorderedSet.h>
+#include <VulkanIncludes.h>
+#include <VulkanApplicationSubobjectBase.h>
+#include <DescriptorAllocation/DescriptorLayoutPool.h>
+
+namespace graphics_backend
+{
+	using namespace thread_management;
+	struct CPipelineObjectDescriptor;
+	struct ComputePipelineDescriptor;
+
+	//Portable form of pipeline descriptors, runtime descriptors reference shader modules, layouts and render passes by handle
+	struct PipelineManifestShader
+	{
+		uint64_t sourceHash = 0;
+		ECompileShaderType shaderType = ECompileShaderType::eVert;
+		castl::string entryPoint;
+		castl::vector<uint8_t> byteCode;
+	};
+
+	struct PipelineManifestVertexBinding
+	{
+		uint32_t stride = 0;
+		bool perInstance = false;
+		castl::vector<VertexAttribute> attributes;
+	};
+
+	struct GraphicsPipelineManifestEntry
+	{
+		CPipelineStateObject pso{};
+		InputAssemblyStates assemblyStates{};
+		castl::vector<PipelineManifestVertexBinding> vertexBindings;
+		uint64_t vertexShader = 0;
+		uint64_t fragmentShader = 0;
+		castl::vector<DescriptorSetDesc> descriptorSets;
+		uint32_t pushConstantSize = 0;
+		CRenderPassInfo renderPassInfo{};
+		uint32_t subpassIndex = 0;
+	};
+
+	struct ComputePipelineManifestEntry
+	{
+		uint64_t computeShader = 0;
+		castl::vector<DescriptorSetDesc> descriptorSets;
+		uint32_t pushConstantSize = 0;
+	};
+
+	struct PipelineManifest
+	{
+		castl::vector<PipelineManifestShader> shaders;
+		castl::vector<GraphicsPipelineManifestEntry> graphicsPipelines;
+		castl::vector<ComputePipelineManifestEntry> computePipelines;
+	};
+
+	//Owns the VkPipelineCache used by every pipeline creation and persists it between runs.
+	//The cache file is rejected when the vendor, device, driver version or pipeline cache uuid changed.
+	//Pipelines created during a run are recorded into a manifest, so that the next run can compile them on worker threads while loading
+	class PersistentPipelineCache : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		PersistentPipelineCache(CVulkanApplication& app);
+		void Initialize(castl::string const& cacheFilePath, castl::string const& manifestFilePath);
+		//Writes the cache and the manifest back to disk, pipelines created with the cache must be alive or already destroyed
+		void Release();
+		vk::PipelineCache GetPipelineCache() const { return m_PipelineCache; }
+
+		void RecordShader(uint64_t sourceHash, ShaderSourceInfo const& shaderSourceInfo);
+		void RecordGraphicsPipeline(CPipelineObjectDescriptor const& descriptor);
+		void RecordComputePipeline(ComputePipelineDescriptor const& descriptor);
+
+		//Compiles every pipeline of the manifest into the pipeline cache, first use of those pipelines on the frame thread becomes a cache hit
+		void Prewarm(TaskScheduler* scheduler);
+	private:
+		struct PipelineCacheFileHeader
+		{
+			uint32_t magic = 0;
+			uint32_t version = 0;
+			uint32_t vendorID = 0;
+			uint32_t deviceID = 0;
+			uint32_t driverVersion = 0;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE] = {};
+			uint64_t dataSize = 0;
+			uint64_t dataHash = 0;
+		};
+
+		struct ManifestFileHeader
+		{
+			uint32_t magic = 0;
+			uint32_t version = 0;
+			uint64_t dataSize = 0;
+			uint64_t dataHash = 0;
+		};
+
+		PipelineCacheFileHeader MakePipelineCacheFileHeader() const;
+		castl::vector<uint8_t> LoadPipelineCacheData() const;
+		void SavePipelineCacheData() const;
+		void LoadManifest();
+		void SaveManifest() const;
+
+		bool TranslateDescriptorSetLayouts(castl::vector<vk::DescriptorSetLayout> const& layouts, castl::vector<DescriptorSetDesc>& outDescs);
+		template<typename EntryType>
+		void AddManifestEntry(EntryType const& entry, castl::vector<EntryType>& inoutEntries);
+
+		static PipelineManifestShader const* FindShader(PipelineManifest const& manifest, uint64_t sourceHash);
+		void PrewarmGraphicsPipeline(PipelineManifest const& manifest, GraphicsPipelineManifestEntry const& entry);
+		void PrewarmComputePipeline(PipelineManifest const& manifest, ComputePipelineManifestEntry const& entry);
+
+		castl::string m_CacheFilePath;
+		castl::string m_ManifestFilePath;
+		vk::PipelineCache m_PipelineCache = nullptr;
+
+		mutable castl::mutex m_ManifestMutex;
+		PipelineManifest m_Manifest;
+		castl::unordered_map<uint64_t, uint32_t> m_ShaderIndices;
+		castl::unordered_set<uint64_t> m_RecordedEntries;
+	};
+}
@@ -1,26 +1,42 @@
 #include "pch.h"
 #include "GPUObjectManager.h"
+#include "RenderBackendSettings.h"
 
 namespace graphics_backend
 {
 	GPUObjectManager::GPUObjectManager(CVulkanApplication& app)
 		: VKAppSubObjectBaseNoCopy(app)
+		, m_PersistentPipelineCache(app)
 		, m_RenderPassCache(app)
 		, m_PipelineObjectCache(app)
 		, m_TextureSamplerCache(app)
 		, m_ShaderModuleCache(app)
 		, m_DescriptorSetLayoutCache(app)
 		, m_ComputePipelineCache(app)
+		, m_DescriptorSetCache(app)
+		, m_BindlessDescriptorHeap(app)
+		, m_ShaderArgBindingCache(app)
 	{
 	}
+	void GPUObjectManager::Initialize()
+	{
+		m_PersistentPipelineCache.Initialize(PIPELINE_CACHE_FILE_PATH, PIPELINE_MANIFEST_FILE_PATH);
+		m_PipelineCompileQueue.Initialize(PIPELINE_COMPILE_THREAD_COUNT, "Compile Pipeline");
+		m_BindlessDescriptorHeap.Initialize();
+	}
 	void GPUObjectManager::Release()
 	{
+		m_PipelineCompileQueue.Release();
+		m_ShaderArgBindingCache.Release();
 		m_TextureSamplerCache.ReleaseAll();
 		m_ShaderModuleCache.ReleaseAll();
+		m_DescriptorSetCache.Release();
+		m_BindlessDescriptorHeap.Release();
 		m_DescriptorSetLayoutCache.ReleaseAll();
 		m_PipelineObjectCache.ReleaseAll();
 		m_ComputePipelineCache.ReleaseAll();
 		m_RenderPassCache.ReleaseAll();
+		m_PersistentPipelineCache.Release();
 	}
 }
 
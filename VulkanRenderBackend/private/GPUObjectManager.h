@@ -6,7 +6,12 @@
 #include "FramebufferObject.h"
 #include "TextureSampler_Impl.h"
 #include <DescriptorAllocation/DescriptorLayoutPool.h>
+#include <DescriptorAllocation/DescriptorSetCache.h>
+#include <DescriptorAllocation/BindlessDescriptorHeap.h>
+#include <GPUGraphExecutor/ShaderArgBinding.h>
 #include <GPUObject/ComputePipelineObject.h>
+#include <GPUObject/PersistentPipelineCache.h>
+#include <Utilities/BackgroundTaskQueue.h>
 
 namespace graphics_backend
 {
@@ -14,19 +19,30 @@ namespace graphics_backend
 	{
 	public:
 		GPUObjectManager(CVulkanApplication& application);
+		void Initialize();
 		void Release();
 		RenderPassObjectDic& GetRenderPassCache() { return m_RenderPassCache; }
 		PipelineObjectDic& GetPipelineCache() { return m_PipelineObjectCache; }
 		TextureSamplerObjectDic& GetTextureSamplerCache() { return m_TextureSamplerCache; }
 		ComputePipelineObjectDic& GetComputePipelineCache() { return m_ComputePipelineCache; }
 		DescriptorSetAllocatorDic& GetDescriptorSetLayoutCache() { return m_DescriptorSetLayoutCache; }
+		DescriptorSetCache& GetDescriptorSetCache() { return m_DescriptorSetCache; }
+		BindlessDescriptorHeap& GetBindlessDescriptorHeap() { return m_BindlessDescriptorHeap; }
+		ShaderArgBindingCache& GetShaderArgBindingCache() { return m_ShaderArgBindingCache; }
 		ShaderModuleObjectDic& GetShaderModuleCache() { return m_ShaderModuleCache; }
+		PersistentPipelineCache& GetPersistentPipelineCache() { return m_PersistentPipelineCache; }
+		BackgroundTaskQueue& GetPipelineCompileQueue() { return m_PipelineCompileQueue; }
 	private:
+		PersistentPipelineCache m_PersistentPipelineCache;
+		BackgroundTaskQueue m_PipelineCompileQueue;
 		RenderPassObjectDic m_RenderPassCache;
 		PipelineObjectDic m_PipelineObjectCache;
 		TextureSamplerObjectDic m_TextureSamplerCache;
 		ComputePipelineObjectDic m_ComputePipelineCache;
 		ShaderModuleObjectDic m_ShaderModuleCache;
 		DescriptorSetAllocatorDic m_DescriptorSetLayoutCache;
+		DescriptorSetCache m_DescriptorSetCache;
+		BindlessDescriptorHeap m_BindlessDescriptorHeap;
+		ShaderArgBindingCache m_ShaderArgBindingCache;
 	};
 }
\ No newline at end of file
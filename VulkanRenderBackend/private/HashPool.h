@@ -2,10 +2,15 @@
 #include "VulkanApplicationSubobjectBase.h"
 #include <Hasher.h>
 #include <CASTL/CAMutex.h>
-#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAArray.h>
 #include <CASTL/CAFunctional.h>
+#include <CASTL/CAAtomic.h>
+#include <CASTL/CASharedPtr.h>
+#include <CASTL/CAUniquePtr.h>
 #include <DebugUtils.h>
 #include <Utilities/SubobjectTraits.h>
+#include <Utilities/BackgroundTaskQueue.h>
 
 namespace graphics_backend
 {
@@ -15,69 +20,246 @@ namespace graphics_backend
 		val.Create(desc);
 	};
 
+	//Shared state of a pooled object, the object is published once its creation finished
+	template<typename ValType>
+	struct HashPoolEntry
+	{
+		castl::atomic<bool> m_Ready{ false };
+		castl::shared_ptr<ValType> m_Object = nullptr;
+
+		bool IsReady() const { return m_Ready.load(castl::memory_order_acquire); }
+		//Only valid when ready
+		castl::shared_ptr<ValType> const& Get() const { return m_Object; }
+	};
+
+	template<typename ValType>
+	using HashPoolFuture = castl::shared_ptr<HashPoolEntry<ValType>>;
+
+	//Insert only concurrent cache of vulkan objects.
+	//Keys are spread over shards by hash, each shard is an open addressing table of immutable nodes,
+	//lookups of existing objects only read atomics, inserts lock their shard and publish a grown table when needed.
+	//Tables replaced by a grow stay alive until the pool is cleared, so readers never see freed memory
 	template<typename DescType, typename ValType>
 	requires has_create<ValType, DescType>
 	class HashPool : public VKAppSubObjectBaseNoCopy
 	{
 	public:
-
-		using map_type = castl::unordered_map<DescType, castl::shared_ptr<ValType>, cacore::hash<DescType>>;
+		using entry_type = HashPoolEntry<ValType>;
+		using key_type = cacore::HashObj<DescType>;
 
 		HashPool() = delete;
 		HashPool(HashPool const& other) = delete;
 		HashPool& operator=(HashPool const&) = delete;
 		HashPool(HashPool&& other) noexcept : VKAppSubObjectBaseNoCopy(other.GetVulkanApplication())
 		{
-			castl::lock_guard<castl::mutex> lockGuard(other.m_Mutex);
-			m_InternalMap = castl::move(other.m_InternalMap);
+			for (uint32_t shardID = 0; shardID < SHARD_COUNT; ++shardID)
+			{
+				auto& srcShard = other.m_Shards[shardID];
+				auto& dstShard = m_Shards[shardID];
+				castl::lock_guard<castl::mutex> lockGuard(srcShard.m_WriteMutex);
+				dstShard.m_Table.store(srcShard.m_Table.exchange(nullptr));
+				dstShard.m_Tables = castl::move(srcShard.m_Tables);
+				dstShard.m_Nodes = castl::move(srcShard.m_Nodes);
+			}
 		}
 		HashPool& operator=(HashPool&&) = delete;
 
 		HashPool(CVulkanApplication& application) : VKAppSubObjectBaseNoCopy(application)
 		{}
 
+		//Objects are created outside of the shard lock, threads asking for an object that is being created wait for it
 		castl::shared_ptr<ValType> GetOrCreate(DescType const& desc, castl::string const& name = "")
 		{
-			castl::shared_ptr<ValType> result = nullptr;
+			return GetOrCreateHashed(desc, cacore::hash<DescType>{}(desc));
+		}
+
+		//Keys with a precomputed hash skip hashing the whole descriptor
+		castl::shared_ptr<ValType> GetOrCreate(key_type const& key)
+		{
+			return GetOrCreateHashed(key.Get(), key.Valid() ? key.GetHash() : cacore::hash<DescType>{}(key.Get()));
+		}
+
+		//Queues creation of a missing object on the background queue and returns immediately
+		HashPoolFuture<ValType> GetOrCreateAsync(DescType const& desc, BackgroundTaskQueue& backgroundQueue)
+		{
+			bool newEntry = false;
+			auto& entry = FindOrAddEntry(desc, cacore::hash<DescType>{}(desc), newEntry);
+			if (newEntry)
 			{
-				castl::lock_guard<castl::mutex> lockGuard(m_Mutex);
-				auto mapEnd = m_InternalMap.end();
-				auto it = m_InternalMap.find(desc);
-				if (it != mapEnd)
-				{
-					result = it->second;
-				}
-				else
-				{
-					result = GetVulkanApplication().NewSubObject_Shared<ValType>(desc);
-					it = m_InternalMap.insert(castl::make_pair(desc, result)).first;
-				}
+				backgroundQueue.Enqueue([this, entry, desc]()
+					{
+						CreateEntry(entry, desc);
+					});
 			}
-			return result;
+			return entry;
 		}
 
 		void Foreach(castl::function<void(DescType const&, ValType*)> callbackFunc)
 		{
-			castl::lock_guard<castl::mutex> lockGuard(m_Mutex);
-			for (auto& it : m_InternalMap)
+			for (auto& shard : m_Shards)
 			{
-				callbackFunc(it.first, it.second.get());
-			};
+				castl::lock_guard<castl::mutex> lockGuard(shard.m_WriteMutex);
+				for (auto& node : shard.m_Nodes)
+				{
+					if (node->entry->IsReady())
+					{
+						callbackFunc(node->desc, node->entry->Get().get());
+					}
+				}
+			}
 		}
 
 		void ReleaseAll() requires has_release<ValType>
 		{
-			castl::lock_guard<castl::mutex> lockGuard(m_Mutex);
-			m_InternalMap.clear();
+			Clear();
 		}
 
+		//Must not run concurrently with lookups
 		void Clear()
 		{
-			castl::lock_guard<castl::mutex> lockGuard(m_Mutex);
-			m_InternalMap.clear();
+			for (auto& shard : m_Shards)
+			{
+				castl::lock_guard<castl::mutex> lockGuard(shard.m_WriteMutex);
+				shard.m_Table.store(nullptr, castl::memory_order_release);
+				shard.m_Tables.clear();
+				shard.m_Nodes.clear();
+			}
 		}
 	private:
-		castl::mutex m_Mutex;
-		castl::unordered_map<DescType, castl::shared_ptr<ValType>, cacore::hash<DescType>> m_InternalMap;
+		static constexpr uint32_t SHARD_COUNT = 16;
+		static constexpr uint32_t SHARD_INDEX_SHIFT = 60;
+		static constexpr uint32_t INITIAL_TABLE_CAPACITY = 16;
+
+		struct Node
+		{
+			uint64_t hash;
+			DescType desc;
+			castl::shared_ptr<entry_type> entry;
+		};
+
+		struct Table
+		{
+			uint32_t capacity = 0;
+			castl::unique_ptr<castl::atomic<Node*>[]> slots;
+
+			Table(uint32_t inCapacity) : capacity(inCapacity), slots(new castl::atomic<Node*>[inCapacity])
+			{
+				for (uint32_t i = 0; i < capacity; ++i)
+				{
+					slots[i].store(nullptr, castl::memory_order_relaxed);
+				}
+			}
+
+			Node* Find(DescType const& desc, uint64_t hash) const
+			{
+				uint32_t mask = capacity - 1;
+				for (uint32_t slotID = static_cast<uint32_t>(hash) & mask; ; slotID = (slotID + 1) & mask)
+				{
+					Node* node = slots[slotID].load(castl::memory_order_acquire);
+					if (node == nullptr)
+					{
+						return nullptr;
+					}
+					if (node->hash == hash && node->desc == desc)
+					{
+						return node;
+					}
+				}
+			}
+
+			void Insert(Node* node)
+			{
+				uint32_t mask = capacity - 1;
+				uint32_t slotID = static_cast<uint32_t>(node->hash) & mask;
+				while (slots[slotID].load(castl::memory_order_relaxed) != nullptr)
+				{
+					slotID = (slotID + 1) & mask;
+				}
+				slots[slotID].store(node, castl::memory_order_release);
+			}
+		};
+
+		struct Shard
+		{
+			castl::atomic<Table*> m_Table{ nullptr };
+			castl::mutex m_WriteMutex;
+			//Current and retired tables
+			castl::vector<castl::unique_ptr<Table>> m_Tables;
+			castl::vector<castl::unique_ptr<Node>> m_Nodes;
+		};
+
+		castl::shared_ptr<ValType> GetOrCreateHashed(DescType const& desc, uint64_t hash)
+		{
+			bool newEntry = false;
+			auto& entry = FindOrAddEntry(desc, hash, newEntry);
+			if (newEntry)
+			{
+				CreateEntry(entry, desc);
+			}
+			else if (!entry->IsReady())
+			{
+				castl::unique_lock<castl::mutex> lock(m_ReadyMutex);
+				m_ReadyCondition.wait(lock, [&entry]() { return entry->IsReady(); });
+			}
+			return entry->Get();
+		}
+
+		static Node* FindNode(Shard const& shard, DescType const& desc, uint64_t hash)
+		{
+			Table* table = shard.m_Table.load(castl::memory_order_acquire);
+			return table == nullptr ? nullptr : table->Find(desc, hash);
+		}
+
+		castl::shared_ptr<entry_type> const& FindOrAddEntry(DescType const& desc, uint64_t hash, bool& outNewEntry)
+		{
+			outNewEntry = false;
+			auto& shard = m_Shards[hash >> SHARD_INDEX_SHIFT];
+			if (Node* node = FindNode(shard, desc, hash))
+			{
+				return node->entry;
+			}
+
+			castl::lock_guard<castl::mutex> lockGuard(shard.m_WriteMutex);
+			if (Node* node = FindNode(shard, desc, hash))
+			{
+				return node->entry;
+			}
+			outNewEntry = true;
+			shard.m_Nodes.push_back(castl::unique_ptr<Node>(new Node{ hash, desc, castl::make_shared<entry_type>() }));
+			Node* newNode = shard.m_Nodes.back().get();
+
+			//Keep the load factor under one half so that probes always end on an empty slot
+			Table* table = shard.m_Table.load(castl::memory_order_relaxed);
+			if (table == nullptr || shard.m_Nodes.size() * 2 > table->capacity)
+			{
+				uint32_t newCapacity = table == nullptr ? INITIAL_TABLE_CAPACITY : table->capacity * 2;
+				auto newTable = castl::unique_ptr<Table>(new Table(newCapacity));
+				for (auto& node : shard.m_Nodes)
+				{
+					newTable->Insert(node.get());
+				}
+				shard.m_Table.store(newTable.get(), castl::memory_order_release);
+				shard.m_Tables.push_back(castl::move(newTable));
+			}
+			else
+			{
+				table->Insert(newNode);
+			}
+			return newNode->entry;
+		}
+
+		void CreateEntry(castl::shared_ptr<entry_type> const& entry, DescType const& desc)
+		{
+			entry->m_Object = GetVulkanApplication().NewSubObject_Shared<ValType>(desc);
+			{
+				castl::lock_guard<castl::mutex> lockGuard(m_ReadyMutex);
+				entry->m_Ready.store(true, castl::memory_order_release);
+			}
+			m_ReadyCondition.notify_all();
+		}
+
+		castl::array<Shard, SHARD_COUNT> m_Shards;
+		castl::mutex m_ReadyMutex;
+		castl::condition_variable m_ReadyCondition;
 	};
-}
\ No newline at end of file
+}
@@ -25,6 +25,8 @@ namespace graphics_backend
 		case VertexInputFormat::eR8G8B8A8_UNorm: return vk::Format::eR8G8B8A8Unorm;
 		case VertexInputFormat::eR32_UInt: return vk::Format::eR32Uint;
 		case VertexInputFormat::eR32_SInt: return vk::Format::eR32Sint;
+		case VertexInputFormat::eR16G16_SFloat: return vk::Format::eR16G16Sfloat;
+		case VertexInputFormat::eR8G8B8A8_SNorm: return vk::Format::eR8G8B8A8Snorm;
 		default: return vk::Format::eR32Sfloat;
 		}
 	}
@@ -97,6 +99,22 @@ namespace graphics_backend
 				return vk::Format::eR32Sfloat;
 			case ETextureFormat::E_R32G32B32A32_SFLOAT:
 				return vk::Format::eR32G32B32A32Sfloat;
+			case ETextureFormat::E_R8G8B8A8_SRGB:
+				return vk::Format::eR8G8B8A8Srgb;
+			case ETextureFormat::E_BC1_RGBA_UNORM:
+				return vk::Format::eBc1RgbaUnormBlock;
+			case ETextureFormat::E_BC1_RGBA_SRGB:
+				return vk::Format::eBc1RgbaSrgbBlock;
+			case ETextureFormat::E_BC3_UNORM:
+				return vk::Format::eBc3UnormBlock;
+			case ETextureFormat::E_BC3_SRGB:
+				return vk::Format::eBc3SrgbBlock;
+			case ETextureFormat::E_BC5_UNORM:
+				return vk::Format::eBc5UnormBlock;
+			case ETextureFormat::E_BC7_UNORM:
+				return vk::Format::eBc7UnormBlock;
+			case ETextureFormat::E_BC7_SRGB:
+				return vk::Format::eBc7SrgbBlock;
 			case ETextureFormat::E_D32_SFLOAT:
 				return vk::Format::eD32Sfloat;
 			case ETextureFormat::E_D32_SFLOAT_S8_UINT:
@@ -109,7 +127,8 @@ namespace graphics_backend
 
 
 
-	constexpr vk::BufferImageCopy GPUTextureDescriptorToBufferImageCopy(GPUTextureDescriptor const& descriptor)
+	//Copy of one whole mip of every layer, data of the mip starts at bufferOffset
+	constexpr vk::BufferImageCopy GPUTextureDescriptorToBufferImageCopy(GPUTextureDescriptor const& descriptor, uint32_t mipLevel = 0)
 	{
 		bool isDepthOnly = IsDepthOnlyFormat(descriptor.format);
 		bool isDepthStencil = IsDepthStencilFormat(descriptor.format);
@@ -128,13 +147,13 @@ namespace graphics_backend
 		{
 			result.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
 		}
-		result.imageSubresource.mipLevel = 0;
+		result.imageSubresource.mipLevel = mipLevel;
 		result.imageSubresource.baseArrayLayer = 0;
 		result.imageSubresource.layerCount = is3D ? 1 : descriptor.layers;
 		result.bufferImageHeight = 0;
 		result.bufferOffset = 0;
 		result.imageOffset = vk::Offset3D{ 0, 0, 0 };
-		result.imageExtent = vk::Extent3D(descriptor.width, descriptor.height, is3D ? descriptor.layers : 1);
+		result.imageExtent = vk::Extent3D(descriptor.GetMipWidth(mipLevel), descriptor.GetMipHeight(mipLevel), is3D ? descriptor.GetMipLayers(mipLevel) : 1);
 		return result;
 	}
 
@@ -252,6 +271,22 @@ namespace graphics_backend
 			return ETextureFormat::E_R32_SFLOAT;
 		case vk::Format::eR32G32B32A32Sfloat:
 			return ETextureFormat::E_R32G32B32A32_SFLOAT;
+		case vk::Format::eR8G8B8A8Srgb:
+			return ETextureFormat::E_R8G8B8A8_SRGB;
+		case vk::Format::eBc1RgbaUnormBlock:
+			return ETextureFormat::E_BC1_RGBA_UNORM;
+		case vk::Format::eBc1RgbaSrgbBlock:
+			return ETextureFormat::E_BC1_RGBA_SRGB;
+		case vk::Format::eBc3UnormBlock:
+			return ETextureFormat::E_BC3_UNORM;
+		case vk::Format::eBc3SrgbBlock:
+			return ETextureFormat::E_BC3_SRGB;
+		case vk::Format::eBc5UnormBlock:
+			return ETextureFormat::E_BC5_UNORM;
+		case vk::Format::eBc7UnormBlock:
+			return ETextureFormat::E_BC7_UNORM;
+		case vk::Format::eBc7SrgbBlock:
+			return ETextureFormat::E_BC7_SRGB;
 		case vk::Format::eD32Sfloat:
 			return ETextureFormat::E_D32_SFLOAT;
 		case vk::Format::eD32SfloatS8Uint:
@@ -540,6 +575,8 @@ namespace graphics_backend
 			return vk::BufferUsageFlagBits::eTransferDst;
 		case EBufferUsage::eDataSrc:
 			return vk::BufferUsageFlagBits::eTransferSrc;
+		case EBufferUsage::eIndirectBuffer:
+			return vk::BufferUsageFlagBits::eIndirectBuffer;
 		default: return vk::BufferUsageFlagBits::eUniformBuffer;
 		}
 	}
@@ -4,9 +4,34 @@
 namespace graphics_backend
 {
 	constexpr uint32_t FRAMEBOUND_RESOURCE_POOL_SWAP_COUNT_PER_CONTEXT = 3;
+	//Frame bound resource pools of the frame context, at most this many frames are in flight
+	constexpr uint32_t FRAMEBOUND_RESOURCE_POOL_COUNT = 4;
 	constexpr uint32_t SWAPCHAIN_BUFFER_COUNT = 3;
 	using FrameType = uint64_t;
 	constexpr FrameType INVALID_FRAMEID = (castl::numeric_limits<FrameType>::max)();
+	//Render passes with enough draw batches are recorded into secondary command buffers in parallel
+	constexpr uint32_t MIN_DRAW_BATCHES_PER_SECONDARY_COMMAND = 128;
+	constexpr uint32_t MAX_SECONDARY_COMMANDS_PER_RENDER_PASS = 8;
+	//Initial size of the persistently mapped per frame staging ring, it grows when a frame overflows it
+	constexpr uint64_t STAGING_RING_BUFFER_INITIAL_SIZE = 16ull * 1024ull * 1024ull;
+	//Initial size of the per frame uniform arena, uniform blocks are sub-allocated from it and bound with dynamic offsets
+	constexpr uint64_t UNIFORM_RING_BUFFER_INITIAL_SIZE = 4ull * 1024ull * 1024ull;
+	//Async uploads on the transfer queue never keep more than the staging budget in flight, copies are split into chunks
+	constexpr uint64_t ASYNC_UPLOAD_STAGING_BUDGET = 64ull * 1024ull * 1024ull;
+	constexpr uint64_t ASYNC_UPLOAD_CHUNK_SIZE = 4ull * 1024ull * 1024ull;
+	//Driver pipeline cache and the manifest of pipelines created in previous runs, relative to the working directory
+	constexpr char const* PIPELINE_CACHE_FILE_PATH = "VulkanPipelineCache.bin";
+	constexpr char const* PIPELINE_MANIFEST_FILE_PATH = "VulkanPipelineManifest.bin";
+	//Graphics pipelines missing from the cache are compiled on background threads, their draw batches are skipped until ready
+	constexpr uint32_t PIPELINE_COMPILE_THREAD_COUNT = 2;
+	//Descriptor sets that only reference persistent resources are cached across frames, sets unused for the retire frame count are freed
+	constexpr uint32_t DESCRIPTOR_SET_CACHE_RETIRE_FRAME_COUNT = 8;
+	constexpr uint32_t DESCRIPTOR_SET_CACHE_SETS_PER_POOL = 64;
+	//Slots of the global bindless descriptor set, clamped to the update after bind limits of the device
+	constexpr uint32_t BINDLESS_TEXTURE_CAPACITY = 16384;
+	constexpr uint32_t BINDLESS_BUFFER_CAPACITY = 16384;
+	//Shader argument lists resolved against reflection data are dropped after being unused for this many frames
+	constexpr uint32_t SHADER_ARG_BINDING_RETIRE_FRAME_COUNT = 8;
 
 	static castl::vector<const char*> GetInstanceExtensionNames()
 	{
@@ -68,6 +68,11 @@ namespace graphics_backend
 		return m_CommandBufferPools[m_QueueTypeToPoolIndex[uenum::enumToInt(QueueType::eGraphics)]].AllocSecondaryCommandBuffer(GetDevice(), cmdName);
 	}
 
+	vk::CommandBuffer OneTimeCommandBufferPool::AllocSecondaryCommand(vk::CommandBufferInheritanceInfo const& inheritanceInfo, const char* cmdName)
+	{
+		return m_CommandBufferPools[m_QueueTypeToPoolIndex[uenum::enumToInt(QueueType::eGraphics)]].AllocSecondaryCommandBuffer(GetDevice(), cmdName, &inheritanceInfo);
+	}
+
 
 	void OneTimeCommandBufferPool::ResetCommandBufferPool()
 	{
@@ -96,9 +101,9 @@ namespace graphics_backend
 		return AllocateOnetimeCommandBufferInternal(device, cmdName, m_PrimaryCommandBuffers, vk::CommandBufferLevel::ePrimary);
 	}
 
-	vk::CommandBuffer OneTimeCommandBufferPool::SubCommandBufferPool::AllocSecondaryCommandBuffer(vk::Device device, const char* cmdName)
+	vk::CommandBuffer OneTimeCommandBufferPool::SubCommandBufferPool::AllocSecondaryCommandBuffer(vk::Device device, const char* cmdName, vk::CommandBufferInheritanceInfo const* pInheritanceInfo)
 	{
-		return AllocateOnetimeCommandBufferInternal(device, cmdName, m_SecondaryCommandBuffers, vk::CommandBufferLevel::eSecondary);
+		return AllocateOnetimeCommandBufferInternal(device, cmdName, m_SecondaryCommandBuffers, vk::CommandBufferLevel::eSecondary, pInheritanceInfo);
 	}
 
 
@@ -106,7 +111,8 @@ namespace graphics_backend
 		vk::Device device
 		, const char* cmdName
 		, CommandBufferList& manageList
-		, vk::CommandBufferLevel commandLevel)
+		, vk::CommandBufferLevel commandLevel
+		, vk::CommandBufferInheritanceInfo const* pInheritanceInfo)
 	{
 		vk::CommandBuffer result;
 		if (!manageList.TryGetNextCommandBuffer(result))
@@ -119,7 +125,12 @@ namespace graphics_backend
 			manageList.AddNewCommandBuffer(result);
 		}
 		SetVKObjectDebugName(device, result, cmdName);
-		result.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+		vk::CommandBufferUsageFlags usageFlags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		if (pInheritanceInfo != nullptr && pInheritanceInfo->renderPass != vk::RenderPass{ nullptr })
+		{
+			usageFlags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+		}
+		result.begin(vk::CommandBufferBeginInfo(usageFlags, pInheritanceInfo));
 		return result;
 	}
 
@@ -16,6 +16,8 @@ namespace graphics_backend
 		vk::CommandBuffer AllocCommand(QueueType queueType, const char* cmdName = "Default Cmd");
 		vk::CommandBuffer AllocCommand(uint32_t queueFamilyID, const char* cmdName = "Default Cmd");
 		vk::CommandBuffer AllocSecondaryCommand(const char* cmdName = "Default Cmd");
+		//Secondary command buffer continuing a render pass begun in a primary command buffer
+		vk::CommandBuffer AllocSecondaryCommand(vk::CommandBufferInheritanceInfo const& inheritanceInfo, const char* cmdName = "Default Cmd");
 		void ResetCommandBufferPool();
 	private:
 		friend class CommandBufferThreadPool;
@@ -54,8 +56,9 @@ namespace graphics_backend
 			CommandBufferList m_PrimaryCommandBuffers;
 			CommandBufferList m_SecondaryCommandBuffers;
 			vk::CommandBuffer AllocPrimaryCommandBuffer(vk::Device device, const char* cmdName);
-			vk::CommandBuffer AllocSecondaryCommandBuffer(vk::Device device, const char* cmdName);
-			vk::CommandBuffer AllocateOnetimeCommandBufferInternal(vk::Device device, const char* cmdName, CommandBufferList& manageList, vk::CommandBufferLevel commandLevel);
+			vk::CommandBuffer AllocSecondaryCommandBuffer(vk::Device device, const char* cmdName, vk::CommandBufferInheritanceInfo const* pInheritanceInfo = nullptr);
+			vk::CommandBuffer AllocateOnetimeCommandBufferInternal(vk::Device device, const char* cmdName, CommandBufferList& manageList, vk::CommandBufferLevel commandLevel
+				, vk::CommandBufferInheritanceInfo const* pInheritanceInfo = nullptr);
 			void ResetCommandBufferPool(vk::Device device);
 			void Release(vk::Device device);
 		};
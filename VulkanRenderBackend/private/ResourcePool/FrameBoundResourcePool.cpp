@@ -1,6 +1,8 @@
 #include "Platform.h"
 #include "FrameBoundResourcePool.h"
 #include <VulkanDebug.h>
+#include <VulkanApplication.h>
+#include <RenderBackendSettings.h>
 
 namespace graphics_backend
 {
@@ -13,6 +15,10 @@ namespace graphics_backend
 		, framebufferObjectCache(app)
 		, descriptorPools(app)
 		, semaphorePool(app)
+		, eventPool(app)
+		, timestampQueryPool(app)
+		, stagingRingBuffer(app, memoryManager)
+		, uniformRingBuffer(app, memoryManager)
 		, m_GraphExecutorManager(app)
 	{
 	}
@@ -25,12 +31,19 @@ namespace graphics_backend
 		, framebufferObjectCache(castl::move(other.framebufferObjectCache))
 		, descriptorPools(castl::move(other.descriptorPools))
 		, semaphorePool(castl::move(other.semaphorePool))
+		, eventPool(castl::move(other.eventPool))
+		, timestampQueryPool(castl::move(other.timestampQueryPool))
+		, stagingRingBuffer(castl::move(other.stagingRingBuffer), memoryManager)
+		, uniformRingBuffer(castl::move(other.uniformRingBuffer), memoryManager)
 		, m_GraphExecutorManager(castl::move(other.m_GraphExecutorManager))
 	{
 	}
 	void FrameBoundResourcePool::Initialize()
 	{
 		memoryManager.Initialize();
+		timestampQueryPool.Initialize();
+		stagingRingBuffer.Initialize(STAGING_RING_BUFFER_INITIAL_SIZE);
+		uniformRingBuffer.Initialize(UNIFORM_RING_BUFFER_INITIAL_SIZE, vk::BufferUsageFlagBits::eUniformBuffer, "Uniform Ring Buffer");
 		vk::FenceCreateInfo info{};
 		info.flags = vk::FenceCreateFlagBits::eSignaled;
 		m_Fence = GetDevice().createFence(info);
@@ -39,11 +52,15 @@ namespace graphics_backend
 	{
 		framebufferObjectCache.ReleaseAll();
 		commandBufferThreadPool.ReleasePool();
+		stagingRingBuffer.Release();
+		uniformRingBuffer.Release();
 		memoryManager.Release();
 		releaseQueue.ReleaseGlobalResources();
 		resourceObjectManager.Release();
 		descriptorPools.ReleasePool();
 		semaphorePool.Release();
+		eventPool.Release();
+		timestampQueryPool.Release();
 		m_GraphExecutorManager.Release();
 		GetDevice().destroyFence(m_Fence);
 	}
@@ -54,10 +71,22 @@ namespace graphics_backend
 		framebufferObjectCache.ReleaseAll();
 		commandBufferThreadPool.ResetPool();
 		memoryManager.FreeAllMemory();
+		stagingRingBuffer.Reset();
+		uniformRingBuffer.Reset();
 		releaseQueue.ReleaseGlobalResources();
 		resourceObjectManager.DestroyAll();
 		descriptorPools.ResetPool();
+		GetGPUObjectManager().GetDescriptorSetCache().NextFrame();
+		GetGPUObjectManager().GetShaderArgBindingCache().NextFrame();
 		semaphorePool.Reset();
+		eventPool.Reset();
+		if (m_HasBarrierStatistics)
+		{
+			m_BarrierStatistics.stallTimeMS = timestampQueryPool.ResolveAndReset();
+			GetVulkanApplication().UpdateBarrierStatistics(m_BarrierStatistics);
+			m_BarrierStatistics = {};
+			m_HasBarrierStatistics = false;
+		}
 		m_GraphExecutorManager.Reset();
 	}
 	VKBufferObject FrameBoundResourcePool::CreateStagingBuffer(size_t size, EBufferUsageFlags usages, castl::string const& name)
@@ -108,4 +137,9 @@ namespace graphics_backend
 			m_LeafStageFlags.push_back(vk::PipelineStageFlagBits::eAllCommands);
 		}
 	}
+	void FrameBoundResourcePool::AddBarrierStatistics(BarrierStatistics const& statistics)
+	{
+		m_BarrierStatistics += statistics;
+		m_HasBarrierStatistics = true;
+	}
 }
\ No newline at end of file
@@ -6,10 +6,12 @@
 #include "GPUMemoryManager.h"
 #include "ResourceReleaseQueue.h"
 #include "GPUResourceObjectManager.h"
+#include "StagingRingBuffer.h"
 #include "GraphExecutorManager.h"
 #include <DescriptorAllocation/DescriptorLayoutPool.h>
 #include <FramebufferObject.h>
 #include <CASTL/CAMutex.h>
+#include <VulkanBarrierCollector.h>
 
 namespace graphics_backend
 {
@@ -31,6 +33,7 @@ namespace graphics_backend
 
 		void FinalizeSubmit();
 		void AddLeafSempahores(vk::ArrayProxy<vk::Semaphore> semaphores);
+		void AddBarrierStatistics(BarrierStatistics const& statistics);
 	public:
 		CommandBufferThreadPool commandBufferThreadPool;
 		GPUMemoryResourceManager memoryManager;
@@ -39,6 +42,11 @@ namespace graphics_backend
 		GlobalResourceReleaseQueue releaseQueue;
 		DescriptorSetThreadPool descriptorPools;
 		SemaphorePool semaphorePool;
+		EventPool eventPool;
+		TimestampQueryPool timestampQueryPool;
+		StagingRingBuffer stagingRingBuffer;
+		//Linear arena of the uniform data written by the frame, bound with dynamic offsets
+		StagingRingBuffer uniformRingBuffer;
 	private:
 		vk::Fence m_Fence;
 
@@ -47,12 +55,18 @@ namespace graphics_backend
 		castl::vector<vk::Semaphore> m_LeafSemaphores;
 		castl::vector<vk::PipelineStageFlags> m_LeafStageFlags;
 
+		//Barrier statistics of the frame, stall time is resolved once the frame fence is signaled
+		BarrierStatistics m_BarrierStatistics;
+		bool m_HasBarrierStatistics = false;
+
 		static_assert(std::move_constructible<CommandBufferThreadPool>, "CommandBufferThreadPool Shoule Be Movable");
 		static_assert(std::move_constructible<GPUMemoryResourceManager>, "GPUMemoryResourceManager Shoule Be Movable");
 		static_assert(std::move_constructible<GPUResourceObjectManager>, "GPUResourceObjectManager Shoule Be Movable");
 		static_assert(std::move_constructible<GlobalResourceReleaseQueue>, "GlobalResourceReleaseQueue Shoule Be Movable");
 		static_assert(std::move_constructible<DescriptorSetThreadPool>, "DescriptorSetThreadPool Shoule Be Movable");
 		static_assert(std::move_constructible<SemaphorePool>, "SemaphorePool Shoule Be Movable");
+		static_assert(std::move_constructible<EventPool>, "EventPool Shoule Be Movable");
+		static_assert(std::move_constructible<TimestampQueryPool>, "TimestampQueryPool Shoule Be Movable");
 		static_assert(std::move_constructible<GraphExecutorManager>, "GraphExecutorManager Shoule Be Movable");
 		static_assert(std::move_constructible<FramebufferObjectDic>, "FramebufferObjectDic Shoule Be Movable");
 	};
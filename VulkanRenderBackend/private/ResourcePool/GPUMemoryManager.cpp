@@ -12,6 +12,10 @@ namespace graphics_backend
 		castl::lock_guard<castl::mutex> guard(other.m_Mutex);
 		m_Allocator = castl::move(other.m_Allocator);
 		m_ActiveAllocations = castl::move(other.m_ActiveAllocations);
+		m_PersistentAllocations = castl::move(other.m_PersistentAllocations);
+		m_ImageAllocations = castl::move(other.m_ImageAllocations);
+		m_ImageBytes = other.m_ImageBytes;
+		m_BufferBytes = other.m_BufferBytes;
 	}
 	void GPUMemoryResourceManager::Initialize()
 	{
@@ -29,20 +33,29 @@ namespace graphics_backend
 		FreeAllMemory();
 		{
 			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			for (auto itrAllocation : m_PersistentAllocations)
+			{
+				vmaFreeMemory(m_Allocator, itrAllocation);
+			}
+			m_PersistentAllocations.clear();
 			vmaDestroyAllocator(m_Allocator);
 		}
 	}
 	VmaAllocation GPUMemoryResourceManager::AllocateMemory(vk::Image image, vk::MemoryPropertyFlags memoryProperties)
 	{
 		auto requirements = GetDevice().getImageMemoryRequirements(image);
-		return AllocateMemory(requirements, memoryProperties);
+		return AllocateMemory(requirements, memoryProperties, true);
 	}
 	VmaAllocation GPUMemoryResourceManager::AllocateMemory(vk::Buffer buffer, vk::MemoryPropertyFlags memoryProperties)
 	{
 		auto requirements = GetDevice().getBufferMemoryRequirements(buffer);
-		return AllocateMemory(requirements, memoryProperties);
+		return AllocateMemory(requirements, memoryProperties, false);
 	}
 	VmaAllocation GPUMemoryResourceManager::AllocateMemory(vk::MemoryRequirements const& memoryReqs, vk::MemoryPropertyFlags memoryProperties)
+	{
+		return AllocateMemory(memoryReqs, memoryProperties, false);
+	}
+	VmaAllocation GPUMemoryResourceManager::AllocateMemory(vk::MemoryRequirements const& memoryReqs, vk::MemoryPropertyFlags memoryProperties, bool image)
 	{
 		VmaAllocation alloc = nullptr;
 		{
@@ -53,6 +66,15 @@ namespace graphics_backend
 			VmaAllocationInfo allocationInfo{};
 			VKResultCheck(vmaAllocateMemory(m_Allocator, &req, &allocCreateInfo, &alloc, &allocationInfo));
 			m_ActiveAllocations.insert(alloc);
+			if (image)
+			{
+				m_ImageAllocations.insert(alloc);
+				m_ImageBytes += allocationInfo.size;
+			}
+			else
+			{
+				m_BufferBytes += allocationInfo.size;
+			}
 		}
 		return alloc;
 	}
@@ -93,7 +115,7 @@ namespace graphics_backend
 		if (found != m_ActiveAllocations.end())
 		{
 			m_ActiveAllocations.erase(found);
-			vmaFreeMemory(m_Allocator, allocation);
+			FreeAllocation(allocation);
 		}
 	}
 	void GPUMemoryResourceManager::FreeAllMemory()
@@ -101,10 +123,69 @@ namespace graphics_backend
 		castl::lock_guard<castl::mutex> guard(m_Mutex);
 		for (auto itrAllocation : m_ActiveAllocations)
 		{
-			vmaFreeMemory(m_Allocator, itrAllocation);
+			FreeAllocation(itrAllocation);
 		}
 		m_ActiveAllocations.clear();
 	}
+	void GPUMemoryResourceManager::FreeAllocation(VmaAllocation allocation)
+	{
+		VmaAllocationInfo allocationInfo{};
+		vmaGetAllocationInfo(m_Allocator, allocation, &allocationInfo);
+		if (m_ImageAllocations.erase(allocation) > 0)
+		{
+			m_ImageBytes -= allocationInfo.size;
+		}
+		else
+		{
+			m_BufferBytes -= allocationInfo.size;
+		}
+		vmaFreeMemory(m_Allocator, allocation);
+	}
+	VmaAllocation GPUMemoryResourceManager::AllocatePersistentMemory(vk::Buffer buffer, vk::MemoryPropertyFlags memoryProperties)
+	{
+		VkMemoryRequirements req = GetDevice().getBufferMemoryRequirements(buffer);
+		VmaAllocation alloc = nullptr;
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			VmaAllocationCreateInfo allocCreateInfo = {};
+			allocCreateInfo.preferredFlags = static_cast<VkMemoryPropertyFlags>(memoryProperties);
+			VmaAllocationInfo allocationInfo{};
+			VKResultCheck(vmaAllocateMemory(m_Allocator, &req, &allocCreateInfo, &alloc, &allocationInfo));
+			m_PersistentAllocations.insert(alloc);
+			m_BufferBytes += allocationInfo.size;
+		}
+		return alloc;
+	}
+	void GPUMemoryResourceManager::FreePersistentMemory(VmaAllocation const& allocation)
+	{
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		auto found = m_PersistentAllocations.find(allocation);
+		if (found != m_PersistentAllocations.end())
+		{
+			m_PersistentAllocations.erase(found);
+			FreeAllocation(allocation);
+		}
+	}
+	GPUMemoryStatistics GPUMemoryResourceManager::GetMemoryStatistics()
+	{
+		GPUMemoryStatistics result{};
+		castl::lock_guard<castl::mutex> guard(m_Mutex);
+		result.textureBytes = m_ImageBytes;
+		result.bufferBytes = m_BufferBytes;
+		VkPhysicalDeviceMemoryProperties const* pMemoryProperties = nullptr;
+		vmaGetMemoryProperties(m_Allocator, &pMemoryProperties);
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(m_Allocator, budgets);
+		for (uint32_t heapID = 0; heapID < pMemoryProperties->memoryHeapCount; ++heapID)
+		{
+			if (pMemoryProperties->memoryHeaps[heapID].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				result.deviceLocalUsage += budgets[heapID].usage;
+				result.deviceLocalBudget += budgets[heapID].budget;
+			}
+		}
+		return result;
+	}
 	MapMemoryScope::~MapMemoryScope()
 	{
 		p_Manager->UnmapMemory(m_Allocation);
@@ -1,6 +1,7 @@
 #pragma once
 #include <GPUTexture.h>
 #include <GPUBuffer.h>
+#include <CRenderBackend.h>
 #include <VulkanIncludes.h>
 #include <CASTL/CASet.h>
 #include <VMA.h>
@@ -41,9 +42,21 @@ namespace graphics_backend
 		void BindMemory(vk::Buffer buffer, VmaAllocation allocation);
 		void FreeMemory(VmaAllocation const& allocation);
 		void FreeAllMemory();
+		//Persistent allocations survive FreeAllMemory, they are only freed explicitly or when the manager is released
+		VmaAllocation AllocatePersistentMemory(vk::Buffer buffer, vk::MemoryPropertyFlags memoryProperties);
+		void FreePersistentMemory(VmaAllocation const& allocation);
+		//Bytes of the active image and buffer allocations, persistent allocations count as buffers
+		GPUMemoryStatistics GetMemoryStatistics();
 	private:
+		VmaAllocation AllocateMemory(vk::MemoryRequirements const& memoryReqs, vk::MemoryPropertyFlags memoryProperties, bool image);
+		void FreeAllocation(VmaAllocation allocation);
+
 		castl::mutex m_Mutex;
 		VmaAllocator m_Allocator {nullptr};
 		castl::set<VmaAllocation> m_ActiveAllocations;
+		castl::set<VmaAllocation> m_PersistentAllocations;
+		castl::set<VmaAllocation> m_ImageAllocations;
+		uint64_t m_ImageBytes = 0;
+		uint64_t m_BufferBytes = 0;
 	};
 }
@@ -151,4 +151,135 @@ namespace graphics_backend
 		return m_Semaphores[m_SemaphoreIndex++];
 	}
 	
+
+	EventPool::EventPool(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	void EventPool::Release()
+	{
+		for (auto& event : m_Events)
+		{
+			GetDevice().destroyEvent(event);
+		}
+		m_Events.clear();
+		m_EventIndex = 0;
+	}
+
+	void EventPool::Reset()
+	{
+		for (uint32_t eventID = 0; eventID < m_EventIndex; ++eventID)
+		{
+			GetDevice().resetEvent(m_Events[eventID]);
+		}
+		m_EventIndex = 0;
+	}
+
+	vk::Event EventPool::AllocEvent()
+	{
+		if (m_EventIndex == m_Events.size())
+		{
+			vk::EventCreateInfo createInfo{};
+			m_Events.push_back(GetDevice().createEvent(createInfo));
+		}
+		return m_Events[m_EventIndex++];
+	}
+
+	TimestampQueryPool::TimestampQueryPool(CVulkanApplication& app) : VKAppSubObjectBaseNoCopy(app)
+	{
+	}
+
+	TimestampQueryPool::TimestampQueryPool(TimestampQueryPool&& other) noexcept : VKAppSubObjectBaseNoCopy(std::move(other))
+		, m_QueryPool(other.m_QueryPool)
+		, m_MaxQueryPairCount(other.m_MaxQueryPairCount)
+		, m_QueryPairIndex(other.m_QueryPairIndex.load())
+		, m_QueueFamilyTimestampBits(castl::move(other.m_QueueFamilyTimestampBits))
+	{
+		other.m_QueryPool = nullptr;
+		other.m_MaxQueryPairCount = 0;
+	}
+
+	void TimestampQueryPool::Initialize(uint32_t maxQueryPairCount)
+	{
+		auto queueFamilyProperties = GetPhysicalDevice().getQueueFamilyProperties();
+		m_QueueFamilyTimestampBits.resize(queueFamilyProperties.size());
+		for (size_t familyID = 0; familyID < queueFamilyProperties.size(); ++familyID)
+		{
+			m_QueueFamilyTimestampBits[familyID] = queueFamilyProperties[familyID].timestampValidBits;
+		}
+		m_MaxQueryPairCount = maxQueryPairCount;
+		vk::QueryPoolCreateInfo createInfo({}, vk::QueryType::eTimestamp, m_MaxQueryPairCount * 2);
+		m_QueryPool = GetDevice().createQueryPool(createInfo);
+		GetDevice().resetQueryPool(m_QueryPool, 0, m_MaxQueryPairCount * 2);
+		m_QueryPairIndex = 0;
+	}
+
+	void TimestampQueryPool::Release()
+	{
+		if (m_QueryPool != vk::QueryPool{ nullptr })
+		{
+			GetDevice().destroyQueryPool(m_QueryPool);
+			m_QueryPool = nullptr;
+		}
+		m_QueryPairIndex = 0;
+	}
+
+	double TimestampQueryPool::ResolveAndReset()
+	{
+		uint32_t usedPairCount = castl::min(m_QueryPairIndex.load(), m_MaxQueryPairCount);
+		if (usedPairCount == 0)
+		{
+			return 0.0;
+		}
+		castl::vector<uint64_t> timestamps;
+		timestamps.resize(usedPairCount * 2);
+		auto result = GetDevice().getQueryPoolResults(m_QueryPool, 0, usedPairCount * 2
+			, timestamps.size() * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t)
+			, vk::QueryResultFlagBits::e64);
+		double elapsedMS = 0.0;
+		if (result == vk::Result::eSuccess)
+		{
+			double timestampPeriod = GetPhysicalDevice().getProperties().limits.timestampPeriod;
+			for (uint32_t pairID = 0; pairID < usedPairCount; ++pairID)
+			{
+				uint64_t begin = timestamps[pairID * 2];
+				uint64_t end = timestamps[pairID * 2 + 1];
+				if (end > begin)
+				{
+					elapsedMS += (end - begin) * timestampPeriod * 1e-6;
+				}
+			}
+		}
+		GetDevice().resetQueryPool(m_QueryPool, 0, usedPairCount * 2);
+		m_QueryPairIndex = 0;
+		return elapsedMS;
+	}
+
+	uint32_t TimestampQueryPool::BeginQuery(vk::CommandBuffer commandBuffer, uint32_t queueFamily)
+	{
+		if (m_QueryPool == vk::QueryPool{ nullptr }
+			|| queueFamily >= m_QueueFamilyTimestampBits.size()
+			|| m_QueueFamilyTimestampBits[queueFamily] == 0)
+		{
+			return INVALID_QUERY;
+		}
+		uint32_t queryPairID = m_QueryPairIndex.fetch_add(1);
+		if (queryPairID >= m_MaxQueryPairCount)
+		{
+			return INVALID_QUERY;
+		}
+		//Written once the queue front reaches the barrier
+		commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, m_QueryPool, queryPairID * 2);
+		return queryPairID;
+	}
+
+	void TimestampQueryPool::EndQuery(vk::CommandBuffer commandBuffer, uint32_t queryPairID)
+	{
+		if (queryPairID == INVALID_QUERY)
+		{
+			return;
+		}
+		//Written once all the work the barrier waits on has drained
+		commandBuffer.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, m_QueryPool, queryPairID * 2 + 1);
+	}
 }
\ No newline at end of file
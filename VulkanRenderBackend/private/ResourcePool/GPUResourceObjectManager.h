@@ -8,6 +8,7 @@
 #include <VulkanApplicationSubobjectBase.h>
 #include <CASTL/CAUnorderedMap.h>
 #include <CASTL/CAMap.h>
+#include <CASTL/CAAtomic.h>
 
 namespace graphics_backend
 {
@@ -49,4 +50,36 @@ namespace graphics_backend
 		castl::vector<vk::Semaphore> m_Semaphores;
 		uint32_t m_SemaphoreIndex = 0;
 	};
+
+	class EventPool : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		EventPool(CVulkanApplication& app);
+		void Release();
+		void Reset();
+		vk::Event AllocEvent();
+	private:
+		castl::vector<vk::Event> m_Events;
+		uint32_t m_EventIndex = 0;
+	};
+
+	//Pairs of timestamps written around barriers, used to measure how long the queue stalls on them
+	class TimestampQueryPool : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		static constexpr uint32_t INVALID_QUERY = (castl::numeric_limits<uint32_t>::max)();
+		TimestampQueryPool(CVulkanApplication& app);
+		TimestampQueryPool(TimestampQueryPool&& other) noexcept;
+		void Initialize(uint32_t maxQueryPairCount = 512);
+		void Release();
+		//Returns elapsed time of all query pairs in milliseconds and resets the pool, fence of the frame must be signaled
+		double ResolveAndReset();
+		uint32_t BeginQuery(vk::CommandBuffer commandBuffer, uint32_t queueFamily);
+		void EndQuery(vk::CommandBuffer commandBuffer, uint32_t queryPairID);
+	private:
+		vk::QueryPool m_QueryPool = nullptr;
+		uint32_t m_MaxQueryPairCount = 0;
+		castl::atomic<uint32_t> m_QueryPairIndex{ 0 };
+		castl::vector<uint32_t> m_QueueFamilyTimestampBits;
+	};
 }
@@ -1,6 +1,7 @@
 #include "ResourceReleaseQueue.h"
 #include "GPUMemoryManager.h"
 #include "GPUResourceObjectManager.h"
+#include <GPUObjectManager.h>
 
 namespace graphics_backend
 {
@@ -16,6 +17,22 @@ namespace graphics_backend
 	void GlobalResourceReleaseQueue::ReleaseGlobalResources()
 	{
 		castl::lock_guard<castl::mutex> thisLock(m_Mutex);
+		{
+			castl::vector<vk::Image> releasingImages;
+			castl::vector<vk::Buffer> releasingBuffers;
+			releasingImages.reserve(m_PendingImages.size());
+			releasingBuffers.reserve(m_PendingBuffers.size());
+			for (auto& image : m_PendingImages)
+			{
+				releasingImages.push_back(image.image);
+			}
+			for (auto& buffer : m_PendingBuffers)
+			{
+				releasingBuffers.push_back(buffer.buffer);
+			}
+			GetGPUObjectManager().GetDescriptorSetCache().ReleaseSetsReferencing(releasingImages, releasingBuffers);
+			GetGPUObjectManager().GetBindlessDescriptorHeap().ReleaseResources(releasingImages, releasingBuffers);
+		}
 		for (auto& buffer : m_PendingBuffers)
 		{
 			GetGlobalResourceObjectManager().DestroyBuffer(buffer.buffer);
@@ -0,0 +1,178 @@
+#include "StagingRingBuffer.h"
+#include "GPUMemoryManager.h"
+#include <VulkanDebug.h>
+#include <VulkanApplication.h>
+#include <GPUObjectManager.h>
+#include <CASTL/CAAlgorithm.h>
+
+namespace graphics_backend
+{
+	namespace
+	{
+		constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	StagingRingBuffer::StagingRingBuffer(CVulkanApplication& app, GPUMemoryResourceManager& memoryManager) :
+		VKAppSubObjectBaseNoCopy(app)
+		, p_MemoryManager(&memoryManager)
+	{
+	}
+
+	StagingRingBuffer::StagingRingBuffer(StagingRingBuffer&& other, GPUMemoryResourceManager& memoryManager) noexcept : VKAppSubObjectBaseNoCopy(std::move(other))
+		, p_MemoryManager(&memoryManager)
+		, m_Usage(other.m_Usage)
+		, m_Name(other.m_Name)
+		, m_MinAlignment(other.m_MinAlignment)
+		, m_Ring(other.m_Ring)
+		, m_RingOffset(other.m_RingOffset.load())
+		, m_OverflowPages(castl::move(other.m_OverflowPages))
+		, m_OverflowPageOffset(other.m_OverflowPageOffset)
+		, m_OverflowBytes(other.m_OverflowBytes)
+	{
+		other.m_Ring = {};
+	}
+
+	void StagingRingBuffer::Initialize(uint64_t initialSize, vk::BufferUsageFlags usage, const char* name)
+	{
+		m_Usage = usage;
+		m_Name = name;
+		auto limits = GetPhysicalDevice().getProperties().limits;
+		//Buffer to image copies need offsets aligned to 4 and to the texel block size, 16 covers all uncompressed and block compressed formats
+		m_MinAlignment = castl::max(castl::max(uint64_t(16), static_cast<uint64_t>(limits.optimalBufferCopyOffsetAlignment))
+			, static_cast<uint64_t>(limits.nonCoherentAtomSize));
+		if (m_Usage & vk::BufferUsageFlagBits::eUniformBuffer)
+		{
+			m_MinAlignment = castl::max(m_MinAlignment, static_cast<uint64_t>(limits.minUniformBufferOffsetAlignment));
+		}
+		m_Ring = CreatePage(initialSize);
+		m_RingOffset = 0;
+	}
+
+	void StagingRingBuffer::Release()
+	{
+		castl::lock_guard<castl::mutex> guard(m_OverflowMutex);
+		DestroyPage(m_Ring);
+		for (auto& page : m_OverflowPages)
+		{
+			DestroyPage(page);
+		}
+		m_OverflowPages.clear();
+		m_OverflowPageOffset = 0;
+		m_OverflowBytes = 0;
+		m_RingOffset = 0;
+	}
+
+	void StagingRingBuffer::Reset()
+	{
+		castl::lock_guard<castl::mutex> guard(m_OverflowMutex);
+		if (m_OverflowBytes > 0)
+		{
+			//Grow the ring so that the next frame with the same upload volume fits without overflow pages
+			uint64_t newSize = m_Ring.size;
+			while (newSize < m_Ring.size + m_OverflowBytes)
+			{
+				newSize *= 2;
+			}
+			DestroyPage(m_Ring);
+			for (auto& page : m_OverflowPages)
+			{
+				DestroyPage(page);
+			}
+			m_OverflowPages.clear();
+			m_Ring = CreatePage(newSize);
+		}
+		m_OverflowPageOffset = 0;
+		m_OverflowBytes = 0;
+		m_RingOffset = 0;
+	}
+
+	StagingAllocation StagingRingBuffer::Allocate(uint64_t size, uint64_t alignment)
+	{
+		alignment = castl::max(alignment, m_MinAlignment);
+		uint64_t currentOffset = m_RingOffset.load(castl::memory_order_relaxed);
+		uint64_t alignedOffset = 0;
+		do
+		{
+			alignedOffset = AlignUp(currentOffset, alignment);
+			if (alignedOffset + size > m_Ring.size)
+			{
+				return AllocateOverflow(size, alignment);
+			}
+		} while (!m_RingOffset.compare_exchange_weak(currentOffset, alignedOffset + size, castl::memory_order_relaxed));
+
+		StagingAllocation result{};
+		result.buffer = m_Ring.buffer;
+		result.offset = alignedOffset;
+		result.pMappedData = m_Ring.pMappedData + alignedOffset;
+		return result;
+	}
+
+	StagingAllocation StagingRingBuffer::AllocateOverflow(uint64_t size, uint64_t alignment)
+	{
+		castl::lock_guard<castl::mutex> guard(m_OverflowMutex);
+		uint64_t alignedOffset = m_OverflowPages.empty() ? 0 : AlignUp(m_OverflowPageOffset, alignment);
+		if (m_OverflowPages.empty() || alignedOffset + size > m_OverflowPages.back().size)
+		{
+			m_OverflowPages.push_back(CreatePage(castl::max(size, m_Ring.size)));
+			alignedOffset = 0;
+		}
+		auto& page = m_OverflowPages.back();
+		m_OverflowPageOffset = alignedOffset + size;
+		m_OverflowBytes += size + alignment;
+
+		StagingAllocation result{};
+		result.buffer = page.buffer;
+		result.offset = alignedOffset;
+		result.pMappedData = page.pMappedData + alignedOffset;
+		return result;
+	}
+
+	StagingRingBuffer::StagingPage StagingRingBuffer::CreatePage(uint64_t size)
+	{
+		auto& queueContext = GetQueueContext();
+		castl::vector<uint32_t> queueFamilies;
+		for (int family : { queueContext.GetGraphicsQueueFamily(), queueContext.GetComputeQueueFamily(), queueContext.GetTransferQueueFamily() })
+		{
+			if (family >= 0 && castl::find(queueFamilies.begin(), queueFamilies.end(), static_cast<uint32_t>(family)) == queueFamilies.end())
+			{
+				queueFamilies.push_back(static_cast<uint32_t>(family));
+			}
+		}
+		//Staging memory is read by transfer and graphics queues in the same frame, avoid ownership transfers
+		vk::BufferCreateInfo bufferCreateInfo({}
+			, size
+			, m_Usage
+			, queueFamilies.size() > 1 ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive
+			, queueFamilies.size() > 1 ? static_cast<uint32_t>(queueFamilies.size()) : 0
+			, queueFamilies.size() > 1 ? queueFamilies.data() : nullptr);
+
+		StagingPage page{};
+		page.size = size;
+		page.buffer = GetDevice().createBuffer(bufferCreateInfo);
+		SetVKObjectDebugName(GetDevice(), page.buffer, m_Name);
+		page.allocation = p_MemoryManager->AllocatePersistentMemory(page.buffer
+			, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+		p_MemoryManager->BindMemory(page.buffer, page.allocation);
+		page.pMappedData = static_cast<uint8_t*>(p_MemoryManager->MapMemory(page.allocation));
+		return page;
+	}
+
+	void StagingRingBuffer::DestroyPage(StagingPage& page)
+	{
+		if (page.buffer != vk::Buffer{ nullptr })
+		{
+			//Cached descriptor sets may bind the uniform arena with dynamic offsets
+			if (m_Usage & vk::BufferUsageFlagBits::eUniformBuffer)
+			{
+				GetGPUObjectManager().GetDescriptorSetCache().ReleaseSetsReferencing({}, page.buffer);
+			}
+			p_MemoryManager->UnmapMemory(page.allocation);
+			p_MemoryManager->FreePersistentMemory(page.allocation);
+			GetDevice().destroyBuffer(page.buffer);
+		}
+		page = {};
+	}
+}
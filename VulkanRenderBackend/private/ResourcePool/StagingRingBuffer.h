@@ -0,0 +1,66 @@
+#pragma once
+#include <VulkanIncludes.h>
+#include <VMA.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAAtomic.h>
+#include <VulkanApplicationSubobjectBase.h>
+
+namespace graphics_backend
+{
+	class GPUMemoryResourceManager;
+
+	struct StagingAllocation
+	{
+		vk::Buffer buffer = nullptr;
+		uint64_t offset = 0;
+		void* pMappedData = nullptr;
+
+		bool IsValid() const
+		{
+			return buffer != vk::Buffer{ nullptr } && pMappedData != nullptr;
+		}
+	};
+
+	//Persistently mapped upload buffer owned by a frame bound resource pool.
+	//Allocations are sub-allocated with an atomic offset and recycled when the pool is reset after its fence,
+	//overflow pages are only created when the ring is exhausted and are merged into a bigger ring on the next reset.
+	//With uniform buffer usage the ring backs the per frame uniform arena, allocations are bound with dynamic offsets
+	class StagingRingBuffer : public VKAppSubObjectBaseNoCopy
+	{
+	public:
+		StagingRingBuffer(CVulkanApplication& app, GPUMemoryResourceManager& memoryManager);
+		//Allocations are owned by the memory manager, which moves together with the owner pool
+		StagingRingBuffer(StagingRingBuffer&& other, GPUMemoryResourceManager& memoryManager) noexcept;
+		void Initialize(uint64_t initialSize
+			, vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eTransferSrc
+			, const char* name = "Staging Ring Buffer");
+		void Release();
+		//Fence of the owner frame must be signaled
+		void Reset();
+		StagingAllocation Allocate(uint64_t size, uint64_t alignment = 0);
+	private:
+		struct StagingPage
+		{
+			vk::Buffer buffer = nullptr;
+			VmaAllocation allocation = nullptr;
+			uint8_t* pMappedData = nullptr;
+			uint64_t size = 0;
+		};
+		StagingPage CreatePage(uint64_t size);
+		void DestroyPage(StagingPage& page);
+		StagingAllocation AllocateOverflow(uint64_t size, uint64_t alignment);
+
+		GPUMemoryResourceManager* p_MemoryManager;
+		vk::BufferUsageFlags m_Usage = vk::BufferUsageFlagBits::eTransferSrc;
+		const char* m_Name = "Staging Ring Buffer";
+		uint64_t m_MinAlignment = 16;
+		StagingPage m_Ring;
+		castl::atomic<uint64_t> m_RingOffset{ 0 };
+
+		castl::mutex m_OverflowMutex;
+		castl::vector<StagingPage> m_OverflowPages;
+		uint64_t m_OverflowPageOffset = 0;
+		uint64_t m_OverflowBytes = 0;
+	};
+}
@@ -88,6 +88,12 @@ namespace graphics_backend
 			vk::AccessFlagBits::eVertexAttributeRead,
 			vk::ImageLayout::eGeneral,
 		},
+		//eIndirectRead
+		ResourceUsageVulkanInfo{
+			vk::PipelineStageFlagBits::eDrawIndirect,
+			vk::AccessFlagBits::eIndirectCommandRead,
+			vk::ImageLayout::eGeneral,
+		},
 	};
 
 
@@ -23,6 +23,7 @@ namespace graphics_backend
 		ePresentID,
 
 		eVertexAttributeID,
+		eIndirectReadID,
 
 		eMax,
 	};
@@ -48,6 +49,7 @@ namespace graphics_backend
 		ePresent = 1 << ePresentID,
 
 		eVertexAttribute = 1 << eVertexAttributeID,
+		eIndirectRead = 1 << eIndirectReadID,
 	};
 
 	using ResourceUsageFlags = uenum::EnumFlags<ResourceUsage>;
@@ -30,7 +30,8 @@ namespace graphics_backend
 				, vk::Bool32(false)
 				, vk::CompareOp::eNever
 				, 0.0f
-				, 0.0f
+				//Views decide which mips are sampled
+				, VK_LOD_CLAMP_NONE
 				, ETextureSamplerBorderColorToVkBorderColor(descriptor.boarderColor, descriptor.integerFormat)
 				, vk::Bool32(false)
 		};
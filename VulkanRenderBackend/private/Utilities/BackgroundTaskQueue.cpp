@@ -0,0 +1,71 @@
+#include "BackgroundTaskQueue.h"
+#include <CATimer/Timer.h>
+
+namespace graphics_backend
+{
+	void BackgroundTaskQueue::Initialize(uint32_t threadCount, castl::string const& name)
+	{
+		m_Name = name;
+		m_Stop = false;
+		m_Threads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			m_Threads.emplace_back(&BackgroundTaskQueue::WorkLoop, this);
+		}
+	}
+
+	void BackgroundTaskQueue::Release()
+	{
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			m_Stop = true;
+		}
+		m_ConditionVariable.notify_all();
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+		m_Threads.clear();
+	}
+
+	void BackgroundTaskQueue::Enqueue(castl::function<void()> task)
+	{
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			if (!m_Stop)
+			{
+				m_Tasks.push_back(castl::move(task));
+				task = nullptr;
+			}
+		}
+		if (task)
+		{
+			task();
+			return;
+		}
+		m_ConditionVariable.notify_one();
+	}
+
+	void BackgroundTaskQueue::WorkLoop()
+	{
+		while (true)
+		{
+			castl::function<void()> task;
+			{
+				castl::unique_lock<castl::mutex> lock(m_Mutex);
+				m_ConditionVariable.wait(lock, [this]()
+					{
+						return m_Stop || !m_Tasks.empty();
+					});
+				if (m_Tasks.empty())
+				{
+					return;
+				}
+				task = castl::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+			CPUTIMER_SCOPE(m_Name.c_str());
+			task();
+		}
+	}
+}
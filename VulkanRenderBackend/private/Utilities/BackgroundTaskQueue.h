@@ -0,0 +1,34 @@
+#pragma once
+#include <thread>
+#include <CASTL/CAVector.h>
+#include <CASTL/CADeque.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAString.h>
+#include <CASTL/CAFunctional.h>
+
+namespace graphics_backend
+{
+	//Worker threads for backend jobs that may outlive a frame, like pipeline compilation.
+	//Frame task graphs cannot be used for them because a loop iteration only ends when all of its tasks finished
+	class BackgroundTaskQueue
+	{
+	public:
+		BackgroundTaskQueue() = default;
+		BackgroundTaskQueue(BackgroundTaskQueue const&) = delete;
+		BackgroundTaskQueue& operator=(BackgroundTaskQueue const&) = delete;
+		void Initialize(uint32_t threadCount, castl::string const& name);
+		//Pending tasks still run before the threads exit, tasks publish results others may be waiting for
+		void Release();
+		//Runs the task on the calling thread once the queue was released
+		void Enqueue(castl::function<void()> task);
+	private:
+		void WorkLoop();
+
+		castl::mutex m_Mutex;
+		castl::condition_variable m_ConditionVariable;
+		castl::deque<castl::function<void()>> m_Tasks;
+		castl::vector<std::thread> m_Threads;
+		castl::string m_Name;
+		bool m_Stop = false;
+	};
+}
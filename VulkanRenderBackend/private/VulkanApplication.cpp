@@ -29,9 +29,18 @@ namespace graphics_backend
 							TickWindowContexts();
 						});
 
+				//Finished async uploads hand their resources over before graphs of this frame read resource states
+				auto tickAsyncUploads = scheduler->NewTaskGraph()
+					->Name("Tick Async Uploads")
+					->Func([this](auto scheduler)
+						{
+							m_AsyncUploadService.Tick(scheduler);
+						});
+
 				auto runGraph = scheduler->NewTaskGraph()
 					->Name("Run Graph")
 					->DependsOn(tickWindowHandles)
+					->DependsOn(tickAsyncUploads)
 					->Func([this, gpuFrame](auto scheduler)
 						{
 							castl::shared_ptr<FrameBoundResourcePool> frameManager;
@@ -185,7 +194,34 @@ namespace graphics_backend
 		QueueContext::QueueCreationInfo queueCreationInfo{};
 		m_QueueContext.InitQueueCreationInfo(m_PhysicalDevice, queueCreationInfo);
 		auto extensions = GetDeviceExtensionNames();
-		vk::DeviceCreateInfo deviceCreateInfo({}, queueCreationInfo.queueCreateInfoList, {}, extensions);
+
+		auto supportedFeatures = m_PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features, vk::PhysicalDeviceVulkan13Features>();
+		CA_ASSERT(supportedFeatures.get<vk::PhysicalDeviceVulkan13Features>().synchronization2, "Synchronization2 Not Supported");
+		CA_ASSERT(supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>().hostQueryReset, "Host Query Reset Not Supported");
+		CA_ASSERT(supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore, "Timeline Semaphore Not Supported");
+		vk::PhysicalDeviceVulkan12Features vulkan12Features{};
+		vulkan12Features.hostQueryReset = VK_TRUE;
+		vulkan12Features.timelineSemaphore = VK_TRUE;
+		//Bindless descriptors are optional, shaders using them need a device with descriptor indexing
+		if (BindlessDescriptorHeap::IsSupported(supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>()))
+		{
+			BindlessDescriptorHeap::EnableFeatures(vulkan12Features);
+		}
+		//GPU driven draws are optional as well, callers fall back to CPU recorded draws
+		vk::PhysicalDeviceFeatures coreFeatures{};
+		m_IndirectDrawCountSupported = supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount
+			&& supportedFeatures.get<vk::PhysicalDeviceFeatures2>().features.multiDrawIndirect;
+		if (m_IndirectDrawCountSupported)
+		{
+			vulkan12Features.drawIndirectCount = VK_TRUE;
+			coreFeatures.multiDrawIndirect = VK_TRUE;
+		}
+		vk::PhysicalDeviceVulkan13Features vulkan13Features{};
+		vulkan13Features.synchronization2 = VK_TRUE;
+		vulkan12Features.pNext = &vulkan13Features;
+
+		vk::DeviceCreateInfo deviceCreateInfo({}, queueCreationInfo.queueCreateInfoList, {}, extensions, &coreFeatures);
+		deviceCreateInfo.pNext = &vulkan12Features;
 		m_Device = m_PhysicalDevice.createDevice(deviceCreateInfo);
 		vulkan_backend::utils::SetupVulkanDeviceFunctinoPointers(m_Device);
 	}
@@ -249,6 +285,7 @@ namespace graphics_backend
 	, m_GPUResourceObjManager(*this)
 	, m_GPUMemoryManager(*this)
 	, m_GlobalResourceReleasingQueue(*this)
+	, m_AsyncUploadService(*this)
 	{
 	}
 
@@ -263,7 +300,9 @@ namespace graphics_backend
 		CreateDevice();
 		m_GPUMemoryManager.Initialize();
 		m_GPUResourceObjManager.Initialize();
-		m_FrameContext.InitFrameCapacity(4);
+		m_GPUObjectManager.Initialize();
+		m_AsyncUploadService.Initialize();
+		m_FrameContext.InitFrameCapacity(FRAMEBOUND_RESOURCE_POOL_COUNT);
 
 	}
 
@@ -273,6 +312,7 @@ namespace graphics_backend
 		ReleaseAllWindowContexts();
 		m_GlobalResourceReleasingQueue.ReleaseGlobalResources();
 		m_FrameContext.Release();
+		m_AsyncUploadService.Release();
 		m_GPUObjectManager.Release();
 		m_GPUResourceObjManager.Release();
 		m_GPUMemoryManager.Release();
@@ -281,6 +321,18 @@ namespace graphics_backend
 		DestroyInstance();
 	}
 
+	void CVulkanApplication::UpdateBarrierStatistics(BarrierStatistics const& statistics)
+	{
+		castl::lock_guard<castl::mutex> lock(m_StatisticsMutex);
+		m_LastFrameBarrierStatistics = statistics;
+	}
+
+	BarrierStatistics CVulkanApplication::GetLastFrameBarrierStatistics() const
+	{
+		castl::lock_guard<castl::mutex> lock(m_StatisticsMutex);
+		return m_LastFrameBarrierStatistics;
+	}
+
 	void CVulkanApplication::DeviceWaitIdle()
 	{
 		if (m_Device != vk::Device(nullptr))
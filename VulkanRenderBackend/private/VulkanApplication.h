@@ -2,6 +2,7 @@
 #include <ThreadManager.h>
 #include <ShaderBindingBuilder.h>
 #include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAMutex.h>
 #include <CRenderBackend.h>
 #include "WindowContext.h"
 #include "FrameCountContext.h"
@@ -14,6 +15,7 @@
 #include "GPUGraphExecutor/GPUGraphExecutor.h"
 #include <GPUContexts/QueueContext.h>
 #include <GPUContexts/FrameContext.h>
+#include <GPUContexts/AsyncUploadService.h>
 #include <Utilities/SubobjectTraits.h>
 
 namespace graphics_backend
@@ -73,10 +75,14 @@ namespace graphics_backend
 
 		constexpr GPUObjectManager& GetGPUObjectManager() { return m_GPUObjectManager; }
 		constexpr GPUMemoryResourceManager& GetGlobalMemoryManager() { return m_GPUMemoryManager; }
+		constexpr FrameContext& GetFrameContext() { return m_FrameContext; }
 		constexpr GPUResourceObjectManager& GetGlobalResourceObjectManager() { return m_GPUResourceObjManager; }
 		constexpr GlobalResourceReleaseQueue& GetGlobalResourecReleasingQueue() { return m_GlobalResourceReleasingQueue; }
 		constexpr QueueContext& GetQueueContext() { return m_QueueContext; }
+		constexpr AsyncUploadService& GetAsyncUploadService() { return m_AsyncUploadService; }
 		bool AnyWindowRunning() const { return !m_WindowContexts.empty(); }
+		//Batches with indirect draws need drawIndirectCount and multiDrawIndirect
+		bool SupportsIndirectDrawCount() const { return m_IndirectDrawCountSupported; }
 		castl::shared_ptr<WindowHandle> GetWindowHandle(castl::shared_ptr<cawindow::IWindow> window);
 		void TickWindowContexts();
 
@@ -113,6 +119,10 @@ namespace graphics_backend
 		};
 
 		void ScheduleGPUFrame(TaskScheduler* scheduler, GPUFrame const& gpuFrame);
+
+		//Statistics
+		void UpdateBarrierStatistics(BarrierStatistics const& statistics);
+		BarrierStatistics GetLastFrameBarrierStatistics() const;
 	public:
 		//Allocation
 		GPUBuffer* NewGPUBuffer(GPUBufferDescriptor const& inDescriptor);
@@ -132,6 +142,7 @@ private:
 		vk::Instance m_Instance = nullptr;
 		vk::PhysicalDevice m_PhysicalDevice = nullptr;
 		vk::Device m_Device = nullptr;
+		bool m_IndirectDrawCountSupported = false;
 	#if !defined(NDEBUG)
 		vk::DebugUtilsMessengerEXT m_DebugMessager = nullptr;
 	#endif
@@ -142,5 +153,9 @@ private:
 		GlobalResourceReleaseQueue m_GlobalResourceReleasingQueue;
 		QueueContext m_QueueContext;
 		FrameContext m_FrameContext;
+		AsyncUploadService m_AsyncUploadService;
+
+		mutable castl::mutex m_StatisticsMutex;
+		BarrierStatistics m_LastFrameBarrierStatistics;
 	};
 }
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "VulkanBarrierCollector.h"
 #include <GPUContexts/QueueContext.h>
+#include <ResourcePool/GPUResourceObjectManager.h>
 
 namespace graphics_backend
 {
@@ -14,6 +15,60 @@ namespace graphics_backend
 		return inFLags == vk::PipelineStageFlags{0} ? vk::PipelineStageFlagBits::eAllCommands : inFLags;
 	}
 
+	//Legacy stage and access bits share their values with the synchronization2 ones
+	vk::PipelineStageFlags2 ToPipelineStageFlags2(vk::PipelineStageFlags inFlags)
+	{
+		return vk::PipelineStageFlags2{ static_cast<VkPipelineStageFlags2>(static_cast<VkPipelineStageFlags>(inFlags)) };
+	}
+
+	vk::AccessFlags2 ToAccessFlags2(vk::AccessFlags inFlags)
+	{
+		return vk::AccessFlags2{ static_cast<VkAccessFlags2>(static_cast<VkAccessFlags>(inFlags)) };
+	}
+
+	vk::ImageMemoryBarrier2 MakeImageBarrier2(vk::PipelineStageFlags srcStages
+		, vk::PipelineStageFlags dstStages
+		, ResourceUsageVulkanInfo const& sourceInfo
+		, ResourceUsageVulkanInfo const& destInfo
+		, uint32_t srcQueueFamily
+		, uint32_t dstQueueFamily
+		, vk::Image image
+		, ETextureFormat format)
+	{
+		return vk::ImageMemoryBarrier2(
+			ToPipelineStageFlags2(srcStages)
+			, ToAccessFlags2(sourceInfo.m_UsageAccessFlags)
+			, ToPipelineStageFlags2(dstStages)
+			, ToAccessFlags2(destInfo.m_UsageAccessFlags)
+			, sourceInfo.m_UsageImageLayout
+			, destInfo.m_UsageImageLayout
+			, srcQueueFamily
+			, dstQueueFamily
+			, image
+			//Image states are tracked per image, transition every mip and layer
+			, vulkan_backend::utils::MakeSubresourceRange(format, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+	}
+
+	vk::BufferMemoryBarrier2 MakeBufferBarrier2(vk::PipelineStageFlags srcStages
+		, vk::PipelineStageFlags dstStages
+		, ResourceUsageVulkanInfo const& sourceInfo
+		, ResourceUsageVulkanInfo const& destInfo
+		, uint32_t srcQueueFamily
+		, uint32_t dstQueueFamily
+		, vk::Buffer buffer)
+	{
+		return vk::BufferMemoryBarrier2(
+			ToPipelineStageFlags2(srcStages)
+			, ToAccessFlags2(sourceInfo.m_UsageAccessFlags)
+			, ToPipelineStageFlags2(dstStages)
+			, ToAccessFlags2(destInfo.m_UsageAccessFlags)
+			, srcQueueFamily
+			, dstQueueFamily
+			, buffer
+			, 0
+			, VK_WHOLE_SIZE);
+	}
+
 	void VulkanBarrierCollector::PushImageBarrier(vk::Image image
 		, ETextureFormat format
 		, ResourceUsageFlags sourceUsage
@@ -103,22 +158,84 @@ namespace graphics_backend
 		found->second.m_Buffers.push_back(castl::make_tuple(sourceInfo, destInfo, buffer, sourceQueueFamilyIndex));
 	}
 	
-	void VulkanBarrierCollector::ExecuteBarrier(vk::CommandBuffer commandBuffer)
+	void VulkanBarrierCollector::PushImageSplitBarrier(SplitBarrier& splitBarrier, vk::Image image, ETextureFormat format, ResourceUsageFlags sourceUsage, ResourceUsageFlags destUsage)
 	{
+		ResourceUsageVulkanInfo sourceInfo = GetUsageInfo(sourceUsage);
+		ResourceUsageVulkanInfo destInfo = GetUsageInfo(destUsage);
+
+		m_AquireStageMask |= destInfo.m_UsageStageMask & m_StageMasks;
+		splitBarrier.m_ImageBarriers.push_back(MakeImageBarrier2(
+			SanitizePipelienStageFlags(sourceInfo.m_UsageStageMask & m_StageMasks)
+			, SanitizePipelienStageFlags(destInfo.m_UsageStageMask & m_StageMasks)
+			, sourceInfo
+			, destInfo
+			, m_CurrentQueueFamilyIndex
+			, m_CurrentQueueFamilyIndex
+			, image
+			, format));
+	}
+
+	void VulkanBarrierCollector::PushBufferSplitBarrier(SplitBarrier& splitBarrier, vk::Buffer buffer, ResourceUsageFlags sourceUsage, ResourceUsageFlags destUsage)
+	{
+		ResourceUsageVulkanInfo sourceInfo = GetUsageInfo(sourceUsage);
+		ResourceUsageVulkanInfo destInfo = GetUsageInfo(destUsage);
+
+		m_AquireStageMask |= destInfo.m_UsageStageMask & m_StageMasks;
+		splitBarrier.m_BufferBarriers.push_back(MakeBufferBarrier2(
+			SanitizePipelienStageFlags(sourceInfo.m_UsageStageMask & m_StageMasks)
+			, SanitizePipelienStageFlags(destInfo.m_UsageStageMask & m_StageMasks)
+			, sourceInfo
+			, destInfo
+			, m_CurrentQueueFamilyIndex
+			, m_CurrentQueueFamilyIndex
+			, buffer));
+	}
+	
+	void VulkanBarrierCollector::ExecuteBarrier(vk::CommandBuffer commandBuffer, TimestampQueryPool* pStallTimer)
+	{
+		if (m_WaitSplitBarriers.empty() && m_BarrierGroups.empty())
+		{
+			return;
+		}
+
+		uint32_t stallQuery = TimestampQueryPool::INVALID_QUERY;
+		if (pStallTimer != nullptr)
+		{
+			stallQuery = pStallTimer->BeginQuery(commandBuffer, m_CurrentQueueFamilyIndex);
+		}
+
+		if (!m_WaitSplitBarriers.empty())
+		{
+			castl::vector<vk::Event> events;
+			castl::vector<vk::DependencyInfo> dependencyInfos;
+			events.reserve(m_WaitSplitBarriers.size());
+			dependencyInfos.reserve(m_WaitSplitBarriers.size());
+			for (SplitBarrier const* splitBarrier : m_WaitSplitBarriers)
+			{
+				events.push_back(splitBarrier->m_Event);
+				dependencyInfos.push_back(splitBarrier->GetDependencyInfo());
+			}
+			commandBuffer.waitEvents2(events, dependencyInfos);
+			m_Statistics.eventWaitCount += events.size();
+		}
+
 		ExecuteCurrentQueueBarriers(commandBuffer);
+
+		if (pStallTimer != nullptr)
+		{
+			pStallTimer->EndQuery(commandBuffer, stallQuery);
+		}
 	}
 
 	void VulkanBarrierCollector::ExecuteReleaseBarrier(vk::CommandBuffer commandBuffer)
 	{
-		castl::vector<vk::ImageMemoryBarrier> imageBarriers;
-		castl::vector<vk::BufferMemoryBarrier> bufferBarriers;
+		castl::vector<vk::ImageMemoryBarrier2> imageBarriers;
+		castl::vector<vk::BufferMemoryBarrier2> bufferBarriers;
 		for (auto& key_value : m_ReleaseBarrierGroups)
 		{
 			auto key = key_value.first;
-			imageBarriers.clear();
-			bufferBarriers.clear();
-			imageBarriers.reserve(key_value.second.m_Images.size());
-			bufferBarriers.reserve(key_value.second.m_Buffers.size());
+			imageBarriers.reserve(imageBarriers.size() + key_value.second.m_Images.size());
+			bufferBarriers.reserve(bufferBarriers.size() + key_value.second.m_Buffers.size());
 			for (auto& imgInfo : key_value.second.m_Images)
 			{
 				ResourceUsageVulkanInfo& sourceInfo = castl::get<0>(imgInfo);
@@ -127,16 +244,13 @@ namespace graphics_backend
 				ETextureFormat format = castl::get<3>(imgInfo);
 				uint32_t targetQueueFamilyIndex = castl::get<4>(imgInfo);
 
-				vk::ImageMemoryBarrier newBarrier(
-					sourceInfo.m_UsageAccessFlags
-					, destInfo.m_UsageAccessFlags
-					, sourceInfo.m_UsageImageLayout
-					, destInfo.m_UsageImageLayout
+				imageBarriers.push_back(MakeImageBarrier2(castl::get<0>(key), castl::get<1>(key)
+					, sourceInfo
+					, destInfo
 					, m_CurrentQueueFamilyIndex
 					, targetQueueFamilyIndex
 					, image
-					, vulkan_backend::utils::MakeSubresourceRange(format));
-				imageBarriers.push_back(newBarrier);
+					, format));
 			}
 
 			for (auto& bufferInfo : key_value.second.m_Buffers)
@@ -146,24 +260,21 @@ namespace graphics_backend
 				vk::Buffer buffer = castl::get<2>(bufferInfo);
 				uint32_t targetQueueFamilyIndex = castl::get<3>(bufferInfo);
 
-				vk::BufferMemoryBarrier newBarrier(
-					sourceInfo.m_UsageAccessFlags
-					, destInfo.m_UsageAccessFlags
+				bufferBarriers.push_back(MakeBufferBarrier2(castl::get<0>(key), castl::get<1>(key)
+					, sourceInfo
+					, destInfo
 					, m_CurrentQueueFamilyIndex
 					, targetQueueFamilyIndex
-					, buffer
-					, 0
-					, VK_WHOLE_SIZE);
-				bufferBarriers.push_back(newBarrier);
+					, buffer));
 			}
+		}
+		EmitPipelineBarrier(commandBuffer, imageBarriers, bufferBarriers);
 
-			commandBuffer.pipelineBarrier(
-				castl::get<0>(key)
-				, castl::get<1>(key)
-				, {}
-				, {}
-				, bufferBarriers
-				, imageBarriers);
+		//Split Barriers
+		for (SplitBarrier const* splitBarrier : m_SignalSplitBarriers)
+		{
+			commandBuffer.setEvent2(splitBarrier->m_Event, splitBarrier->GetDependencyInfo());
+			m_Statistics.splitBarrierCount += splitBarrier->m_ImageBarriers.size() + splitBarrier->m_BufferBarriers.size();
 		}
 	}
 
@@ -171,19 +282,21 @@ namespace graphics_backend
 	{
 		m_BarrierGroups.clear();
 		m_ReleaseBarrierGroups.clear();
+		m_SignalSplitBarriers.clear();
+		m_WaitSplitBarriers.clear();
+		m_Statistics = {};
 	}
 	
 	void VulkanBarrierCollector::ExecuteCurrentQueueBarriers(vk::CommandBuffer commandBuffer)
 	{
-		castl::vector<vk::ImageMemoryBarrier> imageBarriers;
-		castl::vector<vk::BufferMemoryBarrier> bufferBarriers;
+		//All stage pairs are merged into one dependency, synchronization2 carries stage masks per barrier
+		castl::vector<vk::ImageMemoryBarrier2> imageBarriers;
+		castl::vector<vk::BufferMemoryBarrier2> bufferBarriers;
 		for (auto& key_value : m_BarrierGroups)
 		{
 			auto key = key_value.first;
-			imageBarriers.clear();
-			bufferBarriers.clear();
-			imageBarriers.reserve(key_value.second.m_Images.size());
-			bufferBarriers.reserve(key_value.second.m_Buffers.size());
+			imageBarriers.reserve(imageBarriers.size() + key_value.second.m_Images.size());
+			bufferBarriers.reserve(bufferBarriers.size() + key_value.second.m_Buffers.size());
 			for (auto& imgInfo : key_value.second.m_Images)
 			{
 				ResourceUsageVulkanInfo& sourceInfo = castl::get<0>(imgInfo);
@@ -192,16 +305,13 @@ namespace graphics_backend
 				ETextureFormat format = castl::get<3>(imgInfo);
 				uint32_t sourceQueueFamily = castl::get<4>(imgInfo);
 
-				vk::ImageMemoryBarrier newBarrier(
-					sourceInfo.m_UsageAccessFlags
-					, destInfo.m_UsageAccessFlags
-					, sourceInfo.m_UsageImageLayout
-					, destInfo.m_UsageImageLayout
+				imageBarriers.push_back(MakeImageBarrier2(castl::get<0>(key), castl::get<1>(key)
+					, sourceInfo
+					, destInfo
 					, sourceQueueFamily
 					, m_CurrentQueueFamilyIndex
 					, image
-					, vulkan_backend::utils::MakeSubresourceRange(format));
-				imageBarriers.push_back(newBarrier);
+					, format));
 			}
 
 			for (auto& bufferInfo : key_value.second.m_Buffers)
@@ -211,25 +321,28 @@ namespace graphics_backend
 				vk::Buffer buffer = castl::get<2>(bufferInfo);
 				uint32_t sourceQueueFamily = castl::get<3>(bufferInfo);
 
-				vk::BufferMemoryBarrier newBarrier(
-					sourceInfo.m_UsageAccessFlags
-					, destInfo.m_UsageAccessFlags
+				bufferBarriers.push_back(MakeBufferBarrier2(castl::get<0>(key), castl::get<1>(key)
+					, sourceInfo
+					, destInfo
 					, sourceQueueFamily
 					, m_CurrentQueueFamilyIndex
-					, buffer
-					, 0
-					, VK_WHOLE_SIZE);
-				bufferBarriers.push_back(newBarrier);
+					, buffer));
 			}
-
-			commandBuffer.pipelineBarrier(
-				castl::get<0>(key)
-				, castl::get<1>(key)
-				, {}
-				, {}
-				, bufferBarriers
-				, imageBarriers);
 		}
+		EmitPipelineBarrier(commandBuffer, imageBarriers, bufferBarriers);
+	}
 
+	void VulkanBarrierCollector::EmitPipelineBarrier(vk::CommandBuffer commandBuffer
+		, castl::vector<vk::ImageMemoryBarrier2> const& imageBarriers
+		, castl::vector<vk::BufferMemoryBarrier2> const& bufferBarriers)
+	{
+		if (imageBarriers.empty() && bufferBarriers.empty())
+		{
+			return;
+		}
+		commandBuffer.pipelineBarrier2(vk::DependencyInfo{ {}, {}, bufferBarriers, imageBarriers });
+		++m_Statistics.pipelineBarrierCount;
+		m_Statistics.imageBarrierCount += imageBarriers.size();
+		m_Statistics.bufferBarrierCount += bufferBarriers.size();
 	}
 }
\ No newline at end of file
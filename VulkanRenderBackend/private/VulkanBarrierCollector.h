@@ -8,6 +8,43 @@
 
 namespace graphics_backend
 {
+	class TimestampQueryPool;
+
+	struct BarrierStatistics
+	{
+		uint32_t pipelineBarrierCount = 0;
+		uint32_t imageBarrierCount = 0;
+		uint32_t bufferBarrierCount = 0;
+		uint32_t splitBarrierCount = 0;
+		uint32_t eventWaitCount = 0;
+		double stallTimeMS = 0.0;
+
+		BarrierStatistics& operator+=(BarrierStatistics const& other)
+		{
+			pipelineBarrierCount += other.pipelineBarrierCount;
+			imageBarrierCount += other.imageBarrierCount;
+			bufferBarrierCount += other.bufferBarrierCount;
+			splitBarrierCount += other.splitBarrierCount;
+			eventWaitCount += other.eventWaitCount;
+			stallTimeMS += other.stallTimeMS;
+			return *this;
+		}
+	};
+
+	//Barriers between two passes on the same queue with other passes in between,
+	//signaled right after the producer pass and waited right before the consumer pass
+	struct SplitBarrier
+	{
+		vk::Event m_Event;
+		castl::vector<vk::ImageMemoryBarrier2> m_ImageBarriers;
+		castl::vector<vk::BufferMemoryBarrier2> m_BufferBarriers;
+
+		vk::DependencyInfo GetDependencyInfo() const
+		{
+			return vk::DependencyInfo{ {}, {}, m_BufferBarriers, m_ImageBarriers };
+		}
+	};
+
 	class VulkanBarrierCollector
 	{
 	public:
@@ -49,8 +86,24 @@ namespace graphics_backend
 			, ResourceUsageFlags sourceUsage
 			, ResourceUsageFlags destUsage);
 
-		void ExecuteBarrier(vk::CommandBuffer commandBuffer);
+		void PushImageSplitBarrier(SplitBarrier& splitBarrier
+			, vk::Image image
+			, ETextureFormat format
+			, ResourceUsageFlags sourceUsage
+			, ResourceUsageFlags destUsage);
+
+		void PushBufferSplitBarrier(SplitBarrier& splitBarrier
+			, vk::Buffer buffer
+			, ResourceUsageFlags sourceUsage
+			, ResourceUsageFlags destUsage);
+
+		void PushSplitBarrierSignal(SplitBarrier const* splitBarrier) { m_SignalSplitBarriers.push_back(splitBarrier); }
+		void PushSplitBarrierWait(SplitBarrier const* splitBarrier) { m_WaitSplitBarriers.push_back(splitBarrier); }
 
+		//Waits split barrier events, then emits all other aquire barriers in a single pipelineBarrier2
+		void ExecuteBarrier(vk::CommandBuffer commandBuffer, TimestampQueryPool* pStallTimer = nullptr);
+
+		//Emits queue family release barriers and signals split barrier events of this pass
 		void ExecuteReleaseBarrier(vk::CommandBuffer commandBuffer);
 
 		void Clear();
@@ -62,9 +115,13 @@ namespace graphics_backend
 		};
 
 		vk::PipelineStageFlags GetAquireStageMask() const { return m_AquireStageMask; }
+		BarrierStatistics const& GetStatistics() const { return m_Statistics; }
 	private:
 
 		void ExecuteCurrentQueueBarriers(vk::CommandBuffer commandBuffer);
+		void EmitPipelineBarrier(vk::CommandBuffer commandBuffer
+			, castl::vector<vk::ImageMemoryBarrier2> const& imageBarriers
+			, castl::vector<vk::BufferMemoryBarrier2> const& bufferBarriers);
 
 		vk::PipelineStageFlags m_StageMasks = ~vk::PipelineStageFlags{ 0 };
 		uint32_t m_CurrentQueueFamilyIndex = 0;
@@ -74,6 +131,10 @@ namespace graphics_backend
 		castl::map<castl::tuple<vk::PipelineStageFlags, vk::PipelineStageFlags>
 			, BarrierGroup> m_ReleaseBarrierGroups;
 
+		castl::vector<SplitBarrier const*> m_SignalSplitBarriers;
+		castl::vector<SplitBarrier const*> m_WaitSplitBarriers;
+
 		vk::PipelineStageFlags m_AquireStageMask = vk::PipelineStageFlags{ 0 };
+		BarrierStatistics m_Statistics;
 	};
 }
\ No newline at end of file
@@ -194,7 +194,12 @@ namespace graphics_backend
 		PopulateShaderStages(pipelineObjectDescriptor.shaderState, shaderStages);
 
 		//TODO Populate Shader Binding Layout Info
+		vk::PushConstantRange pushConstantRange{ vk::ShaderStageFlagBits::eAllGraphics, 0, pipelineObjectDescriptor.pushConstantSize };
 		vk::PipelineLayoutCreateInfo layoutCreateInfo{{}, pipelineObjectDescriptor.descriptorSetLayouts, {}};
+		if (pushConstantRange.size > 0)
+		{
+			layoutCreateInfo.setPushConstantRanges(pushConstantRange);
+		}
 		m_PipelineLayout = GetDevice().createPipelineLayout(layoutCreateInfo);
 
 		castl::array<vk::Viewport, 1> dummyViewports = { vk::Viewport{0, 0, 1, 1, 0, 1} };
@@ -223,7 +228,9 @@ namespace graphics_backend
 		graphicsPipeCreateInfo.setSubpass(pipelineObjectDescriptor.subpassIndex);
 		graphicsPipeCreateInfo.setPViewportState(&viewportStateInfo);
 		graphicsPipeCreateInfo.setPDynamicState(&dynamicStateInfo);
-		m_GraphicsPipeline = GetDevice().createGraphicsPipeline(nullptr, graphicsPipeCreateInfo).value;
+		auto& pipelineCache = GetGPUObjectManager().GetPersistentPipelineCache();
+		m_GraphicsPipeline = GetDevice().createGraphicsPipeline(pipelineCache.GetPipelineCache(), graphicsPipeCreateInfo).value;
+		pipelineCache.RecordGraphicsPipeline(pipelineObjectDescriptor);
 	}
 	void CPipelineObject::Release()
 	{
@@ -25,6 +25,8 @@ namespace graphics_backend
 		ShaderStateDescriptor shaderState{};
 		//TODO Wrap ME
 		castl::vector<vk::DescriptorSetLayout> descriptorSetLayouts{};
+		//Size of the push constant block visible to all graphics stages
+		uint32_t pushConstantSize = 0;
 		castl::shared_ptr<RenderPassObject> renderPassObject = nullptr;
 		uint32_t subpassIndex = 0;
 		auto operator<=>(const CPipelineObjectDescriptor&) const = default;
@@ -55,5 +57,6 @@ CA_REFLECTION(graphics_backend::CPipelineObjectDescriptor
 	, vertexInputs
 	, shaderState
 	, descriptorSetLayouts
+	, pushConstantSize
 	, renderPassObject
 	, subpassIndex);
@@ -13,6 +13,7 @@ public:
 	glm::mat4 const& GetViewMatrix() const { return m_ViewMatrix; }
 	glm::mat4 const& GetProjMatrix() const { return m_ProjectionMatrix; }
 	glm::mat4 const& GetViewProjMatrix() const { return m_ViewProjectionMatrix; }
+	glm::vec3 const& GetPosition() const { return m_Position; }
 private:
 	float m_FOV = 45.0f;
 	glm::mat4 m_ViewMatrix;
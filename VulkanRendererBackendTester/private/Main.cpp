@@ -25,6 +25,7 @@
 #include "StaticMeshResource.h"
 #include "MeshRenderer.h"
 #include "TextureResource.h"
+#include "TextureStreamer.h"
 #include "IMGUIContext.h"
 #include <GPUGraph.h>
 #include <TextureSampler.h>
@@ -58,6 +59,7 @@ int main(int argc, char *argv[])
 	castl::string resourceString = castl::to_ca(rootPath.string()) + "CAResources";
 	castl::string assetString = castl::to_ca(rootPath.string()) + "CAAssets";
 	castl::string editorResourceString = castl::to_ca(rootPath.string()) + "EditorConfigs";
+	castl::string shaderCacheString = castl::to_ca(rootPath.string()) + "Intermediate/ShaderCompileCache";
 
 	TModuleLoader<CThreadManager> threadManagerLoader("ThreadManager");
 	TModuleLoader<CRenderBackend> renderBackendLoader("VulkanRenderBackend");
@@ -81,59 +83,93 @@ int main(int argc, char *argv[])
 	pThreadManager->SetDedicateThreadMapping(0, { "MainThread" });
 
 
-	ShaderResourceLoaderSlang slangShaderResourceLoader;
-	StaticMeshImporter staticMeshImporter;
+	ShaderResourceLoaderSlang slangShaderResourceLoader(n);
+	slangShaderResourceLoader.SetCompileCacheDirectory(shaderCacheString);
+	castl::string buildArchivePath;
+	castl::string mountArchivePath;
+	MeshCookSettings meshCookSettings{};
+	TextureCookSettings textureCookSettings{};
+	uint64_t textureBudgetMB = 256;
+	bool verbose = false;
+	for (int argID = 1; argID < argc; ++argID)
+	{
+		if (strcmp(argv[argID], "-cookrelease") == 0)
+		{
+			slangShaderResourceLoader.SetCookConfig(EShaderCookConfig::eRelease);
+			meshCookSettings.quantizeAttributes = true;
+			textureCookSettings.highQuality = true;
+		}
+		else if (strcmp(argv[argID], "-buildpack") == 0 && argID + 1 < argc)
+		{
+			buildArchivePath = argv[++argID];
+		}
+		else if (strcmp(argv[argID], "-mountpack") == 0 && argID + 1 < argc)
+		{
+			mountArchivePath = argv[++argID];
+		}
+		else if (strcmp(argv[argID], "-texturebudget") == 0 && argID + 1 < argc)
+		{
+			textureBudgetMB = strtoull(argv[++argID], nullptr, 10);
+		}
+		else if (strcmp(argv[argID], "-verbose") == 0)
+		{
+			verbose = true;
+		}
+	}
+	StaticMeshImporter staticMeshImporter(n);
+	staticMeshImporter.SetCookSettings(meshCookSettings);
+	staticMeshImporter.SetTextureCookSettings(textureCookSettings);
 
 	auto pResourceManagingSystem = resourceSystemFactory->NewManagingSystemShared();
 	pResourceManagingSystem->SetResourceRootPath(assetString);
 
 	auto pResourceImportingSystem = resourceSystemFactory->NewImportingSystemShared();
 	pResourceImportingSystem->SetResourceManager(pResourceManagingSystem.get());
+	pResourceImportingSystem->SetVerbose(verbose);
 	pResourceImportingSystem->AddImporter(&slangShaderResourceLoader);
 	pResourceImportingSystem->AddImporter(&staticMeshImporter);
-	pResourceImportingSystem->ScanSourceDirectory(resourceString);
-
-	ShaderResrouce* pMeshShaderResource = nullptr;
-	pResourceManagingSystem->LoadResource<ShaderResrouce>("Shaders/TestStaticMeshShader.shaderbundle", [ppResource = &pMeshShaderResource](ShaderResrouce* result)
-		{
-			*ppResource = result;
-		});
-
-	ShaderResrouce* pFinalBlitShaderResource = nullptr;
-	pResourceManagingSystem->LoadResource<ShaderResrouce>("Shaders/testFinalBlit.shaderbundle", [ppResource = &pFinalBlitShaderResource](ShaderResrouce* result)
-		{
-			*ppResource = result;
-		});
-
-	ShaderResrouce* pTestComputeShaderResource = nullptr;
-	pResourceManagingSystem->LoadResource<ShaderResrouce>("Shaders/TestComputeShader.shaderbundle", [ppResource = &pTestComputeShaderResource](ShaderResrouce* result)
-		{
-			*ppResource = result;
-		});
-
-	ShaderResrouce* pFinalBlitShader = nullptr;
-	pResourceManagingSystem->LoadResource<ShaderResrouce>("Shaders/FinalBlit.shaderbundle", [&pFinalBlitShader](ShaderResrouce* result)
-		{
-			pFinalBlitShader = result;
-		});
-
-	StaticMeshResource* pTestMeshResource = nullptr;
-	pResourceManagingSystem->LoadResource<StaticMeshResource>("Models/VikingRoom/mesh.scene", [ppResource = &pTestMeshResource](StaticMeshResource* result)
-		{
-			*ppResource = result;
-		});
-
-	TextureResource* pTextureResource0 = nullptr;
-	pResourceManagingSystem->LoadResource<TextureResource>("Models/VikingRoom/IMG_2348.texture", [ppResource = &pTextureResource0](TextureResource* result)
+	pThreadManager->OneTime([&](auto setup)
 		{
-			*ppResource = result;
-		});
+			pResourceImportingSystem->ScanSourceDirectory(resourceString, setup);
+		}, "");
+	pThreadManager->Run();
 
-	TextureResource* pTextureResource1 = nullptr;
-	pResourceManagingSystem->LoadResource<TextureResource>("Models/VikingRoom/IMG_2349.texture", [ppResource = &pTextureResource1](TextureResource* result)
+	//Packs the freshly imported resources, then reads them through the archive instead of the loose files
+	if (!buildArchivePath.empty())
+	{
+		pResourceImportingSystem->BuildResourceArchive(buildArchivePath, EResourceArchiveCompression::eLZ4);
+		if (mountArchivePath.empty())
 		{
-			*ppResource = result;
-		});
+			mountArchivePath = buildArchivePath;
+		}
+	}
+	if (!mountArchivePath.empty() && !pResourceManagingSystem->MountResourceArchive(mountArchivePath))
+	{
+		std::cout << "Failed to mount resource archive " << mountArchivePath.c_str() << std::endl;
+	}
+
+	//Loaded side by side on the loading threads, waited for before the first frame needs them
+	pResourceManagingSystem->SetLoadingThreadCount(castl::max(n / 2, 1u));
+	auto meshShaderHandle = pResourceManagingSystem->LoadResourceAsync<ShaderResrouce>("Shaders/TestStaticMeshShader.shaderbundle", EResourceLoadPriority::eHigh, {});
+	auto finalBlitShaderHandle = pResourceManagingSystem->LoadResourceAsync<ShaderResrouce>("Shaders/FinalBlit.shaderbundle", EResourceLoadPriority::eHigh, {});
+	auto testFinalBlitShaderHandle = pResourceManagingSystem->LoadResourceAsync<ShaderResrouce>("Shaders/testFinalBlit.shaderbundle", EResourceLoadPriority::eLow, {});
+	auto testComputeShaderHandle = pResourceManagingSystem->LoadResourceAsync<ShaderResrouce>("Shaders/TestComputeShader.shaderbundle", EResourceLoadPriority::eLow, {});
+	auto clusterCullingShaderHandle = pResourceManagingSystem->LoadResourceAsync<ShaderResrouce>("Shaders/ClusterCulling.shaderbundle", EResourceLoadPriority::eHigh, {});
+	auto testMeshHandle = pResourceManagingSystem->LoadResourceAsync<StaticMeshResource>("Models/VikingRoom/mesh.scene", EResourceLoadPriority::eNormal, {});
+	//Only the coarse mips cooked into the textures load here, finer ones are streamed in by TextureStreamer
+	castl::string texturePath0 = "Models/VikingRoom/IMG_2348.texture";
+	castl::string texturePath1 = "Models/VikingRoom/IMG_2349.texture";
+	auto textureHandle0 = pResourceManagingSystem->LoadResourceAsync<TextureResource>(texturePath0, EResourceLoadPriority::eNormal, {});
+	auto textureHandle1 = pResourceManagingSystem->LoadResourceAsync<TextureResource>(texturePath1, EResourceLoadPriority::eNormal, {});
+
+	ShaderResrouce* pMeshShaderResource = meshShaderHandle.Wait();
+	ShaderResrouce* pFinalBlitShader = finalBlitShaderHandle.Wait();
+	ShaderResrouce* pFinalBlitShaderResource = testFinalBlitShaderHandle.Wait();
+	ShaderResrouce* pTestComputeShaderResource = testComputeShaderHandle.Wait();
+	ShaderResrouce* pClusterCullingShader = clusterCullingShaderHandle.Wait();
+	StaticMeshResource* pTestMeshResource = testMeshHandle.Wait();
+	TextureResource* pTextureResource0 = textureHandle0.Wait();
+	TextureResource* pTextureResource1 = textureHandle1.Wait();
 
 	auto pBackend = renderBackendLoader.New();
 	pBackend->Initialize(GetGlobalTimerSystem(), "Test Vulkan Backend", "CASCADED Engine");
@@ -163,8 +199,10 @@ int main(int argc, char *argv[])
 	auto indexBuffer = pBackend->CreateGPUBuffer(
 		EBufferUsage::eIndexBuffer | EBufferUsage::eDataDst, indexDataList.size(), sizeof(uint16_t));
 
-	auto texture = pBackend->CreateGPUTexture(GPUTextureDescriptor::Create(pTextureResource0->GetWidth(), pTextureResource0->GetHeight(), pTextureResource0->GetFormat(), ETextureAccessType::eSampled | ETextureAccessType::eTransferDst));
-	auto texture1 = pBackend->CreateGPUTexture(GPUTextureDescriptor::Create(pTextureResource1->GetWidth(), pTextureResource1->GetHeight(), pTextureResource1->GetFormat(), ETextureAccessType::eSampled | ETextureAccessType::eTransferDst));
+	//GPU copies count against the budgets of the resources they are created from, texture streaming updates its own
+	pResourceManagingSystem->SetExternalMemorySize(pTestMeshResource
+		, pTestMeshResource->GetVertexDataSize() + pTestMeshResource->GetIndexDataSize()
+		+ pTestMeshResource->GetMeshlets().size() * sizeof(StaticMeshResource::MeshletInfo));
 
 	pThreadManager->OneTime([&](auto setup)
 	{
@@ -172,11 +210,10 @@ int main(int argc, char *argv[])
 				->Name("Setup")
 				->Func([&, pBackend = pBackend](auto scheduler)
 				{
+					pBackend->PrewarmPipelines(scheduler);
 					castl::shared_ptr<GPUGraph> submitGraph = castl::make_shared<GPUGraph>();
 					submitGraph->ScheduleData(BufferHandle{ vertexBuffer }, vertexDataList.data(), vertexDataList.size() * sizeof(vertexDataList[0]));
 					submitGraph->ScheduleData(BufferHandle{ indexBuffer }, indexDataList.data(), indexDataList.size() * sizeof(indexDataList[0]));
-					submitGraph->ScheduleData(texture, pTextureResource0->GetData(), pTextureResource0->GetDataSize());
-					submitGraph->ScheduleData(texture1, pTextureResource1->GetData(), pTextureResource1->GetDataSize());
 					RegisterMeshResource(pBackend, submitGraph.get(), pTestMeshResource);
 
 					imguiContext.Initialize(editorResourceString, pBackend, windowSystem, newWindow.lock(), pResourceManagingSystem.get(), submitGraph.get());
@@ -204,7 +241,6 @@ int main(int argc, char *argv[])
 		, RasterizerStates::CullBack()
 	};
 	meshMaterial0.shaderArgs = castl::make_shared<ShaderArgList>();
-	meshMaterial0.shaderArgs->SetImage("albedoTexture", texture1);
 	meshMaterial0.shaderArgs->SetSampler("sampler", TextureSamplerDescriptor::Create());
 	meshMaterial0.shaderSet = pMeshShaderResource;
 
@@ -214,10 +250,16 @@ int main(int argc, char *argv[])
 		, RasterizerStates::CullBack()
 	};
 	meshMaterial1.shaderArgs = castl::make_shared<ShaderArgList>();
-	meshMaterial1.shaderArgs->SetImage("albedoTexture", texture);
 	meshMaterial1.shaderArgs->SetSampler("sampler", TextureSamplerDescriptor::Create());
 	meshMaterial1.shaderSet = pMeshShaderResource;
 
+	TextureStreamer textureStreamer{ pBackend, pResourceManagingSystem.get() };
+	textureStreamer.SetMemoryBudget(textureBudgetMB * 1024 * 1024);
+	//Mips the streamer dropped stay loaded for when they are needed again, until this much mip data is cached
+	pResourceManagingSystem->SetResourceBudget<TextureMipResource>(textureBudgetMB * 1024 * 1024);
+	textureStreamer.AddTexture(texturePath1, pTextureResource1, meshMaterial0.shaderArgs, "albedoTexture");
+	textureStreamer.AddTexture(texturePath0, pTextureResource0, meshMaterial1.shaderArgs, "albedoTexture");
+
 
 	MeshRenderer meshRenderer{};
 	meshRenderer.p_MeshResource = pTestMeshResource;
@@ -226,6 +268,7 @@ int main(int argc, char *argv[])
 	meshRenderer.materials[1] = meshMaterial1;
 
 	MeshBatcher meshBatcher{ pBackend };
+	meshBatcher.SetClusterCullingShader(pClusterCullingShader);
 	meshBatcher.AddMeshRenderer(meshRenderer, glm::mat4(1.0f));
 
 	Camera camera;
@@ -260,6 +303,7 @@ int main(int argc, char *argv[])
 		{
 			return;
 		}
+		pResourceManagingSystem->ScheduleLoadCallbacks(setup, { "MainThread" });
 
 		castl::shared_ptr<GPUGraph> newGraph = castl::make_shared<GPUGraph>();
 
@@ -272,6 +316,10 @@ int main(int argc, char *argv[])
 					CPUTIMER_SCOPE("Draw Everything");
 					//IMGUI Logic
 					imguiContext.PrepareDrawData(newGraph.get());
+					//Mips are picked from the screen sizes of the last frame, uploads land before this frame's draws
+					textureStreamer.UpdateDesiredMips(meshBatcher.GetMaterialScreenSizes());
+					meshBatcher.ClearMaterialScreenSizes();
+					textureStreamer.Update(newGraph.get());
 					//Draw Viewports Here
 #pragma region DrawLoop
 					auto& viewContexts = imguiContext.GetTextureViewContexts();
@@ -351,7 +399,11 @@ int main(int argc, char *argv[])
 							, AttachmentConfig::ClearDepthStencil())
 							.PushShaderArguments("cameraData", cameraArgList)
 							.PushShaderArguments("globalLighting", globalLightShaderArg);
-						meshBatcher.Draw(newGraph.get(), &drawMeshRenderPass);
+						MeshBatchView meshBatchView{};
+						meshBatchView.cameraArgs = cameraArgList;
+						meshBatchView.position = camera.GetPosition();
+						meshBatchView.projectionScale = glm::abs(camera.GetProjMatrix()[1][1]) * windowSize1.y * 0.5f;
+						meshBatcher.Draw(newGraph.get(), &drawMeshRenderPass, meshBatchView);
 						newGraph->AddPass(drawMeshRenderPass)
 							.AddPass
 							(
@@ -396,6 +448,15 @@ int main(int argc, char *argv[])
 	}, "FullGraph");
 	pThreadManager->Run();
 	pThreadManager->LogStatus();
+	if (verbose)
+	{
+		for (auto& statistics : pResourceManagingSystem->GetMemoryStatistics())
+		{
+			std::cout << statistics.typeName.c_str() << ": " << statistics.residentCount << " resident, " << statistics.referencedCount << " referenced, "
+				<< statistics.residentBytes << " + " << statistics.externalBytes << " external bytes, budget " << statistics.budgetBytes
+				<< ", " << statistics.evictedCount << " evicted" << std::endl;
+		}
+	}
 	pThreadManager.reset();
 	pBackend->Release();
 	pBackend.reset();
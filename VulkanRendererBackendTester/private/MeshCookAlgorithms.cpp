@@ -0,0 +1,569 @@
+#include "MeshCookPasses.h"
+#include <CASTL/CAAlgorithm.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <cfloat>
+#include <cmath>
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t INVALID_ID = 0xFFFFFFFF;
+
+		//Scoring of Tom Forsyth's linear speed vertex cache optimization, vertices used recently
+		//and vertices with few triangles left score higher
+		constexpr uint32_t VERTEX_CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.0f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		float VertexScore(uint32_t remainingTriangles, int32_t cachePosition)
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.0f;
+			}
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+				{
+					//Vertices of the last triangle get a fixed score, so the next triangle does not just reuse its edge
+					score = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					float scaler = 1.0f - static_cast<float>(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3);
+					score = std::pow(scaler, CACHE_DECAY_POWER);
+				}
+			}
+			return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+		}
+
+		//Borders keep their outline, collapsing across them costs as much as this many faces
+		constexpr float BORDER_QUADRIC_WEIGHT = 10.0f;
+
+		//Sum of squared distances to weighted planes, the error of a point is the weighted mean
+		struct Quadric
+		{
+			double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+			double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+			double c = 0.0;
+			double weight = 0.0;
+
+			void AddPlane(glm::vec3 const& normal, float distance, float planeWeight)
+			{
+				a00 += planeWeight * normal.x * normal.x;
+				a01 += planeWeight * normal.x * normal.y;
+				a02 += planeWeight * normal.x * normal.z;
+				a11 += planeWeight * normal.y * normal.y;
+				a12 += planeWeight * normal.y * normal.z;
+				a22 += planeWeight * normal.z * normal.z;
+				b0 += planeWeight * normal.x * distance;
+				b1 += planeWeight * normal.y * distance;
+				b2 += planeWeight * normal.z * distance;
+				c += planeWeight * distance * distance;
+				weight += planeWeight;
+			}
+
+			void Add(Quadric const& other)
+			{
+				a00 += other.a00; a01 += other.a01; a02 += other.a02;
+				a11 += other.a11; a12 += other.a12; a22 += other.a22;
+				b0 += other.b0; b1 += other.b1; b2 += other.b2;
+				c += other.c;
+				weight += other.weight;
+			}
+
+			//Squared distance
+			double Error(glm::vec3 const& p) const
+			{
+				double result = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+					+ 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+					+ 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z)
+					+ c;
+				return weight > 0.0 ? castl::max(result, 0.0) / weight : 0.0;
+			}
+		};
+
+		uint64_t EdgeKey(uint32_t from, uint32_t to)
+		{
+			return (static_cast<uint64_t>(from) << 32) | to;
+		}
+
+		glm::vec3 TriangleNormal(glm::vec3 const& p0, glm::vec3 const& p1, glm::vec3 const& p2)
+		{
+			return glm::cross(p1 - p0, p2 - p0);
+		}
+	}
+
+	void MeshVertexOrderPass::OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		uint32_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		//Triangles of every vertex, the ones not emitted yet are kept at the front of its range
+		castl::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+		for (uint32_t indexID = 0; indexID < triangleCount * 3; ++indexID)
+		{
+			++triangleOffsets[pIndices[indexID] + 1];
+		}
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			triangleOffsets[vertexID + 1] += triangleOffsets[vertexID];
+		}
+		castl::vector<uint32_t> remainingTriangles(vertexCount, 0);
+		castl::vector<uint32_t> vertexTriangles(triangleCount * 3);
+		for (uint32_t triangleID = 0; triangleID < triangleCount; ++triangleID)
+		{
+			for (uint32_t cornerID = 0; cornerID < 3; ++cornerID)
+			{
+				uint32_t vertexID = pIndices[triangleID * 3 + cornerID];
+				vertexTriangles[triangleOffsets[vertexID] + remainingTriangles[vertexID]++] = triangleID;
+			}
+		}
+
+		castl::vector<int32_t> cachePositions(vertexCount, -1);
+		castl::vector<float> vertexScores(vertexCount);
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			vertexScores[vertexID] = VertexScore(remainingTriangles[vertexID], -1);
+		}
+		castl::vector<float> triangleScores(triangleCount);
+		castl::vector<uint8_t> emitted(triangleCount, 0);
+		uint32_t bestTriangle = 0;
+		for (uint32_t triangleID = 0; triangleID < triangleCount; ++triangleID)
+		{
+			uint32_t const* pTriangle = pIndices + triangleID * 3;
+			triangleScores[triangleID] = vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+			if (triangleScores[triangleID] > triangleScores[bestTriangle])
+			{
+				bestTriangle = triangleID;
+			}
+		}
+
+		castl::vector<uint32_t> orderedIndices(triangleCount * 3);
+		castl::vector<uint32_t> cache;
+		castl::vector<uint32_t> newCache;
+		cache.reserve(VERTEX_CACHE_SIZE + 3);
+		newCache.reserve(VERTEX_CACHE_SIZE + 3);
+		uint32_t nextTriangle = 0;
+		for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			if (bestTriangle == INVALID_ID)
+			{
+				//No cached vertex has triangles left, continue with the first triangle not emitted
+				while (emitted[nextTriangle])
+				{
+					++nextTriangle;
+				}
+				bestTriangle = nextTriangle;
+			}
+			uint32_t const* pTriangle = pIndices + bestTriangle * 3;
+			orderedIndices[emittedCount * 3] = pTriangle[0];
+			orderedIndices[emittedCount * 3 + 1] = pTriangle[1];
+			orderedIndices[emittedCount * 3 + 2] = pTriangle[2];
+			emitted[bestTriangle] = 1;
+
+			newCache.clear();
+			for (uint32_t cornerID = 0; cornerID < 3; ++cornerID)
+			{
+				uint32_t vertexID = pTriangle[cornerID];
+				uint32_t* pBegin = vertexTriangles.data() + triangleOffsets[vertexID];
+				uint32_t* pEnd = pBegin + remainingTriangles[vertexID];
+				uint32_t* pFound = castl::find(pBegin, pEnd, bestTriangle);
+				castl::swap(*pFound, *(pEnd - 1));
+				--remainingTriangles[vertexID];
+				if (castl::find(newCache.begin(), newCache.end(), vertexID) == newCache.end())
+				{
+					newCache.push_back(vertexID);
+				}
+			}
+			for (uint32_t vertexID : cache)
+			{
+				if (vertexID != pTriangle[0] && vertexID != pTriangle[1] && vertexID != pTriangle[2])
+				{
+					newCache.push_back(vertexID);
+				}
+			}
+
+			//Vertices pushed out of the cache are rescored as well, their triangles may still touch cached ones
+			for (uint32_t cacheID = 0; cacheID < newCache.size(); ++cacheID)
+			{
+				uint32_t vertexID = newCache[cacheID];
+				cachePositions[vertexID] = cacheID < VERTEX_CACHE_SIZE ? static_cast<int32_t>(cacheID) : -1;
+				float score = VertexScore(remainingTriangles[vertexID], cachePositions[vertexID]);
+				float scoreDelta = score - vertexScores[vertexID];
+				vertexScores[vertexID] = score;
+				for (uint32_t triangleID = 0; triangleID < remainingTriangles[vertexID]; ++triangleID)
+				{
+					triangleScores[vertexTriangles[triangleOffsets[vertexID] + triangleID]] += scoreDelta;
+				}
+			}
+			if (newCache.size() > VERTEX_CACHE_SIZE)
+			{
+				newCache.resize(VERTEX_CACHE_SIZE);
+			}
+
+			//Only triangles of cached vertices are candidates, keeping the search linear
+			bestTriangle = INVALID_ID;
+			float bestScore = -1.0f;
+			for (uint32_t vertexID : newCache)
+			{
+				for (uint32_t triangleID = 0; triangleID < remainingTriangles[vertexID]; ++triangleID)
+				{
+					uint32_t candidate = vertexTriangles[triangleOffsets[vertexID] + triangleID];
+					if (triangleScores[candidate] > bestScore)
+					{
+						bestScore = triangleScores[candidate];
+						bestTriangle = candidate;
+					}
+				}
+			}
+			castl::swap(cache, newCache);
+		}
+		castl::copy(orderedIndices.begin(), orderedIndices.end(), pIndices);
+	}
+
+	castl::vector<uint32_t> MeshVertexOrderPass::OptimizeVertexFetch(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		castl::vector<uint32_t> remap(vertexCount, INVALID_ID);
+		castl::vector<uint32_t> vertexOrder;
+		vertexOrder.reserve(vertexCount);
+		for (uint32_t indexID = 0; indexID < indexCount; ++indexID)
+		{
+			uint32_t& newVertexID = remap[pIndices[indexID]];
+			if (newVertexID == INVALID_ID)
+			{
+				newVertexID = static_cast<uint32_t>(vertexOrder.size());
+				vertexOrder.push_back(pIndices[indexID]);
+			}
+			pIndices[indexID] = newVertexID;
+		}
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			if (remap[vertexID] == INVALID_ID)
+			{
+				remap[vertexID] = static_cast<uint32_t>(vertexOrder.size());
+				vertexOrder.push_back(vertexID);
+			}
+		}
+		return vertexOrder;
+	}
+
+	castl::vector<MeshletBuildPass::MeshletRange> MeshletBuildPass::SplitMeshlets(uint32_t const* pIndices, uint32_t indexCount, uint32_t vertexCount)
+	{
+		castl::vector<MeshletRange> result;
+		//Triangles are taken in index order, the cache optimized order keeps neighbouring triangles together
+		castl::vector<uint32_t> vertexMeshlet(vertexCount, INVALID_ID);
+		MeshletRange meshlet{};
+		uint32_t triangleCount = indexCount / 3;
+		for (uint32_t triangleID = 0; triangleID < triangleCount; ++triangleID)
+		{
+			uint32_t const* pTriangle = pIndices + triangleID * 3;
+			uint32_t meshletID = static_cast<uint32_t>(result.size());
+			uint32_t newVertexCount = (vertexMeshlet[pTriangle[0]] != meshletID)
+				+ (vertexMeshlet[pTriangle[1]] != meshletID && pTriangle[1] != pTriangle[0])
+				+ (vertexMeshlet[pTriangle[2]] != meshletID && pTriangle[2] != pTriangle[0] && pTriangle[2] != pTriangle[1]);
+			if (meshlet.indexCount > 0
+				&& (meshlet.vertexCount + newVertexCount > MAX_MESHLET_VERTICES || meshlet.indexCount / 3 + 1 > MAX_MESHLET_TRIANGLES))
+			{
+				result.push_back(meshlet);
+				meshlet.firstIndex = triangleID * 3;
+				meshlet.indexCount = 0;
+				meshlet.vertexCount = 0;
+				++meshletID;
+				newVertexCount = 1 + (pTriangle[1] != pTriangle[0]) + (pTriangle[2] != pTriangle[0] && pTriangle[2] != pTriangle[1]);
+			}
+			for (uint32_t cornerID = 0; cornerID < 3; ++cornerID)
+			{
+				vertexMeshlet[pTriangle[cornerID]] = meshletID;
+			}
+			meshlet.vertexCount += newVertexCount;
+			meshlet.indexCount += 3;
+		}
+		if (meshlet.indexCount > 0)
+		{
+			result.push_back(meshlet);
+		}
+		return result;
+	}
+
+	castl::vector<uint32_t> MeshLodPass::Simplify(uint32_t const* pIndices, uint32_t indexCount
+		, glm::vec3 const* pPositions, uint32_t vertexCount
+		, uint32_t targetIndexCount, float targetError, float& outError)
+	{
+		outError = 0.0f;
+		castl::vector<uint32_t> indices(pIndices, pIndices + indexCount / 3 * 3);
+		if (vertexCount == 0)
+		{
+			return indices;
+		}
+
+		//Vertices sharing a position are wedges of one group, groups move as a whole so seams stay closed
+		castl::vector<uint32_t> sortedVertices(vertexCount);
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			sortedVertices[vertexID] = vertexID;
+		}
+		auto positionLess = [pPositions](uint32_t lhs, uint32_t rhs)
+			{
+				glm::vec3 const& a = pPositions[lhs];
+				glm::vec3 const& b = pPositions[rhs];
+				return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+			};
+		castl::sort(sortedVertices.begin(), sortedVertices.end(), positionLess);
+		castl::vector<uint32_t> vertexGroups(vertexCount);
+		castl::vector<uint32_t> groupWedgeOffsets;
+		for (uint32_t sortedID = 0; sortedID < vertexCount; ++sortedID)
+		{
+			if (sortedID == 0 || pPositions[sortedVertices[sortedID]] != pPositions[sortedVertices[sortedID - 1]])
+			{
+				groupWedgeOffsets.push_back(sortedID);
+			}
+			vertexGroups[sortedVertices[sortedID]] = static_cast<uint32_t>(groupWedgeOffsets.size() - 1);
+		}
+		uint32_t groupCount = static_cast<uint32_t>(groupWedgeOffsets.size());
+		groupWedgeOffsets.push_back(vertexCount);
+		auto groupPosition = [&](uint32_t groupID) -> glm::vec3 const&
+			{
+				return pPositions[sortedVertices[groupWedgeOffsets[groupID]]];
+			};
+
+		castl::unordered_map<uint64_t, uint32_t> groupEdges;
+		auto gatherGroupEdges = [&]()
+			{
+				groupEdges.clear();
+				for (uint32_t indexID = 0; indexID < indices.size(); indexID += 3)
+				{
+					for (uint32_t cornerID = 0; cornerID < 3; ++cornerID)
+					{
+						++groupEdges[EdgeKey(vertexGroups[indices[indexID + cornerID]], vertexGroups[indices[indexID + (cornerID + 1) % 3]])];
+					}
+				}
+			};
+		auto isBorderEdge = [&](uint32_t groupA, uint32_t groupB)
+			{
+				return groupEdges.find(EdgeKey(groupA, groupB)) == groupEdges.end()
+					|| groupEdges.find(EdgeKey(groupB, groupA)) == groupEdges.end();
+			};
+
+		castl::vector<Quadric> quadrics(groupCount);
+		castl::vector<uint8_t> borderGroups(groupCount, 0);
+		gatherGroupEdges();
+		for (uint32_t indexID = 0; indexID < indices.size(); indexID += 3)
+		{
+			uint32_t groups[3] = { vertexGroups[indices[indexID]], vertexGroups[indices[indexID + 1]], vertexGroups[indices[indexID + 2]] };
+			glm::vec3 normal = TriangleNormal(groupPosition(groups[0]), groupPosition(groups[1]), groupPosition(groups[2]));
+			float area = glm::length(normal);
+			if (area <= 0.0f)
+			{
+				continue;
+			}
+			normal /= area;
+			for (uint32_t cornerID = 0; cornerID < 3; ++cornerID)
+			{
+				quadrics[groups[cornerID]].AddPlane(normal, -glm::dot(normal, groupPosition(groups[cornerID])), area * 0.5f);
+				uint32_t nextGroup = groups[(cornerID + 1) % 3];
+				if (groupEdges.find(EdgeKey(nextGroup, groups[cornerID])) == groupEdges.end())
+				{
+					//Plane through the border edge perpendicular to the face
+					glm::vec3 edge = groupPosition(nextGroup) - groupPosition(groups[cornerID]);
+					float edgeLength = glm::length(edge);
+					if (edgeLength > 0.0f)
+					{
+						glm::vec3 borderNormal = glm::normalize(glm::cross(edge / edgeLength, normal));
+						float borderDistance = -glm::dot(borderNormal, groupPosition(groups[cornerID]));
+						quadrics[groups[cornerID]].AddPlane(borderNormal, borderDistance, edgeLength * edgeLength * BORDER_QUADRIC_WEIGHT);
+						quadrics[nextGroup].AddPlane(borderNormal, borderDistance, edgeLength * edgeLength * BORDER_QUADRIC_WEIGHT);
+					}
+					borderGroups[groups[cornerID]] = 1;
+					borderGroups[nextGroup] = 1;
+				}
+			}
+		}
+
+		struct Collapse
+		{
+			uint32_t fromGroup;
+			uint32_t toGroup;
+			double error;
+		};
+		castl::vector<Collapse> collapses;
+		castl::vector<uint32_t> wedgeTriangleOffsets;
+		castl::vector<uint32_t> wedgeTriangles;
+		castl::vector<uint32_t> wedgeRemap(vertexCount);
+		castl::vector<uint8_t> lockedGroups(groupCount);
+		double maxAppliedError = 0.0;
+		double errorLimit = static_cast<double>(targetError) * targetError;
+		while (indices.size() > targetIndexCount)
+		{
+			uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+			wedgeTriangleOffsets.assign(vertexCount + 1, 0);
+			for (uint32_t index : indices)
+			{
+				++wedgeTriangleOffsets[index + 1];
+			}
+			for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+			{
+				wedgeTriangleOffsets[vertexID + 1] += wedgeTriangleOffsets[vertexID];
+			}
+			wedgeTriangles.resize(indices.size());
+			{
+				castl::vector<uint32_t> fillOffsets(wedgeTriangleOffsets.begin(), wedgeTriangleOffsets.end() - 1);
+				for (uint32_t indexID = 0; indexID < indices.size(); ++indexID)
+				{
+					wedgeTriangles[fillOffsets[indices[indexID]]++] = indexID / 3;
+				}
+			}
+			if (groupEdges.empty())
+			{
+				gatherGroupEdges();
+			}
+
+			//Both directions of every edge are scored, borders may only slide along themselves
+			collapses.clear();
+			for (uint32_t indexID = 0; indexID < indices.size(); ++indexID)
+			{
+				uint32_t groupA = vertexGroups[indices[indexID]];
+				uint32_t groupB = vertexGroups[indices[indexID - indexID % 3 + (indexID % 3 + 1) % 3]];
+				bool borderEdge = isBorderEdge(groupA, groupB);
+				if (groupA == groupB || (groupA > groupB && !borderEdge))
+				{
+					continue;
+				}
+				Quadric edgeQuadric = quadrics[groupA];
+				edgeQuadric.Add(quadrics[groupB]);
+				double errorAB = (!borderGroups[groupA] || borderEdge) ? edgeQuadric.Error(groupPosition(groupB)) : DBL_MAX;
+				double errorBA = (!borderGroups[groupB] || borderEdge) ? edgeQuadric.Error(groupPosition(groupA)) : DBL_MAX;
+				if (castl::min(errorAB, errorBA) <= errorLimit)
+				{
+					collapses.push_back(errorAB <= errorBA ? Collapse{ groupA, groupB, errorAB } : Collapse{ groupB, groupA, errorBA });
+				}
+			}
+			if (collapses.empty())
+			{
+				break;
+			}
+			castl::sort(collapses.begin(), collapses.end(), [](Collapse const& lhs, Collapse const& rhs)
+				{
+					return lhs.error < rhs.error;
+				});
+
+			//Collapses of one round do not touch each other's one ring, so their checks stay valid
+			for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+			{
+				wedgeRemap[vertexID] = vertexID;
+			}
+			castl::fill(lockedGroups.begin(), lockedGroups.end(), 0);
+			uint32_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+			uint32_t removedTriangles = 0;
+			uint32_t appliedCollapses = 0;
+			for (auto& collapse : collapses)
+			{
+				if (lockedGroups[collapse.fromGroup] || lockedGroups[collapse.toGroup])
+				{
+					continue;
+				}
+				glm::vec3 const& targetPosition = groupPosition(collapse.toGroup);
+				bool valid = true;
+				uint32_t collapsedTriangles = 0;
+				for (uint32_t wedgeID = groupWedgeOffsets[collapse.fromGroup]; valid && wedgeID < groupWedgeOffsets[collapse.fromGroup + 1]; ++wedgeID)
+				{
+					uint32_t wedge = sortedVertices[wedgeID];
+					uint32_t targetWedge = INVALID_ID;
+					for (uint32_t triangleID = wedgeTriangleOffsets[wedge]; valid && triangleID < wedgeTriangleOffsets[wedge + 1]; ++triangleID)
+					{
+						uint32_t const* pTriangle = indices.data() + wedgeTriangles[triangleID] * 3;
+						uint32_t cornerID = pTriangle[0] == wedge ? 0 : (pTriangle[1] == wedge ? 1 : 2);
+						uint32_t next = pTriangle[(cornerID + 1) % 3];
+						uint32_t previous = pTriangle[(cornerID + 2) % 3];
+						if (vertexGroups[next] == collapse.toGroup || vertexGroups[previous] == collapse.toGroup)
+						{
+							//Wedges follow the neighbour they share a face with, keeping their attributes continuous
+							targetWedge = vertexGroups[next] == collapse.toGroup ? next : previous;
+							++collapsedTriangles;
+							continue;
+						}
+						glm::vec3 const& p1 = pPositions[next];
+						glm::vec3 const& p2 = pPositions[previous];
+						glm::vec3 oldNormal = TriangleNormal(pPositions[wedge], p1, p2);
+						glm::vec3 newNormal = TriangleNormal(targetPosition, p1, p2);
+						if (glm::dot(oldNormal, newNormal) <= 0.0f)
+						{
+							valid = false;
+						}
+					}
+					if (wedgeTriangleOffsets[wedge] == wedgeTriangleOffsets[wedge + 1])
+					{
+						continue;
+					}
+					if (targetWedge == INVALID_ID)
+					{
+						valid = false;
+					}
+					else
+					{
+						wedgeRemap[wedge] = targetWedge;
+					}
+				}
+				if (!valid)
+				{
+					for (uint32_t wedgeID = groupWedgeOffsets[collapse.fromGroup]; wedgeID < groupWedgeOffsets[collapse.fromGroup + 1]; ++wedgeID)
+					{
+						wedgeRemap[sortedVertices[wedgeID]] = sortedVertices[wedgeID];
+					}
+					continue;
+				}
+				for (uint32_t wedgeID = groupWedgeOffsets[collapse.fromGroup]; wedgeID < groupWedgeOffsets[collapse.fromGroup + 1]; ++wedgeID)
+				{
+					uint32_t wedge = sortedVertices[wedgeID];
+					for (uint32_t triangleID = wedgeTriangleOffsets[wedge]; triangleID < wedgeTriangleOffsets[wedge + 1]; ++triangleID)
+					{
+						uint32_t const* pTriangle = indices.data() + wedgeTriangles[triangleID] * 3;
+						lockedGroups[vertexGroups[pTriangle[0]]] = 1;
+						lockedGroups[vertexGroups[pTriangle[1]]] = 1;
+						lockedGroups[vertexGroups[pTriangle[2]]] = 1;
+					}
+				}
+				quadrics[collapse.toGroup].Add(quadrics[collapse.fromGroup]);
+				maxAppliedError = castl::max(maxAppliedError, collapse.error);
+				//Triangles are counted once per wedge corner, a face has one corner in the collapsed group
+				removedTriangles += collapsedTriangles;
+				++appliedCollapses;
+				if (removedTriangles >= trianglesToRemove)
+				{
+					break;
+				}
+			}
+			if (appliedCollapses == 0)
+			{
+				break;
+			}
+
+			uint32_t writeID = 0;
+			for (uint32_t indexID = 0; indexID < indices.size(); indexID += 3)
+			{
+				uint32_t a = wedgeRemap[indices[indexID]];
+				uint32_t b = wedgeRemap[indices[indexID + 1]];
+				uint32_t c = wedgeRemap[indices[indexID + 2]];
+				if (vertexGroups[a] != vertexGroups[b] && vertexGroups[b] != vertexGroups[c] && vertexGroups[a] != vertexGroups[c])
+				{
+					indices[writeID++] = a;
+					indices[writeID++] = b;
+					indices[writeID++] = c;
+				}
+			}
+			indices.resize(writeID);
+			groupEdges.clear();
+		}
+		outError = static_cast<float>(std::sqrt(maxAppliedError));
+		return indices;
+	}
+}
@@ -0,0 +1,291 @@
+#include "MeshCookPasses.h"
+#include "StaticMeshResource.h"
+#include <CASTL/CAAlgorithm.h>
+#include <glm/packing.hpp>
+#include <cmath>
+
+namespace resource_management
+{
+	namespace
+	{
+		//Indices stay below 0xFFFF, it restarts primitives when restart is enabled
+		constexpr int MAX_VERTEX_COUNT_16 = 0xFFFF;
+
+		uint32_t PackDirection(glm::vec3 const& direction)
+		{
+			float length = glm::length(direction);
+			glm::vec3 normalized = length > 0.0f ? direction / length : glm::vec3(0.0f);
+			return glm::packSnorm4x8(glm::vec4(normalized, 0.0f));
+		}
+
+		uint32_t IndexSize(EIndexBufferType indexType)
+		{
+			return indexType == EIndexBufferType::e16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+
+		//Meshlets whose triangles spread wider than this are not worth a cone test
+		constexpr float MIN_CONE_DOT = 0.1f;
+
+		void ComputeMeshletBounds(CommonVertexData const* pVertices, uint32_t const* pIndices, StaticMeshResource::MeshletInfo& inoutMeshlet)
+		{
+			uint32_t const* pMeshletIndices = pIndices + inoutMeshlet.m_FirstIndex;
+			glm::vec3 minPos = pVertices[pMeshletIndices[0]].pos;
+			glm::vec3 maxPos = minPos;
+			for (uint32_t indexID = 1; indexID < inoutMeshlet.m_IndexCount; ++indexID)
+			{
+				minPos = glm::min(minPos, pVertices[pMeshletIndices[indexID]].pos);
+				maxPos = glm::max(maxPos, pVertices[pMeshletIndices[indexID]].pos);
+			}
+			glm::vec3 center = (minPos + maxPos) * 0.5f;
+			float radius = 0.0f;
+			for (uint32_t indexID = 0; indexID < inoutMeshlet.m_IndexCount; ++indexID)
+			{
+				radius = castl::max(radius, glm::length(pVertices[pMeshletIndices[indexID]].pos - center));
+			}
+			inoutMeshlet.m_BoundingSphere = glm::vec4(center, radius);
+
+			//Geometric normals are oriented by the vertex normals, so the cone does not depend on the winding convention
+			castl::vector<glm::vec3> triangleNormals;
+			triangleNormals.reserve(inoutMeshlet.m_IndexCount / 3);
+			glm::vec3 normalSum(0.0f);
+			for (uint32_t indexID = 0; indexID + 2 < inoutMeshlet.m_IndexCount; indexID += 3)
+			{
+				CommonVertexData const& v0 = pVertices[pMeshletIndices[indexID]];
+				CommonVertexData const& v1 = pVertices[pMeshletIndices[indexID + 1]];
+				CommonVertexData const& v2 = pVertices[pMeshletIndices[indexID + 2]];
+				glm::vec3 normal = glm::cross(v1.pos - v0.pos, v2.pos - v0.pos);
+				float area = glm::length(normal);
+				if (area <= 0.0f)
+				{
+					continue;
+				}
+				normal /= area;
+				if (glm::dot(normal, v0.normal + v1.normal + v2.normal) < 0.0f)
+				{
+					normal = -normal;
+				}
+				triangleNormals.push_back(normal);
+				normalSum += normal;
+			}
+			float axisLength = glm::length(normalSum);
+			if (triangleNormals.empty() || axisLength <= 0.0f)
+			{
+				inoutMeshlet.m_NormalCone = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+				return;
+			}
+			glm::vec3 axis = normalSum / axisLength;
+			float minDot = 1.0f;
+			for (auto& normal : triangleNormals)
+			{
+				minDot = castl::min(minDot, glm::dot(axis, normal));
+			}
+			//The meshlet faces away when the view direction is inside the cone widened by the normal spread
+			float cutoff = minDot <= MIN_CONE_DOT ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+			inoutMeshlet.m_NormalCone = glm::vec4(axis, cutoff);
+		}
+
+		//Levels that remove less than this share of the previous level are not kept
+		constexpr float MIN_LOD_REDUCTION = 0.1f;
+	}
+
+	void MeshVertexOrderPass::Process(StaticMeshResource* resource) const
+	{
+		//Quantized vertices are not reordered, the pass runs first
+		if (resource->m_VertexFormat != EMeshVertexFormat::eFloat)
+		{
+			return;
+		}
+		CommonVertexData* pVertices = reinterpret_cast<CommonVertexData*>(resource->m_VertexData.data());
+		castl::vector<CommonVertexData> reorderedVertices;
+		for (auto& submesh : resource->m_SubmeshInfos)
+		{
+			if (submesh.m_IndexType != EIndexBufferType::e32)
+			{
+				continue;
+			}
+			uint32_t* pIndices = reinterpret_cast<uint32_t*>(resource->m_IndexData.data() + submesh.m_IndexByteOffset);
+			OptimizeVertexCache(pIndices, submesh.m_IndicesCount, submesh.m_VertexCount);
+			castl::vector<uint32_t> vertexOrder = OptimizeVertexFetch(pIndices, submesh.m_IndicesCount, submesh.m_VertexCount);
+			CommonVertexData* pSubmeshVertices = pVertices + submesh.m_VertexArrayOffset;
+			reorderedVertices.resize(vertexOrder.size());
+			for (uint32_t vertexID = 0; vertexID < vertexOrder.size(); ++vertexID)
+			{
+				reorderedVertices[vertexID] = pSubmeshVertices[vertexOrder[vertexID]];
+			}
+			castl::copy(reorderedVertices.begin(), reorderedVertices.end(), pSubmeshVertices);
+		}
+	}
+
+	void MeshletBuildPass::Process(StaticMeshResource* resource) const
+	{
+		if (resource->m_VertexFormat != EMeshVertexFormat::eFloat)
+		{
+			return;
+		}
+		CommonVertexData const* pVertices = reinterpret_cast<CommonVertexData const*>(resource->m_VertexData.data());
+		resource->m_Meshlets.clear();
+		for (uint32_t submeshID = 0; submeshID < resource->m_SubmeshInfos.size(); ++submeshID)
+		{
+			auto& submesh = resource->m_SubmeshInfos[submeshID];
+			submesh.m_MeshletOffset = static_cast<int>(resource->m_Meshlets.size());
+			submesh.m_MeshletCount = 0;
+			if (submesh.m_IndexType != EIndexBufferType::e32)
+			{
+				continue;
+			}
+			uint32_t const* pIndices = reinterpret_cast<uint32_t const*>(resource->m_IndexData.data() + submesh.m_IndexByteOffset);
+			CommonVertexData const* pSubmeshVertices = pVertices + submesh.m_VertexArrayOffset;
+			for (auto& range : SplitMeshlets(pIndices, submesh.m_IndicesCount, submesh.m_VertexCount))
+			{
+				StaticMeshResource::MeshletInfo meshlet{};
+				meshlet.m_FirstIndex = range.firstIndex;
+				meshlet.m_IndexCount = range.indexCount;
+				meshlet.m_VertexCount = range.vertexCount;
+				meshlet.m_SubmeshID = submeshID;
+				ComputeMeshletBounds(pSubmeshVertices, pIndices, meshlet);
+				resource->m_Meshlets.push_back(meshlet);
+			}
+			submesh.m_MeshletCount = static_cast<int>(resource->m_Meshlets.size()) - submesh.m_MeshletOffset;
+		}
+	}
+
+	void MeshLodPass::Process(StaticMeshResource* resource) const
+	{
+		if (resource->m_VertexFormat != EMeshVertexFormat::eFloat)
+		{
+			return;
+		}
+		CommonVertexData const* pVertices = reinterpret_cast<CommonVertexData const*>(resource->m_VertexData.data());
+		resource->m_Lods.clear();
+		castl::vector<glm::vec3> positions;
+		for (auto& submesh : resource->m_SubmeshInfos)
+		{
+			submesh.m_LodOffset = static_cast<int>(resource->m_Lods.size());
+			submesh.m_LodCount = 0;
+			if (submesh.m_IndexType != EIndexBufferType::e32 || submesh.m_VertexCount == 0)
+			{
+				continue;
+			}
+			CommonVertexData const* pSubmeshVertices = pVertices + submesh.m_VertexArrayOffset;
+			positions.resize(submesh.m_VertexCount);
+			glm::vec3 minPos = pSubmeshVertices[0].pos;
+			glm::vec3 maxPos = minPos;
+			for (int vertexID = 0; vertexID < submesh.m_VertexCount; ++vertexID)
+			{
+				positions[vertexID] = pSubmeshVertices[vertexID].pos;
+				minPos = glm::min(minPos, positions[vertexID]);
+				maxPos = glm::max(maxPos, positions[vertexID]);
+			}
+			glm::vec3 center = (minPos + maxPos) * 0.5f;
+			float radius = 0.0f;
+			for (auto& position : positions)
+			{
+				radius = castl::max(radius, glm::length(position - center));
+			}
+			submesh.m_BoundingSphere = glm::vec4(center, radius);
+
+			//Every level simplifies the previous one, errors add up along the chain
+			uint32_t const* pSourceIndices = reinterpret_cast<uint32_t const*>(resource->m_IndexData.data() + submesh.m_IndexByteOffset);
+			castl::vector<uint32_t> levelIndices(pSourceIndices, pSourceIndices + submesh.m_IndicesCount);
+			float maxError = m_LodMaxError * radius;
+			float levelError = 0.0f;
+			for (uint32_t lodID = 0; lodID < m_LodCount; ++lodID)
+			{
+				uint32_t targetIndexCount = static_cast<uint32_t>(levelIndices.size() * m_LodReduction) / 3 * 3;
+				float simplifyError = 0.0f;
+				castl::vector<uint32_t> lodIndices = Simplify(levelIndices.data(), static_cast<uint32_t>(levelIndices.size())
+					, positions.data(), submesh.m_VertexCount
+					, targetIndexCount, maxError - levelError, simplifyError);
+				if (lodIndices.empty() || lodIndices.size() > levelIndices.size() * (1.0f - MIN_LOD_REDUCTION))
+				{
+					break;
+				}
+				levelError += simplifyError;
+				MeshVertexOrderPass::OptimizeVertexCache(lodIndices.data(), static_cast<uint32_t>(lodIndices.size()), submesh.m_VertexCount);
+
+				//Appended as 32 bit indices, the index width pass moves them next to their submesh
+				uint32_t byteOffset = static_cast<uint32_t>(resource->m_IndexData.size());
+				resource->m_IndexData.resize(byteOffset + lodIndices.size() * sizeof(uint32_t));
+				castl::copy(lodIndices.begin(), lodIndices.end(), reinterpret_cast<uint32_t*>(resource->m_IndexData.data() + byteOffset));
+				resource->m_Lods.push_back(StaticMeshResource::LodInfo{ static_cast<int>(lodIndices.size()), static_cast<int>(byteOffset), levelError });
+				levelIndices = castl::move(lodIndices);
+			}
+			submesh.m_LodCount = static_cast<int>(resource->m_Lods.size()) - submesh.m_LodOffset;
+		}
+	}
+
+	void MeshQuantizeVertexPass::Process(StaticMeshResource* resource) const
+	{
+		if (resource->m_VertexFormat != EMeshVertexFormat::eFloat)
+		{
+			return;
+		}
+		uint32_t vertexCount = resource->GetVertexCount();
+		CommonVertexData const* pVertices = reinterpret_cast<CommonVertexData const*>(resource->m_VertexData.data());
+		std::vector<uint8_t> quantizedData(vertexCount * sizeof(QuantizedVertexData));
+		QuantizedVertexData* pQuantized = reinterpret_cast<QuantizedVertexData*>(quantizedData.data());
+		for (uint32_t vertexID = 0; vertexID < vertexCount; ++vertexID)
+		{
+			CommonVertexData const& vertex = pVertices[vertexID];
+			pQuantized[vertexID].pos = vertex.pos;
+			pQuantized[vertexID].uv = glm::packHalf2x16(vertex.uv);
+			pQuantized[vertexID].normal = PackDirection(vertex.normal);
+			pQuantized[vertexID].tangent = PackDirection(vertex.tangent);
+			pQuantized[vertexID].bitangent = PackDirection(vertex.bitangent);
+		}
+		resource->m_VertexData = castl::move(quantizedData);
+		resource->m_VertexFormat = EMeshVertexFormat::eQuantized;
+	}
+
+	void MeshIndexWidthPass::Process(StaticMeshResource* resource) const
+	{
+		std::vector<uint8_t> indexData;
+		for (auto& submesh : resource->m_SubmeshInfos)
+		{
+			uint8_t const* pSource = resource->m_IndexData.data() + submesh.m_IndexByteOffset;
+			uint32_t byteOffset = static_cast<uint32_t>((indexData.size() + 3) / 4 * 4);
+			if (submesh.m_IndexType == EIndexBufferType::e32 && submesh.m_VertexCount <= MAX_VERTEX_COUNT_16)
+			{
+				indexData.resize(byteOffset + submesh.m_IndicesCount * sizeof(uint16_t));
+				uint32_t const* pSourceIndices = reinterpret_cast<uint32_t const*>(pSource);
+				uint16_t* pDestIndices = reinterpret_cast<uint16_t*>(indexData.data() + byteOffset);
+				for (int indexID = 0; indexID < submesh.m_IndicesCount; ++indexID)
+				{
+					pDestIndices[indexID] = static_cast<uint16_t>(pSourceIndices[indexID]);
+				}
+				submesh.m_IndexType = EIndexBufferType::e16;
+			}
+			else
+			{
+				uint32_t byteSize = submesh.m_IndicesCount * IndexSize(submesh.m_IndexType);
+				indexData.resize(byteOffset + byteSize);
+				castl::copy(pSource, pSource + byteSize, indexData.data() + byteOffset);
+			}
+			submesh.m_IndexByteOffset = byteOffset;
+
+			//LODs of a submesh use its index width and follow it
+			for (int lodID = submesh.m_LodOffset; lodID < submesh.m_LodOffset + submesh.m_LodCount; ++lodID)
+			{
+				auto& lod = resource->m_Lods[lodID];
+				uint32_t const* pLodIndices = reinterpret_cast<uint32_t const*>(resource->m_IndexData.data() + lod.m_IndexByteOffset);
+				uint32_t lodByteOffset = static_cast<uint32_t>((indexData.size() + 3) / 4 * 4);
+				if (submesh.m_IndexType == EIndexBufferType::e16)
+				{
+					indexData.resize(lodByteOffset + lod.m_IndicesCount * sizeof(uint16_t));
+					uint16_t* pDestIndices = reinterpret_cast<uint16_t*>(indexData.data() + lodByteOffset);
+					for (int indexID = 0; indexID < lod.m_IndicesCount; ++indexID)
+					{
+						pDestIndices[indexID] = static_cast<uint16_t>(pLodIndices[indexID]);
+					}
+				}
+				else
+				{
+					indexData.resize(lodByteOffset + lod.m_IndicesCount * sizeof(uint32_t));
+					castl::copy(pLodIndices, pLodIndices + lod.m_IndicesCount, reinterpret_cast<uint32_t*>(indexData.data() + lodByteOffset));
+				}
+				lod.m_IndexByteOffset = lodByteOffset;
+			}
+		}
+		resource->m_IndexData = castl::move(indexData);
+	}
+}
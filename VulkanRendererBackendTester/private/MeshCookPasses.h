@@ -0,0 +1,87 @@
+#pragma once
+#include <CAResource/ResourceImporter.h>
+#include <CASTL/CAVector.h>
+#include <glm/vec3.hpp>
+
+namespace resource_management
+{
+	class StaticMeshResource;
+
+	struct MeshCookSettings
+	{
+		//Reorders triangles for the post transform cache and vertices for fetch locality
+		bool optimizeVertexOrder = true;
+		//Stores QuantizedVertexData instead of CommonVertexData
+		bool quantizeAttributes = false;
+		//Splits submeshes into meshlets with culling bounds for GPU cluster culling
+		bool buildMeshlets = true;
+		//Simplified levels generated after the source one, 0 disables the LOD chain
+		uint32_t lodCount = 4;
+		//Index count of every level relative to the previous one
+		float lodReduction = 0.25f;
+		//Largest simplification error of the last level relative to the submesh bounding radius
+		float lodMaxError = 0.05f;
+	};
+
+	//Expects float vertices and 32 bit indices, run before the other mesh passes
+	class MeshVertexOrderPass : public ResourceImporterPass<StaticMeshResource>
+	{
+	public:
+		virtual void Process(StaticMeshResource* resource) const override;
+		//Triangle order of the vertex cache optimization, indices are in [0, vertexCount)
+		static void OptimizeVertexCache(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+		//Vertex order of first use, unused vertices are moved last. Remaps the indices
+		static castl::vector<uint32_t> OptimizeVertexFetch(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+	};
+
+	//Expects float vertices and 32 bit indices, run after the vertex order pass so meshlets follow the cache order
+	class MeshletBuildPass : public ResourceImporterPass<StaticMeshResource>
+	{
+	public:
+		static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+		static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+		struct MeshletRange
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			//Distinct vertices referenced by the range
+			uint32_t vertexCount;
+		};
+		virtual void Process(StaticMeshResource* resource) const override;
+		//Contiguous triangle ranges within the meshlet limits, triangles are taken in index order. Indices are in [0, vertexCount)
+		static castl::vector<MeshletRange> SplitMeshlets(uint32_t const* pIndices, uint32_t indexCount, uint32_t vertexCount);
+	};
+
+	//Quadric error edge collapse simplification of every submesh into a LOD chain.
+	//Expects float vertices and 32 bit indices, run after the vertex order and meshlet passes
+	class MeshLodPass : public ResourceImporterPass<StaticMeshResource>
+	{
+	public:
+		MeshLodPass() = default;
+		MeshLodPass(uint32_t lodCount, float lodReduction, float lodMaxError)
+			: m_LodCount(lodCount), m_LodReduction(lodReduction), m_LodMaxError(lodMaxError) {}
+		virtual void Process(StaticMeshResource* resource) const override;
+		//Collapses edges onto existing vertices until targetIndexCount is reached or the next collapse moves the
+		//surface further than targetError. Seams and borders only collapse along themselves
+		static castl::vector<uint32_t> Simplify(uint32_t const* pIndices, uint32_t indexCount
+			, glm::vec3 const* pPositions, uint32_t vertexCount
+			, uint32_t targetIndexCount, float targetError, float& outError);
+	private:
+		uint32_t m_LodCount = 0;
+		float m_LodReduction = 0.25f;
+		float m_LodMaxError = 0.05f;
+	};
+
+	class MeshQuantizeVertexPass : public ResourceImporterPass<StaticMeshResource>
+	{
+	public:
+		virtual void Process(StaticMeshResource* resource) const override;
+	};
+
+	//Narrows the indices of submeshes with less than 65535 vertices to 16 bits, run last
+	class MeshIndexWidthPass : public ResourceImporterPass<StaticMeshResource>
+	{
+	public:
+		virtual void Process(StaticMeshResource* resource) const override;
+	};
+}
@@ -1,5 +1,6 @@
 #include "MeshRenderer.h"
 #include "StaticMeshResource.h"
+#include <CASTL/CAMutex.h>
 
 using namespace graphics_backend;
 
@@ -9,37 +10,107 @@ VertexInputsDescriptor const g_InstanceDescriptor = VertexInputsDescriptor{
 	   , {VertexAttribute{0, 0, VertexInputFormat::eR32_UInt, "INSTANCEID"}}
 };
 
-MeshGPUData::MeshGPUData(castl::shared_ptr<graphics_backend::CRenderBackend> renderBackend)
+//Nodes are not moved by insertions, pointers to the GPU data stay valid until the mesh is released
+static castl::mutex g_MeshGPUDataMutex;
+static uint64_t g_NextMeshRegistrationID = 1;
+static castl::unordered_map<resource_management::StaticMeshResource const*, MeshGPUData> g_MeshResourceToGPUData;
+
+void RegisterMeshResource(castl::shared_ptr<graphics_backend::CRenderBackend> pBackend
+	, graphics_backend::GPUGraph* gpuGraph
+	, resource_management::StaticMeshResource* meshResource)
+{
+	castl::lock_guard<castl::mutex> lock(g_MeshGPUDataMutex);
+	auto found = g_MeshResourceToGPUData.find(meshResource);
+	if (found == g_MeshResourceToGPUData.end())
+	{
+		MeshGPUData gpuData{ pBackend, g_NextMeshRegistrationID++ };
+		gpuData.UploadMeshResource(gpuGraph, meshResource);
+		g_MeshResourceToGPUData.insert(castl::make_pair(meshResource, gpuData));
+	}
+}
+
+MeshGPUData* FindMeshGPUData(resource_management::StaticMeshResource const* meshResource)
+{
+	castl::lock_guard<castl::mutex> lock(g_MeshGPUDataMutex);
+	auto found = g_MeshResourceToGPUData.find(meshResource);
+	return found == g_MeshResourceToGPUData.end() ? nullptr : &found->second;
+}
+
+void ReleaseMeshResource(resource_management::StaticMeshResource const* meshResource)
+{
+	castl::lock_guard<castl::mutex> lock(g_MeshGPUDataMutex);
+	g_MeshResourceToGPUData.erase(meshResource);
+}
+
+MeshGPUData::MeshGPUData(castl::shared_ptr<graphics_backend::CRenderBackend> renderBackend, uint64_t registrationID)
 {
 	m_RenderBackend = renderBackend;
-	m_VertexInputDescriptor = resource_management::CommonVertexData::GetVertexInputDescriptor();
+	m_RegistrationID = registrationID;
 }
 
 void MeshGPUData::UploadMeshResource(graphics_backend::GPUGraph* gpuGraph, resource_management::StaticMeshResource* meshResource)
 {
 	p_MeshResource = meshResource;
-	uint32_t vertexCount = meshResource->GetVertexCount();
-	uint32_t indexCount = meshResource->GetIndicesCount();
+	m_VertexInputDescriptor = meshResource->GetVertexInputDescriptor();
+	//Submeshes of both index types share the buffer, each one binds it at its own byte offset
 	m_VertexBuffer = m_RenderBackend->CreateGPUBuffer(EBufferUsage::eDataDst | EBufferUsage::eVertexBuffer
-		, vertexCount, sizeof(resource_management::CommonVertexData));
+		, meshResource->GetVertexCount(), meshResource->GetVertexStride());
 	m_IndicesBuffer = m_RenderBackend->CreateGPUBuffer(EBufferUsage::eDataDst | EBufferUsage::eIndexBuffer
-		, indexCount, sizeof(uint16_t));
+		, meshResource->GetIndexDataSize() / sizeof(uint16_t), sizeof(uint16_t));
 
-	gpuGraph->ScheduleData(m_VertexBuffer, meshResource->GetVertexData(), vertexCount * sizeof(resource_management::CommonVertexData), 0);
-	gpuGraph->ScheduleData(m_IndicesBuffer, meshResource->GetIndicesData(), indexCount * sizeof(uint16_t), 0);
+	auto& meshlets = meshResource->GetMeshlets();
+	if (!meshlets.empty())
+	{
+		m_MeshletBuffer = m_RenderBackend->CreateGPUBuffer(EBufferUsage::eDataDst | EBufferUsage::eStructuredBuffer
+			, meshlets.size(), sizeof(resource_management::StaticMeshResource::MeshletInfo));
+	}
+
+	//Mesh data is streamed on the transfer queue, the mesh is skipped by batches until all buffers arrive
+	m_PendingUploads = castl::make_shared<castl::atomic<uint32_t>>(m_MeshletBuffer != nullptr ? 3 : 2);
+	auto onUploaded = [pendingUploads = m_PendingUploads]()
+		{
+			--(*pendingUploads);
+		};
+	m_RenderBackend->UploadBufferAsync(m_VertexBuffer, meshResource->GetVertexData(), meshResource->GetVertexDataSize(), 0, onUploaded);
+	m_RenderBackend->UploadBufferAsync(m_IndicesBuffer, meshResource->GetIndexData(), meshResource->GetIndexDataSize(), 0, onUploaded);
+	if (m_MeshletBuffer != nullptr)
+	{
+		m_RenderBackend->UploadBufferAsync(m_MeshletBuffer, meshlets.data()
+			, meshlets.size() * sizeof(resource_management::StaticMeshResource::MeshletInfo), 0, onUploaded);
+	}
 }
 
-void MeshGPUData::DrawCall(graphics_backend::DrawCallBatch& drawcallBatch, uint32_t submeshID, uint32_t instanceCount)
+void MeshGPUData::DrawCall(graphics_backend::DrawCallBatch& drawcallBatch, uint32_t submeshID, uint32_t lodLevel, uint32_t instanceCount)
 {
-	drawcallBatch.SetIndexBuffer(EIndexBufferType::e16, m_IndicesBuffer);
+	auto& submeshInfo = p_MeshResource->GetSubmeshInfos()[submeshID];
+	//LODs share the submesh vertices and index type, only the index range differs
+	uint32_t indexByteOffset = submeshInfo.m_IndexByteOffset;
+	uint32_t indexCount = submeshInfo.m_IndicesCount;
+	if (lodLevel > 0)
+	{
+		auto& lodInfo = p_MeshResource->GetLods()[submeshInfo.m_LodOffset + lodLevel - 1];
+		indexByteOffset = lodInfo.m_IndexByteOffset;
+		indexCount = lodInfo.m_IndicesCount;
+	}
+	drawcallBatch.SetIndexBuffer(submeshInfo.m_IndexType, m_IndicesBuffer, indexByteOffset);
 	drawcallBatch.SetVertexBuffer(m_VertexInputDescriptor, m_VertexBuffer);
-	drawcallBatch.Draw([this, submeshID, instanceCount](graphics_backend::CommandList& commandList)
+	//Recorded after the mesh may have been released, only values are captured
+	uint32_t vertexOffset = static_cast<uint32_t>(submeshInfo.m_VertexArrayOffset);
+	drawcallBatch.Draw([indexCount, instanceCount, vertexOffset](graphics_backend::CommandList& commandList)
 		{
-			auto& submeshInfos = p_MeshResource->GetSubmeshInfos();
-			auto& submeshInfo = submeshInfos[submeshID];
-			commandList.DrawIndexed(submeshInfo.m_IndicesCount
+			commandList.DrawIndexed(indexCount
 				, instanceCount
-				, submeshInfo.m_IndexArrayOffset
-				, submeshInfo.m_VertexArrayOffset);
+				, 0
+				, vertexOffset);
 		});
 }
+
+void MeshGPUData::DrawCallIndirect(graphics_backend::DrawCallBatch& drawcallBatch, uint32_t submeshID
+	, graphics_backend::BufferHandle const& argsBuffer, graphics_backend::BufferHandle const& countBuffer, uint32_t maxDrawCount)
+{
+	auto& submeshInfo = p_MeshResource->GetSubmeshInfos()[submeshID];
+	//Meshlet first indices are relative to the submesh, which the index buffer offset points at
+	drawcallBatch.SetIndexBuffer(submeshInfo.m_IndexType, m_IndicesBuffer, submeshInfo.m_IndexByteOffset);
+	drawcallBatch.SetVertexBuffer(m_VertexInputDescriptor, m_VertexBuffer);
+	drawcallBatch.DrawIndexedIndirect(argsBuffer, 0, countBuffer, 0, maxDrawCount);
+}
@@ -3,6 +3,8 @@
 #include <CRenderBackend.h>
 #include "StaticMeshResource.h"
 #include <GPUGraph.h>
+#include <CASTL/CAAtomic.h>
+#include <cfloat>
 
 using namespace graphics_backend;
 
@@ -10,31 +12,37 @@ class MeshGPUData
 {
 public:
 	MeshGPUData() = default;
-	MeshGPUData(castl::shared_ptr<graphics_backend::CRenderBackend> renderBackend);
+	MeshGPUData(castl::shared_ptr<graphics_backend::CRenderBackend> renderBackend, uint64_t registrationID);
 	void UploadMeshResource(graphics_backend::GPUGraph* gpuGraph, resource_management::StaticMeshResource* meshResource);
-	void DrawCall(graphics_backend::DrawCallBatch& drawallBatch, uint32_t submeshID, uint32_t instanceCount);
+	//LOD 0 is the submesh, higher levels are the cooked LOD chain
+	void DrawCall(graphics_backend::DrawCallBatch& drawallBatch, uint32_t submeshID, uint32_t lodLevel, uint32_t instanceCount);
+	//Draws the meshlets that survived cluster culling, argsBuffer and countBuffer are written by ClusterCulling.slang
+	void DrawCallIndirect(graphics_backend::DrawCallBatch& drawallBatch, uint32_t submeshID
+		, graphics_backend::BufferHandle const& argsBuffer, graphics_backend::BufferHandle const& countBuffer, uint32_t maxDrawCount);
+	bool Ready() const { return m_PendingUploads != nullptr && m_PendingUploads->load() == 0; }
+	resource_management::StaticMeshResource const* GetMeshResource() const { return p_MeshResource; }
+	//Unique per registration, tells a mesh registered again at the address of a released one apart
+	uint64_t GetRegistrationID() const { return m_RegistrationID; }
+	castl::shared_ptr<graphics_backend::GPUBuffer> const& GetMeshletBuffer() const { return m_MeshletBuffer; }
 private:
+	castl::shared_ptr<castl::atomic<uint32_t>> m_PendingUploads;
 	castl::shared_ptr<graphics_backend::CRenderBackend> m_RenderBackend;
+	uint64_t m_RegistrationID = 0;
 	resource_management::StaticMeshResource* p_MeshResource;
 	castl::shared_ptr<graphics_backend::GPUBuffer> m_VertexBuffer;
 	castl::shared_ptr<graphics_backend::GPUBuffer> m_IndicesBuffer;
+	castl::shared_ptr<graphics_backend::GPUBuffer> m_MeshletBuffer;
 	cacore::HashObj<VertexInputsDescriptor> m_VertexInputDescriptor;
 };
 
-static castl::unordered_map<resource_management::StaticMeshResource*, MeshGPUData> g_MeshResourceToGPUData;
-
-static void RegisterMeshResource(castl::shared_ptr<graphics_backend::CRenderBackend> pBackend
+//GPU data of a mesh lives until the mesh resource is unloaded, batchers drop the instances of released meshes
+void RegisterMeshResource(castl::shared_ptr<graphics_backend::CRenderBackend> pBackend
 	, graphics_backend::GPUGraph* gpuGraph
-	, resource_management::StaticMeshResource* meshResource)
-{
-	auto found = g_MeshResourceToGPUData.find(meshResource);
-	if (found == g_MeshResourceToGPUData.end())
-	{
-		MeshGPUData gpuData{ pBackend };
-		gpuData.UploadMeshResource(gpuGraph, meshResource);
-		g_MeshResourceToGPUData.insert(castl::make_pair(meshResource, gpuData));
-	}
-}
+	, resource_management::StaticMeshResource* meshResource);
+//Null when the mesh was not registered, the pointer is valid until the mesh is released
+MeshGPUData* FindMeshGPUData(resource_management::StaticMeshResource const* meshResource);
+//Called by StaticMeshResource::Unload, buffers still used by frames in flight are released after them
+void ReleaseMeshResource(resource_management::StaticMeshResource const* meshResource);
 
 struct MeshMaterial
 {
@@ -55,19 +63,47 @@ public:
 
 extern VertexInputsDescriptor const g_InstanceDescriptor;
 
+struct MeshBatchView
+{
+	castl::shared_ptr<graphics_backend::ShaderArgList> cameraArgs;
+	glm::vec3 position;
+	//Pixels covered by one world unit at distance one, projection[1][1] * viewport height / 2
+	float projectionScale;
+};
+
 class MeshBatcher
 {
 	castl::shared_ptr<graphics_backend::CRenderBackend> pRenderBackend;
+	//Meshlets are culled on the GPU when set and the device supports indirect draw counts
+	IShaderSet const* m_ClusterCullingShader = nullptr;
 
-	castl::vector<glm::mat4> m_Instances;
+	//Coarsest LOD whose simplification error stays under this many pixels on screen
+	float m_LodErrorPixels = 1.0f;
 
+	castl::vector<glm::mat4> m_Instances;
 
+	//Instances are batched again every frame once their LOD is known. The GPU data is looked up again
+	//every frame, instances of meshes released since they were added are dropped
+	struct InstanceRecord
+	{
+		resource_management::StaticMeshResource const* p_MeshResource;
+		uint64_t registrationID;
+		cacore::HashObj<MeshMaterial> material;
+		uint32_t submeshID;
+		uint32_t instanceIndex;
+		glm::vec3 center;
+		float radius;
+		//Largest axis scale, applied to object space LOD errors
+		float scale;
+	};
+	castl::vector<InstanceRecord> m_InstanceRecords;
 
 	struct SubmeshDrawcallInfo
 	{
 		MeshGPUData* p_GPUMeshData;
 		cacore::HashObj<MeshMaterial> material;
 		uint32_t submeshID;
+		uint32_t lodLevel;
 		auto operator<=>(const SubmeshDrawcallInfo&) const = default;
 	};
 
@@ -78,15 +114,43 @@ class MeshBatcher
 
 	castl::unordered_map< SubmeshDrawcallInfo, SubmeshDrawcallData> m_DrawCallInfoToDrawCallData;
 
+	//Largest projected bounding sphere diameter in pixels of the instances of each material, gathered over every Draw until cleared
+	castl::unordered_map<graphics_backend::ShaderArgList const*, float> m_MaterialScreenSizes;
+
 public:
 	MeshBatcher(castl::shared_ptr<graphics_backend::CRenderBackend> pRenderBackend)
 		: pRenderBackend(pRenderBackend)
 	{
 	}
 
+	void SetClusterCullingShader(IShaderSet const* pShaderSet)
+	{
+		m_ClusterCullingShader = pShaderSet;
+	}
+
+	void SetLodErrorPixels(float errorPixels)
+	{
+		m_LodErrorPixels = errorPixels;
+	}
+
+	//Screen size feedback for texture streaming, instances outside of the view count as well
+	castl::unordered_map<graphics_backend::ShaderArgList const*, float> const& GetMaterialScreenSizes() const
+	{
+		return m_MaterialScreenSizes;
+	}
+
+	void ClearMaterialScreenSizes()
+	{
+		m_MaterialScreenSizes.clear();
+	}
+
 	void AddMeshRenderer(MeshRenderer const& meshRenderer, glm::mat4 const& transform)
 	{
-		MeshGPUData* pGpuMeshData = &g_MeshResourceToGPUData[meshRenderer.p_MeshResource];
+		MeshGPUData* pGpuMeshData = FindMeshGPUData(meshRenderer.p_MeshResource);
+		if (pGpuMeshData == nullptr)
+		{
+			return;
+		}
 
 		auto& submeshInfos = meshRenderer.p_MeshResource->GetSubmeshInfos();
 		auto& instances = meshRenderer.p_MeshResource->GetInstanceInfos();
@@ -100,36 +164,133 @@ public:
 			auto& submeshInfo = submeshInfos[instance.m_SubmeshID];
 			auto& material = meshRenderer.materials[castl::min((size_t)submeshInfo.m_MaterialID, meshRenderer.materials.size() - 1)];
 
-			SubmeshDrawcallInfo drawcallinfo{};
-			drawcallinfo.material = material;
-			drawcallinfo.p_GPUMeshData = pGpuMeshData;
-			drawcallinfo.submeshID = instance.m_SubmeshID;
+			glm::vec4 const& boundingSphere = submeshInfo.m_BoundingSphere;
+			float scale = castl::max(castl::max(glm::length(glm::vec3(instanceTrans[0])), glm::length(glm::vec3(instanceTrans[1])))
+				, glm::length(glm::vec3(instanceTrans[2])));
 
-			auto found = m_DrawCallInfoToDrawCallData.find(drawcallinfo);
-			if (found == m_DrawCallInfoToDrawCallData.end())
+			InstanceRecord record{};
+			record.p_MeshResource = meshRenderer.p_MeshResource;
+			record.registrationID = pGpuMeshData->GetRegistrationID();
+			record.material = material;
+			record.submeshID = instance.m_SubmeshID;
+			record.instanceIndex = instanceIndex;
+			record.center = glm::vec3(instanceTrans * glm::vec4(glm::vec3(boundingSphere), 1.0f));
+			record.radius = boundingSphere.w * scale;
+			record.scale = scale;
+			m_InstanceRecords.push_back(record);
+		}
+	}
+
+	//Projected error of a LOD is its object space error scaled to pixels at the nearest point of the bounding sphere
+	uint32_t SelectLod(InstanceRecord const& record, MeshBatchView const& view) const
+	{
+		auto meshResource = record.p_MeshResource;
+		auto& submeshInfo = meshResource->GetSubmeshInfos()[record.submeshID];
+		if (submeshInfo.m_LodCount == 0)
+		{
+			return 0;
+		}
+		float distance = glm::length(record.center - view.position) - record.radius;
+		if (distance <= 0.0f)
+		{
+			return 0;
+		}
+		float pixelsPerUnit = record.scale * view.projectionScale / distance;
+		auto& lods = meshResource->GetLods();
+		uint32_t lodLevel = 0;
+		for (int lodID = 0; lodID < submeshInfo.m_LodCount; ++lodID)
+		{
+			if (lods[submeshInfo.m_LodOffset + lodID].m_Error * pixelsPerUnit > m_LodErrorPixels)
 			{
-				found = m_DrawCallInfoToDrawCallData.insert(castl::make_pair(drawcallinfo, SubmeshDrawcallData{})).first;
+				break;
 			}
-			found->second.m_InstanceIDs.push_back(instanceIndex);
+			lodLevel = lodID + 1;
 		}
+		return lodLevel;
 	}
 
-	void Draw(graphics_backend::GPUGraph* pGraph, graphics_backend::RenderPass* pRenderPass)
+	void Draw(graphics_backend::GPUGraph* pGraph, graphics_backend::RenderPass* pRenderPass, MeshBatchView const& view)
 	{
+		//Batches left empty last frame are dropped, their mesh may have been released since
+		for (auto itr = m_DrawCallInfoToDrawCallData.begin(); itr != m_DrawCallInfoToDrawCallData.end();)
+		{
+			if (itr->second.m_InstanceIDs.empty())
+			{
+				itr = m_DrawCallInfoToDrawCallData.erase(itr);
+				continue;
+			}
+			itr->second.m_InstanceIDs.clear();
+			++itr;
+		}
+		uint32_t keptRecordCount = 0;
+		resource_management::StaticMeshResource const* pLastMeshResource = nullptr;
+		MeshGPUData* pLastGPUMeshData = nullptr;
+		for (auto& record : m_InstanceRecords)
+		{
+			//Instances of one mesh renderer are next to each other
+			if (record.p_MeshResource != pLastMeshResource)
+			{
+				pLastMeshResource = record.p_MeshResource;
+				pLastGPUMeshData = FindMeshGPUData(record.p_MeshResource);
+			}
+			if (pLastGPUMeshData == nullptr || pLastGPUMeshData->GetRegistrationID() != record.registrationID)
+			{
+				continue;
+			}
+			m_InstanceRecords[keptRecordCount++] = record;
+
+			SubmeshDrawcallInfo drawcallinfo{};
+			drawcallinfo.material = record.material;
+			drawcallinfo.p_GPUMeshData = pLastGPUMeshData;
+			drawcallinfo.submeshID = record.submeshID;
+			drawcallinfo.lodLevel = pLastGPUMeshData->Ready() ? SelectLod(record, view) : 0;
+			m_DrawCallInfoToDrawCallData[drawcallinfo].m_InstanceIDs.push_back(record.instanceIndex);
+
+			//The camera inside the bounding sphere sees it at least as large as the view
+			float distance = glm::length(record.center - view.position) - record.radius;
+			float screenSize = distance > 0.0f ? 2.0f * record.radius * view.projectionScale / distance : FLT_MAX;
+			float& materialScreenSize = m_MaterialScreenSizes[record.material->shaderArgs.get()];
+			materialScreenSize = castl::max(materialScreenSize, screenSize);
+		}
+		m_InstanceRecords.resize(keptRecordCount);
+
 		graphics_backend::BufferHandle instanceTransformBuffer{ "InstanceTransformsBuffer" , 0 };
 		pGraph->AllocBuffer(instanceTransformBuffer, GPUBufferDescriptor::Create(EBufferUsage::eStructuredBuffer | EBufferUsage::eDataDst, m_Instances.size(), sizeof(glm::mat4)))
 			.ScheduleData(instanceTransformBuffer, m_Instances.data(), m_Instances.size() * sizeof(glm::mat4));
 		castl::shared_ptr<graphics_backend::ShaderArgList> instanceShaderArgs = castl::make_shared<graphics_backend::ShaderArgList>();
 		instanceShaderArgs->SetBuffer("instanceTransforms", instanceTransformBuffer);
 		pRenderPass->PushShaderArguments("meshInstanceTransforms", instanceShaderArgs);
+
+		//Culling runs before the render pass, one dispatch per batch
+		bool gpuCulling = m_ClusterCullingShader != nullptr && pRenderBackend->SupportsIndirectDrawCount();
+		ComputeBatch cullingBatch = ComputeBatch::New();
+		cullingBatch.PushArgList("meshInstanceTransforms", instanceShaderArgs)
+			.PushArgList("cameraData", view.cameraArgs);
 		uint32_t index = 0;
 		for (auto& pair : m_DrawCallInfoToDrawCallData)
 		{
 			auto& drawcallInfo = pair.first;
 			auto& drawcallInstances = pair.second;
-			graphics_backend::BufferHandle instanceIDBuffer{ "MeshInstanceIDBuffer", index++};
-			size_t bufferSize = drawcallInstances.m_InstanceIDs.size() * sizeof(uint32_t);
-			pGraph->AllocBuffer(instanceIDBuffer, GPUBufferDescriptor::Create(EBufferUsage::eVertexBuffer | EBufferUsage::eDataDst, drawcallInstances.m_InstanceIDs.size(), sizeof(uint32_t)))
+			//Empty batches may point at GPU data of released meshes and are not touched
+			if (drawcallInstances.m_InstanceIDs.empty() || !drawcallInfo.p_GPUMeshData->Ready())
+			{
+				continue;
+			}
+			uint32_t instanceCount = drawcallInstances.m_InstanceIDs.size();
+			auto& submeshInfo = drawcallInfo.p_GPUMeshData->GetMeshResource()->GetSubmeshInfos()[drawcallInfo.submeshID];
+			//Meshlets are built for LOD 0 only
+			bool cullBatch = gpuCulling && drawcallInfo.lodLevel == 0 && submeshInfo.m_MeshletCount > 0;
+
+			uint32_t batchID = index++;
+			graphics_backend::BufferHandle instanceIDBuffer{ "MeshInstanceIDBuffer", batchID };
+			size_t bufferSize = instanceCount * sizeof(uint32_t);
+			EBufferUsageFlags instanceIDUsages = EBufferUsage::eVertexBuffer | EBufferUsage::eDataDst;
+			if (cullBatch)
+			{
+				//Also read by the culling shader to find instance transforms
+				instanceIDUsages |= EBufferUsage::eStructuredBuffer;
+			}
+			pGraph->AllocBuffer(instanceIDBuffer, GPUBufferDescriptor::Create(instanceIDUsages, instanceCount, sizeof(uint32_t)))
 				.ScheduleData(instanceIDBuffer, drawcallInstances.m_InstanceIDs.data(), bufferSize);
 
 			DrawCallBatch newDrawcallBatch = DrawCallBatch::New();
@@ -137,9 +298,40 @@ public:
 				.SetShaderSet(drawcallInfo.material->shaderSet)
 				.SetPipelineState(drawcallInfo.material->pipelineStateObject)
 				.SetVertexBuffer(g_InstanceDescriptor, instanceIDBuffer);
-			drawcallInfo.p_GPUMeshData->DrawCall(newDrawcallBatch, drawcallInfo.submeshID, drawcallInstances.m_InstanceIDs.size());
+			if (cullBatch)
+			{
+				//Every meshlet of every instance may survive, surviving ones are drawn as single instance draws
+				uint32_t maxDrawCount = instanceCount * submeshInfo.m_MeshletCount;
+				graphics_backend::BufferHandle drawArgsBuffer{ "MeshletDrawArgsBuffer", batchID };
+				graphics_backend::BufferHandle drawCountBuffer{ "MeshletDrawCountBuffer", batchID };
+				pGraph->AllocBuffer(drawArgsBuffer, GPUBufferDescriptor::Create(EBufferUsage::eStructuredBuffer | EBufferUsage::eIndirectBuffer, maxDrawCount, sizeof(DrawIndexedIndirectArgs)))
+					.AllocBuffer(drawCountBuffer, GPUBufferDescriptor::Create(EBufferUsage::eStructuredBuffer | EBufferUsage::eIndirectBuffer | EBufferUsage::eDataDst, 1, sizeof(uint32_t)));
+				pGraph->ScheduleData<uint32_t>(drawCountBuffer, 1)[0] = 0;
+
+				castl::shared_ptr<graphics_backend::ShaderArgList> cullingArgs = castl::make_shared<graphics_backend::ShaderArgList>();
+				cullingArgs->SetBuffer("meshlets", drawcallInfo.p_GPUMeshData->GetMeshletBuffer())
+					.SetBuffer("instanceIDs", instanceIDBuffer)
+					.SetBuffer("drawArgs", drawArgsBuffer)
+					.SetBuffer("drawCount", drawCountBuffer)
+					.SetValue("cameraPosition", glm::vec4(view.position, 1.0f))
+					.SetValue("meshletOffset", static_cast<uint32_t>(submeshInfo.m_MeshletOffset))
+					.SetValue("meshletCount", static_cast<uint32_t>(submeshInfo.m_MeshletCount))
+					.SetValue("instanceCount", instanceCount)
+					.SetValue("vertexOffset", static_cast<int32_t>(submeshInfo.m_VertexArrayOffset));
+				cullingBatch.Dispatch(m_ClusterCullingShader, "cullClusters", (maxDrawCount + 63) / 64, 1, 1
+					, { castl::make_pair(castl::string("cullingParams"), cullingArgs) });
+				drawcallInfo.p_GPUMeshData->DrawCallIndirect(newDrawcallBatch, drawcallInfo.submeshID, drawArgsBuffer, drawCountBuffer, maxDrawCount);
+			}
+			else
+			{
+				drawcallInfo.p_GPUMeshData->DrawCall(newDrawcallBatch, drawcallInfo.submeshID, drawcallInfo.lodLevel, instanceCount);
+			}
 
 			pRenderPass->DrawCall(newDrawcallBatch);
 		}
+		if (!cullingBatch.dispatchs.empty())
+		{
+			pGraph->AddPass(cullingBatch);
+		}
 	}
 };
\ No newline at end of file
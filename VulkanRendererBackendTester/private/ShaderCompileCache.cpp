@@ -0,0 +1,300 @@
+#include "ShaderCompileCache.h"
+#include <FileLoader.h>
+#include <Serialization.h>
+#include <Hasher.h>
+#include <DebugUtils.h>
+#include <CASTL/CAAlgorithm.h>
+#include <CASTL/CAUnorderedSet.h>
+#include <CASTL/CADeque.h>
+#include <CASTL/CAAtomic.h>
+#include <random>
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t SHADER_CACHE_FILE_MAGIC = 0x43534343;//CCSC
+		//Bump when the compiler integration or the layout of the compile results changes, old entries stop matching
+		constexpr uint32_t SHADER_CACHE_FILE_VERSION = 2;
+
+		void HashString(cacore::fnv1a& hasher, castl::string const& str)
+		{
+			hasher(static_cast<uint64_t>(str.size()));
+			hasher(str.data(), str.size());
+		}
+
+		castl::string NormalizePath(std::filesystem::path const& path)
+		{
+			return castl::to_ca(std::filesystem::absolute(path).lexically_normal().string());
+		}
+
+		//The resolved path is part of the key, same named files in different folders never share an entry
+		void HashFile(cacore::fnv1a& hasher, castl::string const& path)
+		{
+			castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(path);
+			HashString(hasher, NormalizePath(castl::to_std(path)));
+			hasher(static_cast<uint64_t>(fileData.size()));
+			hasher(fileData.data(), fileData.size());
+		}
+
+		//Temporary file name unique to one write, concurrent stores of the same key from several
+		//threads or processes never write into the same file
+		std::filesystem::path MakeWritingPath(std::filesystem::path const& entryPath)
+		{
+			static uint64_t const s_ProcessToken = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+			static castl::atomic<uint64_t> s_WriteCounter{ 0 };
+			char suffix[48];
+			snprintf(suffix, sizeof(suffix), ".%016llx-%llx.writing"
+				, static_cast<unsigned long long>(s_ProcessToken)
+				, static_cast<unsigned long long>(s_WriteCounter.fetch_add(1)));
+			std::filesystem::path writingPath = entryPath;
+			writingPath += suffix;
+			return writingPath;
+		}
+
+		bool StartsWith(castl::string const& str, char const* prefix)
+		{
+			return str.compare(0, strlen(prefix), prefix) == 0;
+		}
+
+		//Paths referenced by #include, __include and import of one source.
+		//Quoted references are file paths, others are dotted module names
+		void ParseReferences(castl::string const& source, castl::vector<castl::string>& outPaths, castl::vector<castl::string>& outModules)
+		{
+			size_t lineBegin = 0;
+			while (lineBegin < source.size())
+			{
+				size_t lineEnd = source.find('\n', lineBegin);
+				if (lineEnd == castl::string::npos)
+				{
+					lineEnd = source.size();
+				}
+				castl::string line = source.substr(lineBegin, lineEnd - lineBegin);
+				lineBegin = lineEnd + 1;
+
+				size_t begin = line.find_first_not_of(" \t");
+				if (begin == castl::string::npos)
+					continue;
+				line = line.substr(begin);
+				size_t keywordLength = 0;
+				if (StartsWith(line, "#include"))
+				{
+					keywordLength = strlen("#include");
+				}
+				else if (StartsWith(line, "__include "))
+				{
+					keywordLength = strlen("__include ");
+				}
+				else if (StartsWith(line, "import "))
+				{
+					keywordLength = strlen("import ");
+				}
+				else
+				{
+					continue;
+				}
+
+				size_t quoteBegin = line.find_first_of("\"<", keywordLength);
+				if (quoteBegin != castl::string::npos)
+				{
+					size_t quoteEnd = line.find_first_of("\">", quoteBegin + 1);
+					if (quoteEnd != castl::string::npos)
+					{
+						outPaths.push_back(line.substr(quoteBegin + 1, quoteEnd - quoteBegin - 1));
+					}
+					continue;
+				}
+				size_t nameBegin = line.find_first_not_of(" \t", keywordLength);
+				size_t nameEnd = line.find_first_of("; \t\r", nameBegin);
+				if (nameBegin != castl::string::npos)
+				{
+					outModules.push_back(line.substr(nameBegin, nameEnd == castl::string::npos ? castl::string::npos : nameEnd - nameBegin));
+				}
+			}
+		}
+
+		castl::string ResolveReference(std::filesystem::path const& currentFolder
+			, castl::vector<castl::string> const& candidates
+			, castl::vector<castl::string> const& searchPaths)
+		{
+			std::error_code ec;
+			for (auto& candidate : candidates)
+			{
+				std::filesystem::path localPath = currentFolder / castl::to_std(candidate);
+				if (std::filesystem::is_regular_file(localPath, ec))
+				{
+					return NormalizePath(localPath);
+				}
+				for (auto& searchPath : searchPaths)
+				{
+					std::filesystem::path searchedPath = std::filesystem::path(castl::to_std(searchPath)) / castl::to_std(candidate);
+					if (std::filesystem::is_regular_file(searchedPath, ec))
+					{
+						return NormalizePath(searchedPath);
+					}
+				}
+			}
+			//Builtin modules and missing files
+			return {};
+		}
+	}
+
+	castl::vector<castl::string> ShaderDependencyGraph::GetDependencies(castl::string const& sourcePath, castl::vector<castl::string> const& searchPaths)
+	{
+		castl::string normalizedSource = NormalizePath(castl::to_std(sourcePath));
+		castl::unordered_set<castl::string> visited{ normalizedSource };
+		castl::deque<castl::string> pending{ normalizedSource };
+		castl::vector<castl::string> result;
+		while (!pending.empty())
+		{
+			castl::string current = pending.front();
+			pending.pop_front();
+			for (auto& dependency : GetDirectDependencies(current, searchPaths))
+			{
+				if (visited.insert(dependency).second)
+				{
+					result.push_back(dependency);
+					pending.push_back(dependency);
+				}
+			}
+		}
+		castl::sort(result.begin(), result.end());
+		return result;
+	}
+
+	castl::vector<castl::string> ShaderDependencyGraph::GetDirectDependencies(castl::string const& path, castl::vector<castl::string> const& searchPaths)
+	{
+		std::error_code ec;
+		auto writeTime = std::filesystem::last_write_time(castl::to_std(path), ec);
+		{
+			castl::lock_guard<castl::mutex> lock(m_Mutex);
+			auto found = m_Files.find(path);
+			if (found != m_Files.end() && found->second.writeTime == writeTime)
+			{
+				return found->second.directDependencies;
+			}
+		}
+
+		castl::vector<castl::string> paths;
+		castl::vector<castl::string> modules;
+		ParseReferences(cacore::LoadStringFile(path), paths, modules);
+
+		std::filesystem::path currentFolder = castl::to_std(path);
+		currentFolder.remove_filename();
+		FileNode node{ writeTime };
+		for (auto& referencedPath : paths)
+		{
+			castl::string resolved = ResolveReference(currentFolder, { referencedPath }, searchPaths);
+			if (!resolved.empty())
+			{
+				node.directDependencies.push_back(resolved);
+			}
+		}
+		for (auto& moduleName : modules)
+		{
+			//Slang maps module a.b_c to a/b_c.slang or a/b-c.slang
+			castl::string modulePath = moduleName;
+			castl::replace(modulePath.begin(), modulePath.end(), '.', '/');
+			modulePath += ".slang";
+			castl::string dashedPath = modulePath;
+			castl::replace(dashedPath.begin(), dashedPath.end(), '_', '-');
+			castl::string resolved = ResolveReference(currentFolder, { modulePath, dashedPath }, searchPaths);
+			if (!resolved.empty())
+			{
+				node.directDependencies.push_back(resolved);
+			}
+		}
+
+		castl::lock_guard<castl::mutex> lock(m_Mutex);
+		auto& cachedNode = m_Files[path];
+		cachedNode = castl::move(node);
+		return cachedNode.directDependencies;
+	}
+
+	void ShaderCompileCache::SetCacheDirectory(castl::string const& directory)
+	{
+		m_CacheDirectory = castl::to_std(directory);
+		if (!m_CacheDirectory.empty())
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(m_CacheDirectory, ec);
+		}
+	}
+
+	uint64_t ShaderCompileCache::ComputeKey(castl::string const& sourcePath
+		, castl::vector<castl::string> const& dependencies
+		, ShaderCompileOptions const& options) const
+	{
+		cacore::fnv1a hasher{};
+		hasher(static_cast<uint64_t>(SHADER_CACHE_FILE_VERSION));
+		hasher(static_cast<uint64_t>(options.target));
+		hasher(static_cast<uint64_t>(options.debugInfo));
+		hasher(static_cast<uint64_t>(options.optimize));
+		hasher(static_cast<uint64_t>(options.macros.size()));
+		for (auto& macro : options.macros)
+		{
+			HashString(hasher, macro.first);
+			HashString(hasher, macro.second);
+		}
+		HashFile(hasher, sourcePath);
+		hasher(static_cast<uint64_t>(dependencies.size()));
+		for (auto& dependency : dependencies)
+		{
+			HashFile(hasher, dependency);
+		}
+		return static_cast<uint64_t>(hasher);
+	}
+
+	bool ShaderCompileCache::TryLoad(uint64_t key, castl::vector<ShaderCompilerSlang::ShaderCompileTargetResult>& outResults) const
+	{
+		castl::vector<uint8_t> fileData = cacore::LoadBinaryFile(castl::to_ca(GetEntryPath(key).string()));
+		if (fileData.size() < sizeof(CacheFileHeader))
+		{
+			return false;
+		}
+		CacheFileHeader fileHeader{};
+		memcpy(&fileHeader, fileData.data(), sizeof(CacheFileHeader));
+		if (fileHeader.magic != SHADER_CACHE_FILE_MAGIC
+			|| fileHeader.version != SHADER_CACHE_FILE_VERSION
+			|| fileHeader.key != key
+			|| !cacore::verify_payload(fileHeader.dataSize, fileHeader.dataHash, fileData.data() + sizeof(CacheFileHeader), fileData.size() - sizeof(CacheFileHeader)))
+		{
+			CA_LOG_ERR("Shader cache entry is outdated or corrupted, the shader will be recompiled");
+			return false;
+		}
+		outResults.clear();
+		cacore::deserialize(fileData, outResults, sizeof(CacheFileHeader));
+		return true;
+	}
+
+	void ShaderCompileCache::Store(uint64_t key, castl::vector<ShaderCompilerSlang::ShaderCompileTargetResult> const& results) const
+	{
+		castl::vector<uint8_t> fileData(sizeof(CacheFileHeader));
+		cacore::serialize(fileData, results);
+		CacheFileHeader fileHeader{};
+		fileHeader.magic = SHADER_CACHE_FILE_MAGIC;
+		fileHeader.version = SHADER_CACHE_FILE_VERSION;
+		fileHeader.key = key;
+		fileHeader.dataSize = fileData.size() - sizeof(CacheFileHeader);
+		fileHeader.dataHash = cacore::hash_bytes(fileData.data() + sizeof(CacheFileHeader), fileHeader.dataSize);
+		memcpy(fileData.data(), &fileHeader, sizeof(CacheFileHeader));
+
+		//Written aside and moved in place, so readers never see a partial entry
+		std::filesystem::path entryPath = GetEntryPath(key);
+		std::filesystem::path writingPath = MakeWritingPath(entryPath);
+		cacore::WriteBinaryFile(castl::to_ca(writingPath.string()), fileData.data(), fileData.size());
+		std::error_code ec;
+		std::filesystem::rename(writingPath, entryPath, ec);
+		if (ec)
+		{
+			std::filesystem::remove(writingPath, ec);
+		}
+	}
+
+	std::filesystem::path ShaderCompileCache::GetEntryPath(uint64_t key) const
+	{
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "%016llx.shadercache", static_cast<unsigned long long>(key));
+		return m_CacheDirectory / fileName;
+	}
+}
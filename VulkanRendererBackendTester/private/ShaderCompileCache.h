@@ -0,0 +1,65 @@
+#pragma once
+#include <CASTL/CAString.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAUnorderedMap.h>
+#include <CASTL/CAMutex.h>
+#include <Compiler.h>
+#include <filesystem>
+
+namespace resource_management
+{
+	//Files included or imported by slang sources, each file is parsed once per write time.
+	//Conditional includes are always followed, a few extra dependencies only cost a recompile
+	class ShaderDependencyGraph
+	{
+	public:
+		//Every existing file reachable from the source through includes and imports, sorted, without the source itself
+		castl::vector<castl::string> GetDependencies(castl::string const& sourcePath, castl::vector<castl::string> const& searchPaths);
+	private:
+		struct FileNode
+		{
+			std::filesystem::file_time_type writeTime;
+			castl::vector<castl::string> directDependencies;
+		};
+		castl::vector<castl::string> GetDirectDependencies(castl::string const& path, castl::vector<castl::string> const& searchPaths);
+
+		castl::mutex m_Mutex;
+		castl::unordered_map<castl::string, FileNode> m_Files;
+	};
+
+	struct ShaderCompileOptions
+	{
+		castl::vector<castl::string> searchPaths;
+		castl::vector<castl::pair<castl::string, castl::string>> macros;
+		ShaderCompilerSlang::EShaderTargetType target = ShaderCompilerSlang::EShaderTargetType::eSpirV;
+		bool debugInfo = false;
+		bool optimize = false;
+	};
+
+	//Compile results on disk keyed by the content of the source and its dependencies, macros, target and options.
+	//Unchanged modules are served from the cache even after their bundles were deleted or touched
+	class ShaderCompileCache
+	{
+	public:
+		//Caching is disabled while the directory is empty
+		void SetCacheDirectory(castl::string const& directory);
+		bool Enabled() const { return !m_CacheDirectory.empty(); }
+		uint64_t ComputeKey(castl::string const& sourcePath
+			, castl::vector<castl::string> const& dependencies
+			, ShaderCompileOptions const& options) const;
+		bool TryLoad(uint64_t key, castl::vector<ShaderCompilerSlang::ShaderCompileTargetResult>& outResults) const;
+		void Store(uint64_t key, castl::vector<ShaderCompilerSlang::ShaderCompileTargetResult> const& results) const;
+	private:
+		struct CacheFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t key;
+			uint64_t dataSize;
+			uint64_t dataHash;
+		};
+		std::filesystem::path GetEntryPath(uint64_t key) const;
+
+		std::filesystem::path m_CacheDirectory;
+	};
+}
@@ -0,0 +1,104 @@
+#include "ShaderCookPasses.h"
+#include "ShaderResource.h"
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+		constexpr uint32_t SPIRV_HEADER_WORD_COUNT = 5;
+
+		enum ESpirVOp : uint32_t
+		{
+			eOpSourceContinued = 2,
+			eOpSource = 3,
+			eOpSourceExtension = 4,
+			eOpName = 5,
+			eOpMemberName = 6,
+			eOpString = 7,
+			eOpLine = 8,
+			eOpExtInstImport = 11,
+			eOpNoLine = 317,
+			eOpModuleProcessed = 330,
+		};
+	}
+
+	void SpirVStripDebugInfoPass::Process(ShaderResrouce* resource) const
+	{
+		for (auto& targetResult : resource->m_ShaderTargetResults)
+		{
+			if (targetResult.targetType != ShaderCompilerSlang::EShaderTargetType::eSpirV)
+				continue;
+			for (auto& programData : targetResult.programs)
+			{
+				StripDebugInfo(programData.data);
+			}
+		}
+	}
+
+	bool SpirVStripDebugInfoPass::StripDebugInfo(castl::vector<uint8_t>& inoutData)
+	{
+		if (inoutData.size() < SPIRV_HEADER_WORD_COUNT * sizeof(uint32_t) || inoutData.size() % sizeof(uint32_t) != 0)
+		{
+			return false;
+		}
+		uint32_t const* pWords = reinterpret_cast<uint32_t const*>(inoutData.data());
+		uint32_t wordCount = static_cast<uint32_t>(inoutData.size() / sizeof(uint32_t));
+		if (pWords[0] != SPIRV_MAGIC)
+		{
+			return false;
+		}
+
+		//Non semantic debug info references OpString, strings are kept then
+		bool keepStrings = false;
+		for (uint32_t wordID = SPIRV_HEADER_WORD_COUNT; wordID < wordCount;)
+		{
+			uint32_t opCode = pWords[wordID] & 0xFFFF;
+			uint32_t instructionWordCount = pWords[wordID] >> 16;
+			if (instructionWordCount == 0 || wordID + instructionWordCount > wordCount)
+			{
+				return false;
+			}
+			if (opCode == eOpExtInstImport && instructionWordCount > 2)
+			{
+				char const* pName = reinterpret_cast<char const*>(pWords + wordID + 2);
+				keepStrings |= strncmp(pName, "NonSemantic.", strlen("NonSemantic.")) == 0;
+			}
+			wordID += instructionWordCount;
+		}
+
+		castl::vector<uint32_t> strippedWords;
+		strippedWords.reserve(wordCount);
+		strippedWords.insert(strippedWords.end(), pWords, pWords + SPIRV_HEADER_WORD_COUNT);
+		for (uint32_t wordID = SPIRV_HEADER_WORD_COUNT; wordID < wordCount;)
+		{
+			uint32_t opCode = pWords[wordID] & 0xFFFF;
+			uint32_t instructionWordCount = pWords[wordID] >> 16;
+			bool strip = false;
+			switch (opCode)
+			{
+			case eOpSourceContinued:
+			case eOpSource:
+			case eOpSourceExtension:
+			case eOpName:
+			case eOpMemberName:
+			case eOpLine:
+			case eOpNoLine:
+			case eOpModuleProcessed:
+				strip = true;
+				break;
+			case eOpString:
+				strip = !keepStrings;
+				break;
+			}
+			if (!strip)
+			{
+				strippedWords.insert(strippedWords.end(), pWords + wordID, pWords + wordID + instructionWordCount);
+			}
+			wordID += instructionWordCount;
+		}
+		inoutData.resize(strippedWords.size() * sizeof(uint32_t));
+		memcpy(inoutData.data(), strippedWords.data(), inoutData.size());
+		return true;
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <CAResource/ResourceImporter.h>
+#include <CASTL/CAVector.h>
+
+namespace resource_management
+{
+	class ShaderResrouce;
+
+	//Removes names, source text and line info from SPIR-V programs, nothing at runtime reflects on them
+	class SpirVStripDebugInfoPass : public ResourceImporterPass<ShaderResrouce>
+	{
+	public:
+		virtual void Process(ShaderResrouce* resource) const override;
+		//False when the data is not a valid SPIR-V module, it is left untouched then
+		static bool StripDebugInfo(castl::vector<uint8_t>& inoutData);
+	};
+}
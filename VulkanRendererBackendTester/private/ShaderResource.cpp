@@ -1,6 +1,8 @@
 #include "ShaderResource.h"
 #include <FileLoader.h>
 #include <filesystem>
+#include <chrono>
+#include <iostream>
 #include "SerializationLog.h"
 
 namespace resource_management
@@ -14,37 +16,155 @@ namespace resource_management
 		cacore::deserializer<decltype(data)> deserializer(data);
 		deserializer.deserialize(*this);
 	}
+	uint64_t ShaderResrouce::GetMemorySizeInByte() const
+	{
+		uint64_t result = 0;
+		for (auto& targetResult : m_ShaderTargetResults)
+		{
+			for (auto& programData : targetResult.programs)
+			{
+				result += programData.data.capacity();
+			}
+		}
+		return result;
+	}
 
-	ShaderResourceLoaderSlang::ShaderResourceLoaderSlang()
-		: m_ShaderCompilerLoader("ShaderCompilerSlang")
+	ShaderResourceLoaderSlang::ShaderResourceLoaderSlang(uint32_t compilerCount)
+		: m_CompilerCount(castl::max(compilerCount, 1u))
+		, m_ShaderCompilerLoader("ShaderCompilerSlang")
 	{
 		m_ShaderCompilerManager = m_ShaderCompilerLoader.New();
-		m_ShaderCompilerManager->InitializePoolSize(1);
+		m_ShaderCompilerManager->InitializePoolSize(m_CompilerCount);
 	}
-	void ShaderResourceLoaderSlang::ImportResource(ResourceManagingSystem* resourceManager, castl::string const& inPath, castl::string const& outPath)
+	void ShaderResourceLoaderSlang::BeginImportBatch()
 	{
+		//Sessions cache loaded modules, sources may have changed since the last scan
+		m_ShaderCompilerManager->ResetSessionCache();
+		castl::lock_guard<castl::mutex> lock(m_CookedProgramMutex);
+		m_CookedProgramHashes.clear();
+	}
+	bool ShaderResourceLoaderSlang::ImportResource(ResourceManagingSystem* resourceManager, castl::string const& inPath, castl::string const& outPath)
+	{
+		auto startTime = std::chrono::steady_clock::now();
 		std::filesystem::path outPathWithExt = castl::to_std(outPath);
 		outPathWithExt.replace_extension(GetDestFilePostfix().c_str());
-		std::filesystem::path resourcePath(inPath.c_str());
-		std::filesystem::path folderPath = resourcePath;
-		folderPath.remove_filename();
-		auto pCompiler = m_ShaderCompilerManager->AquireShaderCompilerShared();
-		pCompiler->BeginCompileTask();
-		pCompiler->AddInlcudePath(folderPath.string().c_str());
-		pCompiler->AddSourceFile(inPath.c_str());
-		pCompiler->EnableDebugInfo();
-		pCompiler->SetTarget(ShaderCompilerSlang::EShaderTargetType::eSpirV);
-		pCompiler->Compile();
-		if (pCompiler->HasError())
+		ShaderCompileOptions options = GetCompileOptions(inPath);
+
+		castl::vector<ShaderCompilerSlang::ShaderCompileTargetResult> results;
+		uint64_t cacheKey = 0;
+		bool cached = false;
+		if (m_CompileCache.Enabled())
+		{
+			cacheKey = m_CompileCache.ComputeKey(inPath, m_DependencyGraph.GetDependencies(inPath, options.searchPaths), options);
+			cached = m_CompileCache.TryLoad(cacheKey, results);
+		}
+
+		if (!cached)
+		{
+			auto pCompiler = m_ShaderCompilerManager->AquireShaderCompilerShared();
+			pCompiler->BeginCompileTask();
+			for (auto& searchPath : options.searchPaths)
+			{
+				pCompiler->AddInlcudePath(searchPath.c_str());
+			}
+			for (auto& macro : options.macros)
+			{
+				pCompiler->SetMacro(macro.first.c_str(), macro.second.c_str());
+			}
+			pCompiler->AddSourceFile(inPath.c_str());
+			if (options.debugInfo)
+			{
+				pCompiler->EnableDebugInfo();
+			}
+			if (options.optimize)
+			{
+				pCompiler->EnableOptimization();
+			}
+			pCompiler->SetTarget(options.target);
+			pCompiler->Compile();
+			bool hasError = pCompiler->HasError();
+			if (!hasError)
+			{
+				results = pCompiler->GetResults();
+			}
+			pCompiler->EndCompileTask();
+			if (hasError)
+			{
+				CA_LOG_ERR("Shader compile failed: " + inPath);
+				return false;
+			}
+			if (m_CompileCache.Enabled())
+			{
+				m_CompileCache.Store(cacheKey, results);
+			}
+		}
+
+		ShaderResrouce* resource = resourceManager->AllocResource<ShaderResrouce>(castl::to_ca(outPathWithExt.string()));
+		resource->m_ShaderTargetResults = castl::move(results);
+		resource->m_UniqueName = outPath;
+
+		uint64_t compiledSize = 0;
+		for (auto& targetResult : resource->m_ShaderTargetResults)
 		{
-			CA_LOG_ERR("Shader compile failed");
+			for (auto& programData : targetResult.programs)
+			{
+				compiledSize += programData.data.size();
+			}
 		}
-		else
+		ApplyPasses(resource);
+
+		uint64_t cookedSize = 0;
+		uint32_t programCount = 0;
+		uint32_t sharedProgramCount = 0;
+		for (auto& targetResult : resource->m_ShaderTargetResults)
+		{
+			for (auto& programData : targetResult.programs)
+			{
+				programData.dataHash = cacore::hash_bytes(programData.data.data(), programData.data.size());
+				cookedSize += programData.data.size();
+				++programCount;
+				castl::lock_guard<castl::mutex> lock(m_CookedProgramMutex);
+				if (!m_CookedProgramHashes.insert(programData.dataHash).second)
+				{
+					++sharedProgramCount;
+				}
+			}
+		}
+		if (m_Verbose)
+		{
+			auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime);
+			std::cout << "Cooked " << outPath.c_str() << ": " << programCount << " programs, "
+				<< compiledSize << " -> " << cookedSize << " bytes, "
+				<< sharedProgramCount << " shared with other bundles, "
+				<< duration.count() << " ms" << (cached ? " (cached)" : "") << std::endl;
+		}
+		return true;
+	}
+
+	void ShaderResourceLoaderSlang::SetCookConfig(EShaderCookConfig cookConfig)
+	{
+		m_CookConfig = cookConfig;
+		m_Passes.clear();
+		if (m_CookConfig == EShaderCookConfig::eRelease)
 		{
-			ShaderResrouce* resource = resourceManager->AllocResource<ShaderResrouce>(castl::to_ca(outPathWithExt.string()));
-			resource->m_ShaderTargetResults = pCompiler->GetResults();
-			resource->m_UniqueName = outPath;
+			m_Passes.push_back(&m_StripDebugInfoPass);
 		}
-		pCompiler->EndCompileTask();
+	}
+
+	castl::vector<castl::string> ShaderResourceLoaderSlang::GetSourceDependencies(castl::string const& resourcePath)
+	{
+		return m_DependencyGraph.GetDependencies(resourcePath, GetCompileOptions(resourcePath).searchPaths);
+	}
+
+	ShaderCompileOptions ShaderResourceLoaderSlang::GetCompileOptions(castl::string const& resourcePath) const
+	{
+		std::filesystem::path folderPath = castl::to_std(resourcePath);
+		folderPath.remove_filename();
+		ShaderCompileOptions options{};
+		options.searchPaths.push_back(castl::to_ca(folderPath.string()));
+		options.target = ShaderCompilerSlang::EShaderTargetType::eSpirV;
+		options.debugInfo = m_CookConfig == EShaderCookConfig::eDevelopment;
+		options.optimize = m_CookConfig == EShaderCookConfig::eRelease;
+		return options;
 	}
 }
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include <ShaderBindingBuilder.h>
 #include <Serialization.h>
 #include <Hasher.h>
+#include <CASTL/CAUnorderedSet.h>
+#include "ShaderCompileCache.h"
+#include "ShaderCookPasses.h"
 
 namespace resource_management
 {
@@ -19,6 +22,8 @@ namespace resource_management
 	public:
 		virtual void Serialzie(castl::vector<uint8_t>& out) override;
 		virtual void Deserialzie(castl::vector<uint8_t>& in) override;
+		//Program byte code only, reflection data is small in comparison
+		virtual uint64_t GetMemorySizeInByte() const override;
 
 		virtual ShaderSourceInfo GetShaderSourceInfo(ShaderCompilerSlang::EShaderTargetType shaderTargetType, ECompileShaderType shaderType, castl::string_view entryPoint) const override
 		{ 
@@ -38,6 +43,7 @@ namespace resource_management
 								result.dataLength = programData.data.size();
 								result.dataPtr = programData.data.data();
 								result.entryPoint = programData.entryPointName;
+								result.dataHash = programData.dataHash;
 								return result;
 							}
 						}
@@ -76,17 +82,46 @@ namespace resource_management
 	};
 
 
+	enum class EShaderCookConfig
+	{
+		//Debug info, no optimization
+		eDevelopment,
+		//Optimized, debug info stripped
+		eRelease,
+	};
+
 	class ShaderResourceLoaderSlang : public ResourceImporter<ShaderResrouce>
 	{
 	public:
-		ShaderResourceLoaderSlang();
+		//One compiler per worker that may import at the same time
+		ShaderResourceLoaderSlang(uint32_t compilerCount = 1);
 		virtual castl::string GetSourceFilePostfix() const override { return ".slang"; }
 		virtual castl::string GetDestFilePostfix() const override { return ".shaderbundle"; }
-		virtual castl::string GetTags() const override { return "TargetAPI=Vulkan"; }
-		virtual void ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) override;
+		virtual castl::string GetTags() const override { return m_CookConfig == EShaderCookConfig::eRelease ? "TargetAPI=Vulkan;Cook=Release" : "TargetAPI=Vulkan"; }
+		virtual bool ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) override;
+		virtual castl::vector<castl::string> GetSourceDependencies(castl::string const& resourcePath) override;
+		virtual uint32_t GetMaxParallelImports() const override { return m_CompilerCount; }
+		virtual void BeginImportBatch() override;
+		//Prints the program count, byte code size before and after the cook passes, programs shared with other bundles and cook time of each bundle
+		virtual void SetVerbose(bool verbose) override { m_Verbose = verbose; }
+		//Compile results are reused from this directory when the sources and options are unchanged
+		void SetCompileCacheDirectory(castl::string const& directory) { m_CompileCache.SetCacheDirectory(directory); }
+		void SetCookConfig(EShaderCookConfig cookConfig);
 	private:
+		ShaderCompileOptions GetCompileOptions(castl::string const& resourcePath) const;
+
+		uint32_t m_CompilerCount;
 		TModuleLoader<ShaderCompilerSlang::IShaderCompilerManager> m_ShaderCompilerLoader;
 		castl::shared_ptr < ShaderCompilerSlang::IShaderCompilerManager> m_ShaderCompilerManager;
+		ShaderDependencyGraph m_DependencyGraph;
+		ShaderCompileCache m_CompileCache;
+		EShaderCookConfig m_CookConfig = EShaderCookConfig::eDevelopment;
+		SpirVStripDebugInfoPass m_StripDebugInfoPass;
+		bool m_Verbose = false;
+
+		//Program hashes cooked so far, to report byte code shared between bundles
+		castl::mutex m_CookedProgramMutex;
+		castl::unordered_set<uint64_t> m_CookedProgramHashes;
 	};
 }
 
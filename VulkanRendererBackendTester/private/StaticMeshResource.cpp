@@ -2,6 +2,7 @@
 #include "StaticMeshResource.h"
 #include "SerializationLog.h"
 #include "TextureResource.h"
+#include "MeshRenderer.h"
 #include <filesystem>
 
 namespace resource_management
@@ -15,13 +16,104 @@ namespace resource_management
 		cacore::deserializer<castl::vector<uint8_t>> deserializer(data);
 		deserializer.deserialize(*this);
 	}
-	StaticMeshImporter::StaticMeshImporter()
+	void StaticMeshResource::Unload()
 	{
+		ReleaseMeshResource(this);
+	}
+	StaticMeshImporter::StaticMeshImporter(uint32_t importerCount)
+	{
+		importerCount = castl::max(importerCount, 1u);
+		for (uint32_t i = 0; i < importerCount; ++i)
+		{
+			m_Importers.push_back(castl::make_unique<Assimp::Importer>());
+			m_AvailableImporters.push_back(m_Importers.back().get());
+		}
+		SetCookSettings(m_CookSettings);
+	}
+
+	castl::string StaticMeshImporter::GetTags() const
+	{
+		castl::string tags = m_CookSettings.optimizeVertexOrder ? "VertexOrder=Optimized" : "VertexOrder=Source";
+		if (m_CookSettings.quantizeAttributes)
+		{
+			tags += ";Attributes=Quantized";
+		}
+		if (m_CookSettings.buildMeshlets)
+		{
+			tags += ";Meshlets=On";
+		}
+		if (m_CookSettings.lodCount > 0)
+		{
+			tags += ";Lods=" + castl::to_string(m_CookSettings.lodCount)
+				+ "x" + castl::to_string(m_CookSettings.lodReduction)
+				+ "e" + castl::to_string(m_CookSettings.lodMaxError);
+		}
+		TextureCookSettings const& textureCookSettings = m_TextureCooker.GetCookSettings();
+		tags += textureCookSettings.generateMips ? ";Textures=Mips" : ";Textures=NoMips";
+		if (textureCookSettings.blockCompress)
+		{
+			tags += textureCookSettings.highQuality ? ",BC7" : ",BC";
+		}
+		if (textureCookSettings.srgbFormats)
+		{
+			tags += ",SRGB";
+		}
+		if (textureCookSettings.residentMipSize > 0)
+		{
+			tags += ",Resident" + castl::to_string(textureCookSettings.residentMipSize);
+		}
+		return tags;
+	}
+	void StaticMeshImporter::EndImportBatch(thread_management::TaskScheduler* scheduler)
+	{
+		m_TextureCooker.EncodePendingTextures(scheduler);
+	}
 
+	void StaticMeshImporter::SetCookSettings(MeshCookSettings const& cookSettings)
+	{
+		m_CookSettings = cookSettings;
+		m_Passes.clear();
+		if (m_CookSettings.optimizeVertexOrder)
+		{
+			m_Passes.push_back(&m_VertexOrderPass);
+		}
+		if (m_CookSettings.buildMeshlets)
+		{
+			m_Passes.push_back(&m_MeshletBuildPass);
+		}
+		if (m_CookSettings.lodCount > 0)
+		{
+			m_LodPass = MeshLodPass(m_CookSettings.lodCount, m_CookSettings.lodReduction, m_CookSettings.lodMaxError);
+			m_Passes.push_back(&m_LodPass);
+		}
+		if (m_CookSettings.quantizeAttributes)
+		{
+			m_Passes.push_back(&m_QuantizeVertexPass);
+		}
+		m_Passes.push_back(&m_IndexWidthPass);
 	}
-	void StaticMeshImporter::ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath)
+	bool StaticMeshImporter::ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath)
 	{
-		const aiScene* scene = m_Importer.ReadFile(resourcePath.c_str(),
+		castl::shared_ptr<Assimp::Importer> pImporter;
+		{
+			castl::unique_lock<castl::mutex> lock(m_Mutex);
+			m_ConditionVariable.wait(lock, [this]()
+				{
+					return !m_AvailableImporters.empty();
+				});
+			pImporter = castl::shared_ptr<Assimp::Importer>(m_AvailableImporters.back(), [this](Assimp::Importer* importer)
+				{
+					importer->FreeScene();
+					{
+						castl::lock_guard<castl::mutex> lock(m_Mutex);
+						m_AvailableImporters.push_back(importer);
+					}
+					m_ConditionVariable.notify_one();
+				});
+			m_AvailableImporters.pop_back();
+		}
+
+		const aiScene* scene = pImporter->ReadFile(resourcePath.c_str(),
 			aiProcess_GenNormals |
 			aiProcess_CalcTangentSpace |
 			aiProcess_Triangulate |
@@ -31,7 +123,8 @@ namespace resource_management
 			aiProcess_SortByPType);
 
 		if (scene == nullptr) {
-			return;
+			CA_LOG_ERR("Mesh import failed: " + resourcePath);
+			return false;
 		}
 
 		if (scene->HasMeshes())
@@ -44,40 +137,61 @@ namespace resource_management
 				auto itrMesh = scene->mMeshes[i];
 				if (itrMesh->HasPositions() && itrMesh->HasTangentsAndBitangents() && itrMesh->HasNormals() && itrMesh->HasFaces())
 				{
-					meshResource->m_Attributes.resize(vertexOffset + itrMesh->mNumVertices);
+					//Imported as float vertices and 32 bit indices, the cook passes pack them
+					meshResource->m_VertexData.resize((vertexOffset + itrMesh->mNumVertices) * sizeof(CommonVertexData));
+					CommonVertexData* pVertices = reinterpret_cast<CommonVertexData*>(meshResource->m_VertexData.data()) + vertexOffset;
 					for (int iv = 0; iv < itrMesh->mNumVertices; ++iv)
 					{
-						meshResource->m_Attributes[vertexOffset + iv].pos = glm::vec3(itrMesh->mVertices[iv].x, itrMesh->mVertices[iv].y, itrMesh->mVertices[iv].z);
-						meshResource->m_Attributes[vertexOffset + iv].normal = glm::vec3(itrMesh->mNormals[iv].x, itrMesh->mNormals[iv].y, itrMesh->mNormals[iv].z);
-						meshResource->m_Attributes[vertexOffset + iv].tangent = glm::vec3(itrMesh->mTangents[iv].x, itrMesh->mTangents[iv].y, itrMesh->mTangents[iv].z);
-						meshResource->m_Attributes[vertexOffset + iv].bitangent = glm::vec3(itrMesh->mBitangents[iv].x, itrMesh->mBitangents[iv].y, itrMesh->mBitangents[iv].z);
+						pVertices[iv].pos = glm::vec3(itrMesh->mVertices[iv].x, itrMesh->mVertices[iv].y, itrMesh->mVertices[iv].z);
+						pVertices[iv].normal = glm::vec3(itrMesh->mNormals[iv].x, itrMesh->mNormals[iv].y, itrMesh->mNormals[iv].z);
+						pVertices[iv].tangent = glm::vec3(itrMesh->mTangents[iv].x, itrMesh->mTangents[iv].y, itrMesh->mTangents[iv].z);
+						pVertices[iv].bitangent = glm::vec3(itrMesh->mBitangents[iv].x, itrMesh->mBitangents[iv].y, itrMesh->mBitangents[iv].z);
 						if (itrMesh->HasTextureCoords(0))
 						{
-							meshResource->m_Attributes[vertexOffset + iv].uv = glm::vec2(itrMesh->mTextureCoords[0][iv].x, itrMesh->mTextureCoords[0][iv].y);
+							pVertices[iv].uv = glm::vec2(itrMesh->mTextureCoords[0][iv].x, itrMesh->mTextureCoords[0][iv].y);
 						}
 						else
 						{
-							meshResource->m_Attributes[vertexOffset + iv].uv = glm::vec2(0.0f, 0.0f);
+							pVertices[iv].uv = glm::vec2(0.0f, 0.0f);
 						}
 					}
-					meshResource->m_Indices16.resize(indexOffset + itrMesh->mNumFaces * 3);
+					meshResource->m_IndexData.resize((indexOffset + itrMesh->mNumFaces * 3) * sizeof(uint32_t));
+					uint32_t* pIndices = reinterpret_cast<uint32_t*>(meshResource->m_IndexData.data()) + indexOffset;
 					for (int fi = 0; fi < itrMesh->mNumFaces; ++fi)
 					{
 						CA_ASSERT(itrMesh->mFaces[fi].mNumIndices == 3, "Faces Should Be Triangles");
 						for (int ii = 0; ii < 3; ++ii)
 						{
-							meshResource->m_Indices16[indexOffset + fi * 3 + ii] = itrMesh->mFaces[fi].mIndices[ii];
+							pIndices[fi * 3 + ii] = itrMesh->mFaces[fi].mIndices[ii];
 						};
 					}
-					meshResource->m_SubmeshInfos.emplace_back(itrMesh->mMaterialIndex, itrMesh->mNumFaces * 3, indexOffset, vertexOffset);
+					meshResource->m_SubmeshInfos.emplace_back(itrMesh->mMaterialIndex, itrMesh->mNumFaces * 3
+						, indexOffset * sizeof(uint32_t), vertexOffset, itrMesh->mNumVertices, EIndexBufferType::e32);
 
 					indexOffset += itrMesh->mNumFaces * 3;
 					vertexOffset += itrMesh->mNumVertices;
 				}
 			}
 
+			ApplyPasses(meshResource);
+
 			if (scene->mNumTextures > 0)
 			{
+				//Normal maps are filtered as stored, everything else as sRGB color
+				castl::vector<aiTexture const*> linearTextures;
+				for (uint32_t materialID = 0; materialID < scene->mNumMaterials; ++materialID)
+				{
+					aiMaterial* pMaterial = scene->mMaterials[materialID];
+					for (uint32_t slotID = 0; slotID < pMaterial->GetTextureCount(aiTextureType_NORMALS); ++slotID)
+					{
+						aiString texturePath;
+						if (pMaterial->GetTexture(aiTextureType_NORMALS, slotID, &texturePath) == aiReturn_SUCCESS)
+						{
+							linearTextures.push_back(scene->GetEmbeddedTexture(texturePath.C_Str()));
+						}
+					}
+				}
+
 				for (int textureID = 0; textureID < scene->mNumTextures; ++textureID)
 				{
 					aiTexture* pTexture = scene->mTextures[textureID];
@@ -86,28 +200,11 @@ namespace resource_management
 
 					if (pTexture->mHeight == 0)
 					{
-						TextureResource* textureResource = resourceManager->AllocSubResource<TextureResource>(outPath, castl::to_ca(texturePath.string()));
 						int w, h, channel_num;
-						stbi_info_from_memory(reinterpret_cast<stbi_uc*>(pTexture->pcData), pTexture->mWidth, &w, &h, &channel_num);
-						int desiredChannel = channel_num;
-						ETextureFormat format;
-						switch (channel_num)
-						{
-						case 1:
-							format = ETextureFormat::E_R8_UNORM;
-							break;
-						case 2:
-							format = ETextureFormat::E_R8G8_UNORM;
-							break;
-						case 3:
-						case 4:
-							format = ETextureFormat::E_R8G8B8A8_UNORM;
-							desiredChannel = 4;
-							break;
-						}
-						auto data = stbi_load_from_memory(reinterpret_cast<stbi_uc*>(pTexture->pcData), pTexture->mWidth, &w, &h, &channel_num, desiredChannel);
-						textureResource->SetData(data, w * h * sizeof(uint8_t) * desiredChannel);
-						textureResource->SetMetaData(w, h, 1, 1, format, ETextureType::e2D);
+						auto data = stbi_load_from_memory(reinterpret_cast<stbi_uc*>(pTexture->pcData), pTexture->mWidth, &w, &h, &channel_num, 0);
+						ETextureCookUsage usage = castl::find(linearTextures.begin(), linearTextures.end(), pTexture) != linearTextures.end()
+							? ETextureCookUsage::eLinear : ETextureCookUsage::eColor;
+						m_TextureCooker.AddTexture(resourceManager, outPath, castl::to_ca(texturePath.string()), data, w, h, channel_num, usage);
 						stbi_image_free(data);
 					}
 				}
@@ -160,7 +257,10 @@ namespace resource_management
 			StaticMeshResource testResource;
 			testResource.Deserialzie(testData);
 			CA_ASSERT(testResource == *meshResource, "INVALID!!!");
+			return true;
 		}
+		CA_LOG_ERR("Mesh import found no meshes: " + resourcePath);
+		return false;
 	}
 }
 
@@ -12,6 +12,11 @@
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <CRenderBackend.h>
+#include <CASTL/CAUniquePtr.h>
+#include <CASTL/CASharedPtr.h>
+#include <CASTL/CAMutex.h>
+#include "MeshCookPasses.h"
+#include "TextureCookPasses.h"
 
 namespace resource_management
 {
@@ -52,6 +57,41 @@ namespace resource_management
 		}
 	};
 
+	//Normal, tangent and bitangent as signed normalized bytes and uv as half floats, half the size of CommonVertexData
+	struct QuantizedVertexData
+	{
+		glm::vec3 pos;
+		uint32_t uv;
+		uint32_t normal;
+		uint32_t tangent;
+		uint32_t bitangent;
+
+		auto operator<=>(const QuantizedVertexData&) const = default;
+
+		static VertexInputsDescriptor GetVertexInputDescriptor()
+		{
+			VertexInputsDescriptor result;
+			result.perInstance = false;
+			result.stride = sizeof(QuantizedVertexData);
+			result.attributes = castl::vector{
+				VertexAttribute{ 0, offsetof(QuantizedVertexData, pos), VertexInputFormat::eR32G32B32_SFloat, "POSITION"}
+				, VertexAttribute{ 0, offsetof(QuantizedVertexData, uv), VertexInputFormat::eR16G16_SFloat, "TEXCOORD"}
+				, VertexAttribute{0, offsetof(QuantizedVertexData, normal), VertexInputFormat::eR8G8B8A8_SNorm, "NORMAL"}
+				, VertexAttribute{0, offsetof(QuantizedVertexData, tangent), VertexInputFormat::eR8G8B8A8_SNorm, "TANGENT"}
+				, VertexAttribute{ 0, offsetof(QuantizedVertexData, bitangent), VertexInputFormat::eR8G8B8A8_SNorm, "BITANGENT"}
+			};
+			return result;
+		}
+	};
+
+	enum class EMeshVertexFormat : uint32_t
+	{
+		//CommonVertexData
+		eFloat,
+		//QuantizedVertexData
+		eQuantized,
+	};
+
 	using namespace library_loader;
 	class StaticMeshResource : public IResource
 	{
@@ -60,11 +100,47 @@ namespace resource_management
 		{
 			int m_MaterialID;
 			int m_IndicesCount;
-			int m_IndexArrayOffset;
+			//Aligned to 4 bytes, submeshes pick their own index type
+			int m_IndexByteOffset;
 			int m_VertexArrayOffset;
+			int m_VertexCount;
+			EIndexBufferType m_IndexType;
+			//Range in the meshlet array, empty when meshlets are not built
+			int m_MeshletOffset = 0;
+			int m_MeshletCount = 0;
+			//Range in the LOD array, the submesh itself is LOD 0 and is not stored there
+			int m_LodOffset = 0;
+			int m_LodCount = 0;
+			//Object space, xyz center and w radius
+			glm::vec4 m_BoundingSphere = glm::vec4(0.0f);
 			auto operator<=>(const SubmeshInfo&) const = default;
 		};
 
+		//Simplified index range of a submesh, same vertices and index type as the submesh
+		struct LodInfo
+		{
+			int m_IndicesCount;
+			int m_IndexByteOffset;
+			//Object space distance to the source surface, grows with the LOD level
+			float m_Error;
+			auto operator<=>(const LodInfo&) const = default;
+		};
+
+		//Contiguous index range of a submesh, laid out as the GPU reads it
+		struct MeshletInfo
+		{
+			//Object space, xyz center and w radius
+			glm::vec4 m_BoundingSphere;
+			//xyz axis and w cutoff of the triangle normal cone, a cutoff of 1 is never backface culled
+			glm::vec4 m_NormalCone;
+			//Relative to the first index of the submesh
+			uint32_t m_FirstIndex;
+			uint32_t m_IndexCount;
+			uint32_t m_VertexCount;
+			uint32_t m_SubmeshID;
+			auto operator<=>(const MeshletInfo&) const = default;
+		};
+
 		struct InstanceInfo
 		{
 			uint32_t m_SubmeshID;
@@ -73,24 +149,58 @@ namespace resource_management
 		};
 		virtual void Serialzie(castl::vector<uint8_t>& out) override;
 		virtual void Deserialzie(castl::vector<uint8_t>& in) override;
-		uint32_t GetVertexCount() const { return m_Attributes.size(); }
-		uint32_t GetIndicesCount() const { return m_Indices16.size(); }
-		void const* GetVertexData() const { return m_Attributes.data(); }
-		void const* GetIndicesData() const { return m_Indices16.data(); }
+		//Releases the GPU buffers created from the mesh, see RegisterMeshResource
+		virtual void Unload() override;
+		virtual uint64_t GetMemorySizeInByte() const override
+		{
+			return m_VertexData.capacity()
+				+ m_IndexData.capacity()
+				+ m_SubmeshInfos.capacity() * sizeof(SubmeshInfo)
+				+ m_Meshlets.capacity() * sizeof(MeshletInfo)
+				+ m_Lods.capacity() * sizeof(LodInfo)
+				+ m_Instance.capacity() * sizeof(InstanceInfo);
+		}
+		EMeshVertexFormat GetVertexFormat() const { return m_VertexFormat; }
+		uint32_t GetVertexStride() const
+		{
+			return m_VertexFormat == EMeshVertexFormat::eQuantized ? sizeof(QuantizedVertexData) : sizeof(CommonVertexData);
+		}
+		VertexInputsDescriptor GetVertexInputDescriptor() const
+		{
+			return m_VertexFormat == EMeshVertexFormat::eQuantized ? QuantizedVertexData::GetVertexInputDescriptor() : CommonVertexData::GetVertexInputDescriptor();
+		}
+		uint32_t GetVertexCount() const { return m_VertexData.size() / GetVertexStride(); }
+		uint64_t GetVertexDataSize() const { return m_VertexData.size(); }
+		uint64_t GetIndexDataSize() const { return m_IndexData.size(); }
+		void const* GetVertexData() const { return m_VertexData.data(); }
+		void const* GetIndexData() const { return m_IndexData.data(); }
 		std::vector<SubmeshInfo> const& GetSubmeshInfos() const { return m_SubmeshInfos; }
+		std::vector<MeshletInfo> const& GetMeshlets() const { return m_Meshlets; }
+		std::vector<LodInfo> const& GetLods() const { return m_Lods; }
 		std::vector<InstanceInfo> const& GetInstanceInfos() const { return m_Instance; }
 		bool operator==(StaticMeshResource const& other) const
 		{
-			return m_Attributes == other.m_Attributes
-				&& m_Indices16 == other.m_Indices16
+			return m_VertexFormat == other.m_VertexFormat
+				&& m_VertexData == other.m_VertexData
+				&& m_IndexData == other.m_IndexData
 				&& m_SubmeshInfos == other.m_SubmeshInfos
+				&& m_Meshlets == other.m_Meshlets
+				&& m_Lods == other.m_Lods
 				&& m_Instance == other.m_Instance;
 		}
 	private:
 		friend class StaticMeshImporter;
-		std::vector<CommonVertexData> m_Attributes;
-		std::vector<uint16_t> m_Indices16;
+		friend class MeshVertexOrderPass;
+		friend class MeshletBuildPass;
+		friend class MeshLodPass;
+		friend class MeshQuantizeVertexPass;
+		friend class MeshIndexWidthPass;
+		EMeshVertexFormat m_VertexFormat = EMeshVertexFormat::eFloat;
+		std::vector<uint8_t> m_VertexData;
+		std::vector<uint8_t> m_IndexData;
 		std::vector<SubmeshInfo> m_SubmeshInfos;
+		std::vector<MeshletInfo> m_Meshlets;
+		std::vector<LodInfo> m_Lods;
 		std::vector<InstanceInfo> m_Instance;
 
 		CA_PRIVATE_REFLECTION(StaticMeshResource);
@@ -100,14 +210,31 @@ namespace resource_management
 	class StaticMeshImporter : public ResourceImporter<StaticMeshResource>
 	{
 	public:
-		StaticMeshImporter();
+		//Assimp importers can not be shared, one is kept for every import running at the same time
+		StaticMeshImporter(uint32_t importerCount = 1);
 		virtual castl::string GetSourceFilePostfix() const override { return ".fbx"; }
 		virtual castl::string GetDestFilePostfix() const override { return ""; }
-		virtual castl::string GetTags() const override { return ""; }
-		virtual void ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) override;
+		virtual castl::string GetTags() const override;
+		virtual uint32_t GetImporterVersion() const override { return 5; }
+		virtual uint32_t GetMaxParallelImports() const override { return static_cast<uint32_t>(m_Importers.size()); }
+		virtual bool ImportResource(ResourceManagingSystem* resourceManager, castl::string const& resourcePath, castl::string const& outPath) override;
+		virtual void EndImportBatch(thread_management::TaskScheduler* scheduler) override;
+		void SetCookSettings(MeshCookSettings const& cookSettings);
+		//Embedded textures are cooked into sub resources, block compression runs after the import batch
+		void SetTextureCookSettings(TextureCookSettings const& cookSettings) { m_TextureCooker.SetCookSettings(cookSettings); }
 	private:
-		Assimp::Importer m_Importer;
+		MeshCookSettings m_CookSettings;
+		TextureCooker m_TextureCooker;
+		MeshVertexOrderPass m_VertexOrderPass;
+		MeshletBuildPass m_MeshletBuildPass;
+		MeshLodPass m_LodPass;
+		MeshQuantizeVertexPass m_QuantizeVertexPass;
+		MeshIndexWidthPass m_IndexWidthPass;
+		castl::vector<castl::unique_ptr<Assimp::Importer>> m_Importers;
+		castl::mutex m_Mutex;
+		castl::condition_variable m_ConditionVariable;
+		castl::vector<Assimp::Importer*> m_AvailableImporters;
 	};
 }
 
-CA_REFLECTION(resource_management::StaticMeshResource, m_Attributes, m_Indices16, m_SubmeshInfos, m_Instance);
+CA_REFLECTION(resource_management::StaticMeshResource, m_VertexFormat, m_VertexData, m_IndexData, m_SubmeshInfos, m_Meshlets, m_Lods, m_Instance);
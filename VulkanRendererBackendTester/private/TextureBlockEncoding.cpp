@@ -0,0 +1,408 @@
+#include "TextureCookPasses.h"
+#include <DebugUtils.h>
+#include <CASTL/CAAlgorithm.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXTURE_COOK_SSE2 1
+#endif
+
+namespace resource_management
+{
+	namespace
+	{
+		constexpr uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		using Block = uint8_t[16][4];
+
+		//Texels past the image edge repeat the last row and column
+		void LoadBlock(uint8_t const* pRGBA, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& outBlock)
+		{
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				uint32_t x = castl::min(blockX * 4 + texelID % 4, width - 1);
+				uint32_t y = castl::min(blockY * 4 + texelID / 4, height - 1);
+				uint8_t const* pTexel = pRGBA + (static_cast<uint64_t>(y) * width + x) * 4;
+				outBlock[texelID][0] = pTexel[0];
+				outBlock[texelID][1] = pTexel[1];
+				outBlock[texelID][2] = pTexel[2];
+				outBlock[texelID][3] = pTexel[3];
+			}
+		}
+
+		//Nearest palette entry of every texel by squared RGBA distance, four texels at a time with SSE2
+		void FindNearestIndices(Block const& block, uint8_t const (*pPalette)[4], uint32_t paletteSize, uint8_t (&outIndices)[16])
+		{
+#if TEXTURE_COOK_SSE2
+			__m128i const zero = _mm_setzero_si128();
+			for (uint32_t texelID = 0; texelID < 16; texelID += 4)
+			{
+				__m128i texels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block[texelID]));
+				__m128i texels01 = _mm_unpacklo_epi8(texels, zero);
+				__m128i texels23 = _mm_unpackhi_epi8(texels, zero);
+				__m128i bestDistance = _mm_set1_epi32(INT32_MAX);
+				__m128i bestIndex = zero;
+				for (uint32_t paletteID = 0; paletteID < paletteSize; ++paletteID)
+				{
+					uint8_t const* pColor = pPalette[paletteID];
+					__m128i color = _mm_set_epi16(pColor[3], pColor[2], pColor[1], pColor[0], pColor[3], pColor[2], pColor[1], pColor[0]);
+					__m128i diff01 = _mm_sub_epi16(texels01, color);
+					__m128i diff23 = _mm_sub_epi16(texels23, color);
+					//Pairs of squared channel differences, rg and ba of every texel
+					__m128 pairs01 = _mm_castsi128_ps(_mm_madd_epi16(diff01, diff01));
+					__m128 pairs23 = _mm_castsi128_ps(_mm_madd_epi16(diff23, diff23));
+					__m128i distance = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(2, 0, 2, 0)))
+						, _mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(3, 1, 3, 1))));
+					__m128i closer = _mm_cmplt_epi32(distance, bestDistance);
+					bestDistance = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, bestDistance));
+					bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(paletteID)), _mm_andnot_si128(closer, bestIndex));
+				}
+				alignas(16) int32_t indices[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+				for (uint32_t laneID = 0; laneID < 4; ++laneID)
+				{
+					outIndices[texelID + laneID] = static_cast<uint8_t>(indices[laneID]);
+				}
+			}
+#else
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				int32_t bestDistance = INT32_MAX;
+				for (uint32_t paletteID = 0; paletteID < paletteSize; ++paletteID)
+				{
+					int32_t distance = 0;
+					for (uint32_t channelID = 0; channelID < 4; ++channelID)
+					{
+						int32_t diff = static_cast<int32_t>(block[texelID][channelID]) - pPalette[paletteID][channelID];
+						distance += diff * diff;
+					}
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						outIndices[texelID] = static_cast<uint8_t>(paletteID);
+					}
+				}
+			}
+#endif
+		}
+
+		//Endpoints at the extremes of the texels projected on their principal axis, channels beyond channelCount are ignored
+		void PrincipalAxisEndpoints(Block const& block, uint32_t channelCount, float (&outMin)[4], float (&outMax)[4])
+		{
+			float mean[4] = {};
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				for (uint32_t channelID = 0; channelID < channelCount; ++channelID)
+				{
+					mean[channelID] += block[texelID][channelID] / 16.0f;
+				}
+			}
+			float covariance[4][4] = {};
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				float diff[4] = {};
+				for (uint32_t channelID = 0; channelID < channelCount; ++channelID)
+				{
+					diff[channelID] = block[texelID][channelID] - mean[channelID];
+				}
+				for (uint32_t row = 0; row < channelCount; ++row)
+				{
+					for (uint32_t column = 0; column < channelCount; ++column)
+					{
+						covariance[row][column] += diff[row] * diff[column];
+					}
+				}
+			}
+			//Power iteration converges quickly enough for 16 texels
+			float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			for (uint32_t iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[4] = {};
+				float length = 0.0f;
+				for (uint32_t row = 0; row < channelCount; ++row)
+				{
+					for (uint32_t column = 0; column < channelCount; ++column)
+					{
+						next[row] += covariance[row][column] * axis[column];
+					}
+					length = castl::max(length, std::abs(next[row]));
+				}
+				if (length <= 0.0f)
+				{
+					break;
+				}
+				for (uint32_t channelID = 0; channelID < channelCount; ++channelID)
+				{
+					axis[channelID] = next[channelID] / length;
+				}
+			}
+			float minProjection = FLT_MAX;
+			float maxProjection = -FLT_MAX;
+			float axisLengthSquared = 0.0f;
+			for (uint32_t channelID = 0; channelID < channelCount; ++channelID)
+			{
+				axisLengthSquared += axis[channelID] * axis[channelID];
+			}
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				float projection = 0.0f;
+				for (uint32_t channelID = 0; channelID < channelCount; ++channelID)
+				{
+					projection += (block[texelID][channelID] - mean[channelID]) * axis[channelID];
+				}
+				minProjection = castl::min(minProjection, projection);
+				maxProjection = castl::max(maxProjection, projection);
+			}
+			for (uint32_t channelID = 0; channelID < 4; ++channelID)
+			{
+				float axisScale = axisLengthSquared > 0.0f ? axis[channelID] / axisLengthSquared : 0.0f;
+				outMin[channelID] = channelID < channelCount ? mean[channelID] + axisScale * minProjection : 255.0f;
+				outMax[channelID] = channelID < channelCount ? mean[channelID] + axisScale * maxProjection : 255.0f;
+			}
+		}
+
+		uint16_t PackRGB565(float const (&color)[4])
+		{
+			uint32_t r = static_cast<uint32_t>(castl::min(castl::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+			uint32_t g = static_cast<uint32_t>(castl::min(castl::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+			uint32_t b = static_cast<uint32_t>(castl::min(castl::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+			return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+		}
+
+		void UnpackRGB565(uint16_t color, uint8_t (&outColor)[4])
+		{
+			uint32_t r = (color >> 11) & 31;
+			uint32_t g = (color >> 5) & 63;
+			uint32_t b = color & 31;
+			outColor[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+			outColor[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+			outColor[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+			outColor[3] = 0;
+		}
+
+		//Four color mode only, alpha is ignored
+		void EncodeBC1Color(Block const& block, uint8_t* pDest)
+		{
+			float minColor[4];
+			float maxColor[4];
+			PrincipalAxisEndpoints(block, 3, minColor, maxColor);
+			uint16_t color0 = PackRGB565(maxColor);
+			uint16_t color1 = PackRGB565(minColor);
+			if (color0 < color1)
+			{
+				castl::swap(color0, color1);
+			}
+			uint32_t indexBits = 0;
+			if (color0 != color1)
+			{
+				uint8_t palette[4][4];
+				UnpackRGB565(color0, palette[0]);
+				UnpackRGB565(color1, palette[1]);
+				for (uint32_t channelID = 0; channelID < 4; ++channelID)
+				{
+					palette[2][channelID] = static_cast<uint8_t>((2 * palette[0][channelID] + palette[1][channelID]) / 3);
+					palette[3][channelID] = static_cast<uint8_t>((palette[0][channelID] + 2 * palette[1][channelID]) / 3);
+				}
+				Block colorBlock;
+				for (uint32_t texelID = 0; texelID < 16; ++texelID)
+				{
+					colorBlock[texelID][0] = block[texelID][0];
+					colorBlock[texelID][1] = block[texelID][1];
+					colorBlock[texelID][2] = block[texelID][2];
+					colorBlock[texelID][3] = 0;
+				}
+				uint8_t indices[16];
+				FindNearestIndices(colorBlock, palette, 4, indices);
+				for (uint32_t texelID = 0; texelID < 16; ++texelID)
+				{
+					indexBits |= static_cast<uint32_t>(indices[texelID]) << (texelID * 2);
+				}
+			}
+			pDest[0] = static_cast<uint8_t>(color0);
+			pDest[1] = static_cast<uint8_t>(color0 >> 8);
+			pDest[2] = static_cast<uint8_t>(color1);
+			pDest[3] = static_cast<uint8_t>(color1 >> 8);
+			for (uint32_t byteID = 0; byteID < 4; ++byteID)
+			{
+				pDest[4 + byteID] = static_cast<uint8_t>(indexBits >> (byteID * 8));
+			}
+		}
+
+		//Eight value mode of a single channel, shared by BC3 alpha and both BC5 channels
+		void EncodeBC4Channel(Block const& block, uint32_t channelID, uint8_t* pDest)
+		{
+			uint8_t minValue = 255;
+			uint8_t maxValue = 0;
+			for (uint32_t texelID = 0; texelID < 16; ++texelID)
+			{
+				minValue = castl::min(minValue, block[texelID][channelID]);
+				maxValue = castl::max(maxValue, block[texelID][channelID]);
+			}
+			uint64_t bits = static_cast<uint64_t>(maxValue) | (static_cast<uint64_t>(minValue) << 8);
+			if (maxValue != minValue)
+			{
+				int32_t palette[8];
+				palette[0] = maxValue;
+				palette[1] = minValue;
+				for (int32_t stepID = 1; stepID < 7; ++stepID)
+				{
+					palette[stepID + 1] = ((7 - stepID) * maxValue + stepID * minValue) / 7;
+				}
+				for (uint32_t texelID = 0; texelID < 16; ++texelID)
+				{
+					uint32_t bestIndex = 0;
+					int32_t bestDistance = INT32_MAX;
+					for (uint32_t paletteID = 0; paletteID < 8; ++paletteID)
+					{
+						int32_t distance = std::abs(static_cast<int32_t>(block[texelID][channelID]) - palette[paletteID]);
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							bestIndex = paletteID;
+						}
+					}
+					bits |= static_cast<uint64_t>(bestIndex) << (16 + texelID * 3);
+				}
+			}
+			for (uint32_t byteID = 0; byteID < 8; ++byteID)
+			{
+				pDest[byteID] = static_cast<uint8_t>(bits >> (byteID * 8));
+			}
+		}
+
+		class BlockBitWriter
+		{
+		public:
+			BlockBitWriter(uint8_t* pDest) : m_Dest(pDest)
+			{
+				memset(m_Dest, 0, 16);
+			}
+			void Write(uint32_t value, uint32_t bitCount)
+			{
+				for (uint32_t bitID = 0; bitID < bitCount; ++bitID, ++m_Position)
+				{
+					m_Dest[m_Position / 8] |= static_cast<uint8_t>(((value >> bitID) & 1) << (m_Position % 8));
+				}
+			}
+		private:
+			uint8_t* m_Dest;
+			uint32_t m_Position = 0;
+		};
+
+		//7 bit RGBA plus the parity bit that fits the endpoint best
+		void QuantizeBC7Endpoint(float const (&endpoint)[4], uint8_t (&outQuantized)[4], uint32_t& outParity)
+		{
+			float bestError = FLT_MAX;
+			for (uint32_t parity = 0; parity < 2; ++parity)
+			{
+				uint8_t quantized[4];
+				float error = 0.0f;
+				for (uint32_t channelID = 0; channelID < 4; ++channelID)
+				{
+					float value = castl::min(castl::max(endpoint[channelID], 0.0f), 255.0f);
+					int32_t level = castl::min(castl::max(static_cast<int32_t>(std::floor((value - parity) / 2.0f + 0.5f)), 0), 127);
+					quantized[channelID] = static_cast<uint8_t>(level);
+					float diff = static_cast<float>((level << 1) | parity) - value;
+					error += diff * diff;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					outParity = parity;
+					castl::copy(quantized, quantized + 4, outQuantized);
+				}
+			}
+		}
+
+		//Mode 6 only, one RGBA subset with 4 bit indices
+		void EncodeBC7Block(Block const& block, uint8_t* pDest)
+		{
+			float minColor[4];
+			float maxColor[4];
+			PrincipalAxisEndpoints(block, 4, minColor, maxColor);
+			uint8_t endpoints[2][4];
+			uint32_t parities[2];
+			QuantizeBC7Endpoint(minColor, endpoints[0], parities[0]);
+			QuantizeBC7Endpoint(maxColor, endpoints[1], parities[1]);
+
+			uint8_t palette[16][4];
+			for (uint32_t channelID = 0; channelID < 4; ++channelID)
+			{
+				uint32_t value0 = (endpoints[0][channelID] << 1) | parities[0];
+				uint32_t value1 = (endpoints[1][channelID] << 1) | parities[1];
+				for (uint32_t paletteID = 0; paletteID < 16; ++paletteID)
+				{
+					palette[paletteID][channelID] = static_cast<uint8_t>(((64 - BC7_WEIGHTS4[paletteID]) * value0 + BC7_WEIGHTS4[paletteID] * value1 + 32) >> 6);
+				}
+			}
+			uint8_t indices[16];
+			FindNearestIndices(block, palette, 16, indices);
+			//The most significant bit of the first index is implicit zero
+			if (indices[0] >= 8)
+			{
+				castl::swap(endpoints[0], endpoints[1]);
+				castl::swap(parities[0], parities[1]);
+				for (uint8_t& index : indices)
+				{
+					index = static_cast<uint8_t>(15 - index);
+				}
+			}
+
+			BlockBitWriter writer(pDest);
+			writer.Write(1 << 6, 7);
+			for (uint32_t channelID = 0; channelID < 4; ++channelID)
+			{
+				writer.Write(endpoints[0][channelID], 7);
+				writer.Write(endpoints[1][channelID], 7);
+			}
+			writer.Write(parities[0], 1);
+			writer.Write(parities[1], 1);
+			writer.Write(indices[0], 3);
+			for (uint32_t texelID = 1; texelID < 16; ++texelID)
+			{
+				writer.Write(indices[texelID], 4);
+			}
+		}
+	}
+
+	void TextureCooker::EncodeBlockRows(ETextureFormat format, uint8_t const* pRGBA, uint32_t width, uint32_t height
+		, uint32_t blockRowBegin, uint32_t blockRowEnd, uint8_t* pDest)
+	{
+		uint32_t blocksX = (width + 3) / 4;
+		uint32_t blockBytes = GetFormatBlockBytes(format);
+		Block block;
+		for (uint32_t blockY = blockRowBegin; blockY < blockRowEnd; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+			{
+				LoadBlock(pRGBA, width, height, blockX, blockY, block);
+				uint8_t* pBlock = pDest + (static_cast<uint64_t>(blockY) * blocksX + blockX) * blockBytes;
+				switch (format)
+				{
+				case ETextureFormat::E_BC1_RGBA_UNORM:
+				case ETextureFormat::E_BC1_RGBA_SRGB:
+					EncodeBC1Color(block, pBlock);
+					break;
+				case ETextureFormat::E_BC3_UNORM:
+				case ETextureFormat::E_BC3_SRGB:
+					EncodeBC4Channel(block, 3, pBlock);
+					EncodeBC1Color(block, pBlock + 8);
+					break;
+				case ETextureFormat::E_BC5_UNORM:
+					EncodeBC4Channel(block, 0, pBlock);
+					EncodeBC4Channel(block, 1, pBlock + 8);
+					break;
+				case ETextureFormat::E_BC7_UNORM:
+				case ETextureFormat::E_BC7_SRGB:
+					EncodeBC7Block(block, pBlock);
+					break;
+				default:
+					CA_LOG_ERR("Texture Format Is Not Block Compressed");
+					return;
+				}
+			}
+		}
+	}
+}
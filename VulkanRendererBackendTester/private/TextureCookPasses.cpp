@@ -0,0 +1,250 @@
+#include "TextureCookPasses.h"
+#include "TextureResource.h"
+#include <ThreadManager.h>
+#include <GPUTexture.h>
+#include <CASTL/CAAlgorithm.h>
+#include <CASTL/CASharedPtr.h>
+#include <cmath>
+
+namespace resource_management
+{
+	namespace
+	{
+		//Block rows encoded by one job, small mips are encoded by a single job
+		constexpr uint32_t ENCODE_JOB_BLOCK_ROWS = 16;
+
+		float SRGBToLinear(float value)
+		{
+			return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float LinearToSRGB(float value)
+		{
+			return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+
+		uint8_t ToUnorm8(float value)
+		{
+			return static_cast<uint8_t>(castl::min(castl::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+
+		ETextureFormat SelectCookedFormat(uint32_t channelCount, bool hasAlpha, ETextureCookUsage usage, TextureCookSettings const& settings)
+		{
+			if (channelCount == 1)
+			{
+				return ETextureFormat::E_R8_UNORM;
+			}
+			if (channelCount == 2)
+			{
+				return settings.blockCompress ? ETextureFormat::E_BC5_UNORM : ETextureFormat::E_R8G8_UNORM;
+			}
+			bool srgb = usage == ETextureCookUsage::eColor && settings.srgbFormats;
+			if (!settings.blockCompress)
+			{
+				return srgb ? ETextureFormat::E_R8G8B8A8_SRGB : ETextureFormat::E_R8G8B8A8_UNORM;
+			}
+			if (settings.highQuality)
+			{
+				return srgb ? ETextureFormat::E_BC7_SRGB : ETextureFormat::E_BC7_UNORM;
+			}
+			if (hasAlpha)
+			{
+				return srgb ? ETextureFormat::E_BC3_SRGB : ETextureFormat::E_BC3_UNORM;
+			}
+			return srgb ? ETextureFormat::E_BC1_RGBA_SRGB : ETextureFormat::E_BC1_RGBA_UNORM;
+		}
+	}
+
+	castl::vector<uint8_t> TextureCooker::BuildMipChain(uint8_t const* pRGBA, uint32_t width, uint32_t height, uint32_t mipLevels, bool srgb)
+	{
+		float toLinear[256];
+		for (uint32_t value = 0; value < 256; ++value)
+		{
+			toLinear[value] = srgb ? SRGBToLinear(value / 255.0f) : value / 255.0f;
+		}
+		auto textureDesc = graphics_backend::GPUTextureDescriptor::Create(width, height, ETextureFormat::E_R8G8B8A8_UNORM, ETextureAccessType::eSampled
+			, ETextureType::e2D, 1, mipLevels);
+		castl::vector<uint8_t> result(textureDesc.GetMipDataOffset(mipLevels));
+		castl::copy(pRGBA, pRGBA + textureDesc.GetMipDataSize(0), result.data());
+		for (uint32_t mipID = 1; mipID < mipLevels; ++mipID)
+		{
+			uint8_t const* pSource = result.data() + textureDesc.GetMipDataOffset(mipID - 1);
+			uint8_t* pDest = result.data() + textureDesc.GetMipDataOffset(mipID);
+			uint32_t sourceWidth = textureDesc.GetMipWidth(mipID - 1);
+			uint32_t sourceHeight = textureDesc.GetMipHeight(mipID - 1);
+			uint32_t mipWidth = textureDesc.GetMipWidth(mipID);
+			uint32_t mipHeight = textureDesc.GetMipHeight(mipID);
+			for (uint32_t y = 0; y < mipHeight; ++y)
+			{
+				for (uint32_t x = 0; x < mipWidth; ++x)
+				{
+					//2x2 box, odd sized sources repeat their last row or column
+					float sum[4] = {};
+					for (uint32_t sampleID = 0; sampleID < 4; ++sampleID)
+					{
+						uint32_t sourceX = castl::min(x * 2 + sampleID % 2, sourceWidth - 1);
+						uint32_t sourceY = castl::min(y * 2 + sampleID / 2, sourceHeight - 1);
+						uint8_t const* pTexel = pSource + (static_cast<uint64_t>(sourceY) * sourceWidth + sourceX) * 4;
+						sum[0] += toLinear[pTexel[0]];
+						sum[1] += toLinear[pTexel[1]];
+						sum[2] += toLinear[pTexel[2]];
+						sum[3] += pTexel[3] / 255.0f;
+					}
+					uint8_t* pTexel = pDest + (static_cast<uint64_t>(y) * mipWidth + x) * 4;
+					for (uint32_t channelID = 0; channelID < 3; ++channelID)
+					{
+						pTexel[channelID] = ToUnorm8(srgb ? LinearToSRGB(sum[channelID] * 0.25f) : sum[channelID] * 0.25f);
+					}
+					pTexel[3] = ToUnorm8(sum[3] * 0.25f);
+				}
+			}
+		}
+		return result;
+	}
+
+	void TextureCooker::StoreMips(TextureResource* resource, castl::vector<TextureMipResource*> const& mipResources, uint8_t const* pData, uint64_t dataSize
+		, uint32_t width, uint32_t height, ETextureFormat format, uint32_t mipLevels)
+	{
+		auto textureDesc = graphics_backend::GPUTextureDescriptor::Create(width, height, format, ETextureAccessType::eSampled
+			, ETextureType::e2D, 1, mipLevels);
+		uint32_t streamedMipCount = static_cast<uint32_t>(mipResources.size());
+		for (uint32_t mipID = 0; mipID < streamedMipCount; ++mipID)
+		{
+			mipResources[mipID]->SetData(pData + textureDesc.GetMipDataOffset(mipID), textureDesc.GetMipDataSize(mipID));
+		}
+		uint64_t residentOffset = textureDesc.GetMipDataOffset(streamedMipCount);
+		resource->SetData(pData + residentOffset, dataSize - residentOffset);
+		resource->SetStreamedMipCount(streamedMipCount);
+	}
+
+	void TextureCooker::AddTexture(ResourceManagingSystem* resourceManager, castl::string const& outPath, castl::string const& texturePath
+		, uint8_t const* pTexels, uint32_t width, uint32_t height, uint32_t channelCount, ETextureCookUsage usage)
+	{
+		//Mips and blocks are built from RGBA, missing channels read as 0 and opaque
+		uint64_t texelCount = static_cast<uint64_t>(width) * height;
+		castl::vector<uint8_t> rgba(texelCount * 4);
+		bool hasAlpha = false;
+		for (uint64_t texelID = 0; texelID < texelCount; ++texelID)
+		{
+			for (uint32_t channelID = 0; channelID < 4; ++channelID)
+			{
+				rgba[texelID * 4 + channelID] = channelID < channelCount ? pTexels[texelID * channelCount + channelID] : (channelID == 3 ? 255 : 0);
+			}
+			hasAlpha |= rgba[texelID * 4 + 3] != 255;
+		}
+
+		ETextureFormat format = SelectCookedFormat(channelCount, hasAlpha, usage, m_CookSettings);
+		uint32_t mipLevels = m_CookSettings.generateMips ? static_cast<uint32_t>(std::floor(std::log2(castl::max(width, height)))) + 1 : 1;
+		castl::vector<uint8_t> mips = BuildMipChain(rgba.data(), width, height, mipLevels, usage == ETextureCookUsage::eColor);
+		TextureResource* resource = resourceManager->AllocSubResource<TextureResource>(outPath, texturePath);
+		resource->SetMetaData(width, height, 1, mipLevels, format, ETextureType::e2D);
+		//The coarsest mip always stays with the texture so it can be drawn as soon as it is loaded
+		castl::vector<TextureMipResource*> mipResources;
+		uint32_t residentMipSize = m_CookSettings.residentMipSize;
+		while (residentMipSize > 0 && mipResources.size() + 1 < mipLevels
+			&& castl::max(width, height) >> static_cast<uint32_t>(mipResources.size()) > residentMipSize)
+		{
+			mipResources.push_back(resourceManager->AllocSubResource<TextureMipResource>(outPath
+				, TextureResource::GetMipResourcePath(texturePath, static_cast<uint32_t>(mipResources.size()))));
+		}
+		if (IsBlockCompressedFormat(format))
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			m_PendingTextures.push_back(PendingTexture{ resource, castl::move(mipResources), format, width, height, mipLevels, castl::move(mips) });
+			return;
+		}
+
+		//Uncompressed formats keep the leading channels of the RGBA mips
+		uint32_t texelBytes = GetFormatBlockBytes(format);
+		castl::vector<uint8_t> data(mips.size() / 4 * texelBytes);
+		for (uint64_t texelID = 0; texelID < mips.size() / 4; ++texelID)
+		{
+			castl::copy(mips.data() + texelID * 4, mips.data() + texelID * 4 + texelBytes, data.data() + texelID * texelBytes);
+		}
+		StoreMips(resource, mipResources, data.data(), data.size(), width, height, format, mipLevels);
+	}
+
+	void TextureCooker::EncodePendingTextures(thread_management::TaskScheduler* scheduler)
+	{
+		struct EncodeJob
+		{
+			uint32_t textureID;
+			uint32_t mip;
+			uint32_t blockRowBegin;
+			uint32_t blockRowEnd;
+		};
+		struct EncodeBatch
+		{
+			castl::vector<PendingTexture> textures;
+			castl::vector<castl::vector<uint8_t>> encodedTextures;
+			castl::vector<EncodeJob> jobs;
+		};
+		auto batch = castl::make_shared<EncodeBatch>();
+		{
+			castl::lock_guard<castl::mutex> guard(m_Mutex);
+			batch->textures = castl::move(m_PendingTextures);
+			m_PendingTextures.clear();
+		}
+		if (batch->textures.empty())
+		{
+			return;
+		}
+		batch->encodedTextures.resize(batch->textures.size());
+		for (uint32_t textureID = 0; textureID < batch->textures.size(); ++textureID)
+		{
+			auto& texture = batch->textures[textureID];
+			auto textureDesc = graphics_backend::GPUTextureDescriptor::Create(texture.width, texture.height, texture.format, ETextureAccessType::eSampled
+				, ETextureType::e2D, 1, texture.mipLevels);
+			batch->encodedTextures[textureID].resize(textureDesc.GetMipDataOffset(texture.mipLevels));
+			for (uint32_t mipID = 0; mipID < texture.mipLevels; ++mipID)
+			{
+				uint32_t blockRows = (textureDesc.GetMipHeight(mipID) + 3) / 4;
+				for (uint32_t blockRow = 0; blockRow < blockRows; blockRow += ENCODE_JOB_BLOCK_ROWS)
+				{
+					batch->jobs.push_back(EncodeJob{ textureID, mipID, blockRow, castl::min(blockRow + ENCODE_JOB_BLOCK_ROWS, blockRows) });
+				}
+			}
+		}
+
+		auto encode = [batch](uint32_t jobID)
+			{
+				auto& job = batch->jobs[jobID];
+				auto& texture = batch->textures[job.textureID];
+				auto textureDesc = graphics_backend::GPUTextureDescriptor::Create(texture.width, texture.height, texture.format, ETextureAccessType::eSampled
+					, ETextureType::e2D, 1, texture.mipLevels);
+				auto rgbaDesc = textureDesc;
+				rgbaDesc.format = ETextureFormat::E_R8G8B8A8_UNORM;
+				EncodeBlockRows(texture.format, texture.mips.data() + rgbaDesc.GetMipDataOffset(job.mip)
+					, textureDesc.GetMipWidth(job.mip), textureDesc.GetMipHeight(job.mip)
+					, job.blockRowBegin, job.blockRowEnd
+					, batch->encodedTextures[job.textureID].data() + textureDesc.GetMipDataOffset(job.mip));
+			};
+		auto store = [batch]()
+			{
+				for (uint32_t textureID = 0; textureID < batch->textures.size(); ++textureID)
+				{
+					auto& texture = batch->textures[textureID];
+					auto& encoded = batch->encodedTextures[textureID];
+					StoreMips(texture.resource, texture.mipResources, encoded.data(), encoded.size(), texture.width, texture.height, texture.format, texture.mipLevels);
+				}
+			};
+
+		if (scheduler == nullptr)
+		{
+			for (uint32_t jobID = 0; jobID < batch->jobs.size(); ++jobID)
+			{
+				encode(jobID);
+			}
+			store();
+			return;
+		}
+		auto encodeTask = scheduler->NewTaskParallelFor()
+			->Name("Encode Textures")
+			->JobCount(static_cast<uint32_t>(batch->jobs.size()))
+			->Functor(encode);
+		scheduler->NewTask()
+			->Name("Store Encoded Textures")
+			->DependsOn(encodeTask)
+			->Functor(castl::move(store));
+	}
+}
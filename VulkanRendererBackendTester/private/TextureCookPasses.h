@@ -0,0 +1,77 @@
+#pragma once
+#include <Common.h>
+#include <CASTL/CAVector.h>
+#include <CASTL/CAMutex.h>
+#include <CASTL/CAString.h>
+
+namespace thread_management
+{
+	class TaskScheduler;
+}
+
+namespace resource_management
+{
+	class ResourceManagingSystem;
+	class TextureResource;
+	class TextureMipResource;
+
+	enum class ETextureCookUsage : uint8_t
+	{
+		//sRGB encoded color, mips are filtered in linear space
+		eColor,
+		//Normals and other data, filtered as stored
+		eLinear,
+	};
+
+	struct TextureCookSettings
+	{
+		//Box filtered mips down to 1x1
+		bool generateMips = true;
+		//BC1/BC3 for color, BC5 for two channel textures. Single channel textures stay uncompressed
+		bool blockCompress = true;
+		//BC7 instead of BC1/BC3, higher quality at a higher encoding cost
+		bool highQuality = false;
+		//Color textures sample as linear values, keep off while shaders treat texture values as display values
+		bool srgbFormats = false;
+		//Mips up to this size load with the texture, larger ones are stored as TextureMipResources that stream in. 0 keeps every mip in the texture
+		uint32_t residentMipSize = 128;
+	};
+
+	//Mips are built when a texture is added, block compression is queued and split into block row jobs when the import batch ends
+	class TextureCooker
+	{
+	public:
+		void SetCookSettings(TextureCookSettings const& cookSettings) { m_CookSettings = cookSettings; }
+		TextureCookSettings const& GetCookSettings() const { return m_CookSettings; }
+		//Allocates the texture and its streamed mips as sub resources of outPath. Texels hold channelCount 8 bit channels, rows are tightly packed. Thread safe
+		void AddTexture(ResourceManagingSystem* resourceManager, castl::string const& outPath, castl::string const& texturePath
+			, uint8_t const* pTexels, uint32_t width, uint32_t height, uint32_t channelCount, ETextureCookUsage usage);
+		//Encodes the queued textures on tasks of the scheduler, inline when it is null
+		void EncodePendingTextures(thread_management::TaskScheduler* scheduler);
+
+		//RGBA8 mips largest first, one after another
+		static castl::vector<uint8_t> BuildMipChain(uint8_t const* pRGBA, uint32_t width, uint32_t height, uint32_t mipLevels, bool srgb);
+		//Encodes 4x4 block rows [blockRowBegin, blockRowEnd) of an RGBA8 image, pDest points at the first block of the image
+		static void EncodeBlockRows(ETextureFormat format, uint8_t const* pRGBA, uint32_t width, uint32_t height
+			, uint32_t blockRowBegin, uint32_t blockRowEnd, uint8_t* pDest);
+	private:
+		struct PendingTexture
+		{
+			TextureResource* resource;
+			castl::vector<TextureMipResource*> mipResources;
+			ETextureFormat format;
+			uint32_t width;
+			uint32_t height;
+			uint32_t mipLevels;
+			castl::vector<uint8_t> mips;
+		};
+
+		//Splits data laid out as the full mip chain between the streamed mip resources and the texture
+		static void StoreMips(TextureResource* resource, castl::vector<TextureMipResource*> const& mipResources, uint8_t const* pData, uint64_t dataSize
+			, uint32_t width, uint32_t height, ETextureFormat format, uint32_t mipLevels);
+
+		TextureCookSettings m_CookSettings;
+		castl::mutex m_Mutex;
+		castl::vector<PendingTexture> m_PendingTextures;
+	};
+}
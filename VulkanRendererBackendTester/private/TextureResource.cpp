@@ -12,7 +12,7 @@ namespace resource_management
 		cacore::deserializer<decltype(data)> deserializer(data);
 		deserializer.deserialize(*this);
 	}
-	void TextureResource::SetData(void* data, uint64_t size)
+	void TextureResource::SetData(void const* data, uint64_t size)
 	{
 		m_Bytes.resize(size);
 		memcpy(m_Bytes.data(), data, size);
@@ -26,4 +26,19 @@ namespace resource_management
 		m_Format = format;
 		m_Type = type;
 	}
+
+	void TextureMipResource::Serialzie(castl::vector<uint8_t>& data)
+	{
+		cacore::serialize(data, *this);
+	}
+	void TextureMipResource::Deserialzie(castl::vector<uint8_t>& data)
+	{
+		cacore::deserializer<decltype(data)> deserializer(data);
+		deserializer.deserialize(*this);
+	}
+	void TextureMipResource::SetData(void const* data, uint64_t size)
+	{
+		m_Bytes.resize(size);
+		memcpy(m_Bytes.data(), data, size);
+	}
 }
\ No newline at end of file
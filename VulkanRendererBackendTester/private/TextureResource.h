@@ -14,15 +14,22 @@ namespace resource_management
 	public:
 		virtual void Serialzie(castl::vector<uint8_t>& out) override;
 		virtual void Deserialzie(castl::vector<uint8_t>& in) override;
-		void SetData(void* data, uint64_t size);
+		virtual uint64_t GetMemorySizeInByte() const override { return m_Bytes.capacity(); }
+		void SetData(void const* data, uint64_t size);
 		void SetMetaData(uint32_t width, uint32_t height, uint32_t slices, uint32_t mipLevels, ETextureFormat format, ETextureType type);
 		uint32_t GetWidth() const { return m_Width; }
 		uint32_t GetHeight() const { return m_Height; }
 		uint32_t GetSlices() const { return m_Slices; }
 		uint32_t GetMipLevels() const { return m_MipLevels; }
+		//Leading mips stored in TextureMipResources, the data holds the mips after them
+		uint32_t GetStreamedMipCount() const { return m_StreamedMipCount; }
+		void SetStreamedMipCount(uint32_t streamedMipCount) { m_StreamedMipCount = streamedMipCount; }
 		void const* GetData() const { return m_Bytes.data(); }
 		uint64_t GetDataSize() const { return m_Bytes.size(); }
 		ETextureFormat GetFormat() const { return m_Format; }
+		ETextureType GetType() const { return m_Type; }
+		//Path of the resource holding a streamed mip of the texture at texturePath
+		static castl::string GetMipResourcePath(castl::string const& texturePath, uint32_t mip) { return texturePath + ".mip" + castl::to_string(mip); }
 	private:
 		std::vector<uint8_t> m_Bytes;
 		ETextureFormat m_Format;
@@ -31,9 +38,26 @@ namespace resource_management
 		uint32_t m_Height;
 		uint32_t m_Slices;
 		uint32_t m_MipLevels;
+		uint32_t m_StreamedMipCount = 0;
 
 		CA_PRIVATE_REFLECTION(TextureResource);
 	};
+
+	//One streamed mip of a texture, loaded on demand
+	class TextureMipResource : public IResource
+	{
+	public:
+		virtual void Serialzie(castl::vector<uint8_t>& out) override;
+		virtual void Deserialzie(castl::vector<uint8_t>& in) override;
+		virtual uint64_t GetMemorySizeInByte() const override { return m_Bytes.capacity(); }
+		void SetData(void const* data, uint64_t size);
+		void const* GetData() const { return m_Bytes.data(); }
+		uint64_t GetDataSize() const { return m_Bytes.size(); }
+	private:
+		std::vector<uint8_t> m_Bytes;
+
+		CA_PRIVATE_REFLECTION(TextureMipResource);
+	};
 }
 
 CA_REFLECTION(resource_management::TextureResource
@@ -43,4 +67,8 @@ CA_REFLECTION(resource_management::TextureResource
 	, m_Width
 	, m_Height
 	, m_Slices
-	, m_MipLevels);
\ No newline at end of file
+	, m_MipLevels
+	, m_StreamedMipCount);
+
+CA_REFLECTION(resource_management::TextureMipResource
+	, m_Bytes);
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "TextureStreamer.h"
+#include <cmath>
+
+using namespace graphics_backend;
+using namespace resource_management;
+
+TextureStreamer::TextureStreamer(castl::shared_ptr<CRenderBackend> pRenderBackend, ResourceManagingSystem* pResourceManager)
+	: m_RenderBackend(pRenderBackend)
+	, m_ResourceManager(pResourceManager)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	for (auto& texture : m_Textures)
+	{
+		texture.mipHandles.clear();
+		m_ResourceManager->ReleaseResourceReference(texture.pResource);
+	}
+}
+
+void TextureStreamer::AddTexture(castl::string const& path, TextureResource* pResource
+	, castl::shared_ptr<ShaderArgList> const& shaderArgs, castl::string const& argName)
+{
+	m_ResourceManager->AddResourceReference(pResource);
+	StreamedTexture texture{};
+	texture.path = path;
+	texture.pResource = pResource;
+	texture.shaderArgs = shaderArgs;
+	texture.argName = argName;
+	texture.desiredMip = pResource->GetStreamedMipCount();
+	texture.mipHandles.resize(pResource->GetStreamedMipCount());
+	m_Textures.push_back(castl::move(texture));
+}
+
+void TextureStreamer::UpdateDesiredMips(castl::unordered_map<ShaderArgList const*, float> const& materialScreenSizes)
+{
+	for (auto& texture : m_Textures)
+	{
+		auto found = materialScreenSizes.find(texture.shaderArgs.get());
+		texture.screenSize = found != materialScreenSizes.end() ? found->second : 0.0f;
+		uint32_t coarsestMip = texture.pResource->GetStreamedMipCount();
+		uint32_t desiredMip = coarsestMip;
+		if (texture.screenSize > 0.0f)
+		{
+			//The texture is assumed to be stretched once over the bounding sphere of what it is drawn on
+			float extent = static_cast<float>(castl::max(texture.pResource->GetWidth(), texture.pResource->GetHeight()));
+			float mip = std::floor(std::log2(castl::max(extent / texture.screenSize, 1.0f)));
+			desiredMip = castl::min(static_cast<uint32_t>(mip), coarsestMip);
+		}
+		//Coarser mips are only asked for two mips past the current one, sizes near a mip boundary do not reallocate every frame
+		if (desiredMip < texture.desiredMip || desiredMip > texture.desiredMip + 1 || desiredMip == coarsestMip)
+		{
+			texture.desiredMip = desiredMip;
+		}
+	}
+}
+
+void TextureStreamer::Update(GPUGraph* pGraph)
+{
+	uint64_t budget = m_MemoryBudget;
+	GPUMemoryStatistics statistics = m_RenderBackend->GetGPUMemoryStatistics();
+	if (statistics.deviceLocalBudget > 0)
+	{
+		uint64_t headroom = statistics.deviceLocalBudget > statistics.deviceLocalUsage ? statistics.deviceLocalBudget - statistics.deviceLocalUsage : 0;
+		budget = castl::min(budget, m_AllocatedBytes + headroom);
+	}
+
+	//Over budget, the texture that is finest relative to what it asks for gives up a mip first, smaller ones on screen before larger ones
+	castl::vector<uint32_t> targetMips(m_Textures.size());
+	uint64_t targetBytes = 0;
+	for (uint32_t textureID = 0; textureID < m_Textures.size(); ++textureID)
+	{
+		targetMips[textureID] = m_Textures[textureID].desiredMip;
+		targetBytes += GetMipChainSize(m_Textures[textureID], targetMips[textureID]);
+	}
+	while (targetBytes > budget)
+	{
+		int32_t candidateID = -1;
+		for (uint32_t textureID = 0; textureID < m_Textures.size(); ++textureID)
+		{
+			auto& texture = m_Textures[textureID];
+			if (targetMips[textureID] >= texture.pResource->GetStreamedMipCount())
+			{
+				continue;
+			}
+			if (candidateID < 0)
+			{
+				candidateID = textureID;
+				continue;
+			}
+			auto& candidate = m_Textures[candidateID];
+			uint32_t bias = targetMips[textureID] - texture.desiredMip;
+			uint32_t candidateBias = targetMips[candidateID] - candidate.desiredMip;
+			if (bias < candidateBias || (bias == candidateBias && texture.screenSize < candidate.screenSize))
+			{
+				candidateID = textureID;
+			}
+		}
+		if (candidateID < 0)
+		{
+			break;
+		}
+		auto& candidate = m_Textures[candidateID];
+		targetBytes -= GetMipChainSize(candidate, targetMips[candidateID]) - GetMipChainSize(candidate, targetMips[candidateID] + 1);
+		++targetMips[candidateID];
+	}
+
+	m_AllocatedBytes = 0;
+	for (uint32_t textureID = 0; textureID < m_Textures.size(); ++textureID)
+	{
+		UpdateTexture(pGraph, m_Textures[textureID], targetMips[textureID]);
+		m_AllocatedBytes += GetMipChainSize(m_Textures[textureID], m_Textures[textureID].allocatedMip);
+	}
+}
+
+GPUTextureDescriptor TextureStreamer::GetMipChainDescriptor(StreamedTexture const& texture, uint32_t firstMip)
+{
+	auto pResource = texture.pResource;
+	auto sourceDesc = GPUTextureDescriptor::Create(pResource->GetWidth(), pResource->GetHeight(), pResource->GetFormat()
+		, ETextureAccessType::eSampled | ETextureAccessType::eTransferDst, pResource->GetType(), pResource->GetSlices(), pResource->GetMipLevels());
+	return GPUTextureDescriptor::Create(sourceDesc.GetMipWidth(firstMip), sourceDesc.GetMipHeight(firstMip), sourceDesc.format
+		, sourceDesc.accessType, sourceDesc.textureType, sourceDesc.GetMipLayers(firstMip), sourceDesc.mipLevels - firstMip);
+}
+
+uint64_t TextureStreamer::GetMipChainSize(StreamedTexture const& texture, uint32_t firstMip)
+{
+	auto desc = GetMipChainDescriptor(texture, firstMip);
+	return desc.GetMipDataOffset(desc.mipLevels);
+}
+
+void TextureStreamer::UpdateTexture(GPUGraph* pGraph, StreamedTexture& texture, uint32_t targetMip)
+{
+	uint32_t streamedMipCount = texture.pResource->GetStreamedMipCount();
+	//Mips finer than the target are released, loads still queued are canceled
+	for (uint32_t mipID = 0; mipID < targetMip; ++mipID)
+	{
+		texture.mipHandles[mipID].Cancel();
+	}
+	for (uint32_t mipID = targetMip; mipID < streamedMipCount; ++mipID)
+	{
+		if (!texture.mipHandles[mipID].Valid())
+		{
+			texture.mipHandles[mipID] = m_ResourceManager->LoadResourceAsync<TextureMipResource>(TextureResource::GetMipResourcePath(texture.path, mipID)
+				, EResourceLoadPriority::eNormal, {});
+		}
+	}
+	//Mips only become resident coarse to fine, the next one needed is loaded first
+	uint32_t loadedMip = streamedMipCount;
+	while (loadedMip > targetMip && texture.mipHandles[loadedMip - 1].IsLoaded())
+	{
+		--loadedMip;
+	}
+	if (loadedMip > targetMip)
+	{
+		texture.mipHandles[loadedMip - 1].RaisePriority(EResourceLoadPriority::eHigh);
+	}
+
+	bool rebind = false;
+	if (texture.texture == nullptr || texture.allocatedMip != targetMip)
+	{
+		//Old textures are released once the frames using them are done, the new one gets the resident mips uploaded again
+		auto desc = GetMipChainDescriptor(texture, targetMip);
+		texture.texture = m_RenderBackend->CreateGPUTexture(desc);
+		texture.allocatedMip = targetMip;
+		texture.residentMip = texture.pResource->GetMipLevels();
+		m_ResourceManager->SetExternalMemorySize(texture.pResource, desc.GetMipDataOffset(desc.mipLevels));
+		rebind = true;
+	}
+
+	auto& desc = texture.texture->GetDescriptor();
+	if (texture.residentMip > streamedMipCount)
+	{
+		pGraph->ScheduleData(texture.texture, texture.pResource->GetData(), texture.pResource->GetDataSize()
+			, desc.GetMipDataOffset(streamedMipCount - texture.allocatedMip));
+		texture.residentMip = streamedMipCount;
+		rebind = true;
+	}
+	while (texture.residentMip > loadedMip)
+	{
+		--texture.residentMip;
+		TextureMipResource* pMip = texture.mipHandles[texture.residentMip].Get();
+		pGraph->ScheduleData(texture.texture, pMip->GetData(), pMip->GetDataSize()
+			, desc.GetMipDataOffset(texture.residentMip - texture.allocatedMip));
+		rebind = true;
+	}
+
+	if (rebind)
+	{
+		texture.shaderArgs->SetImage(texture.argName, texture.texture
+			, GPUTextureView::CreateForResidentMips(desc.format, texture.residentMip - texture.allocatedMip));
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <CRenderBackend.h>
+#include <GPUGraph.h>
+#include <CAResource/ResourceManagingSystem.h>
+#include <CASTL/CAUnorderedMap.h>
+#include "TextureResource.h"
+
+//Keeps the mips of streamed textures resident by how large they are drawn.
+//Mips cooked into the texture resource are always resident, finer ones are loaded as TextureMipResources and uploaded through the frame graph.
+//A texture is allocated down to its target mip at once and its view starts at the finest mip uploaded so far
+class TextureStreamer
+{
+public:
+	TextureStreamer(castl::shared_ptr<graphics_backend::CRenderBackend> pRenderBackend, resource_management::ResourceManagingSystem* pResourceManager);
+	TextureStreamer(TextureStreamer const&) = delete;
+	TextureStreamer& operator=(TextureStreamer const&) = delete;
+	~TextureStreamer();
+
+	//Device memory the streamed textures may take, their always resident mips included. Never more than the device budget has left
+	void SetMemoryBudget(uint64_t budgetInBytes) { m_MemoryBudget = budgetInBytes; }
+	//The texture is bound to argName of shaderArgs and bound again whenever its resident mips change.
+	//The streamer references the texture resource until it is destroyed
+	void AddTexture(castl::string const& path, resource_management::TextureResource* pResource
+		, castl::shared_ptr<graphics_backend::ShaderArgList> const& shaderArgs, castl::string const& argName);
+	//Screen sizes in pixels of the materials drawn last frame, see MeshBatcher::GetMaterialScreenSizes.
+	//Textures of materials that were not drawn fall back to their always resident mips
+	void UpdateDesiredMips(castl::unordered_map<graphics_backend::ShaderArgList const*, float> const& materialScreenSizes);
+	//Fits the desired mips into the budget, loads and releases mips, uploads the loaded ones and rebinds changed textures.
+	//Call before the graph draws with the bound shader arguments
+	void Update(graphics_backend::GPUGraph* pGraph);
+	uint64_t GetAllocatedBytes() const { return m_AllocatedBytes; }
+private:
+	struct StreamedTexture
+	{
+		castl::string path;
+		resource_management::TextureResource* pResource;
+		castl::shared_ptr<graphics_backend::ShaderArgList> shaderArgs;
+		castl::string argName;
+		castl::shared_ptr<graphics_backend::GPUTexture> texture;
+		//Source mip of the GPU texture's mip 0
+		uint32_t allocatedMip = 0;
+		//Finest source mip uploaded, the view starts at it
+		uint32_t residentMip = 0;
+		uint32_t desiredMip = 0;
+		float screenSize = 0.0f;
+		//Indexed by source mip, loads of mips coarser than the target are kept so reallocated textures can be uploaded again
+		castl::vector<resource_management::ResourceLoadHandle<resource_management::TextureMipResource>> mipHandles;
+	};
+
+	//Descriptor of the source mip chain from firstMip on
+	static graphics_backend::GPUTextureDescriptor GetMipChainDescriptor(StreamedTexture const& texture, uint32_t firstMip);
+	static uint64_t GetMipChainSize(StreamedTexture const& texture, uint32_t firstMip);
+	void UpdateTexture(graphics_backend::GPUGraph* pGraph, StreamedTexture& texture, uint32_t targetMip);
+
+	castl::shared_ptr<graphics_backend::CRenderBackend> m_RenderBackend;
+	resource_management::ResourceManagingSystem* m_ResourceManager;
+	uint64_t m_MemoryBudget = 256ull * 1024 * 1024;
+	uint64_t m_AllocatedBytes = 0;
+	castl::vector<StreamedTexture> m_Textures;
+};